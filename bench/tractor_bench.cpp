@@ -0,0 +1,493 @@
+// Throughput and latency benchmark of Tty and Serial over pseudo terminals
+//
+// usage: tractor_bench [--stream nmea|fixed|prefixed|all] [--dispatch inline|queued|reactor|uring|all]
+//                      [--frames N] [--rate FRAMES_PER_SECOND] [--size BYTES] [--no-tty]
+//
+// A producer thread writes synthetic frames to the master side of a pty pair, Serial (or a bare Tty)
+// reads the slave side. Every frame carries its sequence number, so the delivery latency of each
+// frame is measured from just before its write() to its callback. A rate of 0 (the default) sends
+// as fast as the pty accepts, which measures throughput; latency is only meaningful with a rate the
+// receiver can keep up with.
+
+#include "tractor/comms/reactor.hpp"
+#include "tractor/comms/serial.hpp"
+#include "tractor/comms/tty.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace tractor::comms;
+using Clock = std::chrono::steady_clock;
+
+// Every allocation of the process is counted, the benchmark itself does not allocate while measuring
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { std::free(pointer); }
+
+namespace {
+
+    enum class Stream { Nmea, Fixed, Prefixed };
+    enum class Dispatch { Inline, Queued, Reactor, Uring };
+
+    struct BenchOptions {
+        std::vector<Stream> streams = {Stream::Nmea, Stream::Fixed, Stream::Prefixed};
+        std::vector<Dispatch> dispatches = {Dispatch::Inline, Dispatch::Queued, Dispatch::Reactor, Dispatch::Uring};
+        size_t frames = 100000;
+        double rate = 0.0; // Frames per second, 0 sends as fast as possible
+        size_t size = 72;  // Bytes per frame on the wire
+        bool tty = true;
+    };
+
+    struct Result {
+        double seconds = 0.0;
+        size_t bytes = 0;
+        size_t frames = 0;
+        uint64_t reads = 0;
+        uint64_t allocations = 0;
+        std::vector<uint64_t> latencies_ns; // Per delivered frame, sorted
+    };
+
+    const char *stream_name(Stream stream) {
+        switch (stream) {
+        case Stream::Nmea:
+            return "nmea";
+        case Stream::Fixed:
+            return "fixed";
+        case Stream::Prefixed:
+            return "prefixed";
+        }
+        return "";
+    }
+
+    const char *dispatch_name(Dispatch dispatch) {
+        switch (dispatch) {
+        case Dispatch::Inline:
+            return "inline";
+        case Dispatch::Queued:
+            return "queued";
+        case Dispatch::Reactor:
+            return "reactor";
+        case Dispatch::Uring:
+            return "uring";
+        }
+        return "";
+    }
+
+    // Pseudo terminal pair, the producer writes to the master side
+    struct PtyPair {
+        int master = -1;
+        std::string slave;
+
+        PtyPair() {
+            master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0) {
+                slave = ptsname(master);
+            }
+        }
+
+        ~PtyPair() {
+            if (master >= 0) {
+                ::close(master);
+            }
+        }
+    };
+
+    // Read syscalls of the whole process, from /proc/self/io
+    uint64_t read_syscalls() {
+        std::ifstream io("/proc/self/io");
+        std::string key;
+        uint64_t value = 0;
+        while (io >> key >> value) {
+            if (key == "syscr:") {
+                return value;
+            }
+        }
+        return 0;
+    }
+
+    // Frames of the given stream with the sequence number embedded, all back to back in one buffer
+    std::vector<uint8_t> build_frames(Stream stream, size_t count, size_t size) {
+        std::vector<uint8_t> wire;
+        wire.reserve(count * size);
+        char sentence[512];
+        for (size_t seq = 0; seq < count; seq++) {
+            switch (stream) {
+            case Stream::Nmea: {
+                // $TRBNC,<sequence>,<padding>*hh\r\n
+                int length = std::snprintf(sentence, sizeof(sentence), "$TRBNC,%08zu,", seq);
+                size_t body = std::max(size, size_t{22}) - 5;
+                std::memset(sentence + length, 'A', body - static_cast<size_t>(length));
+                uint8_t checksum = 0;
+                for (size_t i = 1; i < body; i++) {
+                    checksum ^= static_cast<uint8_t>(sentence[i]);
+                }
+                std::snprintf(sentence + body, sizeof(sentence) - body, "*%02X\r\n", checksum);
+                wire.insert(wire.end(), sentence, sentence + body + 5);
+                break;
+            }
+            case Stream::Fixed:
+            case Stream::Prefixed: {
+                size_t payload = stream == Stream::Prefixed ? size - 1 : size;
+                if (stream == Stream::Prefixed) {
+                    wire.push_back(static_cast<uint8_t>(payload));
+                }
+                uint32_t sequence = static_cast<uint32_t>(seq);
+                const auto *bytes = reinterpret_cast<const uint8_t *>(&sequence);
+                wire.insert(wire.end(), bytes, bytes + sizeof(sequence));
+                wire.insert(wire.end(), payload - sizeof(sequence), 0x55);
+                break;
+            }
+            }
+        }
+        return wire;
+    }
+
+    size_t sequence_of(Stream stream, const uint8_t *data, size_t size) {
+        if (stream == Stream::Nmea) {
+            return size > 15 ? static_cast<size_t>(std::strtoul(reinterpret_cast<const char *>(data) + 7, nullptr, 10))
+                             : SIZE_MAX;
+        }
+        uint32_t sequence;
+        if (size < sizeof(sequence)) {
+            return SIZE_MAX;
+        }
+        std::memcpy(&sequence, data, sizeof(sequence));
+        return sequence;
+    }
+
+    /**
+     * Writes the prepared frames to the master side, either paced at the requested rate or in
+     * large chunks as fast as the pty accepts them. Records the send time of every frame.
+     */
+    class Producer {
+      public:
+        Producer(int fd, const std::vector<uint8_t> &wire, size_t frame_size, double rate,
+                 std::vector<std::atomic<int64_t>> &sent)
+            : fd_(fd), wire_(wire), frame_size_(frame_size), rate_(rate), sent_(sent) {}
+
+        void run() {
+            const size_t frames = wire_.size() / frame_size_;
+            const auto start = Clock::now();
+            const size_t batch = rate_ > 0.0 ? 1 : std::max<size_t>(4096 / frame_size_, 1);
+            for (size_t frame = 0; frame < frames;) {
+                if (rate_ > 0.0) {
+                    std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                                                              std::chrono::duration<double>(frame / rate_)));
+                }
+
+                // Send everything that is due in one write
+                size_t due = batch;
+                if (rate_ > 0.0) {
+                    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+                    due = std::max<size_t>(static_cast<size_t>(elapsed * rate_) + 1 - frame, 1);
+                }
+                due = std::min(due, frames - frame);
+
+                int64_t now = Clock::now().time_since_epoch().count();
+                for (size_t i = 0; i < due; i++) {
+                    sent_[frame + i].store(now, std::memory_order_relaxed);
+                }
+                write_all(wire_.data() + frame * frame_size_, due * frame_size_);
+                frame += due;
+            }
+        }
+
+      private:
+        int fd_;
+        const std::vector<uint8_t> &wire_;
+        size_t frame_size_;
+        double rate_;
+        std::vector<std::atomic<int64_t>> &sent_;
+
+        void write_all(const uint8_t *data, size_t size) {
+            while (size > 0) {
+                ssize_t written = ::write(fd_, data, size);
+                if (written <= 0) {
+                    return;
+                }
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+    };
+
+    // Waits until `expected` frames were delivered or nothing arrived for a second
+    template <typename Progress> void wait_for_frames(size_t expected, Progress progress) {
+        size_t last = 0;
+        auto last_change = Clock::now();
+        while (progress() < expected && Clock::now() - last_change < std::chrono::seconds(1)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (progress() != last) {
+                last = progress();
+                last_change = Clock::now();
+            }
+        }
+    }
+
+    Result run_serial(const BenchOptions &options, Stream stream, Dispatch dispatch) {
+        Result result;
+        PtyPair pty;
+        if (pty.slave.empty()) {
+            std::fprintf(stderr, "Failed to open a pseudo terminal\n");
+            return result;
+        }
+
+        auto wire = build_frames(stream, options.frames, options.size);
+        const size_t frame_size = wire.size() / options.frames;
+        std::vector<std::atomic<int64_t>> sent(options.frames);
+        std::vector<uint64_t> latencies(options.frames, 0);
+        std::atomic<size_t> delivered{0};
+        std::atomic<int64_t> last_delivery{0};
+
+        SerialOptions serial_options;
+        serial_options.port = pty.slave;
+        serial_options.tty_config.baud_rate = 115200;
+        serial_options.tty_config.read_timeout_ms = 100;
+        serial_options.dispatch = dispatch == Dispatch::Queued ? DispatchMode::Queued : DispatchMode::Inline;
+        serial_options.dispatch_queue_depth = 1024;
+        serial_options.overflow_policy = OverflowPolicy::Block;
+        switch (stream) {
+        case Stream::Nmea:
+            serial_options.framing = FramingMode::LineDelimited;
+            break;
+        case Stream::Fixed:
+            serial_options.framing = FramingMode::FixedLength;
+            serial_options.fixed_length = frame_size;
+            break;
+        case Stream::Prefixed:
+            serial_options.framing = FramingMode::LengthPrefixed;
+            break;
+        }
+
+        auto on_frame = [&](const uint8_t *data, size_t size) {
+            int64_t now = Clock::now().time_since_epoch().count();
+            size_t seq = sequence_of(stream, data, size);
+            if (seq < latencies.size()) {
+                int64_t sent_at = sent[seq].load(std::memory_order_relaxed);
+                latencies[seq] = now > sent_at ? static_cast<uint64_t>(now - sent_at) : 0;
+            }
+            last_delivery.store(now, std::memory_order_relaxed);
+            delivered.fetch_add(1, std::memory_order_release);
+        };
+
+        Serial serial(serial_options);
+        serial.on_line_view([&](std::string_view line) {
+            on_frame(reinterpret_cast<const uint8_t *>(line.data()), line.size());
+        });
+        serial.on_data_view([&](std::span<const uint8_t> data) { on_frame(data.data(), data.size()); });
+
+        std::unique_ptr<SerialReactor> reactor;
+        if (dispatch == Dispatch::Reactor || dispatch == Dispatch::Uring) {
+            ReactorOptions reactor_options;
+            reactor_options.backend = dispatch == Dispatch::Uring ? ReactorBackend::IoUring : ReactorBackend::Epoll;
+            reactor = std::make_unique<SerialReactor>(reactor_options);
+            if (reactor->get_backend() != reactor_options.backend) {
+                std::fprintf(stderr, "%s\n", reactor->get_last_error().c_str());
+                return result;
+            }
+            if (!reactor->start() || !reactor->add(serial)) {
+                std::fprintf(stderr, "Failed to start the reactor: %s\n", reactor->get_last_error().c_str());
+                return result;
+            }
+        } else if (!serial.start()) {
+            std::fprintf(stderr, "Failed to start serial on %s\n", pty.slave.c_str());
+            return result;
+        }
+
+        Producer producer(pty.master, wire, frame_size, options.rate, sent);
+        uint64_t reads_before = read_syscalls();
+        uint64_t allocations_before = allocations.load();
+        auto start = Clock::now();
+
+        std::thread writer(&Producer::run, &producer);
+        wait_for_frames(options.frames, [&] { return delivered.load(std::memory_order_acquire); });
+        writer.join();
+
+        result.allocations = allocations.load() - allocations_before;
+        result.reads = read_syscalls() - reads_before;
+        serial.stop(); // Also takes the port off the reactor
+
+        result.frames = delivered.load();
+        result.bytes = result.frames * frame_size;
+        Clock::time_point end{Clock::duration(last_delivery.load())};
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        for (size_t i = 0; i < latencies.size(); i++) {
+            if (latencies[i] > 0) {
+                result.latencies_ns.push_back(latencies[i]);
+            }
+        }
+        std::sort(result.latencies_ns.begin(), result.latencies_ns.end());
+        return result;
+    }
+
+    // The port alone, without framing: bytes are read as they arrive and counted
+    Result run_tty(const BenchOptions &options) {
+        Result result;
+        PtyPair pty;
+        SerialConfig config;
+        config.baud_rate = 115200;
+        config.read_timeout_ms = 100;
+        Tty tty(pty.slave, config);
+        if (pty.slave.empty() || !tty.open()) {
+            std::fprintf(stderr, "Failed to open the pty: %s\n", tty.get_last_error().c_str());
+            return result;
+        }
+
+        auto wire = build_frames(Stream::Fixed, options.frames, options.size);
+        std::vector<std::atomic<int64_t>> sent(options.frames);
+        Producer producer(pty.master, wire, options.size, options.rate, sent);
+
+        std::vector<uint8_t> buffer(4096);
+        uint64_t reads_before = read_syscalls();
+        uint64_t allocations_before = allocations.load();
+        auto start = Clock::now();
+        auto end = start;
+        std::thread writer(&Producer::run, &producer);
+        while (result.bytes < wire.size()) {
+            ssize_t bytes = tty.read(buffer.data(), buffer.size());
+            if (bytes <= 0) {
+                break;
+            }
+            result.bytes += static_cast<size_t>(bytes);
+            end = Clock::now();
+        }
+        writer.join();
+
+        result.allocations = allocations.load() - allocations_before;
+        result.reads = read_syscalls() - reads_before;
+        result.frames = result.bytes / options.size;
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        return result;
+    }
+
+    double percentile_us(const std::vector<uint64_t> &sorted, double percentile) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[index]) / 1000.0;
+    }
+
+    void print_header() {
+        std::printf("%-9s %-8s %9s %10s %12s %11s %9s %9s %9s %12s\n", "stream", "dispatch", "frames", "MB/s",
+                    "frames/s", "reads/frame", "p50_us", "p99_us", "p999_us", "allocs/frame");
+    }
+
+    void print_result(const char *stream, const char *dispatch, const Result &result) {
+        double seconds = result.seconds > 0.0 ? result.seconds : 1.0;
+        double frames = result.frames > 0 ? static_cast<double>(result.frames) : 1.0;
+        std::printf("%-9s %-8s %9zu %10.2f %12.0f %11.3f", stream, dispatch, result.frames,
+                    static_cast<double>(result.bytes) / seconds / 1e6, static_cast<double>(result.frames) / seconds,
+                    static_cast<double>(result.reads) / frames);
+        if (result.latencies_ns.empty()) {
+            std::printf(" %9s %9s %9s", "-", "-", "-");
+        } else {
+            std::printf(" %9.1f %9.1f %9.1f", percentile_us(result.latencies_ns, 50.0),
+                        percentile_us(result.latencies_ns, 99.0), percentile_us(result.latencies_ns, 99.9));
+        }
+        std::printf(" %12.3f\n", static_cast<double>(result.allocations) / frames);
+        std::fflush(stdout);
+    }
+
+    bool parse_arguments(int argc, char **argv, BenchOptions &options) {
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            std::string_view value = i + 1 < argc ? argv[i + 1] : "";
+            if (arg == "--no-tty") {
+                options.tty = false;
+                continue;
+            }
+            if (value.empty()) {
+                return false;
+            }
+            i++;
+
+            if (arg == "--stream") {
+                if (value == "nmea") {
+                    options.streams = {Stream::Nmea};
+                } else if (value == "fixed") {
+                    options.streams = {Stream::Fixed};
+                } else if (value == "prefixed") {
+                    options.streams = {Stream::Prefixed};
+                } else if (value != "all") {
+                    return false;
+                }
+            } else if (arg == "--dispatch") {
+                if (value == "inline") {
+                    options.dispatches = {Dispatch::Inline};
+                } else if (value == "queued") {
+                    options.dispatches = {Dispatch::Queued};
+                } else if (value == "reactor") {
+                    options.dispatches = {Dispatch::Reactor};
+                } else if (value == "uring") {
+                    options.dispatches = {Dispatch::Uring};
+                } else if (value != "all") {
+                    return false;
+                }
+            } else if (arg == "--frames") {
+                options.frames = std::max<size_t>(std::strtoull(value.data(), nullptr, 10), 1);
+            } else if (arg == "--rate") {
+                options.rate = std::strtod(value.data(), nullptr);
+            } else if (arg == "--size") {
+                // The length prefix is a single byte and every frame carries a 4 byte sequence number
+                options.size = std::clamp<size_t>(std::strtoull(value.data(), nullptr, 10), 24, 256);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    if (!parse_arguments(argc, argv, options)) {
+        std::fprintf(stderr,
+                     "usage: %s [--stream nmea|fixed|prefixed|all] [--dispatch inline|queued|reactor|uring|all]\n"
+                     "       [--frames N] [--rate FRAMES_PER_SECOND] [--size BYTES] [--no-tty]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    if (options.rate > 0.0) {
+        std::printf("%zu frames of %zu bytes at %.0f frames/s\n", options.frames, options.size, options.rate);
+    } else {
+        std::printf("%zu frames of %zu bytes, unlimited rate\n", options.frames, options.size);
+    }
+    print_header();
+    if (options.tty) {
+        print_result("raw", "tty", run_tty(options));
+    }
+    for (Stream stream : options.streams) {
+        for (Dispatch dispatch : options.dispatches) {
+            print_result(stream_name(stream), dispatch_name(dispatch), run_serial(options, stream, dispatch));
+        }
+    }
+    return 0;
+}
@@ -5,15 +5,19 @@
 #include "isobus/isobus/isobus_device_descriptor_object_pool.hpp"
 #include "isobus/isobus/isobus_standard_data_description_indices.hpp"
 #include "isobus/isobus/isobus_task_controller_client.hpp"
+#include "tractor/can/gnss_bridge.hpp"
 #include "tractor/comms/serial.hpp"
+#include "tractor/nmea/dispatcher.hpp"
+#include "tractor/nmea/fix_history.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <csignal>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 
 // Global state
@@ -21,14 +25,12 @@ static std::atomic_bool running = true;
 static std::atomic<std::int32_t> gnss_auth_status = 0; // 0=unauthenticated, 1=authenticated, 2=degraded
 static std::atomic<std::int32_t> gnss_warning = 0;
 
-// GPS position data (for TC-GEO)
-static std::atomic<double> gnss_latitude = 0.0;
-static std::atomic<double> gnss_longitude = 0.0;
-static std::atomic<double> gnss_altitude = 0.0;
-static std::atomic<bool> gnss_position_valid = false;
+// GPS position data (for TC-GEO), read lock-free from any thread and never torn between two fixes
+static tractor::nmea::FixHistory gnss_fixes;
+static std::chrono::steady_clock::time_point nmea_line_time; // Arrival of the sentence being dispatched
 
-// Pointer to TC client (needed for GPS updates)
-static std::shared_ptr<isobus::TaskControllerClient> g_tc_client = nullptr;
+// Sends the GNSS fix as NMEA 2000 Position Rapid Update, COG/SOG Rapid Update and GNSS Position Data
+static tractor::can::GnssBridge gnss_bridge;
 
 void signal_handler(int) { running = false; }
 
@@ -49,204 +51,45 @@ enum class DDOPObjectIDs : std::uint16_t {
     WidthPresentation = 101
 };
 
-// PHTG (Proprietary GNSS Authentication) sentence structure
-struct PHTGData {
-    std::string date;    // Field 0: Date (DD:MM:YYYY)
-    std::string time;    // Field 1: Time (HH:MM:SS.SS)
-    std::string system;  // Field 2: GNSS System
-    std::string service; // Field 3: Service (e.g., HAS, OSNMA)
-    int auth_result;     // Field 4: Authentication result (0=fail, 1=pass)
-    int warning;         // Field 5: Warning status
-};
-
-// GGA (GPS Fix Data) sentence structure
-struct GGAData {
-    double latitude;  // Decimal degrees
-    double longitude; // Decimal degrees
-    double altitude;  // Meters above sea level
-    int fix_quality;  // 0=invalid, 1=GPS, 2=DGPS, 4=RTK Fixed, 5=RTK Float
-    int num_sats;     // Number of satellites
-    double hdop;      // Horizontal dilution of precision
-};
-
-bool validate_checksum(const std::string &sentence) {
-    size_t star_pos = sentence.find('*');
-    if (star_pos == std::string::npos || star_pos + 2 >= sentence.length()) {
-        return false;
-    }
-
-    std::uint8_t calc_cs = 0;
-    for (size_t i = 1; i < star_pos; i++) {
-        calc_cs ^= static_cast<std::uint8_t>(sentence[i]);
-    }
-
-    std::string cs_str = sentence.substr(star_pos + 1, 2);
-    int recv_cs = std::stoi(cs_str, nullptr, 16);
-
-    return calc_cs == recv_cs;
-}
-
-// Convert NMEA coordinate format (DDMM.MMMM) to decimal degrees
-double nmea_to_decimal(const std::string &coord, const std::string &direction) {
-    if (coord.empty())
-        return 0.0;
-
-    // Find decimal point
-    size_t dot_pos = coord.find('.');
-    if (dot_pos == std::string::npos || dot_pos < 2)
-        return 0.0;
-
-    // Extract degrees and minutes
-    int degrees = std::stoi(coord.substr(0, dot_pos - 2));
-    double minutes = std::stod(coord.substr(dot_pos - 2));
-
-    double decimal = degrees + (minutes / 60.0);
-
-    // Apply direction (S and W are negative)
-    if (direction == "S" || direction == "W") {
-        decimal = -decimal;
-    }
-
-    return decimal;
-}
-
-bool parse_phtg(const std::string &sentence, PHTGData &data) {
-    if (sentence.substr(0, 5) != "$PHTG") {
-        return false;
-    }
-
-    if (!validate_checksum(sentence)) {
-        return false;
-    }
+// Routes sentences by type, so every talker (GP, GN, GL, ...) reaches the same handler
+static tractor::nmea::Dispatcher nmea_dispatcher;
 
-    size_t star_pos = sentence.find('*');
-    std::string body = sentence.substr(6, star_pos - 6);
-
-    std::stringstream ss(body);
-    std::string token;
-    int field = 0;
-
-    while (std::getline(ss, token, ',')) {
-        switch (field) {
-        case 0:
-            data.date = token;
-            break;
-        case 1:
-            data.time = token;
-            break;
-        case 2:
-            data.system = token;
-            break;
-        case 3:
-            data.service = token;
-            break;
-        case 4:
-            data.auth_result = token.empty() ? 0 : std::stoi(token);
-            break;
-        case 5:
-            data.warning = token.empty() ? 0 : std::stoi(token);
-            break;
-        }
-        field++;
-    }
-
-    return field >= 6;
-}
-
-bool parse_gga(const std::string &sentence, GGAData &data) {
-    if (sentence.substr(0, 6) != "$GPGGA" && sentence.substr(0, 6) != "$GNGGA") {
-        return false;
-    }
+void register_nmea_handlers() {
+    // Process PHTG (Authentication) messages
+    nmea_dispatcher.on<tractor::nmea::PHTG>([](const tractor::nmea::PHTG &phtg) {
+        std::cout << "PHTG: [" << phtg.date.view() << " " << phtg.time.view() << "] " << phtg.system.view() << "/"
+                  << phtg.service.view() << " Auth=" << phtg.auth_result << " Warn=" << phtg.warning << "\n";
 
-    if (!validate_checksum(sentence)) {
-        return false;
-    }
+        gnss_auth_status.store(phtg.auth_result);
+        gnss_warning.store(phtg.warning);
+    });
 
-    size_t star_pos = sentence.find('*');
-    std::string body = sentence.substr(7, star_pos - 7);
-
-    std::stringstream ss(body);
-    std::string token;
-    int field = 0;
-
-    std::string lat_str, lat_dir, lon_str, lon_dir, alt_str;
-
-    while (std::getline(ss, token, ',')) {
-        switch (field) {
-        case 0: /* time */
-            break;
-        case 1:
-            lat_str = token;
-            break;
-        case 2:
-            lat_dir = token;
-            break;
-        case 3:
-            lon_str = token;
-            break;
-        case 4:
-            lon_dir = token;
-            break;
-        case 5:
-            data.fix_quality = token.empty() ? 0 : std::stoi(token);
-            break;
-        case 6:
-            data.num_sats = token.empty() ? 0 : std::stoi(token);
-            break;
-        case 7:
-            data.hdop = token.empty() ? 0.0 : std::stod(token);
-            break;
-        case 8:
-            alt_str = token;
-            break;
+    // Process GGA (GPS position) messages
+    nmea_dispatcher.on<tractor::nmea::GGA>([](const tractor::nmea::GGA &gga) {
+        if (gga.fix_quality == 0) {
+            return;
         }
-        field++;
-    }
 
-    if (field < 9)
-        return false;
+        gnss_fixes.update(gga, nmea_line_time);
 
-    data.latitude = nmea_to_decimal(lat_str, lat_dir);
-    data.longitude = nmea_to_decimal(lon_str, lon_dir);
-    data.altitude = alt_str.empty() ? 0.0 : std::stod(alt_str);
+        std::cout << "GGA: Lat=" << gga.latitude << " Lon=" << gga.longitude << " Alt=" << gga.altitude
+                  << " Fix=" << static_cast<int>(gga.fix_quality) << " Sats=" << static_cast<int>(gga.satellites)
+                  << "\n";
 
-    return data.fix_quality > 0;
-}
+        // Position, COG/SOG and GNSS Position Data go out on the bus as NMEA 2000 messages
+        gnss_bridge.update(gga);
+    });
 
-void process_nmea_line(const std::string &line) {
-    // Process PHTG (Authentication) messages
-    if (line.substr(0, 5) == "$PHTG") {
-        PHTGData phtg;
-        if (parse_phtg(line, phtg)) {
-            std::cout << "PHTG: [" << phtg.date << " " << phtg.time << "] " << phtg.system << "/" << phtg.service
-                      << " Auth=" << phtg.auth_result << " Warn=" << phtg.warning << "\n";
-
-            gnss_auth_status.store(phtg.auth_result);
-            gnss_warning.store(phtg.warning);
-        }
-    }
-    // Process GPGGA (GPS position) messages
-    else if (line.substr(0, 6) == "$GPGGA" || line.substr(0, 6) == "$GNGGA") {
-        GGAData gga;
-        if (parse_gga(line, gga)) {
-            gnss_latitude.store(gga.latitude);
-            gnss_longitude.store(gga.longitude);
-            gnss_altitude.store(gga.altitude);
-            gnss_position_valid.store(true);
-
-            std::cout << "GGA: Lat=" << gga.latitude << " Lon=" << gga.longitude << " Alt=" << gga.altitude
-                      << " Fix=" << gga.fix_quality << " Sats=" << gga.num_sats << "\n";
-
-            // Send position to Task Controller via TC-GEO mechanism
-            if (g_tc_client != nullptr) {
-                // TC-GEO expects position in specific format
-                // The library will handle PGN 0x1FDD generation
-                // Note: Check your AgIsoStack++ version for exact API
-                // Some versions use: set_gps_position() or update_position()
-                // For now, we'll store it and let the TC client handle it in its update cycle
-            }
-        }
-    }
+    // Course, speed and date for the NMEA 2000 messages
+    nmea_dispatcher.on<tractor::nmea::RMC>([](const tractor::nmea::RMC &rmc) {
+        gnss_fixes.update(rmc);
+        gnss_bridge.update(rmc);
+    });
+    nmea_dispatcher.on<tractor::nmea::VTG>([](const tractor::nmea::VTG &vtg) {
+        gnss_fixes.update(vtg);
+        gnss_bridge.update(vtg);
+    });
+    nmea_dispatcher.on<tractor::nmea::GSA>([](const tractor::nmea::GSA &gsa) { gnss_bridge.update(gsa); });
 }
 
 // Create ISOBUS-TC compliant DDOP with proprietary DDIs
@@ -407,7 +250,6 @@ int main(int argc, char **argv) {
 
     // Create Task Controller Client
     auto tc = std::make_shared<isobus::TaskControllerClient>(tc_partner, my_ecu, nullptr);
-    g_tc_client = tc; // Store globally for GPS updates
 
     // Create DDOP with proprietary DDIs
     auto ddop = std::make_shared<isobus::DeviceDescriptorObjectPool>();
@@ -451,7 +293,11 @@ int main(int argc, char **argv) {
     // Set up serial communication for NMEA data
     auto nmea_serial = std::make_shared<tractor::comms::Serial>(serial_device, serial_baud);
 
-    nmea_serial->on_line([](const std::string &line) { process_nmea_line(line); });
+    register_nmea_handlers();
+    nmea_serial->on_line_view([](std::string_view line, const tractor::comms::FrameInfo &info) {
+        nmea_line_time = info.arrival;
+        nmea_dispatcher.dispatch(line);
+    });
 
     nmea_serial->on_connection([](bool connected) {
         if (connected) {
@@ -471,21 +317,15 @@ int main(int argc, char **argv) {
     std::cout << "\n✅ System running... Press Ctrl+C to exit\n";
     std::cout << "========================================\n\n";
 
-    // Main loop - TC client updates and GPS position transmission
+    // The position bridge sends on its own thread at fixed rates
+    gnss_bridge.start();
+
+    // Main loop - TC client updates run in the background, the GNSS bridge reports whether a fix is being sent
     while (running) {
         std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 
-        // TODO: Send GPS position via TC-GEO
-        // The exact API depends on AgIsoStack++ version
-        // Common methods:
-        //   tc->set_gps_position(lat, lon, alt);
-        //   tc->update_position(...);
-        // This generates TC-GEO messages (PGN 0x1FDD) for the Task Controller
-
-        if (gnss_position_valid.load()) {
-            // Position is ready to be sent
-            // Uncomment and adapt based on your library version:
-            // tc->set_gps_position(gnss_latitude.load(), gnss_longitude.load(), gnss_altitude.load());
+        if (gnss_fixes.count() > 0 && !gnss_bridge.has_fix()) {
+            std::cout << "⚠️  GNSS fix is stale, NMEA 2000 position output paused\n";
         }
     }
 
@@ -494,6 +334,7 @@ int main(int argc, char **argv) {
     std::cout << "========================================\n";
 
     nmea_serial->stop();
+    gnss_bridge.stop();
     tc->terminate();
     isobus::CANHardwareInterface::stop();
 
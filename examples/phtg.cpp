@@ -7,13 +7,14 @@
 #include "isobus/isobus/isobus_standard_data_description_indices.hpp"
 #include "isobus/isobus/isobus_task_controller_client.hpp"
 #include "tractor/comms/serial.hpp"
+#include "tractor/nmea/nmea.hpp"
 
 #include <atomic>
 #include <csignal>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 
 static std::atomic_bool running = true;
@@ -23,112 +24,12 @@ static std::atomic<std::int32_t> gnss_warning = 0;
 
 void signal_handler(int) { running = false; }
 
-struct PHTGData {
-    std::string date;
-    std::string time;
-    std::string system;
-    std::string service;
-    int auth_result;
-    int warning;
-};
-
-bool validate_checksum(const std::string &sentence) {
-    try {
-        size_t star_pos = sentence.find('*');
-        if (star_pos == std::string::npos || star_pos + 2 >= sentence.length()) {
-            return false;
-        }
-
-        std::uint8_t calc_cs = 0;
-        for (size_t i = 1; i < star_pos; i++) {
-            calc_cs ^= static_cast<std::uint8_t>(sentence[i]);
-        }
-
-        std::string cs_str = sentence.substr(star_pos + 1, 2);
-        if (cs_str.empty() || cs_str.length() < 2) {
-            return false;
-        }
-        int recv_cs = std::stoi(cs_str, nullptr, 16);
-
-        return calc_cs == recv_cs;
-    } catch (...) {
-        return false;
-    }
-}
-
-bool parse_phtg(const std::string &sentence, PHTGData &data) {
-    if (sentence.substr(0, 5) != "$PHTG") {
-        return false;
-    }
-
-    if (!validate_checksum(sentence)) {
-        return false;
-    }
-
-    size_t star_pos = sentence.find('*');
-    std::string body = sentence.substr(6, star_pos - 6);
-
-    std::stringstream ss(body);
-    std::string token;
-    int field = 0;
-
-    while (std::getline(ss, token, ',')) {
-        switch (field) {
-        case 0:
-            data.date = token;
-            break;
-        case 1:
-            data.time = token;
-            break;
-        case 2:
-            data.system = token;
-            break;
-        case 3:
-            data.service = token;
-            break;
-        case 4:
-            if (!token.empty()) {
-                try {
-                    data.auth_result = std::stoi(token);
-                } catch (...) {
-                    data.auth_result = 0;
-                }
-            } else {
-                data.auth_result = 0;
-            }
-            break;
-        case 5:
-            if (!token.empty()) {
-                try {
-                    data.warning = std::stoi(token);
-                } catch (...) {
-                    data.warning = 0;
-                }
-            } else {
-                data.warning = 0;
-            }
-            break;
-        }
-        field++;
-    }
-
-    return field >= 6;
-}
-
-void process_nmea_line(const std::string &line) {
-    try {
-        if (line.length() >= 5 && line.substr(0, 5) == "$PHTG") {
-            PHTGData phtg;
-            if (parse_phtg(line, phtg)) {
-                gnss_auth_status.store(phtg.auth_result);
-                gnss_warning.store(phtg.warning);
-                std::cout << "📡 PHTG: Auth=" << phtg.auth_result << " Warning=" << phtg.warning << "\n";
-            }
-        }
-    } catch (const std::exception &e) {
-        std::cerr << "⚠ NMEA parse error: " << e.what() << "\n";
-    } catch (...) {
-        std::cerr << "⚠ Unknown NMEA parse error\n";
+void process_nmea_line(std::string_view line) {
+    tractor::nmea::PHTG phtg;
+    if (tractor::nmea::parse(line, phtg) == tractor::nmea::Error::None) {
+        gnss_auth_status.store(phtg.auth_result);
+        gnss_warning.store(phtg.warning);
+        std::cout << "📡 PHTG: Auth=" << phtg.auth_result << " Warning=" << phtg.warning << "\n";
     }
 }
 
@@ -332,7 +233,7 @@ int main(int argc, char **argv) {
 
     auto nmea_serial = std::make_shared<tractor::comms::Serial>(serial_device, serial_baud);
 
-    nmea_serial->on_line([](const std::string &line) { process_nmea_line(line); });
+    nmea_serial->on_line_view([](std::string_view line) { process_nmea_line(line); });
 
     nmea_serial->on_connection([](bool connected) {
         if (connected) {
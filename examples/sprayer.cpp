@@ -6,6 +6,8 @@
 #include "isobus/isobus/isobus_standard_data_description_indices.hpp"
 #include "isobus/isobus/isobus_task_controller_client.hpp"
 
+#include "tractor/tc/section_boom.hpp"
+
 #include <atomic>
 #include <cassert>
 #include <csignal>
@@ -73,34 +75,25 @@ class SectionControlImplementSimulator {
         HashtagParameter
     };
 
-    explicit SectionControlImplementSimulator(std::uint8_t numberOfSections)
-        : sectionSetpointStates(numberOfSections, false), sectionSwitchStates(numberOfSections, false) {}
+    explicit SectionControlImplementSimulator(std::uint8_t numberOfSections) : boom(numberOfSections) {}
 
-    std::uint8_t get_number_of_sections() const { return static_cast<std::uint8_t>(sectionSetpointStates.size()); }
+    std::uint8_t get_number_of_sections() const { return static_cast<std::uint8_t>(boom.size()); }
 
     bool get_section_actual_state(std::uint8_t index) const {
-        if (isAutoMode) {
-            return sectionSetpointStates.at(index);
-        } else {
-            return sectionSwitchStates.at(index);
-        }
+        return tractor::tc::SectionBoom::State::On == boom.actual(index);
     }
 
-    std::uint8_t get_actual_number_of_sections_on() const {
-        std::uint8_t count = 0;
-        for (std::uint8_t i = 0; i < get_number_of_sections(); i++) {
-            if (get_section_actual_state(i)) {
-                count++;
-            }
-        }
-        return count;
-    }
+    std::uint8_t get_actual_number_of_sections_on() const { return static_cast<std::uint8_t>(boom.count_on()); }
 
-    bool get_section_setpoint_state(std::uint8_t index) const { return sectionSetpointStates.at(index); }
+    bool get_section_setpoint_state(std::uint8_t index) const {
+        return tractor::tc::SectionBoom::State::On == boom.setpoint(index);
+    }
 
-    void set_section_switch_state(std::uint8_t index, bool value) { sectionSwitchStates.at(index) = value; }
+    void set_section_switch_state(std::uint8_t index, bool value) { boom.set_switch(index, value); }
 
-    bool get_section_switch_state(std::uint8_t index) const { return sectionSwitchStates.at(index); }
+    bool get_section_switch_state(std::uint8_t index) const {
+        return tractor::tc::SectionBoom::State::On == boom.switch_state(index);
+    }
 
     std::uint32_t get_actual_rate() const {
         bool anySectionOn = get_actual_number_of_sections_on() > 0;
@@ -111,9 +104,9 @@ class SectionControlImplementSimulator {
 
     bool get_setpoint_work_state() const { return setpointWorkState; }
 
-    void set_is_mode_auto(bool isAuto) { isAutoMode = isAuto; }
+    void set_is_mode_auto(bool isAuto) { boom.set_auto(isAuto); }
 
-    bool get_is_mode_auto() const { return isAutoMode; }
+    bool get_is_mode_auto() const { return boom.is_auto(); }
 
     std::uint32_t get_prescription_control_state() const { return static_cast<std::uint32_t>(get_is_mode_auto()); }
 
@@ -458,17 +451,9 @@ class SectionControlImplementSimulator {
             case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::PrescriptionControlState):
                 value = sim->get_prescription_control_state();
                 break;
-            case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualCondensedWorkState1_16): {
-                value = 0;
-                for (std::uint_fast8_t i = 0; i < NUMBER_SECTIONS_PER_CONDENSED_MESSAGE; i++) {
-                    if (i < sim->get_number_of_sections()) {
-                        bool sectionState = sim->get_section_actual_state(i);
-                        value |= static_cast<std::uint8_t>(sectionState) << (2 * i);
-                    } else {
-                        value |= (static_cast<std::uint32_t>(0x03) << (2 * i));
-                    }
-                }
-            } break;
+            case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualCondensedWorkState1_16):
+                value = static_cast<std::int32_t>(sim->boom.encode_actual(0));
+                break;
             case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualVolumePerAreaApplicationRate):
                 value = sim->get_actual_rate();
                 break;
@@ -483,17 +468,9 @@ class SectionControlImplementSimulator {
             case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualWorkingWidth):
                 value = BOOM_WIDTH;
                 break;
-            case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::SetpointCondensedWorkState1_16): {
-                value = 0;
-                for (std::uint_fast8_t i = 0; i < NUMBER_SECTIONS_PER_CONDENSED_MESSAGE; i++) {
-                    if (i < sim->get_number_of_sections()) {
-                        std::uint8_t sectionState = sim->get_section_setpoint_state(i);
-                        value |= sectionState << (2 * i);
-                    } else {
-                        value |= (static_cast<std::uint32_t>(0x03) << (2 * i));
-                    }
-                }
-            } break;
+            case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::SetpointCondensedWorkState1_16):
+                value = static_cast<std::int32_t>(sim->boom.encode_setpoint(0));
+                break;
             case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::SetpointVolumePerAreaApplicationRate):
                 value = sim->get_target_rate();
                 break;
@@ -520,16 +497,9 @@ class SectionControlImplementSimulator {
         if (nullptr != parentPointer) {
             auto sim = reinterpret_cast<SectionControlImplementSimulator *>(parentPointer);
             switch (DDI) {
-            case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::SetpointCondensedWorkState1_16): {
-                for (std::uint_fast8_t i = 0; i < NUMBER_SECTIONS_PER_CONDENSED_MESSAGE; i++) {
-                    if (i < sim->get_number_of_sections()) {
-                        bool sectionState = (0x01 == (processVariableValue >> (2 * i) & 0x03));
-                        sim->sectionSetpointStates.at(i) = sectionState;
-                    } else {
-                        break;
-                    }
-                }
-            } break;
+            case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::SetpointCondensedWorkState1_16):
+                sim->boom.decode_setpoint(0, static_cast<std::uint32_t>(processVariableValue));
+                break;
             case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::SetpointVolumePerAreaApplicationRate):
                 sim->targetRate = processVariableValue;
                 break;
@@ -547,11 +517,9 @@ class SectionControlImplementSimulator {
         return true;
     }
 
-    std::vector<bool> sectionSetpointStates;
-    std::vector<bool> sectionSwitchStates;
+    tractor::tc::SectionBoom boom;
     std::uint32_t targetRate = 100000;
     bool setpointWorkState = true;
-    bool isAutoMode = true;
 };
 
 int main(int argc, char **argv) {
@@ -1,25 +1,17 @@
-#include "isobus/hardware_integration/can_hardware_interface.hpp"
-#include "isobus/hardware_integration/socket_can_interface.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_partnered_control_function.hpp"
 #include "isobus/isobus/isobus_device_descriptor_object_pool.hpp"
 #include "isobus/isobus/isobus_standard_data_description_indices.hpp"
 #include "isobus/isobus/isobus_task_controller_client.hpp"
+#include "tractor/tractor.hpp"
 
-#include <atomic>
 #include <cassert>
-#include <csignal>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <vector>
 
-static std::atomic_bool running = true;
-
-void signal_handler(int) { running = false; }
-
 class SectionControlImplementSimulator {
   public:
     static constexpr std::uint16_t MAX_NUMBER_SECTIONS_SUPPORTED = 256;
@@ -530,26 +522,8 @@ class SectionControlImplementSimulator {
 };
 
 int main(int argc, char **argv) {
-    std::signal(SIGINT, signal_handler);
-
     std::cout << "Sprayer TC Client Example (Clean Version)\n";
 
-    auto canDriver = std::make_shared<isobus::SocketCANInterface>("can0");
-    if (nullptr == canDriver) {
-        std::cout << "Unable to find a CAN driver." << std::endl;
-        return -1;
-    }
-
-    isobus::CANHardwareInterface::set_number_of_can_channels(1);
-    isobus::CANHardwareInterface::assign_can_channel_frame_handler(0, canDriver);
-
-    if ((!isobus::CANHardwareInterface::start()) || (!canDriver->get_is_valid())) {
-        std::cout << "Failed to start hardware interface." << std::endl;
-        return -2;
-    }
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(250));
-
     isobus::NAME TestDeviceNAME(0);
     TestDeviceNAME.set_arbitrary_address_capable(true);
     TestDeviceNAME.set_industry_group(2);
@@ -561,54 +535,39 @@ int main(int argc, char **argv) {
     TestDeviceNAME.set_device_class_instance(0);
     TestDeviceNAME.set_manufacturer_code(1407);
 
-    const isobus::NAMEFilter filterTaskController(isobus::NAME::NAMEParameters::FunctionCode,
-                                                  static_cast<std::uint8_t>(isobus::NAME::Function::TaskController));
-    const isobus::NAMEFilter filterTaskControllerInstance(isobus::NAME::NAMEParameters::FunctionInstance, 0);
-    const isobus::NAMEFilter filterTaskControllerIndustryGroup(
-        isobus::NAME::NAMEParameters::IndustryGroup,
-        static_cast<std::uint8_t>(isobus::NAME::IndustryGroup::AgriculturalAndForestryEquipment));
-    const isobus::NAMEFilter filterTaskControllerDeviceClass(
-        isobus::NAME::NAMEParameters::DeviceClass, static_cast<std::uint8_t>(isobus::NAME::DeviceClass::NonSpecific));
-    const std::vector<isobus::NAMEFilter> tcNameFilters = {filterTaskController, filterTaskControllerInstance,
-                                                           filterTaskControllerIndustryGroup,
-                                                           filterTaskControllerDeviceClass};
-
-    auto TestInternalECU = isobus::CANNetworkManager::CANNetwork.create_internal_control_function(TestDeviceNAME, 0);
-    auto TestPartnerTC = isobus::CANNetworkManager::CANNetwork.create_partnered_control_function(0, tcNameFilters);
+    // The runtime brings up can0, claims the NAME, partners with the TC and handles Ctrl+C
+    tractor::TractorOptions options;
+    options.can.interface = "can0";
+    options.name = TestDeviceNAME.get_full_name();
+    tractor::Tractor runtime(options);
 
-    auto TestTCClient = std::make_shared<isobus::TaskControllerClient>(TestPartnerTC, TestInternalECU, nullptr);
+    if (!runtime.start()) {
+        std::cout << "Failed to start: " << runtime.get_last_error() << std::endl;
+        return -2;
+    }
 
     auto myDDOP = std::make_shared<isobus::DeviceDescriptorObjectPool>();
-    bool tcClientStarted = false;
-
     constexpr std::uint8_t NUMBER_OF_SECTIONS = 6;
     SectionControlImplementSimulator rateController(NUMBER_OF_SECTIONS);
 
     std::cout << "Sections: " << static_cast<int>(NUMBER_OF_SECTIONS) << "\n";
-    std::cout << "Waiting for TC server...\n\n";
-
-    while (running) {
-        if (!tcClientStarted) {
-            if (rateController.create_ddop(myDDOP, TestInternalECU->get_NAME())) {
-                TestTCClient->configure(myDDOP, 1, NUMBER_OF_SECTIONS, 1, true, false, true, false, true);
-                TestTCClient->add_request_value_callback(
-                    SectionControlImplementSimulator::request_value_command_callback, &rateController);
-                TestTCClient->add_value_command_callback(SectionControlImplementSimulator::value_command_callback,
-                                                         &rateController);
-                TestTCClient->initialize(true);
-                tcClientStarted = true;
-                std::cout << "TC Client initialized successfully\n";
-            } else {
-                std::cout << "Failed to create DDOP\n";
-                break;
-            }
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    if (!rateController.create_ddop(myDDOP, runtime.get_control_function()->get_NAME())) {
+        std::cout << "Failed to create DDOP\n";
+        return 1;
     }
 
+    // Updated by the runtime's scheduler, not a thread of its own
+    auto TestTCClient = runtime.get_tc_client();
+    TestTCClient->configure(myDDOP, 1, NUMBER_OF_SECTIONS, 1, true, false, true, false, true);
+    TestTCClient->add_request_value_callback(SectionControlImplementSimulator::request_value_command_callback,
+                                             &rateController);
+    TestTCClient->add_value_command_callback(SectionControlImplementSimulator::value_command_callback,
+                                             &rateController);
+    TestTCClient->initialize(false);
+    std::cout << "TC Client initialized successfully\n";
+    std::cout << "Waiting for TC server...\n\n";
+
+    int result = runtime.run();
     std::cout << "\nShutting down...\n";
-    TestTCClient->terminate();
-    isobus::CANHardwareInterface::stop();
-    return (!tcClientStarted);
+    return result;
 }
@@ -7,6 +7,11 @@
 #include "isobus/isobus/isobus_task_controller_client.hpp"
 
 #include "tractor/comms/serial.hpp"
+#include "tractor/nmea/nmea.hpp"
+#include "tractor/tc/change_scheduler.hpp"
+#include "tractor/tc/ddop.hpp"
+#include "tractor/tc/ddop_cache.hpp"
+#include "tractor/tc/process_data.hpp"
 
 #include "echo/echo.hpp"
 #include "echo/format.hpp"
@@ -19,16 +24,13 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 static std::atomic_bool running = true;
-static std::atomic<std::int32_t> gnss_auth_status = 0;
 static std::atomic<std::int32_t> gnss_warning = 0;
-// Current work state: 0 = not working, 1 = working
-static std::atomic<std::int32_t> current_work_state = 0;
 // Auto mode: true = TC controls sections, false = manual control
 static std::atomic_bool is_auto_mode = true;
 // Section control state: 0 = manual, 1 = auto
@@ -38,15 +40,6 @@ static std::atomic<std::uint32_t> send_frequency_ms = 1000;
 
 static void signal_handler(int) { running = false; }
 
-struct PHTGData {
-    std::string date;
-    std::string time;
-    std::string system;
-    std::string service;
-    int auth_result = 0;
-    int warning = 0;
-};
-
 bool export_ddop_to_xml(std::shared_ptr<isobus::DeviceDescriptorObjectPool> ddop, const std::string &filename) {
     if (!ddop) {
         std::cerr << "Error: DDOP is null\n";
@@ -72,125 +65,51 @@ bool export_ddop_to_xml(std::shared_ptr<isobus::DeviceDescriptorObjectPool> ddop
     return true;
 }
 
-static bool validate_checksum(const std::string &sentence) {
-    size_t star_pos = sentence.find('*');
-    if (star_pos == std::string::npos || star_pos + 2 >= sentence.length()) {
-        return false;
-    }
-
-    std::uint8_t calc_cs = 0;
-    for (size_t i = 1; i < star_pos; i++) {
-        calc_cs ^= static_cast<std::uint8_t>(sentence[i]);
-    }
-
-    std::string cs_str = sentence.substr(star_pos + 1, 2);
-    int recv_cs = std::stoi(cs_str, nullptr, 16);
-
-    return calc_cs == recv_cs;
-}
-
-static bool parse_phtg(const std::string &sentence, PHTGData &data) {
-    if (sentence.size() < 5) {
-        return false;
-    }
-    if (sentence.substr(0, 5) != "$PHTG") {
-        return false;
-    }
-    if (!validate_checksum(sentence)) {
-        return false;
-    }
-
-    size_t star_pos = sentence.find('*');
-    if (star_pos == std::string::npos) {
-        return false;
-    }
-
-    std::string body = sentence.substr(6, star_pos - 6);
-
-    std::stringstream ss(body);
-    std::string token;
-    int field = 0;
-
-    while (std::getline(ss, token, ',')) {
-        switch (field) {
-        case 0:
-            data.date = token;
-            break;
-        case 1:
-            data.time = token;
-            break;
-        case 2:
-            data.system = token;
-            break;
-        case 3:
-            data.service = token;
-            break;
-        case 4:
-            data.auth_result = token.empty() ? 0 : std::stoi(token);
-            break;
-        case 5:
-            data.warning = token.empty() ? 0 : std::stoi(token);
-            break;
-        default:
-            break;
-        }
-        field++;
-    }
-
-    return field >= 6;
-}
+static constexpr std::uint16_t DDI_AUTH_RESULT = 65432;
+static constexpr std::uint16_t MAIN_DEVICE_ELEMENT = 0;
+
+// DDOP of the HASHTAG sensor, object IDs and child lists follow from the table
+static constexpr tractor::tc::DdopDescription<1, 4, 0, 3> TAG_DDOP{
+    .device = {"HAS#TAG", "1.3.25", "HASHTAG-SENSOR"},
+    .elements = {{{"WURDevice", tractor::tc::ElementType::Device, MAIN_DEVICE_ELEMENT}}},
+    .process_data = {{
+        // Request Default Process Data first (required by most Task Controllers)
+        {0, "Request Default Process Data",
+         static_cast<std::uint16_t>(isobus::DataDescriptionIndex::RequestDefaultProcessData), 0,
+         tractor::tc::TRIGGER_TOTAL},
+        {0, "Hashtag DDI #1", DDI_AUTH_RESULT, tractor::tc::PD_MEMBER_OF_DEFAULT_SET | tractor::tc::PD_SETTABLE,
+         tractor::tc::TRIGGER_ON_CHANGE, 2},
+        {0, "Actual Work State", static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualWorkState),
+         tractor::tc::PD_MEMBER_OF_DEFAULT_SET, tractor::tc::TRIGGER_ON_CHANGE},
+        {0, "Total Time", static_cast<std::uint16_t>(isobus::DataDescriptionIndex::EffectiveTotalTime),
+         tractor::tc::PD_MEMBER_OF_DEFAULT_SET | tractor::tc::PD_SETTABLE, tractor::tc::TRIGGER_TOTAL},
+    }},
+    .presentations = {{{"mm"}, {"minutes"}, {"raw"}}},
+};
+static_assert(TAG_DDOP.valid());
 
-static void process_nmea_line(const std::string &line) {
-    if (line.size() >= 5 && line.substr(0, 5) == "$PHTG") {
-        PHTGData phtg;
-        if (parse_phtg(line, phtg)) {
-            gnss_auth_status.store(phtg.auth_result);
-            gnss_warning.store(phtg.warning);
-        }
-    }
+// Process data served to the TC, written by the NMEA and main threads
+static tractor::tc::ProcessDataStore process_data;
+static tractor::tc::ProcessDataStore::Handle auth_result_pd;
+// Current work state: 0 = not working, 1 = working
+static tractor::tc::ProcessDataStore::Handle work_state_pd;
+// Pushes changed process data to the TC
+static tractor::tc::ChangeScheduler change_scheduler(process_data);
+
+static void register_process_data() {
+    // Request default process data always reads 0, total time is not tracked yet
+    TAG_DDOP.register_process_data(process_data);
+    auth_result_pd = process_data.find(MAIN_DEVICE_ELEMENT, DDI_AUTH_RESULT);
+    work_state_pd = process_data.find(MAIN_DEVICE_ELEMENT,
+                                      static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualWorkState));
 }
 
-// DDOP object IDs for HASHTAG sensor
-enum class HashtagDDOPObjectIDs : std::uint16_t {
-    Device = 0,
-    MainDeviceElement = 1,
-    RequestDefaultProcessData = 5,
-    AuthResultPD = 10,
-    DeviceTotalTime = 20,
-    ActualWorkState = 21,
-    RawPresentation = 50,
-    SurfacePresentation = 51,
-    TimePresentation = 52
-};
-
-static constexpr std::uint16_t DDI_AUTH_RESULT = 65432;
-static constexpr std::uint16_t MAIN_DEVICE_ELEMENT = 1;
-
-static bool request_value_command_callback(std::uint16_t elementNumber, std::uint16_t DDI, std::int32_t &value,
-                                           void *) {
-    switch (DDI) {
-    case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::RequestDefaultProcessData):
-        // Always return 0 for request default process data
-        value = 0;
-        break;
-    case DDI_AUTH_RESULT:
-        // Report current hashtag authentication result from NMEA data
-        value = gnss_auth_status.load();
-        break;
-    case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualWorkState):
-        // Report current work state (toggles every 5 seconds)
-        value = current_work_state.load();
-        break;
-    case static_cast<std::uint16_t>(isobus::DataDescriptionIndex::EffectiveTotalTime):
-        // Report total operating time in minutes
-        value = 0; // TODO: Implement actual time tracking
-        break;
-    default:
-        value = 0;
-        break;
+static void process_nmea_line(std::string_view line) {
+    tractor::nmea::PHTG phtg;
+    if (tractor::nmea::parse(line, phtg) == tractor::nmea::Error::None) {
+        process_data.set(auth_result_pd, phtg.auth_result);
+        gnss_warning.store(phtg.warning);
     }
-
-    return true;
 }
 
 // static bool default_process_data_requested_callback(short unsigned int elm, short unsigned int ddi,
@@ -205,89 +124,6 @@ static bool request_value_command_callback(std::uint16_t elementNumber, std::uin
 //     return true;
 // }
 
-static bool value_command_callback(std::uint16_t, std::uint16_t, std::int32_t, void *) { return true; }
-
-static bool create_ddop(std::shared_ptr<isobus::DeviceDescriptorObjectPool> pool, isobus::NAME clientName) {
-    if (!pool) {
-        return false;
-    }
-
-    pool->clear();
-
-    std::array<std::uint8_t, 7> localizationData = {'e', 'n', 0x50, 0x00, 0x55, 0x55, 0xFF};
-
-    bool ok = true;
-
-    ok &= pool->add_device("HAS#TAG", "1.3.25", "HASHTAG-SENSOR", "HTS0.0.13", localizationData,
-                           std::vector<std::uint8_t>(), clientName.get_full_name());
-
-    ok &= pool->add_device_element("WURDevice", 0, static_cast<std::uint16_t>(HashtagDDOPObjectIDs::Device),
-                                   isobus::task_controller_object::DeviceElementObject::Type::Device,
-                                   static_cast<std::uint16_t>(HashtagDDOPObjectIDs::MainDeviceElement));
-
-    ok &= pool->add_device_value_presentation("mm", 0, 1.0f, 0,
-                                              static_cast<std::uint16_t>(HashtagDDOPObjectIDs::SurfacePresentation));
-
-    ok &= pool->add_device_value_presentation("minutes", 0, 1.0f, 0,
-                                              static_cast<std::uint16_t>(HashtagDDOPObjectIDs::TimePresentation));
-
-    ok &= pool->add_device_value_presentation("raw", 0, 1.0f, 0,
-                                              static_cast<std::uint16_t>(HashtagDDOPObjectIDs::RawPresentation));
-
-    // Add Request Default Process Data first (required by most Task Controllers)
-    ok &= pool->add_device_process_data(
-        "Request Default Process Data",
-        static_cast<std::uint16_t>(isobus::DataDescriptionIndex::RequestDefaultProcessData), isobus::NULL_OBJECT_ID, 0,
-        static_cast<std::uint8_t>(
-            isobus::task_controller_object::DeviceProcessDataObject::AvailableTriggerMethods::Total),
-        static_cast<std::uint16_t>(HashtagDDOPObjectIDs::RequestDefaultProcessData));
-
-    ok &= pool->add_device_process_data(
-        "Hashtag DDI #1", DDI_AUTH_RESULT, static_cast<std::uint16_t>(HashtagDDOPObjectIDs::RawPresentation),
-        static_cast<std::uint8_t>(
-            isobus::task_controller_object::DeviceProcessDataObject::PropertiesBit::MemberOfDefaultSet) |
-            static_cast<std::uint8_t>(isobus::task_controller_object::DeviceProcessDataObject::PropertiesBit::Settable),
-        static_cast<std::uint8_t>(
-            isobus::task_controller_object::DeviceProcessDataObject::AvailableTriggerMethods::OnChange),
-        static_cast<std::uint16_t>(HashtagDDOPObjectIDs::AuthResultPD));
-
-    ok &= pool->add_device_process_data(
-        "Actual Work State", static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualWorkState),
-        isobus::NULL_OBJECT_ID,
-        static_cast<std::uint8_t>(
-            isobus::task_controller_object::DeviceProcessDataObject::PropertiesBit::MemberOfDefaultSet),
-        static_cast<std::uint8_t>(
-            isobus::task_controller_object::DeviceProcessDataObject::AvailableTriggerMethods::OnChange),
-        static_cast<std::uint16_t>(HashtagDDOPObjectIDs::ActualWorkState));
-
-    ok &= pool->add_device_process_data(
-        "Total Time", static_cast<std::uint16_t>(isobus::DataDescriptionIndex::EffectiveTotalTime),
-        isobus::NULL_OBJECT_ID,
-        static_cast<std::uint8_t>(
-            isobus::task_controller_object::DeviceProcessDataObject::PropertiesBit::MemberOfDefaultSet) |
-            static_cast<std::uint8_t>(isobus::task_controller_object::DeviceProcessDataObject::PropertiesBit::Settable),
-        static_cast<std::uint8_t>(
-            isobus::task_controller_object::DeviceProcessDataObject::AvailableTriggerMethods::Total),
-        static_cast<std::uint16_t>(HashtagDDOPObjectIDs::DeviceTotalTime));
-
-    if (!ok) {
-        return false;
-    }
-
-    auto mainElement = std::static_pointer_cast<isobus::task_controller_object::DeviceElementObject>(
-        pool->get_object_by_id(static_cast<std::uint16_t>(HashtagDDOPObjectIDs::MainDeviceElement)));
-
-    if (mainElement) {
-        mainElement->add_reference_to_child_object(
-            static_cast<std::uint16_t>(HashtagDDOPObjectIDs::RequestDefaultProcessData));
-        mainElement->add_reference_to_child_object(static_cast<std::uint16_t>(HashtagDDOPObjectIDs::ActualWorkState));
-        mainElement->add_reference_to_child_object(static_cast<std::uint16_t>(HashtagDDOPObjectIDs::AuthResultPD));
-        mainElement->add_reference_to_child_object(static_cast<std::uint16_t>(HashtagDDOPObjectIDs::DeviceTotalTime));
-    }
-
-    return true;
-}
-
 int main(int argc, char **argv) {
 
     const char *serial_device = "/tmp/ttyV0";
@@ -309,8 +145,11 @@ int main(int argc, char **argv) {
     std::cout << "HASHTAG Tractor Sensor TC Client\n";
     std::cout << "Serial: " << serial_device << " @ " << serial_baud << "\n";
 
+    // Register before the serial thread starts writing
+    register_process_data();
+
     auto nmea_serial = std::make_shared<tractor::comms::Serial>(serial_device, serial_baud);
-    nmea_serial->on_line([](const std::string &line) { process_nmea_line(line); });
+    nmea_serial->on_line_view([](std::string_view line) { process_nmea_line(line); });
     nmea_serial->on_connection([](bool connected) {
         if (connected)
             std::cout << "Serial connected\n";
@@ -362,31 +201,54 @@ int main(int argc, char **argv) {
 
     auto tcClient = std::make_shared<isobus::TaskControllerClient>(partnerTC, ecu, nullptr);
 
-    auto ddop = std::make_shared<isobus::DeviceDescriptorObjectPool>();
-    if (!create_ddop(ddop, ecu->get_NAME())) {
-        std::cerr << "Failed to create DDOP\n";
-        return 4;
+    // Reuse the pool of the last start, only serialize (and export) it when the structure changed
+    tractor::tc::DdopCache ddop_cache;
+    std::vector<std::uint8_t> binary_ddop;
+    static constexpr auto ddop_layout = TAG_DDOP.layout();
+    constexpr std::uint64_t ddop_hash = ddop_layout.structure_hash;
+    const std::uint64_t client_name = ecu->get_NAME().get_full_name();
+    if (ddop_cache.load(ddop_hash, client_name)) {
+        std::cout << "Using cached DDOP " << ddop_cache.path(ddop_hash, client_name) << "\n";
+    } else {
+        if (!ddop_cache.get_last_error().empty()) {
+            std::cerr << "DDOP cache: " << ddop_cache.get_last_error() << "\n";
+        }
+        TAG_DDOP.serialize(client_name, binary_ddop, ddop_layout);
+        if (!ddop_cache.store(ddop_hash, client_name, binary_ddop)) {
+            std::cerr << "Failed to cache DDOP: " << ddop_cache.get_last_error() << "\n";
+        }
+        auto ddop = std::make_shared<isobus::DeviceDescriptorObjectPool>();
+        if (ddop->deserialize_binary_object_pool(binary_ddop, ecu->get_NAME())) {
+            export_ddop_to_xml(ddop, "tag_fromcode.xml");
+        }
     }
 
     // Enable default process data callback for timing configuration
     // tcClient->add_default_process_data_requested_callback(default_process_data_requested_callback, nullptr);
 
-    tcClient->add_request_value_callback(request_value_command_callback, nullptr);
-    tcClient->add_value_command_callback(value_command_callback, nullptr);
+    tcClient->add_request_value_callback(tractor::tc::ProcessDataStore::request_value_callback, &process_data);
+    tcClient->add_value_command_callback(tractor::tc::ProcessDataStore::value_command_callback, &process_data);
 
-    tcClient->configure(ddop, 1, 1, 1,
+    // Without a cache file the client uploads straight from the serialized pool
+    const std::uint8_t *ddop_data = ddop_cache.is_loaded() ? ddop_cache.data() : binary_ddop.data();
+    const auto ddop_size = ddop_cache.is_loaded() ? ddop_cache.size() : static_cast<std::uint32_t>(binary_ddop.size());
+    tcClient->configure(ddop_data, ddop_size, 1, 1, 1,
                         true, // supports documentation (so TC can log you)
                         false, true, false, true);
 
     tcClient->initialize(true);
     std::cout << "TC Client started\n";
 
-    std::int32_t lastAuth = gnss_auth_status.load();
-    std::int32_t lastWarn = gnss_warning.load();
+    // Auth results reach the TC right away, a flapping sensor is limited to one update per 100 ms
+    change_scheduler.set_notify([tcClient](std::uint16_t element, std::uint16_t ddi) {
+        return tcClient->on_value_changed_trigger(element, ddi);
+    });
+    change_scheduler.watch(MAIN_DEVICE_ELEMENT, DDI_AUTH_RESULT);
+    change_scheduler.watch(MAIN_DEVICE_ELEMENT,
+                           static_cast<std::uint16_t>(isobus::DataDescriptionIndex::ActualWorkState));
+    change_scheduler.start();
 
-    std::string filenameee = "tag_fromcode.xml";
-    const char *xml_export_filename = filenameee.c_str();
-    export_ddop_to_xml(ddop, xml_export_filename);
+    std::int32_t lastWarn = gnss_warning.load();
 
     echo::box("Tractor Hashtag Sensor TC Client", echo::BoxStyle::Double);
 
@@ -403,22 +265,16 @@ int main(int argc, char **argv) {
 
         // Toggle work state every 5 seconds (independent of send frequency)
         if (now - last_toggle_time >= toggle_interval) {
-            current_work_state.store(1 - current_work_state.load());
+            process_data.set(work_state_pd, 1 - process_data.get(work_state_pd));
             last_toggle_time = now;
         }
 
-        auto a = gnss_auth_status.load();
         auto w = gnss_warning.load();
 
-        if (a != lastAuth) {
-            tcClient->on_value_changed_trigger(MAIN_DEVICE_ELEMENT, DDI_AUTH_RESULT);
-            lastAuth = a;
-        }
-
-        std::cout << "\r  Work State: [" << (current_work_state.load() ? " ON " : "OFF ") << "]  " << std::flush;
+        std::cout << "\r  Work State: [" << (process_data.get(work_state_pd) ? " ON " : "OFF ") << "]  " << std::flush;
 
         echo::format::String pretty_string;
-        if (current_work_state.load()) {
+        if (process_data.get(work_state_pd)) {
             pretty_string = echo::format::String(" [ ON  ] ").bg(0, 255, 0).black().bold();
         } else {
             pretty_string = echo::format::String(" [ OFF ] ").bg(255, 0, 0).black().bold();
@@ -432,6 +288,7 @@ int main(int argc, char **argv) {
 
     std::cout << "Shutting down...\n";
     nmea_serial->stop();
+    change_scheduler.stop();
     tcClient->terminate();
     isobus::CANHardwareInterface::stop();
     return 0;
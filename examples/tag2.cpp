@@ -7,6 +7,7 @@
 #include "isobus/isobus/isobus_task_controller_client.hpp"
 
 #include "tractor/comms/serial.hpp"
+#include "tractor/nmea/nmea.hpp"
 
 #include "echo/echo.hpp"
 
@@ -17,8 +18,8 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -28,15 +29,6 @@ static std::atomic<std::int32_t> gnss_warning = 0;
 
 static void signal_handler(int) { running = false; }
 
-struct PHTGData {
-    std::string date;
-    std::string time;
-    std::string system;
-    std::string service;
-    int auth_result = 0;
-    int warning = 0;
-};
-
 bool export_ddop_to_xml(std::shared_ptr<isobus::DeviceDescriptorObjectPool> ddop, const std::string &filename) {
     if (!ddop) {
         std::cerr << "Error: DDOP is null\n";
@@ -62,81 +54,11 @@ bool export_ddop_to_xml(std::shared_ptr<isobus::DeviceDescriptorObjectPool> ddop
     return true;
 }
 
-static bool validate_checksum(const std::string &sentence) {
-    size_t star_pos = sentence.find('*');
-    if (star_pos == std::string::npos || star_pos + 2 >= sentence.length()) {
-        return false;
-    }
-
-    std::uint8_t calc_cs = 0;
-    for (size_t i = 1; i < star_pos; i++) {
-        calc_cs ^= static_cast<std::uint8_t>(sentence[i]);
-    }
-
-    std::string cs_str = sentence.substr(star_pos + 1, 2);
-    int recv_cs = std::stoi(cs_str, nullptr, 16);
-
-    return calc_cs == recv_cs;
-}
-
-static bool parse_phtg(const std::string &sentence, PHTGData &data) {
-    if (sentence.size() < 5) {
-        return false;
-    }
-    if (sentence.substr(0, 5) != "$PHTG") {
-        return false;
-    }
-    if (!validate_checksum(sentence)) {
-        return false;
-    }
-
-    size_t star_pos = sentence.find('*');
-    if (star_pos == std::string::npos) {
-        return false;
-    }
-
-    std::string body = sentence.substr(6, star_pos - 6);
-
-    std::stringstream ss(body);
-    std::string token;
-    int field = 0;
-
-    while (std::getline(ss, token, ',')) {
-        switch (field) {
-        case 0:
-            data.date = token;
-            break;
-        case 1:
-            data.time = token;
-            break;
-        case 2:
-            data.system = token;
-            break;
-        case 3:
-            data.service = token;
-            break;
-        case 4:
-            data.auth_result = token.empty() ? 0 : std::stoi(token);
-            break;
-        case 5:
-            data.warning = token.empty() ? 0 : std::stoi(token);
-            break;
-        default:
-            break;
-        }
-        field++;
-    }
-
-    return field >= 6;
-}
-
-static void process_nmea_line(const std::string &line) {
-    if (line.size() >= 5 && line.substr(0, 5) == "$PHTG") {
-        PHTGData phtg;
-        if (parse_phtg(line, phtg)) {
-            gnss_auth_status.store(phtg.auth_result);
-            gnss_warning.store(phtg.warning);
-        }
+static void process_nmea_line(std::string_view line) {
+    tractor::nmea::PHTG phtg;
+    if (tractor::nmea::parse(line, phtg) == tractor::nmea::Error::None) {
+        gnss_auth_status.store(phtg.auth_result);
+        gnss_warning.store(phtg.warning);
     }
 }
 
@@ -278,7 +200,7 @@ int main(int argc, char **argv) {
     std::cout << "Serial: " << serial_device << " @ " << serial_baud << "\n";
 
     auto nmea_serial = std::make_shared<tractor::comms::Serial>(serial_device, serial_baud);
-    nmea_serial->on_line([](const std::string &line) { process_nmea_line(line); });
+    nmea_serial->on_line_view([](std::string_view line) { process_nmea_line(line); });
     nmea_serial->on_connection([](bool connected) {
         if (connected)
             std::cout << "Serial connected\n";
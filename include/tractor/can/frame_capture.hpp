@@ -0,0 +1,56 @@
+#pragma once
+
+#include "isobus/isobus/can_message_frame.hpp"
+#include "tractor/comms/capture.hpp"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+namespace tractor {
+    namespace can {
+
+        /**
+         * @brief Receives replayed CAN frames
+         */
+        using FrameHandler = std::function<void(const isobus::CANMessageFrame &frame)>;
+
+        /**
+         * @brief Payload size of a captured frame: identifier, flags, length and 8 data bytes
+         */
+        constexpr size_t CAPTURED_FRAME_SIZE = 14;
+
+        /**
+         * @brief Append a received frame to a capture
+         *
+         * Meant to be called from the frame received listener of the CAN hardware interface, e.g.
+         * isobus::CANHardwareInterface::get_can_frame_received_event_dispatcher(). The record is
+         * tagged with the frame's channel.
+         *
+         * @param capture Open capture
+         * @param frame Received frame
+         * @param time When the frame was received
+         * @return true if appended, false if the capture is closed or full
+         */
+        bool capture_frame(comms::CaptureWriter &capture, const isobus::CANMessageFrame &frame,
+                           std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now());
+
+        /**
+         * @brief Decode a CaptureKind::CanFrame record
+         * @param record Capture record
+         * @param frame Receives the frame, timestamp_us is the time since the capture was opened
+         * @return true if the record holds a frame, false otherwise
+         */
+        bool decode_frame(const comms::CaptureRecord &record, isobus::CANMessageFrame &frame);
+
+        /**
+         * @brief Hand captured frames to a handler, for example the network manager's receive path
+         * @param reader Capture positioned at the first record to replay
+         * @param handler Called for every frame
+         * @param options Pacing and channel selection, the record kind is always CanFrame
+         * @return Number of frames replayed
+         */
+        size_t replay_frames(comms::CaptureReader &reader, const FrameHandler &handler,
+                             const comms::ReplayOptions &options = comms::ReplayOptions{});
+
+    } // namespace can
+} // namespace tractor
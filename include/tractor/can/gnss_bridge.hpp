@@ -0,0 +1,155 @@
+#pragma once
+
+#include "isobus/isobus/can_message_frame.hpp"
+#include "tractor/can/nmea2000.hpp"
+#include "tractor/nmea/nmea.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace tractor {
+    namespace can {
+
+        /**
+         * @brief Sends a single CAN frame, returns false if it could not be queued
+         */
+        using FrameSink = std::function<bool(const isobus::CANMessageFrame &frame)>;
+
+        /**
+         * @brief Configuration of the GNSS to NMEA 2000 bridge
+         */
+        struct GnssBridgeConfig {
+            uint8_t channel = 0;
+            uint8_t source_address = 0x80;
+            uint8_t rapid_priority = 2;           // PGN 129025 and 129026
+            uint8_t position_priority = 3;        // PGN 129029
+            uint32_t rapid_interval_ms = 100;     // NMEA 2000 sends the rapid updates at 10 Hz
+            uint32_t position_interval_ms = 1000; // GNSS Position Data at 1 Hz
+            uint32_t fix_timeout_ms = 2000;       // Stop sending once the newest fix is older than this
+            uint8_t gnss_type = 0;                // PGN 129029 GNSS type, see GnssPosition
+        };
+
+        /**
+         * @brief Bridge parsed NMEA 0183 fixes onto the bus as NMEA 2000 position messages
+         *
+         * GGA, RMC, VTG and GSA updates are merged into one fix, which is sent as:
+         * - PGN 129025 Position, Rapid Update
+         * - PGN 129026 COG & SOG, Rapid Update
+         * - PGN 129029 GNSS Position Data (fast packet)
+         *
+         * Messages go out at fixed rates independent of the receiver's output rate, either from an
+         * internal thread (start()) or from the caller's loop (poll()). All frames are built in
+         * preallocated buffers, sending does not allocate. The update() calls are thread-safe.
+         */
+        class GnssBridge {
+          public:
+            /**
+             * @brief Constructor
+             * @param config Bridge configuration
+             */
+            explicit GnssBridge(const GnssBridgeConfig &config = GnssBridgeConfig{});
+
+            /**
+             * @brief Destructor, stops the sending thread
+             */
+            ~GnssBridge();
+
+            // Delete copy
+            GnssBridge(const GnssBridge &) = delete;
+            GnssBridge &operator=(const GnssBridge &) = delete;
+
+            /**
+             * @brief Update time, position, altitude and quality from a GGA sentence
+             * @param gga Parsed sentence, ignored without a fix
+             */
+            void update(const nmea::GGA &gga);
+
+            /**
+             * @brief Update time, date, position, course and speed from an RMC sentence
+             * @param rmc Parsed sentence, ignored unless its status is active
+             */
+            void update(const nmea::RMC &rmc);
+
+            /**
+             * @brief Update course and speed from a VTG sentence
+             * @param vtg Parsed sentence
+             */
+            void update(const nmea::VTG &vtg);
+
+            /**
+             * @brief Update PDOP from a GSA sentence
+             * @param gsa Parsed sentence
+             */
+            void update(const nmea::GSA &gsa);
+
+            /**
+             * @brief Replace the function frames are sent with
+             *
+             * Defaults to isobus::CANHardwareInterface::transmit_can_frame(). Must not be called while
+             * the bridge is running.
+             *
+             * @param sink Function to send frames with
+             */
+            void set_sink(FrameSink sink);
+
+            /**
+             * @brief Start sending from an internal thread
+             * @return true if started, false if already running
+             */
+            bool start();
+
+            /**
+             * @brief Stop the sending thread
+             */
+            void stop();
+
+            /**
+             * @brief Check if the sending thread is active
+             * @return true if running, false otherwise
+             */
+            bool is_running() const;
+
+            /**
+             * @brief Send every message that is due
+             *
+             * For callers driving the bridge from their own loop instead of start(). Must not be
+             * called concurrently with itself or while the bridge is running.
+             *
+             * @param now Current time
+             * @return Number of frames sent
+             */
+            size_t poll(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+            /**
+             * @brief Check whether the newest position is recent enough to be sent
+             * @return true if a position within fix_timeout_ms is available, false otherwise
+             */
+            bool has_fix() const;
+
+            /**
+             * @brief Get statistics
+             */
+            struct Statistics {
+                size_t position_rapid_sent = 0;
+                size_t cog_sog_sent = 0;
+                size_t gnss_position_sent = 0;
+                size_t frames_sent = 0;
+                size_t send_failures = 0;
+            };
+
+            /**
+             * @brief Get a snapshot of the statistics
+             */
+            Statistics get_statistics() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+
+            void sender_thread();
+            bool send(uint32_t identifier, const FramePayload &payload, std::chrono::steady_clock::time_point now);
+        };
+
+    } // namespace can
+} // namespace tractor
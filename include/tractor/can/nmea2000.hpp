@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tractor {
+    namespace can {
+
+        // NMEA 2000 parameter group numbers
+        constexpr uint32_t PGN_POSITION_RAPID = 129025; // 0x1F801 Position, Rapid Update
+        constexpr uint32_t PGN_COG_SOG_RAPID = 129026;  // 0x1F802 COG & SOG, Rapid Update
+        constexpr uint32_t PGN_GNSS_POSITION = 129029;  // 0x1F805 GNSS Position Data (fast packet)
+
+        constexpr uint8_t BROADCAST_ADDRESS = 0xFF;
+
+        /**
+         * @brief Build the 29 bit identifier of an NMEA 2000 / J1939 frame
+         * @param pgn Parameter group number
+         * @param source Source address
+         * @param priority Priority 0 (highest) to 7
+         * @param destination Destination address, only used by PDU1 groups (PF below 240)
+         * @return Extended CAN identifier
+         */
+        constexpr uint32_t n2k_can_id(uint32_t pgn, uint8_t source, uint8_t priority,
+                                      uint8_t destination = BROADCAST_ADDRESS) {
+            uint32_t dp = (pgn >> 16) & 0x1;
+            uint32_t pf = (pgn >> 8) & 0xFF;
+            uint32_t ps = pf < 240 ? destination : (pgn & 0xFF);
+            return (static_cast<uint32_t>(priority & 0x7) << 26) | (dp << 24) | (pf << 16) | (ps << 8) | source;
+        }
+
+        /**
+         * @brief A single classic CAN payload
+         */
+        using FramePayload = std::array<uint8_t, 8>;
+
+        /**
+         * @brief Position fix carried by PGN 129029
+         *
+         * Unavailable fields are sent with the NMEA 2000 "not available" values.
+         */
+        struct GnssPosition {
+            uint8_t sid = 0;
+            uint16_t days_since_1970 = 0xFFFF;
+            uint32_t seconds_since_midnight_x10000 = 0xFFFFFFFF;
+            double latitude = 0.0;  // Decimal degrees
+            double longitude = 0.0; // Decimal degrees
+            double altitude = 0.0;  // Meters
+            uint8_t gnss_type = 0;  // 0=GPS, 1=GLONASS, 2=GPS+GLONASS, 3=GPS+SBAS, 4=GPS+SBAS+GLONASS, 8=Galileo
+            uint8_t method = 0;     // Same numbering as the NMEA 0183 GGA fix quality
+            uint8_t integrity = 0;  // 0=No checking, 1=Safe, 2=Caution
+            uint8_t satellites = 0;
+            double hdop = -1.0; // Negative if unavailable
+            double pdop = -1.0;
+            double geoid_separation = 0.0; // Meters
+            bool has_reference_station = false;
+            uint16_t reference_station_id = 0;
+            double reference_station_age = 0.0; // Seconds
+        };
+
+        /**
+         * @brief Maximum payload of PGN 129029 with one reference station
+         */
+        constexpr size_t GNSS_POSITION_MAX_SIZE = 47;
+
+        /**
+         * @brief Encode PGN 129025 Position, Rapid Update
+         * @param latitude Decimal degrees
+         * @param longitude Decimal degrees
+         * @return Frame payload
+         */
+        FramePayload encode_position_rapid(double latitude, double longitude);
+
+        /**
+         * @brief Encode PGN 129026 COG & SOG, Rapid Update (true course reference)
+         * @param sid Sequence identifier linking PGNs of one fix
+         * @param course_deg Course over ground in degrees, negative if unavailable
+         * @param speed_mps Speed over ground in meters per second, negative if unavailable
+         * @return Frame payload
+         */
+        FramePayload encode_cog_sog_rapid(uint8_t sid, double course_deg, double speed_mps);
+
+        /**
+         * @brief Encode PGN 129029 GNSS Position Data
+         * @param position Fix to encode
+         * @param out Buffer of at least GNSS_POSITION_MAX_SIZE bytes
+         * @return Number of bytes written (43, or 47 with a reference station)
+         */
+        size_t encode_gnss_position(const GnssPosition &position, uint8_t *out);
+
+        /**
+         * @brief Maximum number of frames of a fast packet message (223 bytes)
+         */
+        constexpr size_t FAST_PACKET_MAX_FRAMES = 32;
+
+        /**
+         * @brief Split a message into NMEA 2000 fast packet frames
+         *
+         * The first frame carries the sequence and frame counter, the length and 6 bytes, every
+         * following frame the counters and 7 bytes. Unused bytes of the last frame are 0xFF.
+         *
+         * @param data Message payload
+         * @param size Payload size, at most 223 bytes
+         * @param sequence Sequence counter, only the lower 3 bits are used
+         * @param frames Receives the frames
+         * @return Number of frames written, 0 if the payload is too large
+         */
+        size_t fast_packet_frames(const uint8_t *data, size_t size, uint8_t sequence,
+                                  std::array<FramePayload, FAST_PACKET_MAX_FRAMES> &frames);
+
+    } // namespace can
+} // namespace tractor
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace tractor {
+    namespace can {
+
+        /**
+         * @brief Receive timestamps requested from the kernel
+         */
+        enum class CanTimestamps {
+            None,     // timestamp_us stays 0
+            Software, // Taken by the kernel when the driver hands the frame to the network stack
+            Hardware  // Taken by the controller where the driver supports it, software otherwise
+        };
+
+        /**
+         * @brief Configuration of the batched SocketCAN frame handler
+         */
+        struct SocketCanOptions {
+            std::string interface = "can0";
+            size_t batch_size = 32;              // Frames per recvmmsg() and sendmmsg() call
+            size_t transmit_queue_depth = 256;   // Frames write_frame() may queue ahead of the writer thread
+            uint32_t receive_timeout_ms = 100;   // read_frame() returns false after this long without a frame
+            CanTimestamps timestamps = CanTimestamps::Hardware;
+            bool use_io_uring = false; // Keep batch_size receives posted in an io_uring instead of recvmmsg()
+        };
+
+        /**
+         * @brief SocketCAN frame handler that receives and transmits in batches
+         *
+         * Drop-in replacement for isobus::SocketCANInterface, assigned with
+         * isobus::CANHardwareInterface::assign_can_channel_frame_handler(). read_frame() hands out
+         * frames from a buffer filled by one recvmmsg() call per batch instead of one read() per
+         * frame. write_frame() queues the frame for a writer thread, which sends everything queued
+         * at that moment with a single sendmmsg(), so bursts such as transport protocol or fast
+         * packet sequences cost one system call.
+         *
+         * With SocketCanOptions::use_io_uring every receive slot not currently handed out has a
+         * recvmsg() posted in an io_uring, so frames land while the receive thread is busy and one
+         * io_uring_enter() both reposts the consumed slots and collects the next batch. This needs a
+         * build with TRACTOR_IO_URING, otherwise open() notes it in get_last_error() and uses
+         * recvmmsg().
+         *
+         * Frames carry the kernel receive timestamp in timestamp_us, in microseconds of the system
+         * clock like the stock driver. read_frame() is meant for a single receive thread, the one
+         * of the hardware interface; write_frame() is thread-safe.
+         */
+        class BatchedSocketCan : public isobus::CANHardwarePlugin {
+          public:
+            /**
+             * @brief Constructor
+             * @param options Frame handler configuration
+             */
+            explicit BatchedSocketCan(const SocketCanOptions &options = SocketCanOptions{});
+
+            /**
+             * @brief Destructor, closes the socket
+             */
+            ~BatchedSocketCan() override;
+
+            // Delete copy
+            BatchedSocketCan(const BatchedSocketCan &) = delete;
+            BatchedSocketCan &operator=(const BatchedSocketCan &) = delete;
+
+            /**
+             * @brief Check if the socket is open and bound
+             * @return true if usable, false otherwise
+             */
+            bool get_is_valid() const override;
+
+            /**
+             * @brief Close the socket, frames still queued for transmission are sent first
+             */
+            void close() override;
+
+            /**
+             * @brief Open and bind the socket and start the writer thread, see get_last_error() on failure
+             */
+            void open() override;
+
+            /**
+             * @brief Get the next received frame
+             * @param canFrame Receives the frame
+             * @return true if a frame was read, false on timeout or error
+             */
+            bool read_frame(isobus::CANMessageFrame &canFrame) override;
+
+            /**
+             * @brief Queue a frame for transmission
+             * @param canFrame Frame to send
+             * @return true if queued, false if closed or the queue is full
+             */
+            bool write_frame(const isobus::CANMessageFrame &canFrame) override;
+
+            /**
+             * @brief Get statistics
+             */
+            struct Statistics {
+                size_t frames_received = 0;
+                size_t frames_sent = 0;
+                size_t receive_calls = 0;       // recvmmsg() calls that returned frames
+                size_t send_calls = 0;          // sendmmsg() calls
+                size_t send_failures = 0;       // Frames that could not be sent
+                size_t hardware_timestamps = 0; // Frames stamped by the controller
+                size_t software_timestamps = 0; // Frames stamped by the kernel
+                size_t kernel_drops = 0;        // Frames the socket receive queue dropped (SO_RXQ_OVFL)
+            };
+
+            /**
+             * @brief Get a snapshot of the statistics
+             */
+            Statistics get_statistics() const;
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+
+            bool receive_batch();
+            void writer_thread();
+        };
+
+    } // namespace can
+} // namespace tractor
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace tractor {
+    namespace comms {
+
+        /**
+         * @brief What a capture record holds
+         */
+        enum class CaptureKind : uint16_t {
+            SerialChunk = 1, // Bytes returned by one read() of a serial port, before framing
+            CanFrame = 2     // One received CAN frame, see tractor/can/frame_capture.hpp
+        };
+
+        /**
+         * @brief One record of a capture file
+         */
+        struct CaptureRecord {
+            CaptureKind kind = CaptureKind::SerialChunk;
+            uint16_t channel = 0;          // Chosen by the writer, e.g. one per port or CAN channel
+            uint64_t timestamp_ns = 0;     // Time since the capture was opened
+            std::span<const uint8_t> data; // Points into the mapped file, valid while the reader is open
+        };
+
+        /**
+         * @brief Append-only capture log in a preallocated, memory-mapped file
+         *
+         * The file is sized once on open(), appending a record reserves space with a single atomic
+         * add and copies the bytes into the mapping, so capturing from the receive path costs a
+         * memcpy and never blocks or allocates. Writers on different threads may share one capture.
+         * A record becomes visible to readers only once completely written, so a file left behind by
+         * a crash ends at the last complete record. When the file is full, further records are
+         * counted as dropped.
+         */
+        class CaptureWriter {
+          public:
+            /**
+             * @brief Constructor
+             * @param path Capture file, replaced on open()
+             * @param capacity Bytes reserved for records
+             */
+            explicit CaptureWriter(std::string path, size_t capacity = 64 * 1024 * 1024);
+
+            /**
+             * @brief Destructor, closes the file
+             */
+            ~CaptureWriter();
+
+            // Delete copy
+            CaptureWriter(const CaptureWriter &) = delete;
+            CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+            /**
+             * @brief Create and map the capture file
+             * @return true if successful, false otherwise
+             */
+            bool open();
+
+            /**
+             * @brief Flush the records and trim the file to the bytes used
+             *
+             * No append() may run concurrently with close().
+             */
+            void close();
+
+            /**
+             * @brief Check if the capture file is open
+             */
+            bool is_open() const;
+
+            /**
+             * @brief Append a record
+             * @param kind Record kind
+             * @param channel Channel of the record
+             * @param data Record payload
+             * @param time When the data was received
+             * @return true if appended, false if the capture is closed or full
+             */
+            bool append(CaptureKind kind, uint16_t channel, std::span<const uint8_t> data,
+                        std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now());
+
+            /**
+             * @brief Get the number of record bytes written so far
+             */
+            size_t bytes_used() const;
+
+            /**
+             * @brief Get the number of records that did not fit
+             */
+            size_t records_dropped() const;
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+        };
+
+        /**
+         * @brief Pacing of a replay
+         */
+        struct ReplayOptions {
+            bool realtime = false; // Keep the recorded spacing between records instead of running flat out
+            double speed = 1.0;    // Realtime playback speed factor, 2.0 plays twice as fast
+            CaptureKind kind = CaptureKind::SerialChunk;
+            int channel = -1; // Channel to replay, -1 replays every channel
+        };
+
+        /**
+         * @brief Sequential reader of a capture file
+         */
+        class CaptureReader {
+          public:
+            CaptureReader();
+
+            /**
+             * @brief Destructor, unmaps the file
+             */
+            ~CaptureReader();
+
+            // Delete copy
+            CaptureReader(const CaptureReader &) = delete;
+            CaptureReader &operator=(const CaptureReader &) = delete;
+
+            /**
+             * @brief Map a capture file
+             * @param path Capture file
+             * @return true if it is a valid capture, false otherwise
+             */
+            bool open(const std::string &path);
+
+            /**
+             * @brief Unmap the file, invalidates every record returned so far
+             */
+            void close();
+
+            /**
+             * @brief Get the next record
+             * @param record Receives the record
+             * @return true if a record was read, false at the end of the capture
+             */
+            bool next(CaptureRecord &record);
+
+            /**
+             * @brief Start over at the first record
+             */
+            void rewind();
+
+            /**
+             * @brief Hand the records selected by the options to a handler, starting at the current record
+             *
+             * With options.realtime the handler is invoked at the recorded time offsets relative to the
+             * first record handed over, otherwise as fast as possible.
+             *
+             * @param options Record selection and pacing
+             * @param handler Called for every selected record, returning false stops the replay
+             * @return Number of records handed over
+             */
+            size_t replay(const ReplayOptions &options, const std::function<bool(const CaptureRecord &)> &handler);
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+        };
+
+    } // namespace comms
+} // namespace tractor
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace tractor {
+    namespace comms {
+
+        namespace detail {
+            struct FrameArena;
+
+            // Header in front of every buffer of a pool
+            struct FrameBlock {
+                std::atomic<uint32_t> references{0};
+                std::atomic<uint32_t> next{0}; // Free list link, index + 1 of the next free block, 0 ends it
+                uint32_t index = 0;
+                uint32_t size = 0;
+                FrameArena *arena = nullptr;
+
+                uint8_t *data() { return reinterpret_cast<uint8_t *>(this) + BLOCK_HEADER; }
+
+                static constexpr size_t BLOCK_HEADER = 32;
+            };
+
+            void release(FrameBlock *block);
+        } // namespace detail
+
+        /**
+         * @brief Reference-counted handle to one buffer of a FramePool
+         *
+         * Copies share the buffer and add a reference without allocating, the buffer goes back to the
+         * pool when the last handle is destroyed or reset. Handles may be passed to and released on
+         * any thread. The bytes should be considered immutable once a handle is shared.
+         */
+        class Frame {
+          public:
+            Frame() = default;
+            Frame(const Frame &other) noexcept : block_(other.block_) {
+                if (block_ != nullptr) {
+                    block_->references.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            Frame(Frame &&other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+            Frame &operator=(const Frame &other) noexcept {
+                Frame(other).swap(*this);
+                return *this;
+            }
+            Frame &operator=(Frame &&other) noexcept {
+                Frame(std::move(other)).swap(*this);
+                return *this;
+            }
+            ~Frame() { reset(); }
+
+            /**
+             * @brief Drop this handle's reference
+             */
+            void reset() noexcept {
+                if (block_ != nullptr && block_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    detail::release(block_);
+                }
+                block_ = nullptr;
+            }
+
+            void swap(Frame &other) noexcept { std::swap(block_, other.block_); }
+
+            /**
+             * @brief Check if the handle holds a buffer
+             */
+            explicit operator bool() const { return block_ != nullptr; }
+
+            uint8_t *data() { return block_ ? block_->data() : nullptr; }
+            const uint8_t *data() const { return block_ ? block_->data() : nullptr; }
+            size_t size() const { return block_ ? block_->size : 0; }
+            bool empty() const { return size() == 0; }
+
+            /**
+             * @brief Get the number of bytes the buffer can hold, the frame size of its pool
+             */
+            size_t capacity() const;
+
+            /**
+             * @brief Set the number of valid bytes
+             * @return true if within capacity()
+             */
+            bool resize(size_t size);
+
+            /**
+             * @brief Copy bytes into the buffer
+             * @return true if they fit
+             */
+            bool assign(std::span<const uint8_t> bytes);
+
+            std::span<const uint8_t> bytes() const { return {data(), size()}; }
+            std::string_view view() const { return {reinterpret_cast<const char *>(data()), size()}; }
+
+            /**
+             * @brief Get the number of handles sharing the buffer
+             */
+            size_t use_count() const { return block_ ? block_->references.load(std::memory_order_relaxed) : 0; }
+
+          private:
+            friend class FramePool;
+            explicit Frame(detail::FrameBlock *block) : block_(block) {}
+
+            detail::FrameBlock *block_ = nullptr;
+        };
+
+        /**
+         * @brief Fixed number of equally sized buffers, allocated once, handed out as Frame handles
+         *
+         * All buffers are allocated and touched by the constructor. Taking and returning one is a
+         * compare-and-swap on a lock-free free list, so a pool never calls malloc after construction
+         * and a running system has a fixed memory footprint. An exhausted pool hands out empty
+         * frames rather than growing; the statistics show how close a pool came to that.
+         *
+         * The pool is also a std::pmr::memory_resource serving allocations up to frame_size() bytes
+         * with one buffer each, e.g. for a std::pmr::string or a node container that must stay off
+         * the heap. It throws std::bad_alloc for anything larger or once exhausted.
+         *
+         * Buffers stay valid while any Frame refers to them, even after the pool is destroyed. All
+         * members are thread-safe.
+         */
+        class FramePool : public std::pmr::memory_resource {
+          public:
+            /**
+             * @brief Constructor
+             * @param frame_size Bytes per buffer
+             * @param frames Number of buffers
+             */
+            FramePool(size_t frame_size, size_t frames);
+
+            /**
+             * @brief Destructor - the memory is freed once the last Frame is released
+             */
+            ~FramePool() override;
+
+            // Delete copy
+            FramePool(const FramePool &) = delete;
+            FramePool &operator=(const FramePool &) = delete;
+
+            /**
+             * @brief Take a free buffer
+             * @return Frame of size 0, empty if every buffer is in use
+             */
+            Frame acquire();
+
+            /**
+             * @brief Take a free buffer and copy bytes into it
+             * @return Frame holding the bytes, empty if they do not fit or every buffer is in use
+             */
+            Frame acquire(std::span<const uint8_t> bytes);
+
+            /**
+             * @brief Get the bytes per buffer
+             */
+            size_t frame_size() const;
+
+            /**
+             * @brief Get the number of buffers
+             */
+            size_t capacity() const;
+
+            /**
+             * @brief Get the number of buffers not in use
+             */
+            size_t available() const;
+
+            /**
+             * @brief Get statistics
+             */
+            struct Statistics {
+                size_t acquired = 0;        // Buffers handed out, by acquire() or allocate()
+                size_t exhausted = 0;       // Requests that found no free buffer
+                size_t in_use = 0;          // Buffers out right now
+                size_t high_water_mark = 0; // Most buffers out at once
+            };
+
+            /**
+             * @brief Get a snapshot of the statistics
+             */
+            Statistics get_statistics() const;
+
+          protected:
+            void *do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+          private:
+            detail::FrameArena *arena_;
+        };
+
+    } // namespace comms
+} // namespace tractor
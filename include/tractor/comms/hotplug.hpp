@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tractor {
+    namespace comms {
+
+        /**
+         * @brief Serial device as seen in /dev and sysfs
+         */
+        struct PortDescription {
+            std::string path;        // Name that appeared, e.g. /dev/ttyUSB0 or a /dev/serial/by-id link
+            std::string device;      // Device node the path resolves to
+            std::string by_id;       // Stable /dev/serial/by-id link of the device, empty if there is none
+            uint16_t vendor_id = 0;  // USB idVendor, 0 for devices that are not USB
+            uint16_t product_id = 0; // USB idProduct
+            std::string serial_number;
+            std::string manufacturer;
+            std::string product;
+        };
+
+        /**
+         * @brief Selects devices by path or by USB attributes, empty fields match anything
+         */
+        struct PortMatch {
+            std::string path;          // Device node or link, compared with path, device and by_id
+            uint16_t vendor_id = 0;    // 0 matches any vendor
+            uint16_t product_id = 0;   // 0 matches any product
+            std::string serial_number; // Empty matches any serial number
+
+            /**
+             * @brief Check if any USB attribute is set
+             */
+            bool by_attributes() const { return vendor_id != 0 || product_id != 0 || !serial_number.empty(); }
+
+            /**
+             * @brief Check if a device matches
+             * @param port Device to check
+             * @return true if every set field matches, false otherwise
+             */
+            bool matches(const PortDescription &port) const;
+        };
+
+        /**
+         * @brief Describe a serial device from its node and sysfs
+         *
+         * Follows links such as /dev/serial/by-id entries to the device node and reads the USB
+         * attributes of the device it belongs to from /sys/class/tty.
+         *
+         * @param path Device node or link
+         * @param port Receives the description
+         * @return true if the path exists, false otherwise
+         */
+        bool describe_port(const std::string &path, PortDescription &port);
+
+        /**
+         * @brief Describe every port Tty::list_ports() finds
+         * @return Port descriptions sorted by path
+         */
+        std::vector<PortDescription> list_port_descriptions();
+
+        /**
+         * @brief What happened to a device
+         */
+        enum class HotplugEvent {
+            Added,  // Created, renamed into place or had its permissions changed, may repeat for one device
+            Removed // Deleted or renamed away, only path and what was known when it was added are set
+        };
+
+        /**
+         * @brief inotify based watcher for serial devices appearing and disappearing
+         *
+         * Watches /dev and the /dev/serial/by-id and /dev/serial/by-path link directories and keeps
+         * a snapshot of the ports present, so lookups do not walk /dev. Directories that do not exist
+         * yet, like /dev/serial/by-id before the first USB adapter is plugged in, are watched from
+         * their closest existing parent and added when they appear. No udev library or netlink
+         * privileges are needed; devices count as added once udev created their node or link.
+         *
+         * Callbacks run on the watcher thread and must neither subscribe nor unsubscribe.
+         */
+        class HotplugMonitor {
+          public:
+            using Callback = std::function<void(HotplugEvent event, const PortDescription &port)>;
+
+            /**
+             * @brief Constructor, watching the standard device directories
+             */
+            HotplugMonitor();
+
+            /**
+             * @brief Constructor
+             * @param directories Directories to watch, "/dev" itself only reports the nodes Tty::list_ports() finds
+             */
+            explicit HotplugMonitor(std::vector<std::string> directories);
+
+            /**
+             * @brief Destructor - stops the watcher thread
+             */
+            ~HotplugMonitor();
+
+            // Delete copy
+            HotplugMonitor(const HotplugMonitor &) = delete;
+            HotplugMonitor &operator=(const HotplugMonitor &) = delete;
+
+            /**
+             * @brief Get the process wide monitor used by Serial, started by its first subscription
+             */
+            static HotplugMonitor &shared();
+
+            /**
+             * @brief Start the watcher thread
+             * @return true if running, false otherwise
+             */
+            bool start();
+
+            /**
+             * @brief Stop the watcher thread
+             */
+            void stop();
+
+            /**
+             * @brief Check if the watcher thread is running
+             */
+            bool is_running() const;
+
+            /**
+             * @brief Additionally watch a directory, e.g. one holding links created by socat
+             * @param directory Directory to watch
+             */
+            void watch_directory(const std::string &directory);
+
+            /**
+             * @brief Get notified about matching devices, starts the monitor if needed
+             *
+             * The directory of match.path is watched as well.
+             *
+             * @param match Devices of interest
+             * @param callback Called for every event of a matching device
+             * @return Subscription id for unsubscribe(), 0 if the monitor could not start
+             */
+            size_t subscribe(const PortMatch &match, Callback callback);
+
+            /**
+             * @brief Cancel a subscription, waits for a callback of it that is running
+             * @param id Subscription id
+             */
+            void unsubscribe(size_t id);
+
+            /**
+             * @brief Get the ports currently present in the watched directories
+             * @return Port descriptions sorted by path
+             */
+            std::vector<PortDescription> ports() const;
+
+            /**
+             * @brief Find the first present port that matches
+             * @param match Devices of interest
+             * @param port Receives the port
+             * @return true if found, false otherwise
+             */
+            bool find(const PortMatch &match, PortDescription &port) const;
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+
+            void watcher_thread();
+        };
+
+    } // namespace comms
+} // namespace tractor
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "tractor/comms/serial.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace tractor {
+    namespace comms {
+
+        /**
+         * @brief How the reactor waits for input
+         */
+        enum class ReactorBackend {
+            Epoll,  // One epoll_wait() per batch of ready ports plus one read() per port
+            IoUring // Reads stay posted in an io_uring, one system call reaps every completed read
+        };
+
+        /**
+         * @brief Configuration for the shared serial event loop
+         */
+        struct ReactorOptions {
+            size_t threads = 1;     // Worker threads waiting on the shared epoll set
+            uint32_t tick_ms = 50;  // Granularity of reconnect attempts and read timeout handling
+            size_t max_events = 16; // Events collected per epoll_wait() call
+            ReactorBackend backend = ReactorBackend::Epoll;
+            size_t ring_buffers = 8;        // io_uring: registered read buffers, further ports read into their own
+            size_t ring_buffer_size = 4096; // io_uring: bytes per registered buffer
+        };
+
+        /**
+         * @brief epoll based event loop servicing many Serial instances from a small thread pool
+         *
+         * Serial objects added to a reactor do not start their own reader thread. Their ports are
+         * switched to non-blocking mode and registered with one epoll set; whichever worker wakes up
+         * reads the pending chunk and runs the framing and callbacks of that port. Each port is armed
+         * one-shot, so a port is never serviced by two workers at once and its callbacks stay
+         * serialized. Automatic reconnection and read timeouts are driven by the same workers.
+         *
+         * With ReactorBackend::IoUring every attached port always has a read posted in an io_uring
+         * instead. A single worker submits the reads and reaps their completions in one system call
+         * and feeds each chunk to the framing straight from the completed buffer, so ports cost no
+         * system call of their own. Ports whose read_chunk_size fits ring_buffer_size read into one
+         * of ring_buffers registered buffers, the kernel maps those once rather than on every read.
+         * The backend is compiled in with TRACTOR_IO_URING; without it, or on kernels older than
+         * 5.11, the reactor falls back to epoll, see get_backend().
+         *
+         * Callbacks may call Serial::stop() or SerialReactor::remove() on the port they are invoked
+         * for, the worker then detaches the port once they returned.
+         */
+        class SerialReactor {
+          public:
+            /**
+             * @brief Constructor
+             * @param options Reactor options
+             */
+            explicit SerialReactor(const ReactorOptions &options = ReactorOptions{});
+
+            /**
+             * @brief Destructor - stops the workers and detaches all ports
+             */
+            ~SerialReactor();
+
+            // Delete copy
+            SerialReactor(const SerialReactor &) = delete;
+            SerialReactor &operator=(const SerialReactor &) = delete;
+
+            /**
+             * @brief Hand a serial port over to the reactor
+             *
+             * Connects the port if possible. A port that cannot be opened yet is still accepted when
+             * auto_reconnect is enabled in its options.
+             *
+             * @param serial Serial instance that is not running yet
+             * @return true if the port is now serviced by this reactor, false otherwise
+             */
+            bool add(Serial &serial);
+
+            /**
+             * @brief Stop servicing a port and close it
+             *
+             * Waits until a worker currently inside the port's callbacks has returned. Called from those
+             * callbacks it returns at once, the port is detached and closed when they returned.
+             *
+             * @param serial Serial instance previously added
+             */
+            void remove(Serial &serial);
+
+            /**
+             * @brief Start the worker threads
+             * @return true if running, false otherwise
+             */
+            bool start();
+
+            /**
+             * @brief Stop the worker threads, ports stay attached
+             */
+            void stop();
+
+            /**
+             * @brief Check if the workers are running
+             * @return true if running, false otherwise
+             */
+            bool is_running() const;
+
+            /**
+             * @brief Get the number of attached ports
+             * @return Number of ports
+             */
+            size_t size() const;
+
+            /**
+             * @brief Get the backend in use
+             * @return ReactorBackend::Epoll when io_uring was requested but is unavailable
+             */
+            ReactorBackend get_backend() const;
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+
+            void worker();
+            void ring_worker();
+            void service_timers();
+        };
+
+    } // namespace comms
+} // namespace tractor
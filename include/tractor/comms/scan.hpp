@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace tractor {
+    namespace comms {
+
+        /**
+         * @brief Instruction set used by the byte scanning kernels
+         */
+        enum class SimdLevel { Scalar, SSE2, AVX2, NEON };
+
+        /**
+         * @brief Get the instruction set the scanning kernels currently dispatch to
+         *
+         * Detected once at startup: AVX2 if the CPU reports it, otherwise SSE2 on x86-64 and NEON on
+         * aarch64, scalar code everywhere else.
+         *
+         * @return Active instruction set
+         */
+        SimdLevel simd_level();
+
+        /**
+         * @brief Get the best instruction set supported by this CPU
+         * @return Detected instruction set
+         */
+        SimdLevel detected_simd_level();
+
+        /**
+         * @brief Restrict the kernels to a given instruction set (for testing and benchmarking)
+         * @param level Requested instruction set, clamped to what the CPU supports
+         * @return The instruction set now in use
+         */
+        SimdLevel set_simd_level(SimdLevel level);
+
+        /**
+         * @brief Get a printable name for an instruction set
+         * @param level Instruction set
+         * @return Name such as "avx2"
+         */
+        const char *simd_level_name(SimdLevel level);
+
+        /**
+         * @brief Find the first occurrence of a byte (memchr semantics)
+         * @param data Buffer to scan
+         * @param size Number of bytes in the buffer
+         * @param value Byte to look for
+         * @return Pointer to the first match, nullptr if the byte does not occur
+         */
+        const uint8_t *find_byte(const uint8_t *data, size_t size, uint8_t value);
+
+        /**
+         * @brief XOR all bytes of a buffer together
+         * @param data Buffer to reduce
+         * @param size Number of bytes in the buffer
+         * @return XOR of all bytes, 0 for an empty buffer
+         */
+        uint8_t xor_bytes(const uint8_t *data, size_t size);
+
+        /**
+         * @brief Compute the NMEA 0183 checksum of a sentence
+         *
+         * XORs every character after the leading '$' or '!' up to, not including, the '*'.
+         *
+         * @param sentence Sentence with or without the checksum field
+         * @return Checksum over the sentence body
+         */
+        uint8_t nmea_checksum(std::string_view sentence);
+
+        /**
+         * @brief Validate the "*hh" checksum field of an NMEA 0183 sentence
+         * @param sentence Complete sentence, trailing line endings allowed
+         * @return true if the field is present and matches, false otherwise
+         */
+        bool nmea_checksum_valid(std::string_view sentence);
+
+    } // namespace comms
+} // namespace tractor
@@ -1,17 +1,26 @@
 #pragma once
 
+#include "tractor/comms/capture.hpp"
+#include "tractor/comms/frame_pool.hpp"
+#include "tractor/comms/hotplug.hpp"
 #include "tractor/comms/tty.hpp"
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 namespace tractor {
     namespace comms {
 
+        class SerialReactor;
+
         /**
          * @brief Callback function for received lines
          * @param line The received line (without delimiter)
@@ -24,6 +33,62 @@ namespace tractor {
          */
         using DataCallback = std::function<void(const std::vector<uint8_t> &data)>;
 
+        /**
+         * @brief Callback function for received lines, without copying them out of the receive buffer
+         * @param line The received line (without delimiter), only valid until the callback returns
+         */
+        using LineViewCallback = std::function<void(std::string_view line)>;
+
+        /**
+         * @brief Callback function for received binary data, without copying it out of the receive buffer
+         * @param data The received data, only valid until the callback returns
+         */
+        using DataViewCallback = std::function<void(std::span<const uint8_t> data)>;
+
+        /**
+         * @brief When the bytes of a received frame arrived
+         *
+         * Serial drivers do not timestamp received bytes, so first_byte and last_byte are taken on
+         * return of the read() that delivered them. When the reader falls behind, a read returns a
+         * backlog whose bytes arrived earlier than the read returned; arrival corrects last_byte by
+         * the wire time of the bytes that followed the frame in the same read, at the configured baud
+         * rate and character format. It is only an estimate and equals last_byte when the frame
+         * ended its read, which is the usual case once the reader keeps up.
+         */
+        struct FrameInfo {
+            std::chrono::steady_clock::time_point first_byte; // Read that returned the frame's first byte
+            std::chrono::steady_clock::time_point last_byte;  // Read that completed the frame
+            std::chrono::steady_clock::time_point arrival;    // Estimated arrival of the last byte
+            uint64_t sequence = 0;                            // Frames framed so far, gaps mean dropped frames
+        };
+
+        /**
+         * @brief Callback function for received lines with their timestamps
+         * @param line The received line (without delimiter), only valid until the callback returns
+         * @param info When the line arrived
+         */
+        using LineInfoCallback = std::function<void(std::string_view line, const FrameInfo &info)>;
+
+        /**
+         * @brief Callback function for received binary data with its timestamps
+         * @param data The received data, only valid until the callback returns
+         * @param info When the data arrived
+         */
+        using DataInfoCallback = std::function<void(std::span<const uint8_t> data, const FrameInfo &info)>;
+
+        /**
+         * @brief Callback function for received frames in a pooled buffer, in any framing mode
+         * @param frame The received frame, copying the handle keeps it past the callback without allocating
+         * @param info When the frame arrived
+         */
+        using FrameCallback = std::function<void(const Frame &frame, const FrameInfo &info)>;
+
+        /**
+         * @brief Callback function reporting the outcome of an asynchronous write
+         * @param success true if every byte of the write reached the port
+         */
+        using WriteCallback = std::function<void(bool success)>;
+
         /**
          * @brief Callback function for connection events
          * @param connected true if connected, false if disconnected
@@ -46,6 +111,23 @@ namespace tractor {
             Custom          // Custom delimiter byte
         };
 
+        /**
+         * @brief Thread on which received frames are handed to the callbacks
+         */
+        enum class DispatchMode {
+            Inline, // Callbacks run on the thread that reads the port
+            Queued  // Frames are queued and a dedicated dispatcher thread runs the callbacks
+        };
+
+        /**
+         * @brief What the reader does when the dispatch queue is full (DispatchMode::Queued)
+         */
+        enum class OverflowPolicy {
+            DropOldest, // Discard the oldest queued frame to make room
+            DropNewest, // Discard the frame that did not fit
+            Block       // Stop reading until the dispatcher catches up
+        };
+
         /**
          * @brief Configuration for high-level serial communication
          */
@@ -60,8 +142,20 @@ namespace tractor {
 
             bool auto_reconnect = false;
             uint32_t reconnect_delay_ms = 1000;
+            uint32_t reconnect_max_delay_ms = 0; // Doubles the delay per failed attempt up to this, jittered
+            bool hotplug = true;                 // Retry as soon as a matching device appears, see HotplugMonitor
+            PortMatch device;                    // With USB attributes set, open the matching device, not port
             size_t max_line_length = 4096;
             bool strip_line_endings = true; // Remove \r\n from lines
+            size_t read_chunk_size = 4096;  // Maximum bytes pulled from the port per read() call
+
+            DispatchMode dispatch = DispatchMode::Inline;
+            size_t dispatch_queue_depth = 64; // Frames buffered between reader and dispatcher
+            OverflowPolicy overflow_policy = OverflowPolicy::DropOldest;
+            size_t frame_pool_size = 128; // Pooled frames shared by the dispatch queue and on_frame() holders
+
+            size_t write_queue_size = 4096; // Bytes buffered by write_async()
+            size_t write_queue_depth = 64;  // write_async() calls that may be pending at once
         };
 
         /**
@@ -71,8 +165,9 @@ namespace tractor {
          * - Automatic message framing (line-based, length-prefixed, etc.)
          * - Callback-based event handling
          * - Thread-safe write operations
-         * - Optional automatic reconnection
+         * - Optional automatic reconnection, immediate once the device is plugged back in
          * - Background reading thread
+         * - Optional dispatcher thread so slow callbacks do not stall reading
          */
         class Serial {
           public:
@@ -100,12 +195,19 @@ namespace tractor {
 
             /**
              * @brief Start serial communication
+             *
+             * With auto_reconnect a port that cannot be opened yet does not fail the start, the reader
+             * keeps retrying until the device is present.
+             *
              * @return true if successfully started, false otherwise
              */
             bool start();
 
             /**
              * @brief Stop serial communication
+             *
+             * On a port of a SerialReactor this may be called from the port's callbacks, it then returns
+             * at once and the port stops when they returned.
              */
             void stop();
 
@@ -135,6 +237,13 @@ namespace tractor {
              */
             bool write(const std::vector<uint8_t> &data);
 
+            /**
+             * @brief Write raw data from any contiguous buffer
+             * @param data Data to write
+             * @return true if successful, false otherwise
+             */
+            bool write(std::span<const uint8_t> data);
+
             /**
              * @brief Write string data
              * @param data String to write
@@ -142,6 +251,34 @@ namespace tractor {
              */
             bool write(const std::string &data);
 
+            /**
+             * @brief Queue data for writing and return immediately
+             *
+             * The data is copied into a preallocated ring and sent by a writer thread, which combines
+             * all writes pending at that moment into one writev() call. Fails without blocking when the
+             * port is not connected or the ring has no room left.
+             *
+             * @param data Data to write
+             * @param on_complete Optional callback invoked from the writer thread once the data was written
+             * @return true if queued, false otherwise
+             */
+            bool write_async(std::span<const uint8_t> data, WriteCallback on_complete = nullptr);
+
+            /**
+             * @brief Queue string data for writing and return immediately
+             * @param data String to write
+             * @param on_complete Optional callback invoked from the writer thread once the data was written
+             * @return true if queued, false otherwise
+             */
+            bool write_async(const std::string &data, WriteCallback on_complete = nullptr);
+
+            /**
+             * @brief Wait until every write_async() call queued so far has completed
+             * @param timeout_ms Maximum time to wait
+             * @return true if the queue is empty, false on timeout
+             */
+            bool flush(uint32_t timeout_ms = 1000);
+
             /**
              * @brief Set callback for received lines (LineDelimited mode)
              * @param callback Function to call when a line is received
@@ -154,6 +291,59 @@ namespace tractor {
              */
             void on_data(DataCallback callback);
 
+            /**
+             * @brief Set callback for received lines that points into the receive buffer (LineDelimited mode)
+             *
+             * Avoids the per-line std::string copy of on_line(). Both callbacks may be set, the view
+             * callback is invoked first.
+             *
+             * @param callback Function to call when a line is received
+             */
+            void on_line_view(LineViewCallback callback);
+
+            /**
+             * @brief Set callback for received data that points into the receive buffer (other framing modes)
+             *
+             * Avoids the per-message std::vector copy of on_data(). Both callbacks may be set, the view
+             * callback is invoked first.
+             *
+             * @param callback Function to call when data is received
+             */
+            void on_data_view(DataViewCallback callback);
+
+            /**
+             * @brief Set callback for received lines with their timestamps (LineDelimited mode)
+             *
+             * Invoked after the view callback and before the copying one.
+             *
+             * @param callback Function to call when a line is received
+             */
+            void on_line_view(LineInfoCallback callback);
+
+            /**
+             * @brief Set callback for received data with its timestamps (other framing modes)
+             *
+             * Invoked after the view callback and before the copying one.
+             *
+             * @param callback Function to call when data is received
+             */
+            void on_data_view(DataInfoCallback callback);
+
+            /**
+             * @brief Set callback for received frames that may be kept past the callback (any framing mode)
+             *
+             * Frames are held in a FramePool of frame_pool_size buffers, large enough for the longest
+             * frame of the framing mode and allocated when this callback is first set or the
+             * dispatcher starts. The dispatch queue stores its frames in the same pool and hands the
+             * queued buffer itself to this callback. Keeping a copy of the handle, e.g. in a queue of
+             * the application, keeps the buffer out of the pool until the copy is released; while
+             * every buffer is held, new frames count as frames_dropped instead. Invoked after the
+             * timestamped view callback and before the copying one.
+             *
+             * @param callback Function to call when a frame is received
+             */
+            void on_frame(FrameCallback callback);
+
             /**
              * @brief Set callback for connection state changes
              * @param callback Function to call on connect/disconnect
@@ -166,17 +356,72 @@ namespace tractor {
              */
             void on_error(ErrorCallback callback);
 
+            /**
+             * @brief Record every chunk read from the port to a capture
+             *
+             * Chunks are captured before framing, so a replay() of the capture goes through the same
+             * framing and callbacks as the original traffic. Only takes effect while stopped.
+             *
+             * @param capture Open capture to append to, nullptr stops capturing
+             * @param channel Channel the records are tagged with
+             * @return true if set, false while running
+             */
+            bool set_capture(std::shared_ptr<CaptureWriter> capture, uint16_t channel = 0);
+
+            /**
+             * @brief Feed captured chunks through the framing and callbacks instead of reading the port
+             *
+             * Runs on the calling thread until the capture ends, with DispatchMode::Queued the frames
+             * still queued are delivered before returning. Statistics count the replayed traffic like
+             * received traffic, so replaying as fast as possible measures the receive path throughput.
+             *
+             * @param reader Capture positioned at the first record to replay
+             * @param options Pacing and channel selection, the record kind is always SerialChunk
+             * @return Number of chunks replayed, 0 while running
+             */
+            size_t replay(CaptureReader &reader, const ReplayOptions &options = ReplayOptions{});
+
             /**
              * @brief Get statistics
+             *
+             * Latency is measured from the read that returned the first byte of a frame to the moment
+             * its callbacks are invoked. Bucket i of the histogram counts frames that took
+             * [2^i, 2^(i+1)) microseconds, bucket 0 also holds everything below 1 us and the last
+             * bucket everything above its lower bound.
              */
             struct Statistics {
+                static constexpr size_t LATENCY_BUCKETS = 24;
+
                 size_t lines_received = 0;
                 size_t bytes_received = 0;
                 size_t bytes_sent = 0;
                 size_t errors = 0;
                 size_t reconnects = 0;
+
+                size_t frames_received = 0;      // Frames delivered in any framing mode
+                double frames_per_second = 0.0;  // Average delivery rate since construction or the last reset
+                std::array<uint64_t, LATENCY_BUCKETS> latency_histogram{};
+                uint64_t callback_time_ns = 0;     // Total time spent inside the receive callbacks
+                uint64_t max_callback_time_ns = 0; // Longest single delivery
+                size_t buffer_high_water_mark = 0; // Largest partial frame held while assembling
+                size_t chunk_high_water_mark = 0;  // Largest single read, read_chunk_size means the reader lags
+                size_t frames_dropped = 0;         // Frames the dispatch queue or an exhausted frame pool discarded
+                size_t pool_high_water_mark = 0;   // Most pooled frames out at once, frame_pool_size means drops
+
+                /**
+                 * @brief Estimate a latency percentile from the histogram
+                 * @param percentile Percentile in the range 0..100
+                 * @return Upper bound of the bucket holding the percentile in microseconds, 0 without frames
+                 */
+                uint64_t latency_percentile_us(double percentile) const;
             };
 
+            /**
+             * @brief Get a snapshot of the statistics
+             *
+             * Counters are updated with relaxed atomics and never block the reader, so the snapshot is
+             * not taken atomically as a whole.
+             */
             Statistics get_statistics() const;
 
             /**
@@ -197,16 +442,48 @@ namespace tractor {
             Tty *get_tty();
 
           private:
+            friend class SerialReactor;
+
             struct Impl;
             std::unique_ptr<Impl> pimpl_;
 
+            // Hooks driven by SerialReactor instead of the reader thread
+            bool reactor_attach(SerialReactor *reactor);
+            void reactor_detach();
+            int reactor_fd() const;
+            bool reactor_read();
+            size_t reactor_chunk_size() const;
+            bool reactor_chunk(const uint8_t *data, ssize_t result);
+            void reactor_idle();
+            void reactor_error();
+            bool reactor_reconnect();
+            std::chrono::milliseconds reactor_reconnect_delay();
+            bool reactor_hotplug();
+
             void reader_thread();
             bool connect();
             void disconnect();
-            void process_line_delimited();
-            void process_fixed_length();
-            void process_length_prefixed();
-            void process_custom();
+            void subscribe_hotplug();
+            void unsubscribe_hotplug();
+            void process_incoming();
+            void reset_framing();
+            void process_chunk(const uint8_t *data, size_t size);
+            void process_line_delimited(const uint8_t *data, size_t size);
+            void process_fixed_length(const uint8_t *data, size_t size);
+            void process_length_prefixed(const uint8_t *data, size_t size);
+            void process_custom(const uint8_t *data, size_t size);
+            void append_to_frame(const uint8_t *data, size_t size, bool exempt_cr, const char *overflow_message);
+            void drop_partial_frame();
+            void deliver_frame(const uint8_t *data, size_t size, std::chrono::steady_clock::time_point first_byte,
+                               size_t trailing);
+            void invoke_callbacks(const uint8_t *data, size_t size, const FrameInfo &info,
+                                  const Frame *frame = nullptr);
+            void start_dispatcher();
+            void stop_dispatcher();
+            void dispatcher_thread();
+            ssize_t write_locked(const struct iovec *iov, int count, size_t size);
+            void writer_thread();
+            void stop_writer();
         };
 
     } // namespace comms
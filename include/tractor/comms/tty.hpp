@@ -7,6 +7,8 @@
 #include <string>
 #include <vector>
 
+struct iovec;
+
 namespace tractor {
     namespace comms {
 
@@ -44,6 +46,34 @@ namespace tractor {
             bool vmin_mode = false; // If true, uses VMIN/VTIME instead of timeout
             uint8_t vmin = 1;       // Minimum characters to read
             uint8_t vtime = 0;      // Time between characters (in deciseconds)
+
+            bool low_latency = false;     // Tune the driver for latency, see Tty::get_latency_report()
+            uint8_t latency_timer_ms = 1; // USB adapter latency timer to request in low_latency mode, 0 = keep
+        };
+
+        /**
+         * @brief What the low latency profile found on the port and what it changed
+         *
+         * USB serial adapters hold received bytes until their buffer fills or a latency timer expires
+         * (16 ms by default on FTDI chips), which dominates the end-to-end latency of short NMEA
+         * sentences far more than the baud rate. With SerialConfig::low_latency the port is
+         * configured so that:
+         * - VMIN and VTIME are 0, read() returns as soon as select() reports data
+         * - ASYNC_LOW_LATENCY is set through TIOCSSERIAL, so the tty layer pushes data to readers
+         *   immediately instead of deferring it to a work queue
+         * - the latency timer in /sys/class/tty/<name>/device/latency_timer is lowered to
+         *   latency_timer_ms where the driver exposes one (FTDI) and the file is writable; otherwise
+         *   it is only reported. CP210x and CDC-ACM devices have no such timer.
+         *
+         * The serial flag is restored on close, the latency timer is a device setting and stays.
+         */
+        struct LatencyReport {
+            bool requested = false;           // SerialConfig::low_latency was set when the port was configured
+            bool async_low_latency = false;   // ASYNC_LOW_LATENCY is active on the port
+            int latency_timer_ms = -1;        // Latency timer found before tuning, -1 if the driver has none
+            int latency_timer_now_ms = -1;    // Latency timer after tuning, -1 if the driver has none
+            std::string latency_timer_path;   // sysfs attribute used, empty if none was found
+            std::vector<std::string> notes;   // Steps that were not possible and why
         };
 
         /**
@@ -140,11 +170,19 @@ namespace tractor {
              */
             ssize_t write(const std::string &data);
 
+            /**
+             * @brief Write several buffers with as few writev() calls as possible
+             * @param iov Buffers to write, in order
+             * @param count Number of buffers
+             * @return Number of bytes actually written, -1 on error
+             */
+            ssize_t write_vectored(const struct iovec *iov, int count);
+
             /**
              * @brief Read data from the serial port
              * @param buffer Buffer to store read data
              * @param size Maximum number of bytes to read
-             * @return Number of bytes actually read, -1 on error, 0 on timeout
+             * @return Number of bytes actually read, -1 on error or hangup, 0 on timeout
              */
             ssize_t read(uint8_t *buffer, size_t size);
 
@@ -156,6 +194,18 @@ namespace tractor {
              */
             ssize_t read(std::vector<uint8_t> &buffer, size_t size);
 
+            /**
+             * @brief Read whatever is already buffered without waiting
+             *
+             * Intended for event loops that learn about readiness through epoll. The port should be
+             * in non-blocking mode, see set_non_blocking().
+             *
+             * @param buffer Buffer to store read data
+             * @param size Maximum number of bytes to read
+             * @return Number of bytes actually read, -1 on error, 0 if nothing was pending
+             */
+            ssize_t read_available(uint8_t *buffer, size_t size);
+
             /**
              * @brief Read until a delimiter is found
              * @param delimiter Byte to use as delimiter
@@ -211,6 +261,10 @@ namespace tractor {
 
             /**
              * @brief Set the baud rate
+             *
+             * Rates without a standard Bxxx constant (250000, 1843200, ...) are set through termios2
+             * with BOTHER, which the driver may round to the nearest rate its clock divider allows.
+             *
              * @param baud_rate Baud rate in bits per second
              * @return true if successful, false otherwise
              */
@@ -218,7 +272,7 @@ namespace tractor {
 
             /**
              * @brief Get current baud rate
-             * @return Current baud rate
+             * @return Rate reported by the driver while open, the configured rate otherwise
              */
             uint32_t get_baud_rate() const;
 
@@ -344,18 +398,39 @@ namespace tractor {
              */
             void send_break(uint32_t duration_ms = 0);
 
+            /**
+             * @brief Switch the file descriptor between blocking and non-blocking mode
+             *
+             * Timeouts of read(), read_exact() and write() keep working in both modes since they wait
+             * with select() before touching the descriptor.
+             *
+             * @param enable true for non-blocking, false for blocking
+             * @return true if successful, false otherwise
+             */
+            bool set_non_blocking(bool enable);
+
             /**
              * @brief Get native file descriptor (for advanced usage)
              * @return File descriptor or -1 if not open
              */
             int get_fd() const;
 
+            /**
+             * @brief Get the outcome of the low latency profile
+             * @return Report of the last configuration with SerialConfig::low_latency
+             */
+            LatencyReport get_latency_report() const;
+
           private:
             class Impl;
             std::unique_ptr<Impl> pimpl_;
 
             bool configure_port();
             bool set_termios_baud(uint32_t baud_rate);
+            bool set_custom_baud(uint32_t baud_rate);
+            void cache_baud_rate();
+            void apply_low_latency();
+            void restore_serial_flags();
         };
 
     } // namespace comms
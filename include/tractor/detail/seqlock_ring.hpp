@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace tractor {
+    namespace detail {
+
+        /**
+         * @brief Ring of values written by one thread and read lock-free by any
+         *
+         * Every slot is a seqlock: the writer makes its sequence odd, stores the value and makes it
+         * even again. The sequence also encodes which value the slot holds, 2 * index + 2, so a reader
+         * that finds it changed knows the value it asked for was overwritten by a newer one and never
+         * returns a mix of both. Readers never block the writer.
+         *
+         * Values are copied as 64 bit words through std::bit_cast, which leaves padding bytes
+         * indeterminate. T must therefore have none: types std::has_unique_object_representations
+         * cannot vouch for, those with floating point members, spell out their padding as members and
+         * assert their size.
+         *
+         * push() and clear() must only be called from one thread at a time, read() and head() from any.
+         */
+        template <typename T>
+        class SeqlockRing {
+            static_assert(std::is_trivially_copyable_v<T>, "Values are copied as words");
+            static_assert(sizeof(T) % sizeof(uint64_t) == 0, "Spell out the tail padding as members");
+
+          public:
+            /**
+             * @brief Constructor
+             * @param capacity Values kept, rounded up to a power of two
+             */
+            explicit SeqlockRing(size_t capacity)
+                : slots_(std::make_unique<Slot[]>(std::bit_ceil(std::max<size_t>(capacity, 1)))),
+                  mask_(std::bit_ceil(std::max<size_t>(capacity, 1)) - 1) {}
+
+            // Delete copy
+            SeqlockRing(const SeqlockRing &) = delete;
+            SeqlockRing &operator=(const SeqlockRing &) = delete;
+
+            /**
+             * @brief Append a value, overwriting the oldest one once the ring is full
+             */
+            void push(const T &value) {
+                uint64_t index = head_.load(std::memory_order_relaxed);
+                Slot &slot = slots_[index & mask_];
+                auto words = std::bit_cast<Words>(value);
+
+                slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                for (size_t i = 0; i < WORDS; i++) {
+                    slot.words[i].store(words[i], std::memory_order_relaxed);
+                }
+                slot.sequence.store(index * 2 + 2, std::memory_order_release);
+                head_.store(index + 1, std::memory_order_release);
+            }
+
+            /**
+             * @brief Read the value pushed as number index
+             * @return true if read, false once the writer reused the slot or before the value was pushed
+             */
+            bool read(uint64_t index, T &value) const {
+                const Slot &slot = slots_[index & mask_];
+                const uint64_t expected = index * 2 + 2;
+                if (slot.sequence.load(std::memory_order_acquire) != expected) {
+                    return false;
+                }
+
+                Words words;
+                for (size_t i = 0; i < WORDS; i++) {
+                    words[i] = slot.words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+                    return false;
+                }
+                value = std::bit_cast<T>(words);
+                return true;
+            }
+
+            /**
+             * @brief Number of values pushed so far, including those overwritten since
+             *
+             * A value below head() is complete before it is counted.
+             */
+            uint64_t head() const { return head_.load(std::memory_order_acquire); }
+
+            /**
+             * @brief Maximum number of values kept
+             */
+            size_t capacity() const { return mask_ + 1; }
+
+            /**
+             * @brief Forget every value, must not run concurrently with readers
+             */
+            void clear() {
+                for (size_t i = 0; i <= mask_; i++) {
+                    slots_[i].sequence.store(0, std::memory_order_relaxed);
+                }
+                head_.store(0, std::memory_order_release);
+            }
+
+          private:
+            static constexpr size_t WORDS = sizeof(T) / sizeof(uint64_t);
+            using Words = std::array<uint64_t, WORDS>;
+
+            struct Slot {
+                std::atomic<uint64_t> sequence{0}; // 2 * index + 2 once value index is stored, odd while writing
+                std::array<std::atomic<uint64_t>, WORDS> words{};
+            };
+
+            std::unique_ptr<Slot[]> slots_;
+            const size_t mask_;
+            alignas(64) std::atomic<uint64_t> head_{0}; // Values pushed so far
+        };
+
+    } // namespace detail
+} // namespace tractor
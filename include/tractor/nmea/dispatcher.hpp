@@ -0,0 +1,159 @@
+#pragma once
+
+#include "tractor/nmea/nmea.hpp"
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace tractor {
+    namespace nmea {
+
+        /**
+         * @brief Pack a sentence name into an integer key
+         *
+         * Standard sentences are keyed by their type without the talker ("GGA"), proprietary ones by
+         * their whole address ("PHTG"), so $GPGGA, $GNGGA and $GLGGA all share one key.
+         *
+         * @param name Sentence name of 1 to 8 characters
+         * @return Key, 0 if the name is empty or too long
+         */
+        constexpr uint64_t sentence_key(std::string_view name) {
+            if (name.empty() || name.size() > 8) {
+                return 0;
+            }
+            uint64_t key = 0;
+            for (char c : name) {
+                key = (key << 8) | static_cast<uint8_t>(c);
+            }
+            return key;
+        }
+
+        /**
+         * @brief Get the dispatch key of a split sentence
+         * @param sentence Output of split()
+         * @return Key as computed by sentence_key()
+         */
+        constexpr uint64_t sentence_key(const Sentence &sentence) {
+            return sentence_key(sentence.proprietary() ? sentence.address : sentence.type);
+        }
+
+        /**
+         * @brief Sentence name of each struct parse() can fill, used by Dispatcher::on<T>()
+         */
+        template <typename T> struct SentenceName;
+        template <> struct SentenceName<GGA> { static constexpr std::string_view value = "GGA"; };
+        template <> struct SentenceName<RMC> { static constexpr std::string_view value = "RMC"; };
+        template <> struct SentenceName<VTG> { static constexpr std::string_view value = "VTG"; };
+        template <> struct SentenceName<GSA> { static constexpr std::string_view value = "GSA"; };
+        template <> struct SentenceName<PHTG> { static constexpr std::string_view value = "PHTG"; };
+
+        /**
+         * @brief Route sentences to handlers registered per sentence type
+         *
+         * Each line is split once and its type packed into an integer, so finding the handler costs one
+         * integer compare per registered type instead of a string compare per talker variant.
+         * Typed handlers parse into a struct owned by the dispatcher, nothing is allocated per line.
+         *
+         * Handlers must be registered before lines are dispatched, dispatch() itself may only be called
+         * from one thread at a time.
+         */
+        class Dispatcher {
+          public:
+            /**
+             * @brief Handler for a sentence that is not parsed by the dispatcher
+             * @param sentence Split sentence, views are only valid until the handler returns
+             */
+            using Handler = std::function<void(const Sentence &sentence)>;
+
+            /**
+             * @brief Handler for lines that failed to split or parse
+             * @param line The offending line
+             * @param error Reason
+             */
+            using ErrorHandler = std::function<void(std::string_view line, Error error)>;
+
+            Dispatcher() = default;
+
+            /**
+             * @brief Register a handler for a sentence type, replacing any previous one
+             * @param name Type without talker ("GGA") or proprietary address ("PHTG", "PUBX")
+             * @param handler Function to call with the split sentence
+             * @return true if registered, false if the name cannot be used as a key
+             */
+            bool on(std::string_view name, Handler handler);
+
+            /**
+             * @brief Register a handler that receives the parsed struct
+             *
+             * @code
+             * dispatcher.on<nmea::GGA>([](const nmea::GGA &gga) { ... });
+             * @endcode
+             *
+             * @param handler Function to call with the parsed sentence
+             * @return true if registered, false otherwise
+             */
+            template <typename T, typename F>
+                requires std::invocable<F &, const T &>
+            bool on(F handler) {
+                return add(sentence_key(SentenceName<T>::value),
+                           [handler = std::move(handler), value = T{}](const Sentence &sentence) mutable {
+                               Error error = parse(sentence, value);
+                               if (error == Error::None) {
+                                   handler(static_cast<const T &>(value));
+                               }
+                               return error;
+                           });
+            }
+
+            /**
+             * @brief Remove the handler of a sentence type
+             * @param name Name passed to on()
+             */
+            void remove(std::string_view name);
+
+            /**
+             * @brief Set a handler for lines that could not be split or parsed
+             * @param handler Function to call on errors
+             */
+            void on_error(ErrorHandler handler);
+
+            /**
+             * @brief Set a handler for valid sentences without a registered handler
+             * @param handler Function to call with the split sentence
+             */
+            void on_unhandled(Handler handler);
+
+            /**
+             * @brief Split a line and hand it to the handler of its type
+             * @param line Complete sentence, trailing line endings allowed
+             * @return Error::None if a handler accepted the line, Error::Unhandled if none is registered,
+             *         the split or parse error otherwise
+             */
+            Error dispatch(std::string_view line);
+
+            /**
+             * @brief Check whether a handler is registered for a sentence type
+             * @param name Name passed to on()
+             * @return true if registered, false otherwise
+             */
+            bool handles(std::string_view name) const;
+
+          private:
+            using Route = std::function<Error(const Sentence &sentence)>;
+
+            struct Entry {
+                uint64_t key;
+                Route route;
+            };
+
+            bool add(uint64_t key, Route route);
+
+            std::vector<Entry> entries_;
+            ErrorHandler error_handler_;
+            Handler unhandled_handler_;
+        };
+
+    } // namespace nmea
+} // namespace tractor
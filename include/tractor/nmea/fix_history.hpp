@@ -0,0 +1,154 @@
+#pragma once
+
+#include "tractor/detail/seqlock_ring.hpp"
+#include "tractor/nmea/nmea.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace tractor {
+    namespace nmea {
+
+        /**
+         * @brief GNSS fix taken at a point in time
+         */
+        struct Fix {
+            std::chrono::steady_clock::time_point time; // When the fix was received, e.g. FrameInfo::arrival
+            double latitude = 0.0;                      // Decimal degrees, south is negative
+            double longitude = 0.0;                     // Decimal degrees, west is negative
+            double altitude = 0.0;                      // Meters above mean sea level
+            double course_deg = 0.0;                    // Course over ground, degrees true
+            double speed_mps = 0.0;                     // Speed over ground in meters per second
+            double hdop = 0.0;
+            uint8_t fix_quality = 0; // GGA fix quality, 0=invalid, 1=GPS, 2=DGPS, 4=RTK Fixed, 5=RTK Float
+            uint8_t satellites = 0;
+            bool has_course = false;   // course_deg and speed_mps were reported by the receiver
+            bool interpolated = false; // Computed by at() between two fixes
+            bool extrapolated = false; // Computed by at() beyond the newest fix
+            uint8_t reserved[3] = {};  // Spelled out padding, FixHistory copies fixes as whole words
+        };
+
+        // The doubles keep std::has_unique_object_representations from telling, so check the sum instead
+        static_assert(sizeof(Fix) == sizeof(Fix::time) + 6 * sizeof(double) + 2 * sizeof(uint8_t) + 3 * sizeof(bool) +
+                                         sizeof(Fix::reserved),
+                      "Fix must not have padding bytes, they would be copied as indeterminate words");
+
+        /**
+         * @brief Ring of the most recent GNSS fixes, written by one thread and read lock-free by any
+         *
+         * The fixes are kept in a detail::SeqlockRing: readers never block the writer and a fix is
+         * always read as a whole, latitude and longitude come from the same sample. A fix overwritten
+         * while it is read is detected rather than returned as a mix of two.
+         *
+         * latest() is O(1). at() finds the fixes around a timestamp with a binary search over the ring
+         * and interpolates between them, or extrapolates past the newest fix, which lets section
+         * control ask where the antenna was or will be at its own rate.
+         *
+         * The update() calls and push() must only be called from one thread at a time, every other
+         * member is thread-safe.
+         */
+        class FixHistory {
+          public:
+            /**
+             * @brief Constructor
+             * @param capacity Fixes kept, rounded up to a power of two, 64 hold 6.4 s of a 10 Hz receiver
+             */
+            explicit FixHistory(size_t capacity = 64);
+
+            /**
+             * @brief Destructor
+             */
+            ~FixHistory();
+
+            // Delete copy
+            FixHistory(const FixHistory &) = delete;
+            FixHistory &operator=(const FixHistory &) = delete;
+
+            /**
+             * @brief Append a fix
+             * @param fix Fix to store, its time must not be older than the previous one
+             */
+            void push(const Fix &fix) { ring_.push(fix); }
+
+            /**
+             * @brief Append the position of a GGA sentence with the course and speed last seen
+             * @param gga Parsed sentence, ignored without a fix or position
+             * @param time When the sentence was received
+             * @return true if a fix was appended, false otherwise
+             */
+            bool update(const GGA &gga, std::chrono::steady_clock::time_point time);
+
+            /**
+             * @brief Take course and speed from an RMC sentence for the following fixes
+             * @param rmc Parsed sentence, ignored unless active with a course
+             */
+            void update(const RMC &rmc);
+
+            /**
+             * @brief Take course and speed from a VTG sentence for the following fixes
+             * @param vtg Parsed sentence, ignored without a course
+             */
+            void update(const VTG &vtg);
+
+            /**
+             * @brief Read the newest fix
+             * @param fix Receives the fix
+             * @return true if a fix was stored yet, false otherwise
+             */
+            bool latest(Fix &fix) const {
+                for (;;) {
+                    uint64_t head = ring_.head();
+                    if (head == 0) {
+                        return false;
+                    }
+                    // Only fails when the writer wrapped around the whole ring meanwhile
+                    if (ring_.read(head - 1, fix)) {
+                        return true;
+                    }
+                }
+            }
+
+            /**
+             * @brief Estimate the fix at a point in time
+             *
+             * Between two stored fixes position, altitude, course and speed are interpolated linearly,
+             * hdop is the larger and fix quality and satellites are taken from the closer fix. Past the
+             * newest fix the position is carried forward along its course and speed, or along the line
+             * through the two newest fixes when the receiver reported no course.
+             *
+             * @param time Point in time
+             * @param fix Receives the estimate
+             * @param max_extrapolation How far past the newest fix to extrapolate
+             * @return true if estimated, false when time lies before the oldest stored fix or beyond
+             *         max_extrapolation past the newest one
+             */
+            bool at(std::chrono::steady_clock::time_point time, Fix &fix,
+                    std::chrono::steady_clock::duration max_extrapolation = std::chrono::milliseconds(500)) const;
+
+            /**
+             * @brief Number of fixes stored so far, including those overwritten since
+             */
+            uint64_t count() const { return ring_.head(); }
+
+            /**
+             * @brief Maximum number of fixes kept
+             */
+            size_t capacity() const { return ring_.capacity(); }
+
+            /**
+             * @brief Forget every fix, must not run concurrently with readers
+             */
+            void clear();
+
+          private:
+            detail::SeqlockRing<Fix> ring_;
+
+            // Latest course and speed, only touched by the writer
+            double course_deg_ = 0.0;
+            double speed_mps_ = 0.0;
+            bool has_course_ = false;
+        };
+
+    } // namespace nmea
+} // namespace tractor
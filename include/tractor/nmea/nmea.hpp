@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace tractor {
+    namespace nmea {
+
+        /**
+         * @brief Result of parsing an NMEA 0183 sentence
+         */
+        enum class Error : uint8_t {
+            None,
+            Empty,           // Nothing but whitespace or line endings
+            MissingStart,    // Sentence does not start with '$' or '!'
+            MissingChecksum, // No "*hh" field at the end of the sentence
+            BadChecksum,     // Checksum field does not match the sentence
+            BadAddress,      // Talker and sentence type cannot be read
+            WrongType,       // Sentence type does not match the requested struct
+            TooFewFields,    // Sentence ends before a required field
+            BadField,        // A field holds a value that cannot be parsed
+            FieldTooLong,    // A text field does not fit its fixed capacity
+            Unhandled        // No handler is registered for the sentence type (Dispatcher)
+        };
+
+        /**
+         * @brief Get a printable name for a parse result
+         * @param error Parse result
+         * @return Name such as "bad checksum"
+         */
+        const char *error_name(Error error);
+
+        /**
+         * @brief Fixed capacity text field, filled without allocating
+         */
+        template <size_t N> struct FixedString {
+            std::array<char, N> data{};
+            uint8_t length = 0;
+
+            static_assert(N <= 255, "FixedString length is stored in a uint8_t");
+
+            /**
+             * @brief Replace the contents
+             * @param text Text to copy
+             * @return true if the text fit, false (contents unchanged) otherwise
+             */
+            bool assign(std::string_view text) {
+                if (text.size() > N) {
+                    return false;
+                }
+                for (size_t i = 0; i < text.size(); i++) {
+                    data[i] = text[i];
+                }
+                length = static_cast<uint8_t>(text.size());
+                return true;
+            }
+
+            std::string_view view() const { return std::string_view(data.data(), length); }
+            bool empty() const { return length == 0; }
+            bool operator==(std::string_view other) const { return view() == other; }
+        };
+
+        /**
+         * @brief A sentence split into its address and field list
+         *
+         * All views point into the string passed to split() and are only valid as long as it is.
+         */
+        struct Sentence {
+            std::string_view address; // "GPGGA", "PHTG"
+            std::string_view talker;  // "GP", "GN", ... or "P" for proprietary sentences
+            std::string_view type;    // "GGA", or the manufacturer code and type of a proprietary sentence ("HTG")
+            std::string_view fields;  // Everything between the first ',' and the '*'
+
+            constexpr bool proprietary() const { return talker == "P"; }
+        };
+
+        /**
+         * @brief Iterate the comma separated fields of a sentence in place
+         */
+        class FieldReader {
+          public:
+            /**
+             * @brief Constructor
+             * @param fields Field list as found in Sentence::fields
+             */
+            explicit FieldReader(std::string_view fields) : fields_(fields), done_(false) {}
+
+            /**
+             * @brief Get the next field
+             * @param field Receives the field, empty for an empty field
+             * @return true if a field was read, false once the list is exhausted
+             */
+            bool next(std::string_view &field) {
+                if (done_) {
+                    return false;
+                }
+                size_t comma = fields_.find(',');
+                if (comma == std::string_view::npos) {
+                    field = fields_;
+                    done_ = true;
+                } else {
+                    field = fields_.substr(0, comma);
+                    fields_.remove_prefix(comma + 1);
+                }
+                return true;
+            }
+
+          private:
+            std::string_view fields_;
+            bool done_;
+        };
+
+        /**
+         * @brief UTC time of day (hhmmss.ss)
+         */
+        struct Time {
+            uint8_t hour = 0;
+            uint8_t minute = 0;
+            double second = 0.0;
+            bool valid = false; // false if the field was empty
+        };
+
+        /**
+         * @brief Calendar date (ddmmyy)
+         */
+        struct Date {
+            uint8_t day = 0;
+            uint8_t month = 0;
+            uint16_t year = 0; // Four digits, two digit years below 80 are taken as 20xx
+            bool valid = false;
+        };
+
+        /**
+         * @brief GGA - Global positioning system fix data
+         */
+        struct GGA {
+            Time time;
+            double latitude = 0.0;  // Decimal degrees, south is negative
+            double longitude = 0.0; // Decimal degrees, west is negative
+            uint8_t fix_quality = 0; // 0=invalid, 1=GPS, 2=DGPS, 4=RTK Fixed, 5=RTK Float
+            uint8_t satellites = 0;
+            double hdop = 0.0;
+            double altitude = 0.0;         // Meters above mean sea level
+            double geoid_separation = 0.0; // Meters
+            double dgps_age = 0.0;         // Seconds since the last differential correction
+            uint16_t dgps_station = 0;
+            bool has_position = false; // false if the latitude or longitude fields were empty
+        };
+
+        /**
+         * @brief RMC - Recommended minimum specific GNSS data
+         */
+        struct RMC {
+            Time time;
+            bool active = false; // Status 'A', false for 'V' (warning)
+            double latitude = 0.0;
+            double longitude = 0.0;
+            double speed_knots = 0.0;
+            double course_deg = 0.0; // Course over ground, degrees true
+            Date date;
+            double magnetic_variation = 0.0; // Degrees, west is negative
+            char mode = 'N';                 // NMEA 2.3 mode indicator (A, D, E, F, R, N), 'N' if absent
+            bool has_position = false;
+            bool has_course = false;
+        };
+
+        /**
+         * @brief VTG - Course over ground and ground speed
+         */
+        struct VTG {
+            double course_true_deg = 0.0;
+            double course_magnetic_deg = 0.0;
+            double speed_knots = 0.0;
+            double speed_kmh = 0.0;
+            char mode = 'N'; // NMEA 2.3 mode indicator, 'N' if absent
+            bool has_course = false;
+        };
+
+        /**
+         * @brief GSA - GNSS DOP and active satellites
+         */
+        struct GSA {
+            static constexpr size_t MAX_SATELLITES = 12;
+
+            char selection = 'A'; // 'M' manual or 'A' automatic 2D/3D selection
+            uint8_t fix_type = 1; // 1=no fix, 2=2D, 3=3D
+            std::array<uint8_t, MAX_SATELLITES> satellites{};
+            uint8_t satellite_count = 0;
+            double pdop = 0.0;
+            double hdop = 0.0;
+            double vdop = 0.0;
+            uint8_t system_id = 0; // NMEA 4.1 GNSS system id, 0 if absent
+        };
+
+        /**
+         * @brief PHTG - Proprietary GNSS authentication status
+         */
+        struct PHTG {
+            FixedString<16> date;    // DD:MM:YYYY
+            FixedString<16> time;    // HH:MM:SS.SS
+            FixedString<16> system;  // GNSS system
+            FixedString<16> service; // Authentication service (HAS, OSNMA, ...)
+            int32_t auth_result = 0; // 0=fail, 1=pass
+            int32_t warning = 0;
+        };
+
+        /**
+         * @brief Validate a sentence and split it into address and fields
+         *
+         * Requires a leading '$' or '!' and a matching "*hh" checksum, trailing line endings are ignored.
+         * Nothing is copied, the result points into the sentence.
+         *
+         * @param sentence Complete sentence
+         * @param out Receives the address and field views
+         * @return Error::None if successful, the reason otherwise
+         */
+        Error split(std::string_view sentence, Sentence &out);
+
+        /**
+         * @brief Parse a sentence into a preallocated struct
+         *
+         * The overloads taking a string validate and split the sentence first, the ones taking a
+         * Sentence expect the output of split(). GGA, RMC, VTG and GSA accept any talker. Empty numeric
+         * fields are read as 0. On failure the struct may be partially filled.
+         *
+         * @param sentence Sentence to parse
+         * @param out Struct to fill
+         * @return Error::None if successful, the reason otherwise
+         */
+        Error parse(std::string_view sentence, GGA &out);
+        Error parse(std::string_view sentence, RMC &out);
+        Error parse(std::string_view sentence, VTG &out);
+        Error parse(std::string_view sentence, GSA &out);
+        Error parse(std::string_view sentence, PHTG &out);
+
+        Error parse(const Sentence &sentence, GGA &out);
+        Error parse(const Sentence &sentence, RMC &out);
+        Error parse(const Sentence &sentence, VTG &out);
+        Error parse(const Sentence &sentence, GSA &out);
+        Error parse(const Sentence &sentence, PHTG &out);
+
+    } // namespace nmea
+} // namespace tractor
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace tractor {
+
+    /**
+     * @brief Lanes from this value down are reserved for the runtime
+     *
+     * Tractor runs each TC client on lane RESERVED_LANE - client id, application tasks keep to lanes
+     * of 0 and up so they never share a thread with one.
+     */
+    constexpr int RESERVED_LANE = -1;
+
+    /**
+     * @brief When and where a scheduled task runs
+     */
+    struct TaskOptions {
+        std::string name;                    // Shown in errors and statistics
+        std::chrono::microseconds period{0}; // Release interval, 0 runs the task only when posted
+        std::chrono::microseconds offset{0}; // First release after start(), spreads tasks of one period
+        int priority = 0;                    // Higher runs first among the tasks due on a lane
+        int cpu = -1;                        // CPU the task's lane is pinned to, -1 leaves it unpinned
+        int lane = 0;                        // Tasks of another lane on the same CPU get a thread of their own,
+                                             // lanes below 0 are reserved, see RESERVED_LANE
+    };
+
+    /**
+     * @brief Configuration of a scheduler
+     */
+    struct SchedulerOptions {
+        bool realtime = false;      // Run the lanes under SCHED_FIFO, needs CAP_SYS_NICE or an rtprio limit
+        int realtime_priority = 10; // SCHED_FIFO priority of the lanes, 1 to 99
+    };
+
+    /**
+     * @brief Periodic and event-driven tasks on a fixed set of threads
+     *
+     * Tasks sharing a cpu and a lane value form a lane, served by one thread pinned to that CPU. A
+     * lane runs one task at a time, so callbacks of a lane never overlap and need no locking among
+     * each other, while a slow task delays only its own lane. Whenever several tasks of a lane are
+     * due, the one with the highest priority runs first, then the one released earliest, then the
+     * one added first, so the order does not depend on thread timing.
+     *
+     * Periodic tasks are released at absolute times, start plus offset plus a whole number of
+     * periods, so lateness in one cycle does not shift the next. A release that passes while the
+     * task is still running or waiting is skipped and counted as an overrun rather than run late in
+     * a burst. post() releases a task at once from any thread, e.g. a CAN or serial callback, and
+     * several posts before the task runs make one run.
+     *
+     * All members are thread-safe. Callbacks may call any of them except stop().
+     */
+    class Scheduler {
+      public:
+        using TaskId = uint32_t;
+        using Callback = std::function<void()>;
+
+        /**
+         * @brief Run time measurements of a task
+         */
+        struct TaskStatistics {
+            uint64_t runs = 0;                        // Completed runs
+            uint64_t overruns = 0;                    // Releases skipped because the previous one was not done
+            std::chrono::nanoseconds last_latency{0}; // Start of the last run after its release
+            std::chrono::nanoseconds max_latency{0};  // Largest start after release, the jitter bound
+            std::chrono::nanoseconds max_runtime{0};  // Longest callback
+        };
+
+        /**
+         * @brief Constructor
+         * @param options Scheduler options
+         */
+        explicit Scheduler(const SchedulerOptions &options = SchedulerOptions{});
+
+        /**
+         * @brief Destructor - stops the lanes
+         */
+        ~Scheduler();
+
+        // Delete copy
+        Scheduler(const Scheduler &) = delete;
+        Scheduler &operator=(const Scheduler &) = delete;
+
+        /**
+         * @brief Add a task, it is released from now on if the scheduler is running
+         * @param options When and where the task runs
+         * @param callback Work of the task
+         * @return Task id, 0 if the callback is empty
+         */
+        TaskId add(const TaskOptions &options, Callback callback);
+
+        /**
+         * @brief Remove a task, waiting for a run in progress on another thread to finish
+         * @return true if the task existed
+         */
+        bool remove(TaskId id);
+
+        /**
+         * @brief Release a task now, in addition to its periodic releases
+         * @return true if the task exists
+         */
+        bool post(TaskId id);
+
+        /**
+         * @brief Start a thread per lane
+         * @return true if running
+         */
+        bool start();
+
+        /**
+         * @brief Stop the lanes after the callbacks in progress return
+         */
+        void stop();
+
+        /**
+         * @brief Check if the scheduler is running
+         */
+        bool is_running() const;
+
+        /**
+         * @brief Get the number of tasks
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get a snapshot of a task's statistics
+         * @return true if the task exists
+         */
+        bool get_statistics(TaskId id, TaskStatistics &statistics) const;
+
+        /**
+         * @brief Get the last error message, e.g. when a lane could not be pinned or made real-time
+         * @return Error message string
+         */
+        std::string get_last_error() const;
+
+      private:
+        struct Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+} // namespace tractor
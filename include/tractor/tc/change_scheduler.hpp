@@ -0,0 +1,168 @@
+#pragma once
+
+#include "tractor/tc/process_data.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace tractor {
+    namespace tc {
+
+        /**
+         * @brief When a watched value is pushed to the TC
+         *
+         * Mirrors the DDOP trigger methods the client takes care of itself: on change (rate limited
+         * and with a change threshold), time interval and distance interval.
+         */
+        struct TriggerSettings {
+            bool on_change = true;             // Notify when the value changes
+            uint32_t min_interval_ms = 100;    // Changes inside this window are coalesced into one notification
+            uint32_t max_interval_ms = 0;      // Notify at least this often, 0 disables the time trigger
+            uint32_t distance_interval_mm = 0; // Notify every time this distance is travelled, 0 disables
+            uint32_t change_threshold = 1;     // Minimum change from the last notified value
+        };
+
+        /**
+         * @brief Sends a value changed notification, returns false if it could not be sent
+         */
+        using ChangeNotify = std::function<bool(uint16_t element, uint16_t ddi)>;
+
+        /**
+         * @brief Push changed process data to the TC on a timer wheel
+         *
+         * Watches entries of a ProcessDataStore and calls the notify function, usually a wrapper
+         * around TaskControllerClient::on_value_changed_trigger(). A change after a quiet period is
+         * sent right away, further changes inside min_interval_ms are coalesced into one notification
+         * at the end of the window, and a value that flaps back to the last sent one is not sent at all.
+         *
+         * Timers live in a hashed wheel of WHEEL_SIZE buckets of TICK_MS each. Work is event driven,
+         * either from an internal thread (start()) that sleeps until the next timer or store change,
+         * or from the caller's loop (poll()).
+         *
+         * With a store shared by several TC clients, each client's values are watched with its
+         * ClientId and notified through the notify function set for that client.
+         *
+         * The scheduler registers itself as the change listener of the store, so it must outlive the
+         * producers writing to the store. watch() must not be called while the scheduler is running.
+         */
+        class ChangeScheduler {
+          public:
+            static constexpr uint32_t TICK_MS = 10;
+            static constexpr size_t WHEEL_SIZE = 256;
+
+            /**
+             * @brief Constructor
+             * @param store Store to watch
+             */
+            explicit ChangeScheduler(ProcessDataStore &store);
+
+            /**
+             * @brief Destructor, stops the thread and detaches from the store
+             */
+            ~ChangeScheduler();
+
+            // Delete copy
+            ChangeScheduler(const ChangeScheduler &) = delete;
+            ChangeScheduler &operator=(const ChangeScheduler &) = delete;
+
+            /**
+             * @brief Watch a registered value
+             * @param element Element number
+             * @param ddi Data dictionary identifier
+             * @param settings Trigger settings, replaces earlier ones of the same pair
+             * @return true if watched, false if the pair is not registered in the store
+             */
+            bool watch(uint16_t element, uint16_t ddi, const TriggerSettings &settings = TriggerSettings{});
+
+            /**
+             * @brief Watch a registered value of one of the clients sharing the store
+             * @param client Client the value belongs to
+             * @param element Element number
+             * @param ddi Data dictionary identifier
+             * @param settings Trigger settings, replaces earlier ones of the same pair
+             * @return true if watched, false if the pair is not registered for the client
+             */
+            bool watch(ClientId client, uint16_t element, uint16_t ddi,
+                       const TriggerSettings &settings = TriggerSettings{});
+
+            /**
+             * @brief Set the function notifications are sent with
+             *
+             * Must not be called while the scheduler is running.
+             *
+             * @param notify Function to send notifications with
+             */
+            void set_notify(ChangeNotify notify);
+
+            /**
+             * @brief Set the function notifications of one client's values are sent with
+             *
+             * Must not be called while the scheduler is running.
+             *
+             * @param client Client the function belongs to
+             * @param notify Function to send notifications with, usually to the client's own TC client
+             */
+            void set_notify(ClientId client, ChangeNotify notify);
+
+            /**
+             * @brief Update the distance travelled, for the distance trigger
+             * @param odometer_mm Total distance in millimeters, may wrap around
+             */
+            void set_distance(uint32_t odometer_mm);
+
+            /**
+             * @brief Start scheduling from an internal thread
+             * @return true if started, false if already running
+             */
+            bool start();
+
+            /**
+             * @brief Stop the scheduling thread
+             */
+            void stop();
+
+            /**
+             * @brief Check if the scheduling thread is active
+             * @return true if running, false otherwise
+             */
+            bool is_running() const;
+
+            /**
+             * @brief Handle store changes and fire every timer that is due
+             *
+             * For callers driving the scheduler from their own loop instead of start(). Must not be
+             * called concurrently with itself or while the scheduler is running.
+             *
+             * @param now Current time
+             * @return Number of notifications sent
+             */
+            size_t poll(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+            /**
+             * @brief Get statistics
+             */
+            struct Statistics {
+                size_t changes_seen = 0;       // Store changes of watched values
+                size_t notifications_sent = 0; // Notifications sent
+                size_t coalesced = 0;          // Changes merged into a pending notification
+                size_t suppressed = 0;         // Pending notifications dropped below the change threshold
+                size_t send_failures = 0;      // Notifications the notify function rejected
+            };
+
+            /**
+             * @brief Get a snapshot of the statistics
+             */
+            Statistics get_statistics() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+
+            bool watch_handle(ProcessDataStore::Handle handle, ClientId client, uint16_t element, uint16_t ddi,
+                              const TriggerSettings &settings);
+            void scheduler_thread();
+        };
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "tractor/tc/section_boom.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tractor {
+    namespace tc {
+
+        /**
+         * @brief Point in a local east/north/up frame, meters
+         */
+        struct EnuPoint {
+            double east = 0.0;
+            double north = 0.0;
+        };
+
+        /**
+         * @brief Tangent plane projection of WGS84 coordinates around a datum
+         *
+         * Scales latitude and longitude by the meridian and prime vertical radii of curvature at the
+         * datum. Within a few kilometers of the datum, i.e. across any single field, the error stays
+         * in the millimeter range.
+         */
+        class LocalFrame {
+          public:
+            /**
+             * @brief Constructor
+             * @param latitude Datum latitude in decimal degrees
+             * @param longitude Datum longitude in decimal degrees
+             */
+            LocalFrame(double latitude, double longitude);
+
+            /**
+             * @brief Project a position into the frame
+             */
+            EnuPoint to_enu(double latitude, double longitude) const;
+
+            /**
+             * @brief Convert a point of the frame back to latitude and longitude
+             */
+            void to_geodetic(const EnuPoint &point, double &latitude, double &longitude) const;
+
+          private:
+            double latitude_;
+            double longitude_;
+            double meters_per_degree_north_;
+            double meters_per_degree_east_;
+        };
+
+        /**
+         * @brief Position and heading of the machine's reference point, usually the GNSS antenna
+         */
+        struct Pose {
+            EnuPoint position;
+            double heading_deg = 0.0; // Direction of travel, degrees clockwise from north
+        };
+
+        /**
+         * @brief Where a section sits relative to the reference point, as declared in the DDOP
+         */
+        struct SectionGeometry {
+            double x = 0.0;     // Offset of the section along the direction of travel, positive forward
+            double y = 0.0;     // Offset of the section's center across it, positive to the right
+            double width = 0.0; // Working width in meters
+        };
+
+        /**
+         * @brief Configuration of a coverage map
+         */
+        struct CoverageOptions {
+            double cell_size = 0.1;           // Cell edge length in meters
+            size_t max_resident_tiles = 4096; // Tiles kept in memory once page_directory is set, 32 MiB
+            std::string page_directory;       // Where tiles page out to, empty keeps every tile in memory
+        };
+
+        /**
+         * @brief Bitmap of where product was applied, used to switch sections automatically
+         *
+         * The field is split into square cells of CoverageOptions::cell_size and a cell is covered once
+         * the center of the cell lies in the swath of a section that was on. Cells are grouped in tiles
+         * of 256 x 256 cells, one bit each, stored row by row, so a row of a section's swath is a few
+         * 64 bit words in one tile and a query counts 64 cells per popcount. Only tiles that were painted
+         * exist, with an unordered map from tile coordinates to tile.
+         *
+         * With a page directory, tiles beyond max_resident_tiles are written out least recently used
+         * first and read back when touched again. Tiles found in the directory at construction are
+         * part of the map, so coverage carries over from a previous run on the same field and frame.
+         *
+         * plan() turns the coverage ahead of the boom into section setpoints for a SectionBoom. All
+         * members are thread-safe.
+         */
+        class CoverageMap {
+          public:
+            static constexpr size_t TILE_CELLS = 256; // Cells along each edge of a tile
+
+            /**
+             * @brief Constructor
+             * @param options Map options
+             */
+            explicit CoverageMap(const CoverageOptions &options = CoverageOptions{});
+
+            /**
+             * @brief Destructor - writes out tiles that changed when paging is enabled
+             */
+            ~CoverageMap();
+
+            // Delete copy
+            CoverageMap(const CoverageMap &) = delete;
+            CoverageMap &operator=(const CoverageMap &) = delete;
+
+            /**
+             * @brief Set the sections of the boom, section n is bit n of a SectionMask
+             * @param sections Sections from left to right, at most SectionBoom::MAX_SECTIONS
+             */
+            void set_sections(std::vector<SectionGeometry> sections);
+
+            /**
+             * @brief Get the number of sections
+             */
+            size_t size() const;
+
+            /**
+             * @brief Mark the swath of the sections that were on while moving from one pose to the next
+             * @param from Pose at the previous update
+             * @param to Current pose
+             * @param on Sections that were applying product, e.g. SectionBoom::actual_mask()
+             * @return Number of cells that were not covered before
+             */
+            size_t paint(const Pose &from, const Pose &to, const SectionBoom::SectionMask &on);
+
+            /**
+             * @brief Measure the coverage of every section's swath between two poses in one pass
+             * @param from Start of the swath
+             * @param to End of the swath
+             * @param fractions Receives the covered fraction of each section's swath, 0 for an empty swath
+             * @return Number of sections measured, the smaller of size() and fractions.size()
+             */
+            size_t overlap(const Pose &from, const Pose &to, std::span<double> fractions) const;
+
+            /**
+             * @brief Decide which sections should apply product
+             *
+             * A section is turned on unless more than max_overlap of its swath between the pose and
+             * look_ahead meters ahead is covered already. The look-ahead is usually the speed times
+             * the time a section takes to switch, so the boom reacts before reaching covered ground.
+             *
+             * @param pose Current pose
+             * @param look_ahead Meters ahead of the sections to consider, positive
+             * @param max_overlap Covered fraction above which a section turns off
+             * @return Sections to turn on, for SectionBoom::set_setpoint_mask()
+             */
+            SectionBoom::SectionMask plan(const Pose &pose, double look_ahead, double max_overlap = 0.5) const;
+
+            /**
+             * @brief Check whether the cell holding a point is covered
+             */
+            bool covered(const EnuPoint &point) const;
+
+            /**
+             * @brief Get the covered area in square meters
+             */
+            double covered_area() const;
+
+            /**
+             * @brief Get the number of tiles, in memory or paged out
+             */
+            size_t tile_count() const;
+
+            /**
+             * @brief Get the number of tiles held in memory
+             */
+            size_t resident_tiles() const;
+
+            /**
+             * @brief Write every changed tile to the page directory
+             * @return true if written or paging is disabled, false on error
+             */
+            bool flush();
+
+            /**
+             * @brief Forget all coverage, including tiles paged out
+             */
+            void clear();
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+        };
+
+    } // namespace tc
+} // namespace tractor
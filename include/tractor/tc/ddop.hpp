@@ -0,0 +1,412 @@
+#pragma once
+
+#include "tractor/tc/ddop_cache.hpp"
+#include "tractor/tc/process_data.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace tractor {
+    namespace tc {
+
+        /**
+         * @brief Index of no object in a DdopDescription table
+         */
+        constexpr int16_t NO_INDEX = -1;
+
+        constexpr uint16_t NULL_OBJECT_ID = 0xFFFF;
+        constexpr size_t MAX_DESIGNATOR_LENGTH = 32;
+
+        /**
+         * @brief Device element types of ISO 11783-10
+         */
+        enum class ElementType : uint8_t {
+            Device = 1,
+            Function = 2,
+            Bin = 3,
+            Section = 4,
+            Unit = 5,
+            Connector = 6,
+            NavigationReference = 7
+        };
+
+        // Device process data property bits
+        constexpr uint8_t PD_MEMBER_OF_DEFAULT_SET = 0x01;
+        constexpr uint8_t PD_SETTABLE = 0x02;
+        constexpr uint8_t PD_CONTROL_SOURCE = 0x04;
+
+        // Device process data available trigger method bits
+        constexpr uint8_t TRIGGER_TIME_INTERVAL = 0x01;
+        constexpr uint8_t TRIGGER_DISTANCE_INTERVAL = 0x02;
+        constexpr uint8_t TRIGGER_THRESHOLD_LIMITS = 0x04;
+        constexpr uint8_t TRIGGER_ON_CHANGE = 0x08;
+        constexpr uint8_t TRIGGER_TOTAL = 0x10;
+
+        /**
+         * @brief Device object (DVC), the structure label is derived from the structure hash
+         */
+        struct DeviceInfo {
+            std::string_view designator;
+            std::string_view software_version;
+            std::string_view serial_number;
+            std::array<uint8_t, 7> localization = {'e', 'n', 0x50, 0x00, 0x55, 0x55, 0xFF};
+            std::string_view extended_structure_label = {};
+            uint8_t version = 4; // TC version the pool is written for, 4 adds the extended structure label
+        };
+
+        /**
+         * @brief Device element object (DET)
+         */
+        struct ElementInfo {
+            std::string_view designator;
+            ElementType type = ElementType::Function;
+            uint16_t number = 0;       // Element number the TC addresses process data with
+            int16_t parent = NO_INDEX; // Index of the parent element, NO_INDEX for the device element
+        };
+
+        /**
+         * @brief Device process data object (DPD)
+         */
+        struct ProcessDataInfo {
+            int16_t element = 0; // Index of the owning element
+            std::string_view designator;
+            uint16_t ddi = 0;
+            uint8_t properties = 0; // PD_* bits
+            uint8_t triggers = 0;   // TRIGGER_* bits
+            int16_t presentation = NO_INDEX;
+        };
+
+        /**
+         * @brief Device property object (DPT)
+         */
+        struct PropertyInfo {
+            int16_t element = 0; // Index of the owning element
+            std::string_view designator;
+            uint16_t ddi = 0;
+            int32_t value = 0;
+            int16_t presentation = NO_INDEX;
+        };
+
+        /**
+         * @brief Device value presentation object (DVP)
+         */
+        struct PresentationInfo {
+            std::string_view designator;
+            int32_t offset = 0;
+            float scale = 1.0f;
+            uint8_t decimals = 0;
+        };
+
+        /**
+         * @brief Appends objects in their binary ISO 11783-10 form
+         */
+        class DdopWriter {
+          public:
+            explicit DdopWriter(std::vector<uint8_t> &out) : out_(out) {}
+
+            void device(const DeviceInfo &device, uint64_t name, std::string_view structure_label);
+            void element(uint16_t id, const ElementInfo &element, uint16_t parent_id, const uint16_t *children,
+                         size_t child_count);
+            void process_data(uint16_t id, const ProcessDataInfo &process_data, uint16_t presentation_id);
+            void property(uint16_t id, const PropertyInfo &property, uint16_t presentation_id);
+            void presentation(uint16_t id, const PresentationInfo &presentation);
+
+          private:
+            std::vector<uint8_t> &out_;
+
+            void tag(const char *name, uint16_t id);
+            void u8(uint8_t value) { out_.push_back(value); }
+            void u16(uint16_t value);
+            void u32(uint32_t value);
+            void text(std::string_view value);
+        };
+
+        /**
+         * @brief A device descriptor object pool described as a constexpr table
+         *
+         * Objects refer to each other by their index in the tables. Object IDs follow from the table
+         * layout: the device is 0, then come the elements, process data, properties and presentations
+         * in table order. valid() checks the table in a static_assert. layout() derives the child ID
+         * list of every element, the structure hash and the pool size; kept in a constexpr variable
+         * it is built at compile time and serialize() only writes bytes.
+         *
+         * @code
+         * constexpr tractor::tc::DdopDescription<1, 1, 0, 0> SENSOR{
+         *     .device = {"Sensor", "1.0.0", "SN1"},
+         *     .elements = {{{"Sensor", tractor::tc::ElementType::Device, 0}}},
+         *     .process_data = {{{0, "Work State", 141, tractor::tc::PD_MEMBER_OF_DEFAULT_SET,
+         *                        tractor::tc::TRIGGER_ON_CHANGE}}},
+         * };
+         * static_assert(SENSOR.valid());
+         * constexpr auto SENSOR_LAYOUT = SENSOR.layout();
+         * SENSOR.serialize(name, pool, SENSOR_LAYOUT);
+         * @endcode
+         */
+        template <size_t Elements, size_t ProcessData, size_t Properties, size_t Presentations>
+        struct DdopDescription {
+            DeviceInfo device;
+            std::array<ElementInfo, Elements> elements{};
+            std::array<ProcessDataInfo, ProcessData> process_data{};
+            std::array<PropertyInfo, Properties> properties{};
+            std::array<PresentationInfo, Presentations> presentations{};
+
+            static constexpr size_t OBJECT_COUNT = 1 + Elements + ProcessData + Properties + Presentations;
+            static constexpr size_t CHILD_COUNT = ProcessData + Properties; // Every one belongs to one element
+            static_assert(Elements > 0, "A pool needs at least the device element");
+            static_assert(OBJECT_COUNT < NULL_OBJECT_ID, "Too many objects for 16 bit object IDs");
+
+            static constexpr uint16_t DEVICE_ID = 0;
+            static constexpr uint16_t element_id(size_t index) { return static_cast<uint16_t>(1 + index); }
+            static constexpr uint16_t process_data_id(size_t index) {
+                return static_cast<uint16_t>(1 + Elements + index);
+            }
+            static constexpr uint16_t property_id(size_t index) {
+                return static_cast<uint16_t>(1 + Elements + ProcessData + index);
+            }
+            static constexpr uint16_t presentation_id(int16_t index) {
+                return index == NO_INDEX ? NULL_OBJECT_ID
+                                         : static_cast<uint16_t>(1 + Elements + ProcessData + Properties + index);
+            }
+
+            /**
+             * @brief Element number of the element a process data entry belongs to
+             */
+            constexpr uint16_t element_number(const ProcessDataInfo &entry) const {
+                return elements[entry.element].number;
+            }
+
+            /**
+             * @brief Check the table for broken references and duplicates
+             *
+             * There must be exactly one element of type Device, with element number 0 and no parent.
+             *
+             * @return true if the pool is well formed
+             */
+            constexpr bool valid() const {
+                auto designator_ok = [](std::string_view text) {
+                    return !text.empty() && text.size() <= MAX_DESIGNATOR_LENGTH;
+                };
+                auto presentation_ok = [](int16_t index) {
+                    return index == NO_INDEX || (index >= 0 && static_cast<size_t>(index) < Presentations);
+                };
+                auto element_ok = [](int16_t index) { return index >= 0 && static_cast<size_t>(index) < Elements; };
+
+                if (!designator_ok(device.designator) || device.software_version.size() > MAX_DESIGNATOR_LENGTH ||
+                    device.serial_number.size() > MAX_DESIGNATOR_LENGTH) {
+                    return false;
+                }
+                size_t device_elements = 0;
+                for (size_t i = 0; i < Elements; i++) {
+                    const auto &element = elements[i];
+                    if (!designator_ok(element.designator) || element.number > 4095) {
+                        return false;
+                    }
+                    if (element.type == ElementType::Device) {
+                        device_elements++;
+                        if (element.parent != NO_INDEX || element.number != 0) {
+                            return false; // ISO 11783-10 numbers the one device element 0
+                        }
+                    } else if (element.parent < 0 || static_cast<size_t>(element.parent) >= i) {
+                        return false; // Parents come first, which also rules out cycles
+                    }
+                    for (size_t j = 0; j < i; j++) {
+                        if (elements[j].number == element.number) {
+                            return false;
+                        }
+                    }
+                }
+                if (device_elements != 1) {
+                    return false;
+                }
+                for (size_t i = 0; i < ProcessData; i++) {
+                    const auto &entry = process_data[i];
+                    if (!element_ok(entry.element) || !designator_ok(entry.designator) ||
+                        !presentation_ok(entry.presentation)) {
+                        return false;
+                    }
+                    for (size_t j = 0; j < i; j++) {
+                        if (process_data[j].element == entry.element && process_data[j].ddi == entry.ddi) {
+                            return false;
+                        }
+                    }
+                }
+                for (const auto &property : properties) {
+                    if (!element_ok(property.element) || !designator_ok(property.designator) ||
+                        !presentation_ok(property.presentation)) {
+                        return false;
+                    }
+                }
+                for (const auto &presentation : presentations) {
+                    if (!designator_ok(presentation.designator)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * @brief Hash of everything that ends up in the pool except the NAME
+             *
+             * Use as DdopCache key, the structure label in the pool is derived from it.
+             */
+            constexpr uint64_t structure_hash() const {
+                StructureHash hash;
+                hash.add("DDOP").add(uint64_t{1}); // Bump when the serialization changes
+                hash.add(device.designator).add(device.software_version).add(device.serial_number);
+                hash.add(device.extended_structure_label).add(uint64_t{device.version});
+                for (uint8_t byte : device.localization) {
+                    hash.add(uint64_t{byte});
+                }
+                for (const auto &element : elements) {
+                    hash.add(element.designator).add(static_cast<uint64_t>(element.type)).add(uint64_t{element.number});
+                    hash.add(static_cast<uint64_t>(element.parent));
+                }
+                for (const auto &entry : process_data) {
+                    hash.add(static_cast<uint64_t>(entry.element)).add(entry.designator).add(uint64_t{entry.ddi});
+                    hash.add(uint64_t{entry.properties}).add(uint64_t{entry.triggers});
+                    hash.add(static_cast<uint64_t>(entry.presentation));
+                }
+                for (const auto &property : properties) {
+                    hash.add(static_cast<uint64_t>(property.element)).add(property.designator);
+                    hash.add(uint64_t{property.ddi});
+                    hash.add(static_cast<uint64_t>(property.value)).add(static_cast<uint64_t>(property.presentation));
+                }
+                for (const auto &presentation : presentations) {
+                    hash.add(presentation.designator).add(static_cast<uint64_t>(presentation.offset));
+                    hash.add(uint64_t{std::bit_cast<uint32_t>(presentation.scale)});
+                    hash.add(uint64_t{presentation.decimals});
+                }
+                return hash.value();
+            }
+
+            /**
+             * @brief What serialize() derives from the tables, see layout()
+             */
+            struct Layout {
+                std::array<uint16_t, CHILD_COUNT> children{};   // Child IDs of the elements, in element order
+                std::array<size_t, Elements + 1> first_child{}; // Children of element i start here, end at i + 1
+                uint64_t structure_hash = 0;
+                size_t binary_size = 0;
+            };
+
+            /**
+             * @brief Derive the child lists, structure hash and size, constexpr to have them at compile time
+             */
+            constexpr Layout layout() const {
+                Layout result;
+                size_t count = 0;
+                for (size_t i = 0; i < Elements; i++) {
+                    result.first_child[i] = count;
+                    for (size_t j = 0; j < ProcessData; j++) {
+                        if (static_cast<size_t>(process_data[j].element) == i) {
+                            result.children[count++] = process_data_id(j);
+                        }
+                    }
+                    for (size_t j = 0; j < Properties; j++) {
+                        if (static_cast<size_t>(properties[j].element) == i) {
+                            result.children[count++] = property_id(j);
+                        }
+                    }
+                }
+                result.first_child[Elements] = count;
+                result.structure_hash = structure_hash();
+                result.binary_size = binary_size();
+                return result;
+            }
+
+            /**
+             * @brief Size of the binary pool in bytes
+             */
+            constexpr size_t binary_size() const {
+                size_t size = 3 + 2 + 1 + device.designator.size() + 1 + device.software_version.size() + 8 + 1 +
+                              device.serial_number.size() + 7 + 7 + 2 * CHILD_COUNT;
+                if (device.version >= 4) {
+                    size += 1 + device.extended_structure_label.size();
+                }
+                for (size_t i = 0; i < Elements; i++) {
+                    size += 3 + 2 + 1 + 1 + elements[i].designator.size() + 2 + 2 + 2;
+                }
+                for (const auto &entry : process_data) {
+                    size += 3 + 2 + 2 + 1 + 1 + 1 + entry.designator.size() + 2;
+                }
+                for (const auto &property : properties) {
+                    size += 3 + 2 + 2 + 4 + 1 + property.designator.size() + 2;
+                }
+                for (const auto &presentation : presentations) {
+                    size += 3 + 2 + 4 + 4 + 1 + 1 + presentation.designator.size();
+                }
+                return size;
+            }
+
+            /**
+             * @brief Write the binary pool
+             * @param name Full 64 bit NAME of the client
+             * @param out Receives the pool, replacing its contents
+             * @param layout layout() of this description, from a constexpr variable
+             */
+            void serialize(uint64_t name, std::vector<uint8_t> &out, const Layout &layout) const {
+                out.clear();
+                out.reserve(layout.binary_size);
+                DdopWriter writer(out);
+                writer.device(device, name, structure_label(layout.structure_hash));
+
+                for (size_t i = 0; i < Elements; i++) {
+                    uint16_t parent = elements[i].parent == NO_INDEX ? DEVICE_ID : element_id(elements[i].parent);
+                    writer.element(element_id(i), elements[i], parent, layout.children.data() + layout.first_child[i],
+                                   layout.first_child[i + 1] - layout.first_child[i]);
+                }
+                for (size_t i = 0; i < ProcessData; i++) {
+                    writer.process_data(process_data_id(i), process_data[i],
+                                        presentation_id(process_data[i].presentation));
+                }
+                for (size_t i = 0; i < Properties; i++) {
+                    writer.property(property_id(i), properties[i], presentation_id(properties[i].presentation));
+                }
+                for (size_t i = 0; i < Presentations; i++) {
+                    writer.presentation(presentation_id(static_cast<int16_t>(i)), presentations[i]);
+                }
+            }
+
+            /**
+             * @brief Write the binary pool, deriving the layout() on the way
+             * @param name Full 64 bit NAME of the client
+             * @param out Receives the pool, replacing its contents
+             */
+            void serialize(uint64_t name, std::vector<uint8_t> &out) const { serialize(name, out, layout()); }
+
+            /**
+             * @brief Register every process data entry in a store, settable ones as settable
+             * @param store Store to register in
+             * @return true if all entries fit, false otherwise
+             */
+            bool register_process_data(ProcessDataStore &store) const {
+                bool ok = true;
+                for (const auto &entry : process_data) {
+                    ok &= store.add(element_number(entry), entry.ddi, 0, (entry.properties & PD_SETTABLE) != 0) !=
+                          ProcessDataStore::INVALID_HANDLE;
+                }
+                return ok;
+            }
+
+            /**
+             * @brief Register every process data entry as the values of one of the clients sharing a store
+             * @param store Store to register in
+             * @param client Client the pool belongs to
+             * @return true if all entries fit, false otherwise
+             */
+            bool register_process_data(ProcessDataStore &store, ClientId client) const {
+                bool ok = true;
+                for (const auto &entry : process_data) {
+                    bool settable = (entry.properties & PD_SETTABLE) != 0;
+                    ok &= store.add(client, element_number(entry), entry.ddi, 0, settable) !=
+                          ProcessDataStore::INVALID_HANDLE;
+                }
+                return ok;
+            }
+        };
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tractor {
+    namespace tc {
+
+        /**
+         * @brief FNV-1a hash of everything a DDOP builder depends on
+         *
+         * Feed it the inputs that decide the pool's structure (device strings, number of sections,
+         * a layout revision bumped whenever the builder changes), never the built pool itself, so
+         * the cache can be looked up without building.
+         */
+        class StructureHash {
+          public:
+            constexpr StructureHash &add(std::string_view text) {
+                for (char c : text) {
+                    mix(static_cast<uint8_t>(c));
+                }
+                mix(0); // Keeps "ab" + "c" apart from "a" + "bc"
+                return *this;
+            }
+
+            constexpr StructureHash &add(uint64_t number) {
+                for (int i = 0; i < 8; i++) {
+                    mix(static_cast<uint8_t>(number >> (8 * i)));
+                }
+                return *this;
+            }
+
+            constexpr uint64_t value() const { return hash_; }
+
+          private:
+            uint64_t hash_ = 0xCBF29CE484222325ull;
+
+            constexpr void mix(uint8_t byte) {
+                hash_ ^= byte;
+                hash_ *= 0x100000001B3ull;
+            }
+        };
+
+        /**
+         * @brief Derive a 7 character DDOP structure label from a structure hash
+         *
+         * The TC compares structure labels to decide whether its stored copy of a pool is still
+         * valid, so a label derived from the hash changes exactly when the structure does.
+         *
+         * @param structure_hash Hash of the pool's structure
+         * @return Label of 7 characters from [0-9A-V]
+         */
+        std::string structure_label(uint64_t structure_hash);
+
+        /**
+         * @brief On-disk cache of binary ISO 11783-10 device descriptor object pools
+         *
+         * Pools are stored per (structure hash, client NAME) in one file each, with a small header
+         * and a checksum of the payload. load() maps the file read-only, so a cache hit costs an
+         * open and an mmap instead of running the builder. The mapped bytes can go straight to
+         * TaskControllerClient::configure(const uint8_t *, uint32_t, ...), which keeps the pointer,
+         * so the cache must outlive the client.
+         */
+        class DdopCache {
+          public:
+            /**
+             * @brief Constructor
+             * @param directory Directory holding the cache files
+             */
+            explicit DdopCache(std::string directory = ".");
+
+            /**
+             * @brief Destructor, unmaps the loaded pool
+             */
+            ~DdopCache();
+
+            // Delete copy
+            DdopCache(const DdopCache &) = delete;
+            DdopCache &operator=(const DdopCache &) = delete;
+
+            /**
+             * @brief Map a cached pool
+             * @param structure_hash Hash of the pool's structure
+             * @param name Full 64 bit NAME of the client
+             * @return true if a valid pool was found and mapped, false otherwise
+             */
+            bool load(uint64_t structure_hash, uint64_t name);
+
+            /**
+             * @brief Write a pool to the cache and map it
+             *
+             * The file is written next to its final path and renamed, so a power cut never leaves a
+             * partial pool behind. Replaces the mapping of an earlier load().
+             *
+             * @param structure_hash Hash of the pool's structure
+             * @param name Full 64 bit NAME of the client
+             * @param pool Binary pool, as generated by DeviceDescriptorObjectPool::generate_binary_object_pool()
+             * @return true if stored, false otherwise
+             */
+            bool store(uint64_t structure_hash, uint64_t name, const std::vector<uint8_t> &pool);
+
+            /**
+             * @brief Check if a pool is mapped
+             */
+            bool is_loaded() const;
+
+            /**
+             * @brief Get the mapped pool, nullptr if none is loaded
+             */
+            const uint8_t *data() const;
+
+            /**
+             * @brief Get the size of the mapped pool in bytes
+             */
+            uint32_t size() const;
+
+            /**
+             * @brief Unmap the loaded pool
+             */
+            void unload();
+
+            /**
+             * @brief Get the file a pool is cached in
+             */
+            std::string path(uint64_t structure_hash, uint64_t name) const;
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+        };
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tractor {
+    namespace tc {
+
+        /**
+         * @brief Pack an element number and DDI into one lookup key
+         */
+        constexpr uint32_t process_data_key(uint16_t element, uint16_t ddi) {
+            return (static_cast<uint32_t>(element) << 16) | ddi;
+        }
+
+        /**
+         * @brief One of the TC clients sharing a store, Default for a store serving a single client
+         */
+        enum class ClientId : uint8_t { Default = 0 };
+
+        constexpr size_t MAX_CLIENTS = 16;
+
+        /**
+         * @brief Pack a client, an element number and a DDI into one lookup key
+         *
+         * Element numbers are 12 bits (ISO 11783-10 allows up to 4095), the client takes the four
+         * bits above them, so the keys of ClientId::Default are the plain (element, DDI) keys.
+         */
+        constexpr uint32_t process_data_key(ClientId client, uint16_t element, uint16_t ddi) {
+            return (static_cast<uint32_t>(static_cast<uint8_t>(client) & 0x0F) << 28) |
+                   (static_cast<uint32_t>(element & 0x0FFF) << 16) | ddi;
+        }
+
+        /**
+         * @brief Process data values of a Task Controller client, keyed by (element number, DDI)
+         *
+         * Entries are registered once, usually while the DDOP is built, then producers update them
+         * and the TC client reads them without taking a lock. Values live in a flat open addressed
+         * table of 8 byte slots, so a lookup is a hash and usually a single cache line.
+         *
+         * request_value_callback() and value_command_callback() are plain TC client callbacks with
+         * the store as parent pointer, so requests for registered values never reach user code.
+         * Both return false for unknown pairs, callbacks registered after them still see those.
+         *
+         * Every update that changes a value marks its entry, take_changes() hands the marked entries to
+         * a consumer such as the ChangeScheduler, which is woken through the change listener.
+         *
+         * Several TC clients, each with its own DDOP, can share one store: the ClientId overloads keep
+         * their entries apart, and client_request_value_callback() and client_value_command_callback()
+         * take client() as parent pointer, a binding of the store and the client precomputed at
+         * construction. Lookups of one client never wait for another.
+         *
+         * add() and set_change_listener() must not run concurrently with anything else, every other
+         * member is thread-safe.
+         */
+        class ProcessDataStore {
+          public:
+            /**
+             * @brief Position of an entry, stays valid for the lifetime of the store
+             */
+            using Handle = uint32_t;
+
+            static constexpr Handle INVALID_HANDLE = 0xFFFFFFFF;
+
+            /**
+             * @brief Called from the producer's thread when a value changes while no change is pending
+             */
+            using ChangeListener = void (*)(void *parent);
+
+            /**
+             * @brief Constructor
+             * @param capacity Maximum number of entries, the table is sized so it stays at most half full
+             */
+            explicit ProcessDataStore(size_t capacity = 64);
+
+            /**
+             * @brief Destructor
+             */
+            ~ProcessDataStore();
+
+            // Delete copy
+            ProcessDataStore(const ProcessDataStore &) = delete;
+            ProcessDataStore &operator=(const ProcessDataStore &) = delete;
+
+            /**
+             * @brief Register a value
+             * @param element Element number
+             * @param ddi Data dictionary identifier
+             * @param initial Initial value
+             * @param settable Whether the TC may write the value with a value command
+             * @return Handle of the entry, the existing one if the pair was already registered,
+             *         INVALID_HANDLE if the store is full
+             */
+            Handle add(uint16_t element, uint16_t ddi, int32_t initial = 0, bool settable = false);
+
+            /**
+             * @brief Register a value of one of the clients sharing the store
+             * @param client Client the value belongs to
+             * @param element Element number, up to 4095
+             * @param ddi Data dictionary identifier
+             * @param initial Initial value
+             * @param settable Whether the TC may write the value with a value command
+             * @return Handle of the entry, INVALID_HANDLE if the store is full
+             */
+            Handle add(ClientId client, uint16_t element, uint16_t ddi, int32_t initial = 0, bool settable = false);
+
+            /**
+             * @brief Look up an entry
+             * @return Handle of the entry, INVALID_HANDLE if not registered
+             */
+            Handle find(uint16_t element, uint16_t ddi) const;
+
+            /**
+             * @brief Look up an entry of a client
+             * @return Handle of the entry, INVALID_HANDLE if not registered
+             */
+            Handle find(ClientId client, uint16_t element, uint16_t ddi) const;
+
+            /**
+             * @brief Check if a pair is registered
+             */
+            bool contains(uint16_t element, uint16_t ddi) const { return find(element, ddi) != INVALID_HANDLE; }
+
+            /**
+             * @brief Update a value
+             * @param handle Handle returned by add() or find()
+             * @param value New value
+             */
+            void set(Handle handle, int32_t value) {
+                if (slots_[handle].value.exchange(value, std::memory_order_relaxed) != value) {
+                    mark_changed(handle);
+                }
+            }
+
+            /**
+             * @brief Read a value
+             * @param handle Handle returned by add() or find()
+             * @return Current value
+             */
+            int32_t get(Handle handle) const { return slots_[handle].value.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Update a value by key
+             * @return true if the pair is registered, false otherwise
+             */
+            bool set(uint16_t element, uint16_t ddi, int32_t value);
+
+            /**
+             * @brief Read a value by key
+             * @param value Receives the value
+             * @return true if the pair is registered, false otherwise
+             */
+            bool get(uint16_t element, uint16_t ddi, int32_t &value) const;
+
+            /**
+             * @brief Update a value of a client by key
+             * @return true if the pair is registered for the client, false otherwise
+             */
+            bool set(ClientId client, uint16_t element, uint16_t ddi, int32_t value);
+
+            /**
+             * @brief Read a value of a client by key
+             * @param value Receives the value
+             * @return true if the pair is registered for the client, false otherwise
+             */
+            bool get(ClientId client, uint16_t element, uint16_t ddi, int32_t &value) const;
+
+            /**
+             * @brief Parent pointer of the client callbacks, see client()
+             */
+            struct Client {
+                ProcessDataStore *store = nullptr;
+                ClientId id = ClientId::Default;
+            };
+
+            /**
+             * @brief Get the parent pointer to register the client callbacks of a client with
+             * @return Binding of this store and the client, valid for the lifetime of the store
+             */
+            Client *client(ClientId id) { return &clients_[static_cast<uint8_t>(id) % MAX_CLIENTS]; }
+
+            /**
+             * @brief Number of registered entries
+             */
+            size_t size() const { return size_; }
+
+            /**
+             * @brief Maximum number of entries
+             */
+            size_t capacity() const { return capacity_; }
+
+            /**
+             * @brief Set the function called when the first change after take_changes() arrives
+             * @param listener Function to call, nullptr to remove it
+             * @param parent Passed to the listener
+             */
+            void set_change_listener(ChangeListener listener, void *parent);
+
+            /**
+             * @brief Hand every entry changed since the last call to a function
+             * @param fn Called with the Handle of each changed entry
+             * @return Number of changed entries
+             */
+            template <typename F> size_t take_changes(F &&fn) {
+                pending_.store(false);
+                size_t count = 0;
+                for (size_t word = 0; word < dirty_words_; word++) {
+                    uint64_t bits = dirty_[word].exchange(0, std::memory_order_acquire);
+                    while (bits != 0) {
+                        int bit = __builtin_ctzll(bits);
+                        bits &= bits - 1;
+                        fn(static_cast<Handle>(word * 64 + bit));
+                        count++;
+                    }
+                }
+                return count;
+            }
+
+            /**
+             * @brief TC client request value callback, parent must point to the store
+             * @return true if the value was found, false otherwise
+             */
+            static bool request_value_callback(uint16_t element, uint16_t ddi, int32_t &value, void *parent);
+
+            /**
+             * @brief TC client value command callback, parent must point to the store
+             * @return true if the value is registered as settable and was stored, false otherwise
+             */
+            static bool value_command_callback(uint16_t element, uint16_t ddi, int32_t value, void *parent);
+
+            /**
+             * @brief TC client request value callback of one client, parent must come from client()
+             * @return true if the value was found, false otherwise
+             */
+            static bool client_request_value_callback(uint16_t element, uint16_t ddi, int32_t &value, void *parent);
+
+            /**
+             * @brief TC client value command callback of one client, parent must come from client()
+             * @return true if the value is registered as settable for the client and was stored, false otherwise
+             */
+            static bool client_value_command_callback(uint16_t element, uint16_t ddi, int32_t value, void *parent);
+
+          private:
+            static constexpr uint32_t EMPTY_KEY = 0xFFFFFFFF; // DDI 0xFFFF is reserved
+
+            struct Slot {
+                uint32_t key = EMPTY_KEY;
+                std::atomic<int32_t> value{0};
+            };
+
+            std::unique_ptr<Slot[]> slots_;
+            std::unique_ptr<bool[]> settable_;
+            std::array<Client, MAX_CLIENTS> clients_;
+            std::unique_ptr<std::atomic<uint64_t>[]> dirty_;
+            size_t dirty_words_ = 0;
+            std::atomic<bool> pending_{false};
+            ChangeListener listener_ = nullptr;
+            void *listener_parent_ = nullptr;
+            uint32_t mask_ = 0;
+            uint32_t shift_ = 0;
+            size_t size_ = 0;
+            size_t capacity_ = 0;
+
+            uint32_t home(uint32_t key) const { return (key * 0x9E3779B1u) >> shift_; }
+            Handle add_key(uint32_t key, int32_t initial, bool settable);
+            Handle find_key(uint32_t key) const;
+            bool command(Handle handle, int32_t value);
+            void mark_changed(Handle handle);
+        };
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace tractor {
+    namespace tc {
+
+        // First DDIs of the 16 condensed work state groups, group n covers sections 16n+1 to 16n+16
+        constexpr uint16_t DDI_ACTUAL_CONDENSED_WORK_STATE_1_16 = 161;
+        constexpr uint16_t DDI_SETPOINT_CONDENSED_WORK_STATE_1_16 = 290;
+
+        /**
+         * @brief Map a DDI to its condensed work state group
+         * @param ddi Data dictionary identifier
+         * @param setpoint Set to true for a setpoint state, false for an actual state
+         * @param group Receives the group index 0 to 15
+         * @return true if the DDI is a condensed work state, false otherwise
+         */
+        constexpr bool condensed_work_state_group(uint16_t ddi, bool &setpoint, size_t &group) {
+            if (ddi >= DDI_ACTUAL_CONDENSED_WORK_STATE_1_16 && ddi < DDI_ACTUAL_CONDENSED_WORK_STATE_1_16 + 16) {
+                setpoint = false;
+                group = ddi - DDI_ACTUAL_CONDENSED_WORK_STATE_1_16;
+                return true;
+            }
+            if (ddi >= DDI_SETPOINT_CONDENSED_WORK_STATE_1_16 && ddi < DDI_SETPOINT_CONDENSED_WORK_STATE_1_16 + 16) {
+                setpoint = true;
+                group = ddi - DDI_SETPOINT_CONDENSED_WORK_STATE_1_16;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Section states of a boom with up to 256 sections
+         *
+         * States are kept as 2 bits per section in 32 bit words of 16 sections, the exact layout of
+         * the condensed work state process data, so encoding a group is a single load. Sections past
+         * the boom's size read as not installed. The controller sets the setpoint states (usually
+         * from the TC or a coverage engine), the operator's switches set the switch states and the
+         * actual state follows the setpoint in automatic mode and the switches otherwise.
+         *
+         * Every word is updated atomically, so the TC, the coverage engine and the operator panel may
+         * write from different threads and readers never see half an update of a group.
+         */
+        class SectionBoom {
+          public:
+            static constexpr size_t MAX_SECTIONS = 256;
+            static constexpr size_t SECTIONS_PER_GROUP = 16;
+            static constexpr size_t GROUPS = MAX_SECTIONS / SECTIONS_PER_GROUP;
+
+            /**
+             * @brief Two bit section state as used by the condensed work state
+             */
+            enum class State : uint8_t { Off = 0, On = 1, Error = 2, NotInstalled = 3 };
+
+            /**
+             * @brief One bit per section, bit n of word n / 64 is section n
+             */
+            using SectionMask = std::array<uint64_t, MAX_SECTIONS / 64>;
+
+            /**
+             * @brief Constructor, all sections start off in automatic mode
+             * @param sections Number of installed sections, clamped to MAX_SECTIONS
+             */
+            explicit SectionBoom(size_t sections);
+
+            /**
+             * @brief Get the number of installed sections
+             */
+            size_t size() const { return sections_; }
+
+            /**
+             * @brief Select whether the actual state follows the setpoint (automatic) or the switches
+             */
+            void set_auto(bool automatic) { auto_.store(automatic, std::memory_order_relaxed); }
+
+            /**
+             * @brief Check if the boom is in automatic mode
+             */
+            bool is_auto() const { return auto_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Set the setpoint state of one section, ignored past size()
+             */
+            void set_setpoint(size_t section, State state);
+
+            /**
+             * @brief Set the switch state of one section, ignored past size()
+             */
+            void set_switch(size_t section, bool on);
+
+            /**
+             * @brief Get the setpoint state of a section
+             */
+            State setpoint(size_t section) const { return state_of(setpoint_, section); }
+
+            /**
+             * @brief Get the switch state of a section
+             */
+            State switch_state(size_t section) const { return state_of(switch_, section); }
+
+            /**
+             * @brief Get the actual state of a section
+             */
+            State actual(size_t section) const { return state_of(is_auto() ? setpoint_ : switch_, section); }
+
+            /**
+             * @brief Turn setpoint sections on and off from a mask, bits past size() are ignored
+             * @param on Sections to turn on, all others are turned off
+             */
+            void set_setpoint_mask(const SectionMask &on);
+
+            /**
+             * @brief Set the switch states from a mask, bits past size() are ignored
+             * @param on Switches that are on, all others are off
+             */
+            void set_switch_mask(const SectionMask &on);
+
+            /**
+             * @brief Get the sections whose setpoint is on
+             */
+            SectionMask setpoint_mask() const { return mask_of(setpoint_); }
+
+            /**
+             * @brief Get the sections that are actually on
+             */
+            SectionMask actual_mask() const { return mask_of(is_auto() ? setpoint_ : switch_); }
+
+            /**
+             * @brief Count the sections that are actually on
+             */
+            size_t count_on() const;
+
+            /**
+             * @brief Encode a setpoint condensed work state
+             * @param group Group 0 (sections 1-16) to 15 (sections 241-256)
+             * @return Process data value, every section not installed for a group past 15
+             */
+            uint32_t encode_setpoint(size_t group) const {
+                return group < GROUPS ? setpoint_[group].load(std::memory_order_relaxed) : ALL_NOT_INSTALLED;
+            }
+
+            /**
+             * @brief Encode an actual condensed work state
+             * @param group Group 0 (sections 1-16) to 15 (sections 241-256)
+             * @return Process data value, every section not installed for a group past 15
+             */
+            uint32_t encode_actual(size_t group) const {
+                if (group >= GROUPS) {
+                    return ALL_NOT_INSTALLED;
+                }
+                return (is_auto() ? setpoint_ : switch_)[group].load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Apply a setpoint condensed work state commanded by the TC
+             *
+             * Sections outside the boom keep reading as not installed, a "not installed" value for an
+             * installed section leaves its state unchanged.
+             *
+             * @param group Group 0 (sections 1-16) to 15 (sections 241-256)
+             * @param value Process data value
+             */
+            void decode_setpoint(size_t group, uint32_t value);
+
+          private:
+            using Words = std::array<std::atomic<uint32_t>, GROUPS>;
+
+            static constexpr uint32_t ALL_NOT_INSTALLED = 0xFFFFFFFF;
+
+            size_t sections_;
+            std::atomic<bool> auto_{true};
+            Words setpoint_;
+            Words switch_;
+            std::array<uint32_t, GROUPS> not_installed_{}; // 11 for every section past size()
+
+            static State state_of(const Words &words, size_t section);
+            static SectionMask mask_of(const Words &words);
+            void set_section(Words &words, size_t section, State state);
+            void set_mask(Words &words, const SectionMask &on);
+        };
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tractor {
+    namespace tc {
+
+        /**
+         * @brief Position part of a time log record, the PTN element of ISO 11783-10
+         */
+        struct TimeLogPosition {
+            double latitude = 0.0;  // Decimal degrees, stored in units of 1e-7 degrees
+            double longitude = 0.0; // Decimal degrees, stored in units of 1e-7 degrees
+            double altitude = 0.0;  // Meters, stored in millimeters
+            uint8_t status = 0;     // 0=no GPS, 1=GNSS, 2=DGNSS, 3=precise, 4=RTK fixed, 5=RTK float, as GGA
+            double pdop = 0.0;
+            double hdop = 0.0;
+            uint8_t satellites = 0;
+        };
+
+        /**
+         * @brief One process data value of a time log record
+         */
+        struct TimeLogValue {
+            uint8_t column = 0; // Index returned by TimeLogger::add_value()
+            int32_t value = 0;
+        };
+
+        /**
+         * @brief Configuration of a task data logger
+         */
+        struct TimeLogOptions {
+            std::string directory;                   // Receives TASKDATA.XML and the TLGnnnnn.xml/.bin pairs
+            size_t segment_size = 16 * 1024 * 1024;  // Bytes preallocated per binary file, rotates when full
+            std::chrono::seconds rotate_interval{0}; // Start a new file after this long, 0 rotates by size only
+            uint32_t flush_interval_ms = 1000;       // How often written records are synced to the disk
+            std::string task_id = "TSK1";            // Plain text, escaped in TASKDATA.XML
+            std::string task_name = "Task";          // Plain text, escaped in TASKDATA.XML
+            std::string device_xml; // Elements placed before the task, e.g. the DVC of the DDOP, may be empty
+        };
+
+        /**
+         * @brief Continuous ISO 11783-10 task logging into TLG binary time logs and TASKDATA.XML
+         *
+         * Every record holds a time stamp, a position and the values of any of the declared columns,
+         * laid out as described by the TLGnnnnn.xml header written next to each binary file. Records
+         * are encoded on the caller's stack and copied into a preallocated, memory-mapped file, so
+         * log() neither allocates nor makes a system call. A background thread syncs the written
+         * pages every flush_interval_ms, finalizes full or expired files and keeps the next file mapped
+         * and ready, so rotating is a pointer swap on the logging thread. TASKDATA.XML lists every
+         * file of the task and is replaced atomically whenever a file is added.
+         *
+         * After a power loss at most flush_interval_ms of records are lost. start() trims time logs
+         * left behind at their preallocated size to their last complete record and keeps them in the
+         * task, so logging into the same directory again continues the task.
+         *
+         * File numbers are never reused. Once TLG99999 is open the logger stops rotating and sets an
+         * error, records that no longer fit into that file are dropped.
+         *
+         * add_value() must be called before start(). log() must only be called from one thread at a
+         * time and not while stop() runs, every other member is thread-safe.
+         */
+        class TimeLogger {
+          public:
+            /**
+             * @brief Constructor
+             * @param options Logger options
+             */
+            explicit TimeLogger(const TimeLogOptions &options);
+
+            /**
+             * @brief Destructor - stops the logger
+             */
+            ~TimeLogger();
+
+            // Delete copy
+            TimeLogger(const TimeLogger &) = delete;
+            TimeLogger &operator=(const TimeLogger &) = delete;
+
+            /**
+             * @brief Declare a logged value, a DLV of the time log header
+             * @param ddi Data dictionary identifier
+             * @param device_element ISOXML id of the device element, e.g. "DET-1"
+             * @return Column index for TimeLogValue, -1 once started or with 255 columns declared
+             */
+            int add_value(uint16_t ddi, const std::string &device_element);
+
+            /**
+             * @brief Open the first time log and start the flusher thread
+             * @return true if logging, false otherwise
+             */
+            bool start();
+
+            /**
+             * @brief Finalize the current time log, mark the task completed and stop the flusher thread
+             */
+            void stop();
+
+            /**
+             * @brief Check if the logger is running
+             */
+            bool is_running() const;
+
+            /**
+             * @brief Append a record with some of the columns
+             * @param time Time of the record
+             * @param position Position of the record
+             * @param values Columns and their values, at most 255
+             * @return true if stored, false if not running or no file had room
+             */
+            bool log(std::chrono::system_clock::time_point time, const TimeLogPosition &position,
+                     std::span<const TimeLogValue> values);
+
+            /**
+             * @brief Append a record with every column
+             * @param time Time of the record
+             * @param position Position of the record
+             * @param values One value per declared column, in add_value() order
+             * @return true if stored, false if not running or no file had room
+             */
+            bool log(std::chrono::system_clock::time_point time, const TimeLogPosition &position,
+                     std::span<const int32_t> values);
+
+            /**
+             * @brief Get statistics
+             */
+            struct Statistics {
+                size_t records = 0;         // Records stored since start()
+                size_t records_dropped = 0; // Records that found no file with room
+                size_t bytes_written = 0;   // Record bytes stored since start()
+                size_t files = 0;           // Time logs of the task, including earlier runs
+            };
+
+            /**
+             * @brief Get a snapshot of the statistics
+             */
+            Statistics get_statistics() const;
+
+            /**
+             * @brief Get the names of the task's time logs, e.g. "TLG00001", oldest first
+             */
+            std::vector<std::string> get_files() const;
+
+            /**
+             * @brief Get the last error message
+             * @return Error message string
+             */
+            std::string get_last_error() const;
+
+          private:
+            struct Impl;
+            std::unique_ptr<Impl> pimpl_;
+
+            void flusher_thread();
+        };
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace tractor {
+    namespace trace {
+
+        /**
+         * @brief Kind of a recorded event, one of the phases of the Chrome trace event format
+         */
+        enum class EventType : uint8_t {
+            Complete,  // A scope with its duration, "X"
+            Instant,   // A point in time, "i"
+            Counter,   // A sampled value, "C"
+            FlowBegin, // Start of an arrow to a later event, possibly on another thread, "s"
+            FlowEnd,   // End of the arrow with the same category, name and id, "f"
+        };
+
+        namespace detail {
+            extern std::atomic<bool> enabled;
+        } // namespace detail
+
+        /**
+         * @brief Check if events are being recorded, true unless set_enabled(false) was called
+         */
+        inline bool is_enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Pause or resume recording, events recorded so far are kept
+         */
+        void set_enabled(bool enabled);
+
+        /**
+         * @brief Get the timestamp events are recorded with, nanoseconds of the steady clock
+         */
+        inline uint64_t now() {
+            auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+        }
+
+        /**
+         * @brief Append an event to the ring buffer of the calling thread
+         *
+         * The first event of a thread allocates its buffer, every later one is a handful of relaxed
+         * stores into it without locks or allocations. A full buffer overwrites its oldest events.
+         * Use the TRACTOR_TRACE_* macros rather than calling this directly.
+         *
+         * @param type Kind of event
+         * @param category Group of the event, must outlive the trace, normally a string literal
+         * @param name Name of the event, must outlive the trace, normally a string literal
+         * @param start Timestamp from now()
+         * @param duration Nanoseconds, Complete events only
+         * @param value Argument of the event, the id of a flow or the sample of a counter
+         */
+        void record(EventType type, const char *category, const char *name, uint64_t start, uint64_t duration,
+                    uint64_t value);
+
+        /**
+         * @brief Record an event timestamped now, unless recording is paused
+         */
+        inline void emit(EventType type, const char *category, const char *name, uint64_t value) {
+            if (is_enabled()) {
+                record(type, category, name, now(), 0, value);
+            }
+        }
+
+        /**
+         * @brief Make the id of a flow unique across objects, e.g. the sequence of a queued item and its queue
+         */
+        inline uint64_t flow_id(const void *owner, uint64_t sequence) {
+            return (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(owner)) << 16) ^ sequence;
+        }
+
+        /**
+         * @brief Records a Complete event for its lifetime, see TRACTOR_TRACE_SCOPE
+         */
+        class Scope {
+          public:
+            Scope(const char *category, const char *name)
+                : category_(category), name_(name), start_(is_enabled() ? now() : 0) {}
+            ~Scope() {
+                if (start_ != 0) {
+                    record(EventType::Complete, category_, name_, start_, now() - start_, value_);
+                }
+            }
+
+            // Delete copy
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+            void set_value(uint64_t value) { value_ = value; }
+
+          private:
+            const char *category_;
+            const char *name_;
+            uint64_t start_;
+            uint64_t value_ = 0;
+        };
+
+        /**
+         * @brief Set the number of events each thread keeps, for threads recording their first event afterwards
+         * @param events Rounded up to a power of two, default 8192
+         */
+        void set_buffer_size(size_t events);
+
+        /**
+         * @brief Recording statistics
+         */
+        struct Statistics {
+            size_t threads = 0;       // Buffers kept, of running and of exited threads
+            uint64_t recorded = 0;    // Events recorded since the last clear()
+            uint64_t overwritten = 0; // Of those, events lost to a full buffer
+        };
+
+        /**
+         * @brief Get a snapshot of the statistics
+         */
+        Statistics get_statistics();
+
+        /**
+         * @brief Drop every event recorded so far, and the buffers of exited threads
+         */
+        void clear();
+
+        /**
+         * @brief Write the recorded events in the Chrome trace event JSON format
+         *
+         * The output opens in chrome://tracing and ui.perfetto.dev. Threads keep recording while it
+         * is written, events they overwrite meanwhile are left out.
+         *
+         * @param out Stream to write to
+         * @return true if the stream is good afterwards
+         */
+        bool write_chrome_trace(std::ostream &out);
+
+        /**
+         * @brief Write the recorded events in the Chrome trace event JSON format to a file
+         * @param path File to create or replace
+         * @return true if written, false otherwise
+         */
+        bool write_chrome_trace(const std::string &path);
+
+    } // namespace trace
+} // namespace tractor
+
+/**
+ * Tracepoints, compiled in with TRACTOR_TRACE defined (the TRACTOR_TRACE option of the build) and
+ * to nothing otherwise, the arguments are then not evaluated. Categories and names must be string
+ * literals.
+ *
+ * TRACTOR_TRACE_SCOPE(category, name)          Complete event from here to the end of the block
+ * TRACTOR_TRACE_VALUE(value)                   Argument of the scope of the current block
+ * TRACTOR_TRACE_INSTANT(category, name, value) Instant event with an argument
+ * TRACTOR_TRACE_COUNTER(category, name, value) Counter sample
+ * TRACTOR_TRACE_FLOW_BEGIN(category, name, id) Start of an arrow, bound to the enclosing scope
+ * TRACTOR_TRACE_FLOW_END(category, name, id)   End of the arrow, bound to the enclosing scope
+ */
+#ifdef TRACTOR_TRACE
+#define TRACTOR_TRACE_SCOPE(category, name) ::tractor::trace::Scope tractor_trace_scope(category, name)
+#define TRACTOR_TRACE_VALUE(value) tractor_trace_scope.set_value(static_cast<uint64_t>(value))
+#define TRACTOR_TRACE_EVENT(type, category, name, value)                                                              \
+    ::tractor::trace::emit(::tractor::trace::EventType::type, category, name, static_cast<uint64_t>(value))
+#define TRACTOR_TRACE_INSTANT(category, name, value) TRACTOR_TRACE_EVENT(Instant, category, name, value)
+#define TRACTOR_TRACE_COUNTER(category, name, value) TRACTOR_TRACE_EVENT(Counter, category, name, value)
+#define TRACTOR_TRACE_FLOW_BEGIN(category, name, id) TRACTOR_TRACE_EVENT(FlowBegin, category, name, id)
+#define TRACTOR_TRACE_FLOW_END(category, name, id) TRACTOR_TRACE_EVENT(FlowEnd, category, name, id)
+#else
+#define TRACTOR_TRACE_SCOPE(category, name) static_cast<void>(0)
+#define TRACTOR_TRACE_VALUE(value) static_cast<void>(0)
+#define TRACTOR_TRACE_INSTANT(category, name, value) static_cast<void>(0)
+#define TRACTOR_TRACE_COUNTER(category, name, value) static_cast<void>(0)
+#define TRACTOR_TRACE_FLOW_BEGIN(category, name, id) static_cast<void>(0)
+#define TRACTOR_TRACE_FLOW_END(category, name, id) static_cast<void>(0)
+#endif
@@ -1,15 +1,213 @@
 #pragma once
 
+#include "tractor/can/socketcan.hpp"
+#include "tractor/comms/reactor.hpp"
+#include "tractor/scheduler.hpp"
+#include "tractor/tc/change_scheduler.hpp"
+#include "tractor/tc/process_data.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 
+namespace isobus {
+    class InternalControlFunction;
+    class PartneredControlFunction;
+    class TaskControllerClient;
+} // namespace isobus
+
 namespace tractor {
 
+    /**
+     * @brief Configuration of the application runtime
+     */
+    struct TractorOptions {
+        can::SocketCanOptions can;               // CAN channel 0, an empty interface runs without CAN and NAME
+        uint32_t can_settle_ms = 250;            // Wait after the CAN interface starts, before address claiming
+        uint64_t name = 0;                       // ISO NAME to claim, isobus::NAME::get_full_name(), 0 claims none
+        bool task_controller = true;             // Partner with a task controller and create a TC client
+        uint8_t tc_instance = 0;                 // Function instance of the task controller to partner with
+        std::chrono::milliseconds tc_update{10}; // Period of the TC client task on the scheduler
+        int tc_cpu = -1;                         // CPU the TC client's lane is pinned to, -1 leaves it unpinned
+        comms::ReactorOptions reactor;           // Serial ports added through reactor()
+        SchedulerOptions scheduler;              // Lanes of the components' tasks
+        bool handle_signals = true;              // run() returns on SIGINT and SIGTERM
+        size_t process_data_capacity = 256;      // Entries of the process data store shared by all TC clients
+    };
+
+    /**
+     * @brief An implement hosted by the runtime, with a NAME, a DDOP and a TC client of its own
+     *
+     * The booms to section_control fields are the capabilities reported to the task controller,
+     * see TaskControllerClient::configure().
+     */
+    struct TcClientOptions {
+        uint64_t name = 0;                    // ISO NAME to claim, isobus::NAME::get_full_name()
+        uint8_t tc_instance = 0;              // Function instance of the task controller to partner with
+        const uint8_t *ddop = nullptr;        // Binary pool, e.g. from a DdopCache, must outlive the runtime
+        uint32_t ddop_size = 0;               // Bytes of the pool
+        uint8_t booms = 1;                    // Booms supported
+        uint8_t sections = 1;                 // Sections supported
+        uint8_t position_channels = 1;        // Channels supported for position based control
+        bool documentation = true;            // Supports documentation
+        bool tcgeo_without_position = false;  // Supports TC-GEO without position based control
+        bool tcgeo_with_position = true;      // Supports TC-GEO with position based control
+        bool peer_control = false;            // Supports peer control assignment
+        bool section_control = true;          // Supports implement section control
+        std::chrono::milliseconds update{10}; // Period of the client's task on the scheduler
+        int cpu = -1;                         // CPU the client's lane is pinned to, -1 leaves it unpinned
+    };
+
+    /**
+     * @brief Application core owning the CAN interface, the TC client, the serial reactor and the scheduler
+     *
+     * start() brings up CAN channel 0 with a BatchedSocketCan, claims options.name, partners with
+     * the task controller and creates the TC client, then starts the serial reactor and the
+     * scheduler. stop() takes them down in the reverse order. Components register their cyclic and
+     * event-driven work on scheduler() and their serial ports on reactor(), so an application is
+     * start(), configuring the components and run(). With an empty options.can.interface only the
+     * reactor and the scheduler run, e.g. for serial-only tools and tests.
+     *
+     * The TC client is driven by a task of the scheduler rather than a thread of its own: configure
+     * it and call initialize(false) on it, its update() then runs every options.tc_update on a lane
+     * reserved for it, see RESERVED_LANE.
+     *
+     * Further implements share the runtime through add_tc_client(), each with its own NAME and DDOP
+     * but one CAN stack, one process_data() store and one change_scheduler() between them.
+     */
     class Tractor {
       public:
-        Tractor() = default;
-        ~Tractor() = default;
+        /**
+         * @brief Constructor with the default options
+         */
+        Tractor();
+
+        /**
+         * @brief Constructor
+         * @param options Runtime options
+         */
+        explicit Tractor(const TractorOptions &options);
+
+        /**
+         * @brief Destructor - stops the runtime
+         */
+        ~Tractor();
+
+        // Delete copy
+        Tractor(const Tractor &) = delete;
+        Tractor &operator=(const Tractor &) = delete;
 
         std::string version() const;
+
+        /**
+         * @brief Start CAN, the control functions, the serial reactor and the scheduler
+         * @return true if running, false otherwise, see get_last_error()
+         */
+        bool start();
+
+        /**
+         * @brief Stop everything started by start(), the TC client is terminated
+         */
+        void stop();
+
+        /**
+         * @brief Check if the runtime is running
+         */
+        bool is_running() const;
+
+        /**
+         * @brief Start unless running, block until request_stop() or a signal, then stop
+         * @return 0 after a clean shutdown, -1 if start() failed
+         */
+        int run();
+
+        /**
+         * @brief Make run() return, async-signal-safe
+         */
+        void request_stop();
+
+        /**
+         * @brief Host another implement, before start()
+         *
+         * start() claims options.name, partners with the task controller and creates, configures and
+         * initializes a TC client with options.ddop. Its request value and value command callbacks
+         * answer from process_data() under the returned id, and the changes watched with that id in
+         * change_scheduler() are sent to it, e.g. after DDOP.register_process_data(process_data(), id).
+         * Every hosted client's update() runs on a scheduler lane of its own, RESERVED_LANE - id on
+         * options.cpu, so a burst of requests on one client does not delay another.
+         *
+         * @param options Client options
+         * @return Id of the client, ClientId::Default if running, the pool is missing or all
+         *         tc::MAX_CLIENTS - 1 ids are taken
+         */
+        tc::ClientId add_tc_client(const TcClientOptions &options);
+
+        /**
+         * @brief Get the process data store of the TC clients
+         *
+         * Values of the options.name client use ClientId::Default, register them with
+         * ProcessDataStore::request_value_callback() where they are not answered by the application.
+         */
+        tc::ProcessDataStore &process_data();
+
+        /**
+         * @brief Get the change scheduler of the process data store, running while hosted clients are
+         *
+         * Watch values before start(), the scheduler must not be running when they are added.
+         */
+        tc::ChangeScheduler &change_scheduler();
+
+        /**
+         * @brief Get the scheduler components register their tasks on
+         */
+        Scheduler &scheduler();
+
+        /**
+         * @brief Get the serial reactor components add their ports to
+         */
+        comms::SerialReactor &reactor();
+
+        /**
+         * @brief Get the CAN driver of channel 0, null before start()
+         */
+        std::shared_ptr<can::BatchedSocketCan> get_can_interface() const;
+
+        /**
+         * @brief Get the control function claiming options.name, null before start() or without a NAME
+         */
+        std::shared_ptr<isobus::InternalControlFunction> get_control_function() const;
+
+        /**
+         * @brief Get the partnered task controller, null without a TC client
+         */
+        std::shared_ptr<isobus::PartneredControlFunction> get_task_controller() const;
+
+        /**
+         * @brief Get the TC client, null before start(), without a NAME or with task_controller off
+         */
+        std::shared_ptr<isobus::TaskControllerClient> get_tc_client() const;
+
+        /**
+         * @brief Get a TC client, ClientId::Default for the options.name one
+         * @return The client, null before start() or for an unknown id
+         */
+        std::shared_ptr<isobus::TaskControllerClient> get_tc_client(tc::ClientId client) const;
+
+        /**
+         * @brief Get the control function of a TC client, ClientId::Default for the options.name one
+         * @return The control function, null before start() or for an unknown id
+         */
+        std::shared_ptr<isobus::InternalControlFunction> get_control_function(tc::ClientId client) const;
+
+        /**
+         * @brief Get the last error message
+         * @return Error message string
+         */
+        std::string get_last_error() const;
+
+      private:
+        struct Impl;
+        std::unique_ptr<Impl> pimpl_;
     };
 
 } // namespace tractor
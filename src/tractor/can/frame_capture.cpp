@@ -0,0 +1,57 @@
+#include "tractor/can/frame_capture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace tractor {
+    namespace can {
+
+        namespace {
+            constexpr uint8_t FLAG_EXTENDED = 0x01;
+        } // namespace
+
+        bool capture_frame(comms::CaptureWriter &capture, const isobus::CANMessageFrame &frame,
+                           std::chrono::steady_clock::time_point time) {
+            std::array<uint8_t, CAPTURED_FRAME_SIZE> payload;
+            std::memcpy(payload.data(), &frame.identifier, sizeof(frame.identifier));
+            payload[4] = frame.isExtendedFrame ? FLAG_EXTENDED : 0;
+            payload[5] = std::min<uint8_t>(frame.dataLength, 8);
+            std::memcpy(payload.data() + 6, frame.data, 8);
+            return capture.append(comms::CaptureKind::CanFrame, frame.channel, payload, time);
+        }
+
+        bool decode_frame(const comms::CaptureRecord &record, isobus::CANMessageFrame &frame) {
+            if (record.kind != comms::CaptureKind::CanFrame || record.data.size() != CAPTURED_FRAME_SIZE) {
+                return false;
+            }
+
+            const uint8_t *payload = record.data.data();
+            std::memcpy(&frame.identifier, payload, sizeof(frame.identifier));
+            frame.isExtendedFrame = (payload[4] & FLAG_EXTENDED) != 0;
+            frame.dataLength = std::min<uint8_t>(payload[5], 8);
+            std::memcpy(frame.data, payload + 6, 8);
+            frame.channel = static_cast<uint8_t>(record.channel);
+            frame.timestamp_us = record.timestamp_ns / 1000;
+            return true;
+        }
+
+        size_t replay_frames(comms::CaptureReader &reader, const FrameHandler &handler,
+                             const comms::ReplayOptions &options) {
+            comms::ReplayOptions frames = options;
+            frames.kind = comms::CaptureKind::CanFrame;
+
+            size_t replayed = 0;
+            isobus::CANMessageFrame frame;
+            reader.replay(frames, [&](const comms::CaptureRecord &record) {
+                if (decode_frame(record, frame)) {
+                    handler(frame);
+                    replayed++;
+                }
+                return true;
+            });
+            return replayed;
+        }
+
+    } // namespace can
+} // namespace tractor
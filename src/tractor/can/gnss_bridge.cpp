@@ -0,0 +1,303 @@
+#include "tractor/can/gnss_bridge.hpp"
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace tractor {
+    namespace can {
+
+        namespace {
+
+            using Clock = std::chrono::steady_clock;
+
+            constexpr double KNOTS_TO_MPS = 1852.0 / 3600.0;
+
+            // Days since 1970-01-01 of a civil date (proleptic Gregorian calendar)
+            uint16_t days_since_1970(const nmea::Date &date) {
+                int y = date.year - (date.month <= 2 ? 1 : 0);
+                int era = (y >= 0 ? y : y - 399) / 400;
+                int yoe = y - era * 400;
+                int mp = date.month > 2 ? date.month - 3 : date.month + 9;
+                int doy = (153 * mp + 2) / 5 + date.day - 1;
+                int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+                int days = era * 146097 + doe - 719468;
+                return days < 0 || days > 0xFFFD ? 0xFFFF : static_cast<uint16_t>(days);
+            }
+
+            uint32_t seconds_since_midnight(const nmea::Time &time) {
+                double seconds = time.hour * 3600.0 + time.minute * 60.0 + time.second;
+                return static_cast<uint32_t>(seconds * 10000.0 + 0.5);
+            }
+
+        } // namespace
+
+        struct GnssBridge::Impl {
+            GnssBridgeConfig config;
+            FrameSink sink = isobus::CANHardwareInterface::transmit_can_frame;
+
+            // Merged fix, written by update() and read by poll()
+            mutable std::mutex fix_mutex;
+            GnssPosition position;
+            bool has_position = false;
+            Clock::time_point position_time;
+            double course_deg = -1.0;
+            double speed_mps = -1.0;
+            Clock::time_point motion_time;
+            uint8_t next_sid = 0;
+            uint32_t sid_time = 0xFFFFFFFF;
+
+            // Sending state, only touched by the thread that polls
+            Clock::time_point next_rapid;
+            Clock::time_point next_position;
+            uint8_t fast_packet_sequence = 0;
+            isobus::CANMessageFrame frame;
+            std::array<uint8_t, GNSS_POSITION_MAX_SIZE> gnss_buffer{};
+            std::array<FramePayload, FAST_PACKET_MAX_FRAMES> fast_packet{};
+
+            std::thread thread;
+            std::atomic<bool> running{false};
+            std::mutex wake_mutex;
+            std::condition_variable wake;
+
+            std::atomic<size_t> position_rapid_sent{0};
+            std::atomic<size_t> cog_sog_sent{0};
+            std::atomic<size_t> gnss_position_sent{0};
+            std::atomic<size_t> frames_sent{0};
+            std::atomic<size_t> send_failures{0};
+
+            explicit Impl(const GnssBridgeConfig &cfg) : config(cfg) {
+                position.gnss_type = cfg.gnss_type;
+                frame.channel = cfg.channel;
+                frame.isExtendedFrame = true;
+                frame.dataLength = 8;
+            }
+
+            bool fresh(Clock::time_point stamp, Clock::time_point now) const {
+                return now - stamp <= std::chrono::milliseconds(config.fix_timeout_ms);
+            }
+
+            // GGA and RMC of one epoch share a time stamp, only a new epoch starts a new SID so all PGNs
+            // sent for it are linked
+            void new_position(Clock::time_point now) {
+                if (!has_position || position.seconds_since_midnight_x10000 != sid_time ||
+                    sid_time == 0xFFFFFFFF) {
+                    position.sid = next_sid;
+                    next_sid = static_cast<uint8_t>((next_sid + 1) % 253);
+                    sid_time = position.seconds_since_midnight_x10000;
+                }
+                position_time = now;
+                has_position = true;
+            }
+        };
+
+        GnssBridge::GnssBridge(const GnssBridgeConfig &config) : pimpl_(std::make_unique<Impl>(config)) {}
+
+        GnssBridge::~GnssBridge() { stop(); }
+
+        void GnssBridge::update(const nmea::GGA &gga) {
+            if (gga.fix_quality == 0 || !gga.has_position) {
+                return;
+            }
+            auto now = Clock::now();
+            std::lock_guard<std::mutex> lock(pimpl_->fix_mutex);
+            GnssPosition &position = pimpl_->position;
+            if (gga.time.valid) {
+                position.seconds_since_midnight_x10000 = seconds_since_midnight(gga.time);
+            }
+            position.latitude = gga.latitude;
+            position.longitude = gga.longitude;
+            position.altitude = gga.altitude;
+            position.method = gga.fix_quality;
+            position.satellites = gga.satellites;
+            position.hdop = gga.hdop;
+            position.geoid_separation = gga.geoid_separation;
+            position.has_reference_station = gga.dgps_age > 0.0;
+            position.reference_station_id = gga.dgps_station;
+            position.reference_station_age = gga.dgps_age;
+            pimpl_->new_position(now);
+        }
+
+        void GnssBridge::update(const nmea::RMC &rmc) {
+            if (!rmc.active) {
+                return;
+            }
+            auto now = Clock::now();
+            std::lock_guard<std::mutex> lock(pimpl_->fix_mutex);
+            GnssPosition &position = pimpl_->position;
+            if (rmc.date.valid) {
+                position.days_since_1970 = days_since_1970(rmc.date);
+            }
+            if (rmc.has_course) {
+                pimpl_->course_deg = rmc.course_deg;
+                pimpl_->speed_mps = rmc.speed_knots * KNOTS_TO_MPS;
+                pimpl_->motion_time = now;
+            }
+            if (!rmc.has_position) {
+                return;
+            }
+            if (rmc.time.valid) {
+                position.seconds_since_midnight_x10000 = seconds_since_midnight(rmc.time);
+            }
+            position.latitude = rmc.latitude;
+            position.longitude = rmc.longitude;
+            if (position.method == 0) {
+                position.method = 1; // RMC carries no quality, assume a plain GNSS fix until GGA tells otherwise
+            }
+            pimpl_->new_position(now);
+        }
+
+        void GnssBridge::update(const nmea::VTG &vtg) {
+            if (!vtg.has_course) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(pimpl_->fix_mutex);
+            pimpl_->course_deg = vtg.course_true_deg;
+            pimpl_->speed_mps = vtg.speed_kmh > 0.0 ? vtg.speed_kmh / 3.6 : vtg.speed_knots * KNOTS_TO_MPS;
+            pimpl_->motion_time = Clock::now();
+        }
+
+        void GnssBridge::update(const nmea::GSA &gsa) {
+            std::lock_guard<std::mutex> lock(pimpl_->fix_mutex);
+            pimpl_->position.pdop = gsa.fix_type > 1 ? gsa.pdop : -1.0;
+        }
+
+        void GnssBridge::set_sink(FrameSink sink) { pimpl_->sink = std::move(sink); }
+
+        bool GnssBridge::start() {
+            if (pimpl_->running) {
+                return false;
+            }
+            pimpl_->running = true;
+            pimpl_->thread = std::thread(&GnssBridge::sender_thread, this);
+            return true;
+        }
+
+        void GnssBridge::stop() {
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->wake_mutex);
+                pimpl_->running = false;
+            }
+            pimpl_->wake.notify_all();
+            if (pimpl_->thread.joinable()) {
+                pimpl_->thread.join();
+            }
+        }
+
+        bool GnssBridge::is_running() const { return pimpl_->running; }
+
+        bool GnssBridge::has_fix() const {
+            std::lock_guard<std::mutex> lock(pimpl_->fix_mutex);
+            return pimpl_->has_position && pimpl_->fresh(pimpl_->position_time, Clock::now());
+        }
+
+        GnssBridge::Statistics GnssBridge::get_statistics() const {
+            Statistics stats;
+            stats.position_rapid_sent = pimpl_->position_rapid_sent.load(std::memory_order_relaxed);
+            stats.cog_sog_sent = pimpl_->cog_sog_sent.load(std::memory_order_relaxed);
+            stats.gnss_position_sent = pimpl_->gnss_position_sent.load(std::memory_order_relaxed);
+            stats.frames_sent = pimpl_->frames_sent.load(std::memory_order_relaxed);
+            stats.send_failures = pimpl_->send_failures.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        void GnssBridge::sender_thread() {
+            while (pimpl_->running) {
+                poll(Clock::now());
+
+                std::unique_lock<std::mutex> lock(pimpl_->wake_mutex);
+                pimpl_->wake.wait_until(lock, std::min(pimpl_->next_rapid, pimpl_->next_position),
+                                        [this] { return !pimpl_->running; });
+            }
+        }
+
+        bool GnssBridge::send(uint32_t identifier, const FramePayload &payload, Clock::time_point now) {
+            auto &frame = pimpl_->frame;
+            frame.identifier = identifier;
+            frame.timestamp_us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count());
+            std::copy(payload.begin(), payload.end(), frame.data);
+
+            if (!pimpl_->sink || !pimpl_->sink(frame)) {
+                pimpl_->send_failures.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            pimpl_->frames_sent.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        size_t GnssBridge::poll(Clock::time_point now) {
+            const auto &config = pimpl_->config;
+            bool rapid_due = now >= pimpl_->next_rapid;
+            bool position_due = now >= pimpl_->next_position;
+            if (!rapid_due && !position_due) {
+                return 0;
+            }
+
+            // Copy the fix out so the receive path never waits for the bus
+            GnssPosition position;
+            bool has_position;
+            bool has_motion;
+            double course_deg;
+            double speed_mps;
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->fix_mutex);
+                position = pimpl_->position;
+                has_position = pimpl_->has_position && pimpl_->fresh(pimpl_->position_time, now);
+                has_motion = pimpl_->speed_mps >= 0.0 && pimpl_->fresh(pimpl_->motion_time, now);
+                course_deg = pimpl_->course_deg;
+                speed_mps = pimpl_->speed_mps;
+            }
+
+            size_t sent = 0;
+            if (rapid_due) {
+                if (has_position &&
+                    send(n2k_can_id(PGN_POSITION_RAPID, config.source_address, config.rapid_priority),
+                         encode_position_rapid(position.latitude, position.longitude), now)) {
+                    pimpl_->position_rapid_sent.fetch_add(1, std::memory_order_relaxed);
+                    sent++;
+                }
+                if (has_motion && send(n2k_can_id(PGN_COG_SOG_RAPID, config.source_address, config.rapid_priority),
+                                       encode_cog_sog_rapid(position.sid, course_deg, speed_mps), now)) {
+                    pimpl_->cog_sog_sent.fetch_add(1, std::memory_order_relaxed);
+                    sent++;
+                }
+                // Keep a fixed cadence, but do not burst to catch up after a stall
+                pimpl_->next_rapid += std::chrono::milliseconds(config.rapid_interval_ms);
+                if (pimpl_->next_rapid <= now) {
+                    pimpl_->next_rapid = now + std::chrono::milliseconds(config.rapid_interval_ms);
+                }
+            }
+
+            if (position_due) {
+                if (has_position) {
+                    size_t size = encode_gnss_position(position, pimpl_->gnss_buffer.data());
+                    size_t count = fast_packet_frames(pimpl_->gnss_buffer.data(), size, pimpl_->fast_packet_sequence,
+                                                      pimpl_->fast_packet);
+                    pimpl_->fast_packet_sequence = static_cast<uint8_t>((pimpl_->fast_packet_sequence + 1) & 0x07);
+
+                    uint32_t identifier =
+                        n2k_can_id(PGN_GNSS_POSITION, config.source_address, config.position_priority);
+                    size_t frames = 0;
+                    while (frames < count && send(identifier, pimpl_->fast_packet[frames], now)) {
+                        frames++;
+                    }
+                    sent += frames;
+                    if (frames == count) {
+                        pimpl_->gnss_position_sent.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                pimpl_->next_position += std::chrono::milliseconds(config.position_interval_ms);
+                if (pimpl_->next_position <= now) {
+                    pimpl_->next_position = now + std::chrono::milliseconds(config.position_interval_ms);
+                }
+            }
+
+            return sent;
+        }
+
+    } // namespace can
+} // namespace tractor
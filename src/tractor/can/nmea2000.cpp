@@ -0,0 +1,121 @@
+#include "tractor/can/nmea2000.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace tractor {
+    namespace can {
+
+        namespace {
+
+            constexpr double PI = 3.14159265358979323846;
+
+            // Fields are little endian, the largest values of each type are reserved for "not available"
+            // and "out of range", so anything beyond the valid range is clamped below them
+            template <typename T> T scaled(double value, double resolution, T not_available) {
+                double raw = std::round(value / resolution);
+                if (!std::isfinite(raw)) {
+                    return not_available;
+                }
+                if (raw <= static_cast<double>(std::numeric_limits<T>::min())) {
+                    return std::numeric_limits<T>::min();
+                }
+                T high = static_cast<T>(not_available - 2);
+                if (raw >= static_cast<double>(high)) {
+                    return high;
+                }
+                return static_cast<T>(raw);
+            }
+
+            template <typename T> void put(uint8_t *out, T value) {
+                using U = std::make_unsigned_t<T>;
+                U bits = static_cast<U>(value);
+                for (size_t i = 0; i < sizeof(T); i++) {
+                    out[i] = static_cast<uint8_t>(bits >> (8 * i));
+                }
+            }
+
+        } // namespace
+
+        FramePayload encode_position_rapid(double latitude, double longitude) {
+            FramePayload payload;
+            put(payload.data(), scaled<int32_t>(latitude, 1e-7, INT32_MAX));
+            put(payload.data() + 4, scaled<int32_t>(longitude, 1e-7, INT32_MAX));
+            return payload;
+        }
+
+        FramePayload encode_cog_sog_rapid(uint8_t sid, double course_deg, double speed_mps) {
+            FramePayload payload;
+            payload.fill(0xFF);
+            payload[0] = sid;
+            payload[1] = 0xFC; // True reference, reserved bits set
+
+            uint16_t course = 0xFFFF;
+            if (course_deg >= 0.0) {
+                course = scaled<uint16_t>(std::fmod(course_deg, 360.0) * PI / 180.0, 1e-4, 0xFFFF);
+            }
+            uint16_t speed = speed_mps >= 0.0 ? scaled<uint16_t>(speed_mps, 0.01, 0xFFFF) : 0xFFFF;
+            put(payload.data() + 2, course);
+            put(payload.data() + 4, speed);
+            return payload;
+        }
+
+        size_t encode_gnss_position(const GnssPosition &position, uint8_t *out) {
+            put(out + 0, position.sid);
+            put(out + 1, position.days_since_1970);
+            put(out + 3, position.seconds_since_midnight_x10000);
+            put(out + 7, scaled<int64_t>(position.latitude * 1e16, 1.0, INT64_MAX));
+            put(out + 15, scaled<int64_t>(position.longitude * 1e16, 1.0, INT64_MAX));
+            put(out + 23, scaled<int64_t>(position.altitude * 1e6, 1.0, INT64_MAX));
+            out[31] = static_cast<uint8_t>((position.gnss_type & 0x0F) | ((position.method & 0x0F) << 4));
+            out[32] = static_cast<uint8_t>((position.integrity & 0x03) | 0xFC);
+            out[33] = position.satellites;
+            put(out + 34, position.hdop >= 0.0 ? scaled<int16_t>(position.hdop, 0.01, INT16_MAX) : INT16_MAX);
+            put(out + 36, position.pdop >= 0.0 ? scaled<int16_t>(position.pdop, 0.01, INT16_MAX) : INT16_MAX);
+            put(out + 38, scaled<int32_t>(position.geoid_separation, 0.01, INT32_MAX));
+
+            if (!position.has_reference_station) {
+                out[42] = 0;
+                return 43;
+            }
+            out[42] = 1;
+            uint16_t type_and_id =
+                static_cast<uint16_t>((position.gnss_type & 0x0F) | ((position.reference_station_id & 0x0FFF) << 4));
+            put(out + 43, type_and_id);
+            put(out + 45, scaled<uint16_t>(position.reference_station_age, 0.01, 0xFFFF));
+            return GNSS_POSITION_MAX_SIZE;
+        }
+
+        size_t fast_packet_frames(const uint8_t *data, size_t size, uint8_t sequence,
+                                  std::array<FramePayload, FAST_PACKET_MAX_FRAMES> &frames) {
+            if (size > 6 + 7 * (FAST_PACKET_MAX_FRAMES - 1)) {
+                return 0;
+            }
+
+            uint8_t counter = static_cast<uint8_t>((sequence & 0x07) << 5);
+            size_t count = 0;
+            size_t offset = 0;
+            while (count == 0 || offset < size) {
+                FramePayload &frame = frames[count];
+                frame.fill(0xFF);
+                frame[0] = static_cast<uint8_t>(counter | count);
+                size_t header = 1;
+                if (count == 0) {
+                    frame[1] = static_cast<uint8_t>(size);
+                    header = 2;
+                }
+                size_t chunk = std::min(frame.size() - header, size - offset);
+                if (chunk > 0) {
+                    std::memcpy(frame.data() + header, data + offset, chunk);
+                }
+                offset += chunk;
+                count++;
+            }
+            return count;
+        }
+
+    } // namespace can
+} // namespace tractor
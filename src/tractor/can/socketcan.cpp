@@ -0,0 +1,476 @@
+#include "tractor/can/socketcan.hpp"
+#include "../comms/uring.hpp"
+#include "tractor/trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <mutex>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace tractor {
+    namespace can {
+
+        namespace {
+            // Room for SCM_TIMESTAMPING (three timespecs) and SO_RXQ_OVFL (one uint32_t)
+            constexpr size_t CONTROL_SIZE = CMSG_SPACE(3 * sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t));
+
+            uint64_t to_us(const struct timespec &ts) {
+                return static_cast<uint64_t>(ts.tv_sec) * 1000000u + static_cast<uint64_t>(ts.tv_nsec) / 1000u;
+            }
+
+            struct can_frame to_can_frame(const isobus::CANMessageFrame &frame) {
+                struct can_frame out {};
+                out.can_id = frame.isExtendedFrame ? (frame.identifier & CAN_EFF_MASK) | CAN_EFF_FLAG
+                                                   : frame.identifier & CAN_SFF_MASK;
+                out.len = std::min<uint8_t>(frame.dataLength, CAN_MAX_DLEN);
+                std::memcpy(out.data, frame.data, out.len);
+                return out;
+            }
+        } // namespace
+
+        struct BatchedSocketCan::Impl {
+            /**
+             * Frames queued by write_frame(), sent by writer_thread. head and tail count frames ever
+             * queued and ever handed to the kernel, the ring index is the count modulo the depth.
+             */
+            struct TransmitQueue {
+                std::mutex mutex;
+                std::condition_variable wake;
+                std::thread thread;
+                bool stopping = false;
+
+                std::vector<struct can_frame> ring;
+                uint64_t head = 0;
+                uint64_t tail = 0;
+            };
+
+            SocketCanOptions options;
+            std::atomic<int> fd{-1};
+            std::string last_error;
+            mutable std::mutex error_mutex;
+
+            // Receive batch, held by read_frame() so close() never pulls the ring out from under it
+            std::mutex rx_mutex;
+            std::vector<struct can_frame> rx_frames;
+            std::vector<std::array<uint8_t, CONTROL_SIZE>> rx_control;
+            std::vector<struct iovec> rx_iov;
+            std::vector<struct mmsghdr> rx_messages;
+            std::vector<uint32_t> rx_order; // Slots of the current batch in the order they were received
+            size_t rx_count = 0;
+            size_t rx_next = 0;
+
+            // io_uring receive path, every slot not handed out by read_frame() has a recvmsg() posted
+            comms::uring::Ring ring;
+            std::vector<uint32_t> rx_repost;
+            size_t rx_posted = 0;
+
+            TransmitQueue tx;
+
+            std::atomic<uint64_t> frames_received{0};
+            std::atomic<uint64_t> frames_sent{0};
+            std::atomic<uint64_t> receive_calls{0};
+            std::atomic<uint64_t> send_calls{0};
+            std::atomic<uint64_t> send_failures{0};
+            std::atomic<uint64_t> hardware_timestamps{0};
+            std::atomic<uint64_t> software_timestamps{0};
+            std::atomic<uint64_t> kernel_drops{0};
+
+            void set_error(std::string message) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                last_error = std::move(message);
+            }
+
+            static void count(std::atomic<uint64_t> &counter, uint64_t amount = 1) {
+                counter.fetch_add(amount, std::memory_order_relaxed);
+            }
+
+            void reset_slot(uint32_t slot) {
+                rx_iov[slot] = {&rx_frames[slot], sizeof(struct can_frame)};
+                struct msghdr &message = rx_messages[slot].msg_hdr;
+                message = {};
+                message.msg_iov = &rx_iov[slot];
+                message.msg_iovlen = 1;
+                message.msg_control = rx_control[slot].data();
+                message.msg_controllen = CONTROL_SIZE;
+            }
+
+            // Posts the slots consumed since the last call, the next wait() submits them
+            void post_receives(int fd) {
+                for (uint32_t slot : rx_repost) {
+                    reset_slot(slot);
+                    if (ring.recvmsg(fd, &rx_messages[slot].msg_hdr, slot)) {
+                        rx_posted++;
+                    }
+                }
+                rx_repost.clear();
+            }
+
+            // Called with rx_mutex held before the socket closes
+            void close_ring() {
+                if (!ring.is_open()) {
+                    return;
+                }
+                for (uint32_t slot = 0; slot < rx_messages.size() && rx_posted > 0; slot++) {
+                    if (!ring.cancel(slot, UINT64_MAX)) {
+                        ring.submit();
+                        ring.cancel(slot, UINT64_MAX);
+                    }
+                }
+
+                // The kernel may write into the slots until their receives completed
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+                while (rx_posted > 0 && std::chrono::steady_clock::now() < deadline) {
+                    ring.wait(static_cast<int>(options.receive_timeout_ms));
+                    comms::uring::Completion completion;
+                    while (ring.next(completion)) {
+                        if (completion.user_data != UINT64_MAX) {
+                            rx_posted--;
+                        }
+                    }
+                }
+                ring.close();
+                rx_repost.clear();
+                rx_posted = 0;
+            }
+        };
+
+        BatchedSocketCan::BatchedSocketCan(const SocketCanOptions &options) : pimpl_(std::make_unique<Impl>()) {
+            pimpl_->options = options;
+            pimpl_->options.batch_size = std::max<size_t>(options.batch_size, 1);
+            pimpl_->options.transmit_queue_depth = std::max<size_t>(options.transmit_queue_depth, 1);
+        }
+
+        BatchedSocketCan::~BatchedSocketCan() { close(); }
+
+        bool BatchedSocketCan::get_is_valid() const { return pimpl_->fd.load() >= 0; }
+
+        void BatchedSocketCan::open() {
+            if (get_is_valid()) {
+                return;
+            }
+
+            const auto &options = pimpl_->options;
+            int fd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+            if (fd < 0) {
+                pimpl_->set_error(std::string("Failed to create CAN socket: ") + std::strerror(errno));
+                return;
+            }
+
+            struct sockaddr_can address {};
+            address.can_family = AF_CAN;
+            address.can_ifindex = static_cast<int>(::if_nametoindex(options.interface.c_str()));
+            if (address.can_ifindex == 0 ||
+                ::bind(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0) {
+                pimpl_->set_error("Failed to bind to " + options.interface + ": " + std::strerror(errno));
+                ::close(fd);
+                return;
+            }
+
+            // Bounds the wait in read_frame() so the receive thread notices a stop
+            struct timeval timeout {};
+            timeout.tv_sec = options.receive_timeout_ms / 1000;
+            timeout.tv_usec = static_cast<suseconds_t>(options.receive_timeout_ms % 1000) * 1000;
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+            int enable = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+
+            if (options.timestamps != CanTimestamps::None) {
+                int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+                if (options.timestamps == CanTimestamps::Hardware) {
+                    // Needs CAP_NET_ADMIN and driver support, frames fall back to software stamps otherwise
+                    struct hwtstamp_config config {};
+                    config.rx_filter = HWTSTAMP_FILTER_ALL;
+                    struct ifreq request {};
+                    std::strncpy(request.ifr_name, options.interface.c_str(), IFNAMSIZ - 1);
+                    request.ifr_data = reinterpret_cast<char *>(&config);
+                    ::ioctl(fd, SIOCSHWTSTAMP, &request);
+                    flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+                }
+                if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+                    pimpl_->set_error(std::string("Receive timestamps unavailable: ") + std::strerror(errno));
+                }
+            }
+
+            // Everything the receive path needs is allocated once here
+            const size_t batch = options.batch_size;
+            pimpl_->rx_frames.assign(batch, {});
+            pimpl_->rx_control.assign(batch, {});
+            pimpl_->rx_iov.resize(batch);
+            pimpl_->rx_messages.resize(batch);
+            pimpl_->rx_order.clear();
+            pimpl_->rx_order.reserve(batch);
+            pimpl_->rx_count = 0;
+            pimpl_->rx_next = 0;
+
+            if (options.use_io_uring) {
+                if (pimpl_->ring.open(static_cast<unsigned>(batch))) {
+                    for (uint32_t slot = 0; slot < batch; slot++) {
+                        pimpl_->rx_repost.push_back(slot);
+                    }
+                    pimpl_->post_receives(fd);
+                    pimpl_->ring.submit();
+                } else {
+                    pimpl_->set_error(std::string("io_uring unavailable, using recvmmsg(): ") + std::strerror(errno));
+                }
+            }
+
+            auto &tx = pimpl_->tx;
+            tx.ring.assign(options.transmit_queue_depth, {});
+            tx.head = 0;
+            tx.tail = 0;
+            tx.stopping = false;
+
+            pimpl_->fd.store(fd);
+            tx.thread = std::thread(&BatchedSocketCan::writer_thread, this);
+        }
+
+        void BatchedSocketCan::close() {
+            auto &tx = pimpl_->tx;
+            {
+                std::lock_guard<std::mutex> lock(tx.mutex);
+                tx.stopping = true;
+            }
+            tx.wake.notify_all();
+
+            // The writer sends what is queued before it exits
+            if (tx.thread.joinable()) {
+                tx.thread.join();
+            }
+
+            std::lock_guard<std::mutex> rx_lock(pimpl_->rx_mutex);
+            pimpl_->close_ring();
+            int fd = pimpl_->fd.exchange(-1);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+
+        bool BatchedSocketCan::read_frame(isobus::CANMessageFrame &canFrame) {
+            std::lock_guard<std::mutex> rx_lock(pimpl_->rx_mutex);
+            if (pimpl_->rx_next == pimpl_->rx_count && !receive_batch()) {
+                return false;
+            }
+
+            const size_t index = pimpl_->rx_order[pimpl_->rx_next++];
+            const struct can_frame &frame = pimpl_->rx_frames[index];
+            const bool extended = (frame.can_id & CAN_EFF_FLAG) != 0;
+            canFrame.identifier = frame.can_id & (extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+            TRACTOR_TRACE_INSTANT("can", "rx", canFrame.identifier);
+            canFrame.isExtendedFrame = extended;
+            canFrame.dataLength = std::min<uint8_t>(frame.len, CAN_MAX_DLEN);
+            std::memcpy(canFrame.data, frame.data, canFrame.dataLength);
+            canFrame.timestamp_us = 0;
+
+            struct msghdr &message = pimpl_->rx_messages[index].msg_hdr;
+            for (struct cmsghdr *control = CMSG_FIRSTHDR(&message); control != nullptr;
+                 control = CMSG_NXTHDR(&message, control)) {
+                if (control->cmsg_level != SOL_SOCKET) {
+                    continue;
+                }
+                if (control->cmsg_type == SO_TIMESTAMPING) {
+                    // [0] software, [2] raw hardware, an unset stamp is zero
+                    struct timespec stamps[3];
+                    std::memcpy(stamps, CMSG_DATA(control), sizeof(stamps));
+                    if (stamps[2].tv_sec != 0 || stamps[2].tv_nsec != 0) {
+                        canFrame.timestamp_us = to_us(stamps[2]);
+                        Impl::count(pimpl_->hardware_timestamps);
+                    } else if (stamps[0].tv_sec != 0 || stamps[0].tv_nsec != 0) {
+                        canFrame.timestamp_us = to_us(stamps[0]);
+                        Impl::count(pimpl_->software_timestamps);
+                    }
+                } else if (control->cmsg_type == SO_RXQ_OVFL) {
+                    // Running total of the socket, kept as the latest value
+                    uint32_t dropped;
+                    std::memcpy(&dropped, CMSG_DATA(control), sizeof(dropped));
+                    pimpl_->kernel_drops.store(dropped, std::memory_order_relaxed);
+                }
+            }
+            return true;
+        }
+
+        bool BatchedSocketCan::receive_batch() {
+            int fd = pimpl_->fd.load();
+            if (fd < 0) {
+                return false;
+            }
+            TRACTOR_TRACE_SCOPE("can", "receive");
+
+            pimpl_->rx_count = 0;
+            pimpl_->rx_next = 0;
+
+            if (pimpl_->ring.is_open()) {
+                // The frames handed out last time are done with, their slots receive again
+                for (uint32_t slot : pimpl_->rx_order) {
+                    pimpl_->rx_repost.push_back(slot);
+                }
+                pimpl_->rx_order.clear();
+                pimpl_->post_receives(fd);
+
+                int result = pimpl_->ring.wait(static_cast<int>(pimpl_->options.receive_timeout_ms));
+                if (result < 0 && result != -EINTR) {
+                    pimpl_->set_error(std::string("io_uring_enter error: ") + std::strerror(-result));
+                }
+
+                comms::uring::Completion completion;
+                while (pimpl_->ring.next(completion)) {
+                    auto slot = static_cast<uint32_t>(completion.user_data);
+                    pimpl_->rx_posted--;
+                    if (completion.result > 0) {
+                        pimpl_->rx_order.push_back(slot);
+                        continue;
+                    }
+                    if (completion.result != -EAGAIN && completion.result != -EINTR) {
+                        pimpl_->set_error(std::string("CAN receive error: ") + std::strerror(-completion.result));
+                    }
+                    pimpl_->rx_repost.push_back(slot);
+                }
+
+                if (pimpl_->rx_order.empty()) {
+                    return false;
+                }
+                pimpl_->rx_count = pimpl_->rx_order.size();
+                Impl::count(pimpl_->receive_calls);
+                Impl::count(pimpl_->frames_received, pimpl_->rx_count);
+                TRACTOR_TRACE_VALUE(pimpl_->rx_count);
+                return true;
+            }
+
+            pimpl_->rx_order.clear();
+            const size_t batch = pimpl_->rx_messages.size();
+            for (uint32_t slot = 0; slot < batch; slot++) {
+                pimpl_->reset_slot(slot);
+            }
+
+            // Waits for the first frame up to the receive timeout, then takes whatever else is queued
+            int received = ::recvmmsg(fd, pimpl_->rx_messages.data(), static_cast<unsigned int>(batch), MSG_WAITFORONE,
+                                      nullptr);
+            if (received <= 0) {
+                if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    pimpl_->set_error(std::string("CAN receive error: ") + std::strerror(errno));
+                }
+                return false;
+            }
+
+            for (uint32_t slot = 0; slot < static_cast<uint32_t>(received); slot++) {
+                pimpl_->rx_order.push_back(slot);
+            }
+            pimpl_->rx_count = static_cast<size_t>(received);
+            Impl::count(pimpl_->receive_calls);
+            Impl::count(pimpl_->frames_received, pimpl_->rx_count);
+            TRACTOR_TRACE_VALUE(pimpl_->rx_count);
+            return true;
+        }
+
+        bool BatchedSocketCan::write_frame(const isobus::CANMessageFrame &canFrame) {
+            auto &tx = pimpl_->tx;
+            {
+                std::lock_guard<std::mutex> lock(tx.mutex);
+                if (tx.stopping || !get_is_valid() || tx.head - tx.tail == tx.ring.size()) {
+                    return false;
+                }
+                tx.ring[tx.head % tx.ring.size()] = to_can_frame(canFrame);
+                TRACTOR_TRACE_FLOW_BEGIN("can", "tx", trace::flow_id(&tx, tx.head));
+                tx.head++;
+            }
+            tx.wake.notify_one();
+            return true;
+        }
+
+        void BatchedSocketCan::writer_thread() {
+            auto &tx = pimpl_->tx;
+            const size_t depth = tx.ring.size();
+            const size_t batch = pimpl_->options.batch_size;
+            std::vector<struct can_frame> frames(batch);
+            std::vector<struct iovec> iov(batch);
+            std::vector<struct mmsghdr> messages(batch);
+
+            std::unique_lock<std::mutex> lock(tx.mutex);
+            for (;;) {
+                tx.wake.wait(lock, [&] { return tx.stopping || tx.head != tx.tail; });
+                if (tx.head == tx.tail) {
+                    break;
+                }
+
+                // Everything queued so far, up to one batch, goes out in one call
+                size_t count = static_cast<size_t>(std::min<uint64_t>(tx.head - tx.tail, batch));
+                TRACTOR_TRACE_SCOPE("can", "send");
+                TRACTOR_TRACE_VALUE(count);
+                for (size_t i = 0; i < count; i++) {
+                    frames[i] = tx.ring[(tx.tail + i) % depth];
+                    TRACTOR_TRACE_FLOW_END("can", "tx", trace::flow_id(&tx, tx.tail + i));
+                }
+                tx.tail += count;
+                lock.unlock();
+
+                for (size_t i = 0; i < count; i++) {
+                    iov[i] = {&frames[i], sizeof(struct can_frame)};
+                    messages[i] = {};
+                    messages[i].msg_hdr.msg_iov = &iov[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                size_t sent = 0;
+                int retries = 0;
+                while (sent < count) {
+                    int result = ::sendmmsg(pimpl_->fd.load(), messages.data() + sent,
+                                            static_cast<unsigned int>(count - sent), 0);
+                    Impl::count(pimpl_->send_calls);
+                    if (result > 0) {
+                        sent += static_cast<size_t>(result);
+                        continue;
+                    }
+
+                    // ENOBUFS means the interface queue is full, give the bus a moment to drain it
+                    if (result < 0 && (errno == ENOBUFS || errno == EAGAIN || errno == EINTR) && retries++ < 100) {
+                        ::poll(nullptr, 0, 1);
+                        continue;
+                    }
+                    if (result < 0) {
+                        pimpl_->set_error(std::string("CAN transmit error: ") + std::strerror(errno));
+                    }
+                    break;
+                }
+                Impl::count(pimpl_->frames_sent, sent);
+                Impl::count(pimpl_->send_failures, count - sent);
+
+                lock.lock();
+            }
+        }
+
+        BatchedSocketCan::Statistics BatchedSocketCan::get_statistics() const {
+            auto load = [](const std::atomic<uint64_t> &counter) { return counter.load(std::memory_order_relaxed); };
+
+            Statistics stats;
+            stats.frames_received = load(pimpl_->frames_received);
+            stats.frames_sent = load(pimpl_->frames_sent);
+            stats.receive_calls = load(pimpl_->receive_calls);
+            stats.send_calls = load(pimpl_->send_calls);
+            stats.send_failures = load(pimpl_->send_failures);
+            stats.hardware_timestamps = load(pimpl_->hardware_timestamps);
+            stats.software_timestamps = load(pimpl_->software_timestamps);
+            stats.kernel_drops = load(pimpl_->kernel_drops);
+            return stats;
+        }
+
+        std::string BatchedSocketCan::get_last_error() const {
+            std::lock_guard<std::mutex> lock(pimpl_->error_mutex);
+            return pimpl_->last_error;
+        }
+
+    } // namespace can
+} // namespace tractor
@@ -0,0 +1,284 @@
+#include "tractor/comms/capture.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+namespace tractor {
+    namespace comms {
+
+        namespace {
+            using Clock = std::chrono::steady_clock;
+
+            constexpr char MAGIC[4] = {'T', 'C', 'A', 'P'};
+            constexpr uint32_t FORMAT_VERSION = 1;
+
+            // Host byte order, like the rest of the on-disk formats
+            struct FileHeader {
+                char magic[4];
+                uint32_t version;
+                uint64_t capacity;
+                int64_t wall_clock_ns; // System clock when the capture was opened, for lining up with other logs
+                uint64_t reserved[5];
+            };
+            static_assert(sizeof(FileHeader) == 64);
+
+            // The tag is stored last, a record with tag 0 was never completed
+            struct RecordHeader {
+                uint32_t tag; // Kind in the upper, channel in the lower 16 bits
+                uint32_t size;
+                uint64_t timestamp_ns;
+            };
+            static_assert(sizeof(RecordHeader) == 16);
+
+            constexpr size_t record_size(size_t payload) { return (sizeof(RecordHeader) + payload + 7) & ~size_t{7}; }
+
+            uint64_t elapsed_ns(Clock::time_point from, Clock::time_point to) {
+                return to > from ? static_cast<uint64_t>(
+                                       std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count())
+                                 : 0;
+            }
+        } // namespace
+
+        struct CaptureWriter::Impl {
+            std::string path;
+            size_t capacity;
+            int fd = -1;
+            uint8_t *map = nullptr;
+            size_t map_size = 0;
+            Clock::time_point start;
+            std::string last_error;
+
+            alignas(64) std::atomic<uint64_t> tail{0};
+            std::atomic<uint64_t> dropped{0};
+
+            Impl(std::string file, size_t bytes) : path(std::move(file)), capacity(bytes) {}
+        };
+
+        CaptureWriter::CaptureWriter(std::string path, size_t capacity)
+            : pimpl_(std::make_unique<Impl>(std::move(path), capacity)) {}
+
+        CaptureWriter::~CaptureWriter() { close(); }
+
+        bool CaptureWriter::open() {
+            close();
+            int fd = ::open(pimpl_->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                pimpl_->last_error = "Failed to create " + pimpl_->path + ": " + std::strerror(errno);
+                return false;
+            }
+
+            // Reserve the blocks up front so appending never waits for the filesystem to allocate
+            size_t size = sizeof(FileHeader) + pimpl_->capacity;
+            int result = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+            if (result != 0 && (result != EOPNOTSUPP || ::ftruncate(fd, static_cast<off_t>(size)) < 0)) {
+                pimpl_->last_error = std::string("Failed to allocate capture file: ") + std::strerror(result);
+                ::close(fd);
+                return false;
+            }
+
+            int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE; // Fault the pages in now rather than on the receive path
+#endif
+            void *map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+            if (map == MAP_FAILED) {
+                pimpl_->last_error = std::string("Failed to map capture file: ") + std::strerror(errno);
+                ::close(fd);
+                return false;
+            }
+
+            pimpl_->start = Clock::now();
+            auto *header = static_cast<FileHeader *>(map);
+            std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+            header->version = FORMAT_VERSION;
+            header->capacity = pimpl_->capacity;
+            header->wall_clock_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::system_clock::now().time_since_epoch())
+                                        .count();
+
+            pimpl_->fd = fd;
+            pimpl_->map = static_cast<uint8_t *>(map);
+            pimpl_->map_size = size;
+            pimpl_->tail.store(0, std::memory_order_relaxed);
+            pimpl_->dropped.store(0, std::memory_order_relaxed);
+            pimpl_->last_error.clear();
+            return true;
+        }
+
+        void CaptureWriter::close() {
+            if (pimpl_->map == nullptr) {
+                return;
+            }
+
+            size_t used = bytes_used();
+            ::msync(pimpl_->map, sizeof(FileHeader) + used, MS_SYNC);
+            ::munmap(pimpl_->map, pimpl_->map_size);
+            if (::ftruncate(pimpl_->fd, static_cast<off_t>(sizeof(FileHeader) + used)) < 0) {
+                pimpl_->last_error = std::string("Failed to trim capture file: ") + std::strerror(errno);
+            }
+            ::close(pimpl_->fd);
+
+            pimpl_->map = nullptr;
+            pimpl_->map_size = 0;
+            pimpl_->fd = -1;
+        }
+
+        bool CaptureWriter::is_open() const { return pimpl_->map != nullptr; }
+
+        bool CaptureWriter::append(CaptureKind kind, uint16_t channel, std::span<const uint8_t> data,
+                                   Clock::time_point time) {
+            uint8_t *map = pimpl_->map;
+            if (map == nullptr || data.size() > UINT32_MAX) {
+                return false;
+            }
+
+            const size_t size = record_size(data.size());
+            const uint64_t offset = pimpl_->tail.fetch_add(size, std::memory_order_relaxed);
+            if (offset + size > pimpl_->capacity) {
+                pimpl_->dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            auto *record = reinterpret_cast<RecordHeader *>(map + sizeof(FileHeader) + offset);
+            record->size = static_cast<uint32_t>(data.size());
+            record->timestamp_ns = elapsed_ns(pimpl_->start, time);
+            std::memcpy(record + 1, data.data(), data.size());
+
+            uint32_t tag = (static_cast<uint32_t>(kind) << 16) | channel;
+            std::atomic_ref<uint32_t>(record->tag).store(tag, std::memory_order_release);
+            return true;
+        }
+
+        size_t CaptureWriter::bytes_used() const {
+            uint64_t used = pimpl_->tail.load(std::memory_order_relaxed);
+            return static_cast<size_t>(std::min<uint64_t>(used, pimpl_->capacity));
+        }
+
+        size_t CaptureWriter::records_dropped() const { return pimpl_->dropped.load(std::memory_order_relaxed); }
+
+        std::string CaptureWriter::get_last_error() const { return pimpl_->last_error; }
+
+        struct CaptureReader::Impl {
+            const uint8_t *map = nullptr;
+            size_t map_size = 0;
+            size_t offset = sizeof(FileHeader);
+            std::string last_error;
+        };
+
+        CaptureReader::CaptureReader() : pimpl_(std::make_unique<Impl>()) {}
+
+        CaptureReader::~CaptureReader() { close(); }
+
+        bool CaptureReader::open(const std::string &path) {
+            close();
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                pimpl_->last_error = "Failed to open " + path + ": " + std::strerror(errno);
+                return false;
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+                ::close(fd);
+                pimpl_->last_error = "Capture file too short: " + path;
+                return false;
+            }
+
+            size_t size = static_cast<size_t>(st.st_size);
+            void *map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (map == MAP_FAILED) {
+                pimpl_->last_error = std::string("Failed to map capture file: ") + std::strerror(errno);
+                return false;
+            }
+
+            const auto *header = static_cast<const FileHeader *>(map);
+            if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != FORMAT_VERSION) {
+                ::munmap(map, size);
+                pimpl_->last_error = "Not a capture file: " + path;
+                return false;
+            }
+
+            pimpl_->map = static_cast<const uint8_t *>(map);
+            pimpl_->map_size = size;
+            pimpl_->offset = sizeof(FileHeader);
+            pimpl_->last_error.clear();
+            return true;
+        }
+
+        void CaptureReader::close() {
+            if (pimpl_->map != nullptr) {
+                ::munmap(const_cast<uint8_t *>(pimpl_->map), pimpl_->map_size);
+                pimpl_->map = nullptr;
+                pimpl_->map_size = 0;
+            }
+        }
+
+        bool CaptureReader::next(CaptureRecord &record) {
+            const size_t offset = pimpl_->offset;
+            if (pimpl_->map == nullptr || offset + sizeof(RecordHeader) > pimpl_->map_size) {
+                return false;
+            }
+
+            // A file still being written ends at the first record without a tag
+            const auto *header = reinterpret_cast<const RecordHeader *>(pimpl_->map + offset);
+            uint32_t tag = header->tag;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (tag == 0 || header->size > pimpl_->map_size - offset - sizeof(RecordHeader)) {
+                return false;
+            }
+
+            record.kind = static_cast<CaptureKind>(tag >> 16);
+            record.channel = static_cast<uint16_t>(tag);
+            record.timestamp_ns = header->timestamp_ns;
+            record.data = std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(header + 1), header->size);
+            pimpl_->offset = offset + record_size(header->size);
+            return true;
+        }
+
+        void CaptureReader::rewind() { pimpl_->offset = sizeof(FileHeader); }
+
+        size_t CaptureReader::replay(const ReplayOptions &options,
+                                     const std::function<bool(const CaptureRecord &)> &handler) {
+            const bool paced = options.realtime && options.speed > 0.0;
+            Clock::time_point started;
+            uint64_t first_timestamp = 0;
+            size_t replayed = 0;
+
+            CaptureRecord record;
+            while (next(record)) {
+                if (record.kind != options.kind || (options.channel >= 0 && record.channel != options.channel)) {
+                    continue;
+                }
+
+                if (paced) {
+                    if (replayed == 0) {
+                        started = Clock::now();
+                        first_timestamp = record.timestamp_ns;
+                    }
+                    // Writers on several threads may complete records slightly out of time order
+                    uint64_t offset_ns = std::max(record.timestamp_ns, first_timestamp) - first_timestamp;
+                    std::chrono::duration<double, std::nano> offset(static_cast<double>(offset_ns) / options.speed);
+                    std::this_thread::sleep_until(started + std::chrono::duration_cast<Clock::duration>(offset));
+                }
+
+                replayed++;
+                if (!handler(record)) {
+                    break;
+                }
+            }
+            return replayed;
+        }
+
+        std::string CaptureReader::get_last_error() const { return pimpl_->last_error; }
+
+    } // namespace comms
+} // namespace tractor
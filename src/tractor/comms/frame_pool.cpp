@@ -0,0 +1,175 @@
+#include "tractor/comms/frame_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace tractor {
+    namespace comms {
+
+        namespace detail {
+            static_assert(sizeof(FrameBlock) <= FrameBlock::BLOCK_HEADER, "Frame header does not fit");
+
+            // Buffers of a pool, freed when the pool and every Frame are gone
+            struct FrameArena {
+                static constexpr size_t ALIGNMENT = 64; // One cache line per header, references never share one
+
+                size_t frame_size = 0;
+                size_t frames = 0;
+                size_t stride = 0;
+                uint8_t *memory = nullptr;
+
+                // Lock-free stack of free blocks: index + 1 of the top in the low half, a tag counting
+                // every change in the high half so a pop racing with pop and push cannot succeed wrongly
+                alignas(ALIGNMENT) std::atomic<uint64_t> free{0};
+                std::atomic<size_t> references{1}; // The pool plus every buffer out
+
+                alignas(ALIGNMENT) std::atomic<size_t> acquired{0};
+                std::atomic<size_t> exhausted{0};
+                std::atomic<size_t> in_use{0};
+                std::atomic<size_t> high_water_mark{0};
+
+                FrameArena(size_t size, size_t count) : frame_size(size), frames(count) {
+                    stride = (FrameBlock::BLOCK_HEADER + frame_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+                    memory = static_cast<uint8_t *>(::operator new(stride * frames, std::align_val_t{ALIGNMENT}));
+                    std::memset(memory, 0, stride * frames); // Fault every page in now
+
+                    for (size_t i = 0; i < frames; i++) {
+                        auto *block = new (memory + i * stride) FrameBlock();
+                        block->index = static_cast<uint32_t>(i);
+                        block->arena = this;
+                        block->next.store(i + 1 < frames ? static_cast<uint32_t>(i + 2) : 0, std::memory_order_relaxed);
+                    }
+                    free.store(1, std::memory_order_relaxed);
+                }
+
+                ~FrameArena() { ::operator delete(memory, std::align_val_t{ALIGNMENT}); }
+
+                FrameBlock *block(uint32_t index) { return reinterpret_cast<FrameBlock *>(memory + index * stride); }
+
+                FrameBlock *pop() {
+                    uint64_t head = free.load(std::memory_order_acquire);
+                    for (;;) {
+                        auto top = static_cast<uint32_t>(head);
+                        if (top == 0) {
+                            exhausted.fetch_add(1, std::memory_order_relaxed);
+                            return nullptr;
+                        }
+                        FrameBlock *candidate = block(top - 1);
+                        uint64_t next = ((head >> 32) + 1) << 32 | candidate->next.load(std::memory_order_relaxed);
+                        if (free.compare_exchange_weak(head, next, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+                            break;
+                        }
+                    }
+
+                    FrameBlock *taken = block(static_cast<uint32_t>(head) - 1);
+                    taken->references.store(1, std::memory_order_relaxed);
+                    taken->size = 0;
+                    references.fetch_add(1, std::memory_order_relaxed);
+                    acquired.fetch_add(1, std::memory_order_relaxed);
+                    size_t out = in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+                    size_t mark = high_water_mark.load(std::memory_order_relaxed);
+                    while (out > mark && !high_water_mark.compare_exchange_weak(mark, out, std::memory_order_relaxed)) {
+                    }
+                    return taken;
+                }
+
+                void push(FrameBlock *block) {
+                    in_use.fetch_sub(1, std::memory_order_relaxed);
+                    uint64_t head = free.load(std::memory_order_relaxed);
+                    uint64_t top = 0;
+                    do {
+                        block->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+                        top = ((head >> 32) + 1) << 32 | (block->index + 1);
+                    } while (
+                        !free.compare_exchange_weak(head, top, std::memory_order_release, std::memory_order_relaxed));
+                    unreference();
+                }
+
+                void unreference() {
+                    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        delete this;
+                    }
+                }
+            };
+
+            void release(FrameBlock *block) { block->arena->push(block); }
+        } // namespace detail
+
+        size_t Frame::capacity() const { return block_ ? block_->arena->frame_size : 0; }
+
+        bool Frame::resize(size_t size) {
+            if (block_ == nullptr || size > block_->arena->frame_size) {
+                return false;
+            }
+            block_->size = static_cast<uint32_t>(size);
+            return true;
+        }
+
+        bool Frame::assign(std::span<const uint8_t> bytes) {
+            if (!resize(bytes.size())) {
+                return false;
+            }
+            if (!bytes.empty()) {
+                std::memcpy(block_->data(), bytes.data(), bytes.size());
+            }
+            return true;
+        }
+
+        FramePool::FramePool(size_t frame_size, size_t frames)
+            : arena_(new detail::FrameArena(std::clamp<size_t>(frame_size, 1, UINT32_MAX),
+                                            std::clamp<size_t>(frames, 1, UINT32_MAX - 1))) {}
+
+        FramePool::~FramePool() { arena_->unreference(); }
+
+        Frame FramePool::acquire() { return Frame(arena_->pop()); }
+
+        Frame FramePool::acquire(std::span<const uint8_t> bytes) {
+            if (bytes.size() > arena_->frame_size) {
+                arena_->exhausted.fetch_add(1, std::memory_order_relaxed);
+                return Frame();
+            }
+            Frame frame = acquire();
+            frame.assign(bytes);
+            return frame;
+        }
+
+        size_t FramePool::frame_size() const { return arena_->frame_size; }
+
+        size_t FramePool::capacity() const { return arena_->frames; }
+
+        size_t FramePool::available() const { return arena_->frames - arena_->in_use.load(std::memory_order_relaxed); }
+
+        FramePool::Statistics FramePool::get_statistics() const {
+            Statistics stats;
+            stats.acquired = arena_->acquired.load(std::memory_order_relaxed);
+            stats.exhausted = arena_->exhausted.load(std::memory_order_relaxed);
+            stats.in_use = arena_->in_use.load(std::memory_order_relaxed);
+            stats.high_water_mark = arena_->high_water_mark.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        void *FramePool::do_allocate(size_t bytes, size_t alignment) {
+            if (bytes > arena_->frame_size || alignment > alignof(std::max_align_t)) {
+                arena_->exhausted.fetch_add(1, std::memory_order_relaxed);
+                throw std::bad_alloc();
+            }
+            detail::FrameBlock *block = arena_->pop();
+            if (block == nullptr) {
+                throw std::bad_alloc();
+            }
+            block->size = static_cast<uint32_t>(bytes);
+            return block->data();
+        }
+
+        void FramePool::do_deallocate(void *p, size_t, size_t) {
+            auto *block = reinterpret_cast<detail::FrameBlock *>(static_cast<uint8_t *>(p) -
+                                                                 detail::FrameBlock::BLOCK_HEADER);
+            Frame(block).reset();
+        }
+
+        bool FramePool::do_is_equal(const std::pmr::memory_resource &other) const noexcept { return this == &other; }
+
+    } // namespace comms
+} // namespace tractor
@@ -0,0 +1,451 @@
+#include "tractor/comms/hotplug.hpp"
+#include "tractor/comms/tty.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+namespace tractor {
+    namespace comms {
+
+        namespace {
+            namespace fs = std::filesystem;
+
+            constexpr const char *DEV_DIRECTORY = "/dev";
+            constexpr const char *BY_ID_DIRECTORY = "/dev/serial/by-id";
+            constexpr const char *BY_PATH_DIRECTORY = "/dev/serial/by-path";
+
+            constexpr uint32_t WATCH_MASK =
+                IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE_SELF | IN_ONLYDIR;
+
+            // The prefixes Tty::list_ports() looks for, /dev holds far more than serial ports
+            bool is_serial_node(const std::string &name) {
+                for (const char *prefix : {"ttyUSB", "ttyACM", "ttyS", "ttyAMA", "rfcomm"}) {
+                    if (name.rfind(prefix, 0) == 0) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::string read_attribute(const fs::path &file) {
+                std::ifstream stream(file);
+                std::string value;
+                std::getline(stream, value);
+                return value;
+            }
+
+            uint16_t read_hex_attribute(const fs::path &file) {
+                std::string value = read_attribute(file);
+                return value.empty() ? 0 : static_cast<uint16_t>(std::strtoul(value.c_str(), nullptr, 16));
+            }
+        } // namespace
+
+        bool PortMatch::matches(const PortDescription &port) const {
+            if (!path.empty() && path != port.path && path != port.device && path != port.by_id) {
+                return false;
+            }
+            if (vendor_id != 0 && vendor_id != port.vendor_id) {
+                return false;
+            }
+            if (product_id != 0 && product_id != port.product_id) {
+                return false;
+            }
+            return serial_number.empty() || serial_number == port.serial_number;
+        }
+
+        bool describe_port(const std::string &path, PortDescription &port) {
+            std::error_code error;
+            if (!fs::exists(path, error)) {
+                return false;
+            }
+
+            port = PortDescription{};
+            port.path = path;
+            fs::path device = fs::canonical(path, error);
+            port.device = error ? path : device.string();
+
+            // The USB attributes sit on the usb_device a few levels above the tty's interface
+            fs::path tty = fs::path("/sys/class/tty") / fs::path(port.device).filename();
+            fs::path sys = fs::canonical(tty / "device", error);
+            for (; !error && sys.has_relative_path(); sys = sys.parent_path()) {
+                if (fs::exists(sys / "idVendor", error)) {
+                    port.vendor_id = read_hex_attribute(sys / "idVendor");
+                    port.product_id = read_hex_attribute(sys / "idProduct");
+                    port.serial_number = read_attribute(sys / "serial");
+                    port.manufacturer = read_attribute(sys / "manufacturer");
+                    port.product = read_attribute(sys / "product");
+                    break;
+                }
+            }
+
+            if (fs::path(path).parent_path().filename() == "by-id") {
+                port.by_id = path;
+            } else {
+                for (fs::directory_iterator it(BY_ID_DIRECTORY, error), end; !error && it != end; it.increment(error)) {
+                    if (fs::canonical(it->path(), error).string() == port.device && !error) {
+                        port.by_id = it->path().string();
+                        break;
+                    }
+                    error.clear();
+                }
+            }
+            return true;
+        }
+
+        std::vector<PortDescription> list_port_descriptions() {
+            std::vector<PortDescription> ports;
+            for (const auto &path : Tty::list_ports()) {
+                PortDescription port;
+                if (describe_port(path, port)) {
+                    ports.push_back(std::move(port));
+                }
+            }
+            return ports;
+        }
+
+        struct HotplugMonitor::Impl {
+            struct Subscription {
+                size_t id;
+                PortMatch match;
+                Callback callback;
+            };
+
+            int inotify_fd = -1;
+            int wake_fd = -1;
+            std::thread thread;
+            std::atomic<bool> running{false};
+
+            // Watched directories and the ports present in them
+            mutable std::mutex state_mutex;
+            std::vector<std::string> targets;
+            std::unordered_map<int, std::string> watches; // Watch descriptor to directory, targets or their parents
+            std::map<std::string, PortDescription> ports;
+            std::string last_error;
+
+            // Held while callbacks run, so unsubscribe() can wait for them
+            std::mutex subscription_mutex;
+            std::vector<Subscription> subscriptions;
+            size_t next_id = 1;
+
+            using Events = std::vector<std::pair<HotplugEvent, PortDescription>>;
+
+            bool is_target(const std::string &directory) const {
+                return std::find(targets.begin(), targets.end(), directory) != targets.end();
+            }
+
+            bool is_watched(const std::string &directory) const {
+                return std::any_of(watches.begin(), watches.end(),
+                                   [&](const auto &watch) { return watch.second == directory; });
+            }
+
+            bool wanted(const std::string &directory, const std::string &name) const {
+                return directory != DEV_DIRECTORY || is_serial_node(name);
+            }
+
+            // Called with state_mutex held, events is null while taking the initial snapshot
+            void port_added(const std::string &path, Events *events) {
+                PortDescription port;
+                if (!describe_port(path, port)) {
+                    return;
+                }
+                ports[path] = port;
+                if (events != nullptr) {
+                    events->emplace_back(HotplugEvent::Added, std::move(port));
+                }
+            }
+
+            void port_removed(const std::string &path, Events &events) {
+                PortDescription port;
+                auto it = ports.find(path);
+                if (it != ports.end()) {
+                    port = std::move(it->second);
+                    ports.erase(it);
+                } else {
+                    port.path = path;
+                }
+                events.emplace_back(HotplugEvent::Removed, std::move(port));
+            }
+
+            // Called with state_mutex held: watches every target that exists and the closest parent of the rest
+            void refresh(Events *events) {
+                if (inotify_fd < 0) {
+                    return;
+                }
+
+                for (const auto &target : targets) {
+                    if (is_watched(target)) {
+                        continue;
+                    }
+
+                    std::error_code error;
+                    fs::path directory = target;
+                    while (!fs::is_directory(directory, error) && directory.has_relative_path()) {
+                        directory = directory.parent_path();
+                    }
+                    if (is_watched(directory.string())) {
+                        continue;
+                    }
+
+                    int wd = inotify_add_watch(inotify_fd, directory.c_str(), WATCH_MASK);
+                    if (wd < 0) {
+                        last_error = "Failed to watch " + directory.string() + ": " + std::strerror(errno);
+                        continue;
+                    }
+                    watches[wd] = directory.string();
+
+                    // Entries created before the watch was in place would otherwise never be reported
+                    if (directory == target) {
+                        for (fs::directory_iterator it(directory, error), end; !error && it != end;
+                             it.increment(error)) {
+                            if (wanted(target, it->path().filename().string())) {
+                                port_added(it->path().string(), events);
+                            }
+                        }
+                    }
+                }
+            }
+
+            void handle(const struct inotify_event &event, Events &events) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                auto watch = watches.find(event.wd);
+                if (watch == watches.end()) {
+                    return;
+                }
+                const std::string directory = watch->second;
+
+                if (event.mask & (IN_IGNORED | IN_DELETE_SELF)) {
+                    // The directory went away, wait for it on its parent again
+                    for (auto it = ports.begin(); it != ports.end();) {
+                        if (fs::path(it->first).parent_path() == directory) {
+                            events.emplace_back(HotplugEvent::Removed, std::move(it->second));
+                            it = ports.erase(it);
+                        } else {
+                            ++it;
+                        }
+                    }
+                    if (event.mask & IN_IGNORED) {
+                        watches.erase(watch);
+                    }
+                    refresh(&events);
+                    return;
+                }
+
+                if (event.len == 0) {
+                    return;
+                }
+                const std::string name = event.name;
+                if (event.mask & IN_ISDIR) {
+                    if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+                        refresh(&events);
+                    }
+                    return;
+                }
+                if (!is_target(directory) || !wanted(directory, name)) {
+                    return;
+                }
+
+                const std::string path = (fs::path(directory) / name).string();
+                if (event.mask & (IN_CREATE | IN_MOVED_TO | IN_ATTRIB)) {
+                    port_added(path, &events);
+                } else if (event.mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    port_removed(path, events);
+                }
+            }
+
+            void dispatch(const Events &events) {
+                std::lock_guard<std::mutex> lock(subscription_mutex);
+                for (const auto &[event, port] : events) {
+                    for (const auto &subscription : subscriptions) {
+                        if (subscription.match.matches(port)) {
+                            subscription.callback(event, port);
+                        }
+                    }
+                }
+            }
+
+            void set_error(std::string message) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                last_error = std::move(message);
+            }
+        };
+
+        HotplugMonitor::HotplugMonitor() : HotplugMonitor({DEV_DIRECTORY, BY_ID_DIRECTORY, BY_PATH_DIRECTORY}) {}
+
+        HotplugMonitor::HotplugMonitor(std::vector<std::string> directories) : pimpl_(std::make_unique<Impl>()) {
+            for (auto &directory : directories) {
+                directory = fs::path(directory).lexically_normal().string();
+                if (directory.size() > 1 && directory.back() == '/') {
+                    directory.pop_back();
+                }
+                if (!pimpl_->is_target(directory)) {
+                    pimpl_->targets.push_back(std::move(directory));
+                }
+            }
+        }
+
+        HotplugMonitor::~HotplugMonitor() {
+            stop();
+            if (pimpl_->inotify_fd >= 0) {
+                ::close(pimpl_->inotify_fd);
+            }
+            if (pimpl_->wake_fd >= 0) {
+                ::close(pimpl_->wake_fd);
+            }
+        }
+
+        HotplugMonitor &HotplugMonitor::shared() {
+            static HotplugMonitor monitor;
+            return monitor;
+        }
+
+        bool HotplugMonitor::start() {
+            std::lock_guard<std::mutex> lock(pimpl_->state_mutex);
+            if (pimpl_->running) {
+                return true;
+            }
+
+            if (pimpl_->inotify_fd < 0) {
+                pimpl_->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                if (pimpl_->inotify_fd < 0) {
+                    pimpl_->last_error = std::string("Failed to create inotify instance: ") + std::strerror(errno);
+                    return false;
+                }
+            }
+            if (pimpl_->wake_fd < 0) {
+                pimpl_->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                if (pimpl_->wake_fd < 0) {
+                    pimpl_->last_error = std::string("Failed to create eventfd: ") + std::strerror(errno);
+                    return false;
+                }
+            }
+
+            pimpl_->refresh(nullptr);
+            pimpl_->running = true;
+            pimpl_->thread = std::thread(&HotplugMonitor::watcher_thread, this);
+            return true;
+        }
+
+        void HotplugMonitor::stop() {
+            if (!pimpl_->running.exchange(false)) {
+                return;
+            }
+
+            uint64_t value = 1;
+            if (::write(pimpl_->wake_fd, &value, sizeof(value)) < 0) {
+                // The thread is only ever blocked in poll() on this eventfd
+            }
+            if (pimpl_->thread.joinable()) {
+                pimpl_->thread.join();
+            }
+            while (::read(pimpl_->wake_fd, &value, sizeof(value)) > 0) {
+            }
+        }
+
+        bool HotplugMonitor::is_running() const { return pimpl_->running; }
+
+        void HotplugMonitor::watch_directory(const std::string &directory) {
+            std::string normal = fs::path(directory).lexically_normal().string();
+            if (normal.size() > 1 && normal.back() == '/') {
+                normal.pop_back();
+            }
+
+            std::lock_guard<std::mutex> lock(pimpl_->state_mutex);
+            if (!pimpl_->is_target(normal)) {
+                pimpl_->targets.push_back(normal);
+                pimpl_->refresh(nullptr);
+            }
+        }
+
+        size_t HotplugMonitor::subscribe(const PortMatch &match, Callback callback) {
+            if (!match.path.empty()) {
+                watch_directory(fs::path(match.path).parent_path().string());
+            }
+            if (!start()) {
+                return 0;
+            }
+
+            std::lock_guard<std::mutex> lock(pimpl_->subscription_mutex);
+            size_t id = pimpl_->next_id++;
+            pimpl_->subscriptions.push_back({id, match, std::move(callback)});
+            return id;
+        }
+
+        void HotplugMonitor::unsubscribe(size_t id) {
+            std::lock_guard<std::mutex> lock(pimpl_->subscription_mutex);
+            auto &subscriptions = pimpl_->subscriptions;
+            subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                                               [id](const auto &subscription) { return subscription.id == id; }),
+                                subscriptions.end());
+        }
+
+        std::vector<PortDescription> HotplugMonitor::ports() const {
+            std::lock_guard<std::mutex> lock(pimpl_->state_mutex);
+            std::vector<PortDescription> result;
+            result.reserve(pimpl_->ports.size());
+            for (const auto &[path, port] : pimpl_->ports) {
+                result.push_back(port);
+            }
+            return result;
+        }
+
+        bool HotplugMonitor::find(const PortMatch &match, PortDescription &port) const {
+            std::lock_guard<std::mutex> lock(pimpl_->state_mutex);
+            for (const auto &[path, candidate] : pimpl_->ports) {
+                if (match.matches(candidate)) {
+                    port = candidate;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string HotplugMonitor::get_last_error() const {
+            std::lock_guard<std::mutex> lock(pimpl_->state_mutex);
+            return pimpl_->last_error;
+        }
+
+        void HotplugMonitor::watcher_thread() {
+            alignas(struct inotify_event) char buffer[4096];
+            Impl::Events events;
+
+            while (pimpl_->running) {
+                struct pollfd fds[2] = {{pimpl_->inotify_fd, POLLIN, 0}, {pimpl_->wake_fd, POLLIN, 0}};
+                if (::poll(fds, 2, -1) < 0) {
+                    if (errno != EINTR) {
+                        pimpl_->set_error(std::string("poll error: ") + std::strerror(errno));
+                        break;
+                    }
+                    continue;
+                }
+
+                ssize_t size;
+                while ((size = ::read(pimpl_->inotify_fd, buffer, sizeof(buffer))) > 0) {
+                    for (ssize_t offset = 0; offset < size;) {
+                        const auto *event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+                        pimpl_->handle(*event, events);
+                        offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+                    }
+                }
+
+                if (!events.empty()) {
+                    pimpl_->dispatch(events);
+                    events.clear();
+                }
+            }
+        }
+
+    } // namespace comms
+} // namespace tractor
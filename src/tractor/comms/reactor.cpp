@@ -0,0 +1,677 @@
+#include "tractor/comms/reactor.hpp"
+#include "uring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace tractor {
+    namespace comms {
+
+        namespace {
+            // epoll user data of the wake-up eventfd, port registrations start at 1
+            constexpr uint64_t WAKE_ID = 0;
+
+            // io_uring user data besides the port ids, the poll ahead of a read carries the port id too
+            constexpr uint64_t CANCEL_ID = UINT64_MAX;
+            constexpr uint64_t POLL_FLAG = uint64_t{1} << 63;
+
+            // Port whose callbacks the calling worker runs, its service mutex is already held
+            thread_local const void *serviced_entry = nullptr;
+
+            struct ServiceScope {
+                explicit ServiceScope(const void *entry) { serviced_entry = entry; }
+                ~ServiceScope() { serviced_entry = nullptr; }
+            };
+        } // namespace
+
+        struct SerialReactor::Impl {
+            using Clock = std::chrono::steady_clock;
+
+            struct Entry {
+                Serial *serial = nullptr;
+                uint64_t id = 0;
+                int fd = -1;
+                bool removed = false;
+                bool remove_pending = false; // remove() was called, from the port's callbacks if not yet removed
+                bool idle_reported = false;
+                bool auto_reconnect = false;
+                std::chrono::milliseconds read_timeout{0};
+                Clock::time_point last_activity;
+                Clock::time_point next_reconnect;
+                std::mutex service_mutex; // Held while a worker runs this port's framing and callbacks
+
+                int buffer_index = -1;       // Registered buffer of the io_uring backend, -1 reads into buffer
+                std::vector<uint8_t> buffer; // Read buffer of a port without a registered one
+                uint32_t read_size = 0;
+                bool posted = false; // A read is in the ring, guarded by ring_mutex
+            };
+
+            ReactorOptions options;
+            int epoll_fd = -1;
+            int wake_fd = -1;
+
+            std::atomic<bool> running{false};
+            std::vector<std::thread> workers;
+
+            mutable std::mutex entries_mutex;
+            std::unordered_map<uint64_t, std::shared_ptr<Entry>> entries;
+            uint64_t next_id = WAKE_ID + 1;
+
+            std::mutex timer_mutex;
+            Clock::time_point next_tick;
+
+            mutable std::mutex error_mutex;
+            std::string last_error;
+
+            // io_uring backend, completions are reaped by the single worker only
+            ReactorBackend backend = ReactorBackend::Epoll;
+            std::mutex ring_mutex; // Serializes submissions, guards the members below
+            std::vector<uint8_t> ring_memory;
+            std::vector<int> free_buffers;
+            std::unordered_map<uint64_t, std::shared_ptr<Entry>> ring_entries; // Kept until the last read completed
+            uint64_t wake_value = 0;
+            bool wake_posted = false;
+            uring::Ring ring; // Destroyed first, the kernel may write into the buffers until then
+
+            void set_error(const std::string &error) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                last_error = error;
+            }
+
+            std::shared_ptr<Entry> find(uint64_t id) const {
+                std::lock_guard<std::mutex> lock(entries_mutex);
+                auto it = entries.find(id);
+                return it != entries.end() ? it->second : nullptr;
+            }
+
+            bool arm(Entry &entry, int op) {
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLONESHOT;
+                event.data.u64 = entry.id;
+                if (epoll_ctl(epoll_fd, op, entry.fd, &event) != 0) {
+                    set_error(std::string("Failed to register port: ") + std::strerror(errno));
+                    return false;
+                }
+                return true;
+            }
+
+            uint8_t *read_buffer(Entry &entry) {
+                return entry.buffer_index >= 0
+                           ? ring_memory.data() + static_cast<size_t>(entry.buffer_index) * options.ring_buffer_size
+                           : entry.buffer.data();
+            }
+
+            // Called with ring_mutex held
+            void release_buffer(Entry &entry) {
+                if (entry.buffer_index >= 0) {
+                    free_buffers.push_back(entry.buffer_index);
+                    entry.buffer_index = -1;
+                }
+            }
+
+            bool post(const std::shared_ptr<Entry> &entry) {
+                std::lock_guard<std::mutex> lock(ring_mutex);
+
+                // The poll keeps a terminal without VMIN and VTIME from completing empty reads in a loop
+                bool queued = ring.poll_in(entry->fd, entry->id | POLL_FLAG);
+                if (!queued && ring.submit() >= 0) {
+                    queued = ring.poll_in(entry->fd, entry->id | POLL_FLAG);
+                }
+                if (queued) {
+                    uint8_t *data = read_buffer(*entry);
+                    queued = entry->buffer_index >= 0
+                                 ? ring.read_fixed(entry->fd, data, entry->read_size,
+                                                   static_cast<uint16_t>(entry->buffer_index), entry->id)
+                                 : ring.read(entry->fd, data, entry->read_size, entry->id);
+                }
+                if (!queued) {
+                    set_error("Failed to post read: io_uring submission queue full");
+                    return false;
+                }
+
+                entry->posted = true;
+                return true;
+            }
+
+            bool watch(const std::shared_ptr<Entry> &entry, int op) {
+                return backend == ReactorBackend::IoUring ? post(entry) : arm(*entry, op);
+            }
+
+            // Called with the entry's service mutex held, once the port is marked removed
+            void unwatch(Entry &entry) {
+                if (backend != ReactorBackend::IoUring) {
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, entry.fd, nullptr);
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(ring_mutex);
+                if (!entry.posted) {
+                    release_buffer(entry);
+                    ring_entries.erase(entry.id);
+                    return;
+                }
+
+                // The worker returns the buffer once the cancelled read completes
+                cancel(entry.id);
+                ring.submit();
+            }
+
+            // Called with ring_mutex held. A read still waiting for its poll is only found through the poll
+            void cancel(uint64_t id) {
+                for (uint64_t target : {id | POLL_FLAG, id}) {
+                    if (!ring.cancel(target, CANCEL_ID)) {
+                        ring.submit();
+                        ring.cancel(target, CANCEL_ID);
+                    }
+                }
+            }
+
+            bool open_ring() {
+                // Two entries per posted read plus the eventfd read and cancellations
+                if (!ring.open(static_cast<unsigned>(2 * options.ring_buffers + 16))) {
+                    set_error(std::string("io_uring unavailable, using epoll: ") + std::strerror(errno));
+                    return false;
+                }
+
+                ring_memory.assign(options.ring_buffers * options.ring_buffer_size, 0);
+                std::vector<struct iovec> buffers(options.ring_buffers);
+                for (size_t i = 0; i < buffers.size(); i++) {
+                    buffers[i] = {ring_memory.data() + i * options.ring_buffer_size, options.ring_buffer_size};
+                }
+                if (buffers.empty() || !ring.register_buffers(buffers.data(), static_cast<unsigned>(buffers.size()))) {
+                    // Still usable, every port reads into a buffer of its own
+                    ring_memory.clear();
+                    buffers.clear();
+                }
+                for (size_t i = buffers.size(); i > 0; i--) {
+                    free_buffers.push_back(static_cast<int>(i - 1));
+                }
+                return true;
+            }
+
+            // Cancels whatever is still posted and waits for the kernel to let go of the buffers
+            void drain_ring() {
+                std::unique_lock<std::mutex> lock(ring_mutex);
+                size_t posted = 0;
+                for (auto &[id, entry] : ring_entries) {
+                    if (entry->posted) {
+                        cancel(id);
+                        posted++;
+                    }
+                }
+                if (wake_posted && !ring.cancel(WAKE_ID, CANCEL_ID)) {
+                    ring.submit();
+                    ring.cancel(WAKE_ID, CANCEL_ID);
+                }
+                ring.submit();
+
+                auto deadline = Clock::now() + std::chrono::seconds(1);
+                while ((posted > 0 || wake_posted) && Clock::now() < deadline) {
+                    lock.unlock();
+                    ring.wait(static_cast<int>(options.tick_ms));
+                    lock.lock();
+
+                    uring::Completion completion;
+                    while (ring.next(completion)) {
+                        if (completion.user_data == WAKE_ID) {
+                            wake_posted = false;
+                        } else if (completion.user_data != CANCEL_ID && !(completion.user_data & POLL_FLAG)) {
+                            auto it = ring_entries.find(completion.user_data);
+                            if (it != ring_entries.end() && it->second->posted) {
+                                it->second->posted = false;
+                                posted--;
+                            }
+                        }
+                    }
+                }
+                ring.close();
+            }
+
+            // Called with the entry's service mutex held once its Serial lost the port
+            void port_lost(Entry &entry, Clock::time_point now) {
+                entry.fd = -1;
+                entry.next_reconnect = now + entry.serial->reactor_reconnect_delay();
+            }
+
+            // Called with the entry's service mutex held, outside of the port's callbacks
+            bool finish_remove(Entry &entry) {
+                if (!entry.remove_pending || entry.removed) {
+                    return false;
+                }
+                entry.removed = true;
+                if (entry.fd >= 0 || backend == ReactorBackend::IoUring) {
+                    unwatch(entry);
+                    entry.fd = -1;
+                }
+                entry.serial->reactor_detach();
+                return true;
+            }
+
+            // Called with the entry's service mutex held
+            void service_timer(const std::shared_ptr<Entry> &entry, Clock::time_point now) {
+                if (entry->fd < 0) {
+                    // A matching device that just appeared is retried right away instead of after the delay
+                    if (!entry->auto_reconnect || (now < entry->next_reconnect && !entry->serial->reactor_hotplug())) {
+                        return;
+                    }
+                    if (!entry->serial->reactor_reconnect()) {
+                        entry->next_reconnect = now + entry->serial->reactor_reconnect_delay();
+                        return;
+                    }
+                    entry->fd = entry->serial->reactor_fd();
+                    entry->last_activity = now;
+                    entry->idle_reported = false;
+                    if (entry->fd < 0 || !watch(entry, EPOLL_CTL_ADD)) {
+                        entry->serial->reactor_error();
+                        port_lost(*entry, now);
+                    }
+                    return;
+                }
+
+                if (!entry->idle_reported && now - entry->last_activity >= entry->read_timeout) {
+                    entry->serial->reactor_idle();
+                    entry->idle_reported = true;
+                }
+            }
+        };
+
+        SerialReactor::SerialReactor(const ReactorOptions &options) : pimpl_(std::make_unique<Impl>()) {
+            pimpl_->options = options;
+            pimpl_->options.threads = std::max<size_t>(options.threads, 1);
+            pimpl_->options.tick_ms = std::max<uint32_t>(options.tick_ms, 1);
+            pimpl_->options.max_events = std::max<size_t>(options.max_events, 1);
+
+            pimpl_->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if (pimpl_->epoll_fd < 0) {
+                pimpl_->set_error(std::string("Failed to create epoll instance: ") + std::strerror(errno));
+                return;
+            }
+
+            pimpl_->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (pimpl_->wake_fd < 0) {
+                pimpl_->set_error(std::string("Failed to create eventfd: ") + std::strerror(errno));
+                return;
+            }
+
+            // Level triggered and never drained, so once signalled every worker wakes up and sees the stop
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = WAKE_ID;
+            if (epoll_ctl(pimpl_->epoll_fd, EPOLL_CTL_ADD, pimpl_->wake_fd, &event) != 0) {
+                pimpl_->set_error(std::string("Failed to register eventfd: ") + std::strerror(errno));
+            }
+
+            if (options.backend == ReactorBackend::IoUring && pimpl_->open_ring()) {
+                pimpl_->backend = ReactorBackend::IoUring;
+            }
+        }
+
+        SerialReactor::~SerialReactor() {
+            stop();
+
+            std::vector<std::shared_ptr<Impl::Entry>> remaining;
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->entries_mutex);
+                for (auto &[id, entry] : pimpl_->entries) {
+                    remaining.push_back(entry);
+                }
+                pimpl_->entries.clear();
+            }
+            for (auto &entry : remaining) {
+                std::lock_guard<std::mutex> service_lock(entry->service_mutex);
+                entry->removed = true;
+                entry->serial->reactor_detach();
+            }
+
+            if (pimpl_->backend == ReactorBackend::IoUring) {
+                pimpl_->drain_ring();
+            }
+
+            if (pimpl_->wake_fd >= 0) {
+                ::close(pimpl_->wake_fd);
+            }
+            if (pimpl_->epoll_fd >= 0) {
+                ::close(pimpl_->epoll_fd);
+            }
+        }
+
+        bool SerialReactor::add(Serial &serial) {
+            if (pimpl_->epoll_fd < 0) {
+                return false;
+            }
+
+            if (!serial.reactor_attach(this)) {
+                pimpl_->set_error("Failed to attach serial port: " + serial.get_options().port);
+                return false;
+            }
+
+            auto options = serial.get_options();
+            auto entry = std::make_shared<Impl::Entry>();
+            entry->serial = &serial;
+            entry->auto_reconnect = options.auto_reconnect;
+            entry->read_timeout = std::chrono::milliseconds(options.tty_config.read_timeout_ms);
+            entry->last_activity = Impl::Clock::now();
+            entry->read_size = static_cast<uint32_t>(std::min<size_t>(serial.reactor_chunk_size(), UINT32_MAX));
+
+            std::lock_guard<std::mutex> service_lock(entry->service_mutex);
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->entries_mutex);
+                entry->id = pimpl_->next_id++;
+                pimpl_->entries.emplace(entry->id, entry);
+            }
+
+            if (pimpl_->backend == ReactorBackend::IoUring) {
+                std::lock_guard<std::mutex> lock(pimpl_->ring_mutex);
+                if (entry->read_size <= pimpl_->options.ring_buffer_size && !pimpl_->free_buffers.empty()) {
+                    entry->buffer_index = pimpl_->free_buffers.back();
+                    pimpl_->free_buffers.pop_back();
+                } else {
+                    entry->buffer.resize(entry->read_size);
+                }
+                pimpl_->ring_entries.emplace(entry->id, entry);
+            }
+
+            entry->fd = serial.reactor_fd();
+            if (entry->fd >= 0 && !pimpl_->watch(entry, EPOLL_CTL_ADD)) {
+                serial.reactor_error();
+                pimpl_->port_lost(*entry, Impl::Clock::now());
+            } else if (entry->fd < 0) {
+                pimpl_->port_lost(*entry, Impl::Clock::now());
+            }
+
+            // The worker may be waiting for a while, hand the new read to the kernel now
+            if (pimpl_->backend == ReactorBackend::IoUring) {
+                std::lock_guard<std::mutex> lock(pimpl_->ring_mutex);
+                pimpl_->ring.submit();
+            }
+
+            return true;
+        }
+
+        void SerialReactor::remove(Serial &serial) {
+            std::shared_ptr<Impl::Entry> entry;
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->entries_mutex);
+                auto it = std::find_if(pimpl_->entries.begin(), pimpl_->entries.end(),
+                                       [&](const auto &item) { return item.second->serial == &serial; });
+                if (it == pimpl_->entries.end()) {
+                    return;
+                }
+                entry = it->second;
+                pimpl_->entries.erase(it);
+            }
+
+            // From the port's own callbacks, the worker finishes the removal once they returned
+            if (serviced_entry == entry.get()) {
+                entry->remove_pending = true;
+                return;
+            }
+
+            std::lock_guard<std::mutex> service_lock(entry->service_mutex);
+            entry->remove_pending = true;
+            pimpl_->finish_remove(*entry);
+        }
+
+        bool SerialReactor::start() {
+            if (pimpl_->running) {
+                return true;
+            }
+
+            if (pimpl_->epoll_fd < 0 || pimpl_->wake_fd < 0) {
+                return false;
+            }
+
+            // Drain a wake-up left over from a previous stop()
+            uint64_t value;
+            while (::read(pimpl_->wake_fd, &value, sizeof(value)) > 0) {
+            }
+
+            pimpl_->next_tick = Impl::Clock::now();
+            pimpl_->running = true;
+            if (pimpl_->backend == ReactorBackend::IoUring) {
+                std::lock_guard<std::mutex> lock(pimpl_->ring_mutex);
+                if (!pimpl_->wake_posted) {
+                    pimpl_->wake_posted =
+                        pimpl_->ring.read(pimpl_->wake_fd, &pimpl_->wake_value, sizeof(pimpl_->wake_value), WAKE_ID);
+                    pimpl_->ring.submit();
+                }
+                pimpl_->workers.emplace_back(&SerialReactor::ring_worker, this);
+                return true;
+            }
+
+            for (size_t i = 0; i < pimpl_->options.threads; i++) {
+                pimpl_->workers.emplace_back(&SerialReactor::worker, this);
+            }
+
+            return true;
+        }
+
+        void SerialReactor::stop() {
+            if (!pimpl_->running) {
+                return;
+            }
+
+            pimpl_->running = false;
+
+            uint64_t value = 1;
+            if (::write(pimpl_->wake_fd, &value, sizeof(value)) < 0) {
+                // Workers still notice the stop on their next tick
+            }
+
+            for (auto &worker : pimpl_->workers) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+            pimpl_->workers.clear();
+        }
+
+        bool SerialReactor::is_running() const { return pimpl_->running; }
+
+        size_t SerialReactor::size() const {
+            std::lock_guard<std::mutex> lock(pimpl_->entries_mutex);
+            return pimpl_->entries.size();
+        }
+
+        ReactorBackend SerialReactor::get_backend() const { return pimpl_->backend; }
+
+        std::string SerialReactor::get_last_error() const {
+            std::lock_guard<std::mutex> lock(pimpl_->error_mutex);
+            return pimpl_->last_error;
+        }
+
+        void SerialReactor::worker() {
+            std::vector<epoll_event> events(pimpl_->options.max_events);
+
+            while (pimpl_->running) {
+                auto now = Impl::Clock::now();
+                int timeout_ms = 0;
+                {
+                    std::lock_guard<std::mutex> lock(pimpl_->timer_mutex);
+                    if (pimpl_->next_tick > now) {
+                        timeout_ms = static_cast<int>(
+                            std::chrono::ceil<std::chrono::milliseconds>(pimpl_->next_tick - now).count());
+                    }
+                }
+
+                int count = epoll_wait(pimpl_->epoll_fd, events.data(), static_cast<int>(events.size()), timeout_ms);
+                if (count < 0) {
+                    if (errno != EINTR) {
+                        pimpl_->set_error(std::string("epoll_wait error: ") + std::strerror(errno));
+                        std::this_thread::sleep_for(std::chrono::milliseconds(pimpl_->options.tick_ms));
+                    }
+                    continue;
+                }
+
+                for (int i = 0; i < count && pimpl_->running; i++) {
+                    if (events[i].data.u64 == WAKE_ID) {
+                        continue;
+                    }
+
+                    auto entry = pimpl_->find(events[i].data.u64);
+                    if (!entry) {
+                        continue;
+                    }
+
+                    std::lock_guard<std::mutex> service_lock(entry->service_mutex);
+                    if (entry->removed || entry->fd < 0) {
+                        continue;
+                    }
+
+                    bool alive = true;
+                    {
+                        ServiceScope scope(entry.get());
+                        if (events[i].events & EPOLLIN) {
+                            alive = entry->serial->reactor_read();
+                        }
+                        if (alive && (events[i].events & (EPOLLHUP | EPOLLERR))) {
+                            entry->serial->reactor_error();
+                            alive = false;
+                        }
+                    }
+                    if (pimpl_->finish_remove(*entry)) {
+                        continue;
+                    }
+
+                    now = Impl::Clock::now();
+                    if (alive) {
+                        entry->last_activity = now;
+                        entry->idle_reported = false;
+                        alive = pimpl_->watch(entry, EPOLL_CTL_MOD);
+                        if (!alive) {
+                            entry->serial->reactor_error();
+                        }
+                    }
+                    if (!alive) {
+                        pimpl_->port_lost(*entry, now);
+                    }
+                }
+
+                service_timers();
+            }
+        }
+
+        void SerialReactor::ring_worker() {
+            while (pimpl_->running) {
+                auto now = Impl::Clock::now();
+                int timeout_ms = 0;
+                {
+                    std::lock_guard<std::mutex> lock(pimpl_->timer_mutex);
+                    if (pimpl_->next_tick > now) {
+                        timeout_ms = static_cast<int>(
+                            std::chrono::ceil<std::chrono::milliseconds>(pimpl_->next_tick - now).count());
+                    }
+                }
+
+                // Submits the reads posted since the last round and reaps what completed in the same call
+                int result = pimpl_->ring.wait(timeout_ms);
+                if (result < 0 && result != -EINTR) {
+                    pimpl_->set_error(std::string("io_uring_enter error: ") + std::strerror(-result));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(pimpl_->options.tick_ms));
+                    continue;
+                }
+
+                uring::Completion completion;
+                while (pimpl_->running && pimpl_->ring.next(completion)) {
+                    if (completion.user_data == WAKE_ID) {
+                        std::lock_guard<std::mutex> lock(pimpl_->ring_mutex);
+                        pimpl_->wake_posted = pimpl_->running && pimpl_->ring.read(pimpl_->wake_fd, &pimpl_->wake_value,
+                                                                                   sizeof(pimpl_->wake_value), WAKE_ID);
+                        continue;
+                    }
+                    if (completion.user_data == CANCEL_ID || (completion.user_data & POLL_FLAG)) {
+                        continue;
+                    }
+
+                    std::shared_ptr<Impl::Entry> entry;
+                    {
+                        std::lock_guard<std::mutex> lock(pimpl_->ring_mutex);
+                        auto it = pimpl_->ring_entries.find(completion.user_data);
+                        if (it == pimpl_->ring_entries.end()) {
+                            continue;
+                        }
+                        entry = it->second;
+                        entry->posted = false;
+                    }
+
+                    std::lock_guard<std::mutex> service_lock(entry->service_mutex);
+                    if (entry->removed) {
+                        std::lock_guard<std::mutex> lock(pimpl_->ring_mutex);
+                        pimpl_->release_buffer(*entry);
+                        pimpl_->ring_entries.erase(entry->id);
+                        continue;
+                    }
+                    if (entry->fd < 0) {
+                        continue;
+                    }
+
+                    bool alive = false;
+                    {
+                        ServiceScope scope(entry.get());
+                        alive = entry->serial->reactor_chunk(pimpl_->read_buffer(*entry), completion.result);
+                    }
+                    if (pimpl_->finish_remove(*entry)) {
+                        continue;
+                    }
+
+                    now = Impl::Clock::now();
+                    if (alive) {
+                        entry->last_activity = now;
+                        entry->idle_reported = false;
+                        alive = pimpl_->post(entry);
+                        if (!alive) {
+                            entry->serial->reactor_error();
+                        }
+                    }
+                    if (!alive) {
+                        pimpl_->port_lost(*entry, now);
+                    }
+                }
+
+                service_timers();
+            }
+        }
+
+        void SerialReactor::service_timers() {
+            std::unique_lock<std::mutex> timer_lock(pimpl_->timer_mutex, std::try_to_lock);
+            auto now = Impl::Clock::now();
+            if (!timer_lock.owns_lock() || now < pimpl_->next_tick) {
+                return;
+            }
+            pimpl_->next_tick = now + std::chrono::milliseconds(pimpl_->options.tick_ms);
+
+            std::vector<std::shared_ptr<Impl::Entry>> snapshot;
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->entries_mutex);
+                snapshot.reserve(pimpl_->entries.size());
+                for (auto &[id, entry] : pimpl_->entries) {
+                    snapshot.push_back(entry);
+                }
+            }
+            timer_lock.unlock();
+
+            for (auto &entry : snapshot) {
+                // A busy port is being serviced right now and needs no timer work
+                std::unique_lock<std::mutex> service_lock(entry->service_mutex, std::try_to_lock);
+                if (!service_lock.owns_lock() || entry->removed) {
+                    continue;
+                }
+                {
+                    ServiceScope scope(entry.get());
+                    pimpl_->service_timer(entry, now);
+                }
+                pimpl_->finish_remove(*entry);
+            }
+        }
+
+    } // namespace comms
+} // namespace tractor
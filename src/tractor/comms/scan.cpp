@@ -0,0 +1,295 @@
+#include "tractor/comms/scan.hpp"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TRACTOR_SCAN_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define TRACTOR_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace tractor {
+    namespace comms {
+
+        namespace {
+
+            // Scalar kernels, also used for the tails the vector kernels leave over
+
+            const uint8_t *find_byte_scalar(const uint8_t *data, size_t size, uint8_t value) {
+                for (size_t i = 0; i < size; i++) {
+                    if (data[i] == value) {
+                        return data + i;
+                    }
+                }
+                return nullptr;
+            }
+
+            uint8_t xor_bytes_scalar(const uint8_t *data, size_t size) {
+                uint64_t acc = 0;
+                size_t i = 0;
+                for (; i + sizeof(acc) <= size; i += sizeof(acc)) {
+                    uint64_t word;
+                    std::memcpy(&word, data + i, sizeof(word));
+                    acc ^= word;
+                }
+                acc ^= acc >> 32;
+                acc ^= acc >> 16;
+                acc ^= acc >> 8;
+
+                auto result = static_cast<uint8_t>(acc);
+                for (; i < size; i++) {
+                    result ^= data[i];
+                }
+                return result;
+            }
+
+#if defined(TRACTOR_SCAN_X86)
+            const uint8_t *find_byte_sse2(const uint8_t *data, size_t size, uint8_t value) {
+                const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+                size_t i = 0;
+                for (; i + 16 <= size; i += 16) {
+                    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+                    if (mask != 0) {
+                        return data + i + __builtin_ctz(static_cast<unsigned>(mask));
+                    }
+                }
+                return find_byte_scalar(data + i, size - i, value);
+            }
+
+            uint8_t fold_xor_128(__m128i acc) {
+                acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+                acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+                acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+                acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+                return static_cast<uint8_t>(_mm_cvtsi128_si32(acc));
+            }
+
+            uint8_t xor_bytes_sse2(const uint8_t *data, size_t size) {
+                __m128i acc = _mm_setzero_si128();
+                size_t i = 0;
+                for (; i + 16 <= size; i += 16) {
+                    acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+                }
+                return fold_xor_128(acc) ^ xor_bytes_scalar(data + i, size - i);
+            }
+
+            __attribute__((target("avx2"))) const uint8_t *find_byte_avx2(const uint8_t *data, size_t size,
+                                                                          uint8_t value) {
+                const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+                size_t i = 0;
+                for (; i + 64 <= size; i += 64) {
+                    __m256i low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)),
+                                                    needle);
+                    __m256i high = _mm256_cmpeq_epi8(
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32)), needle);
+                    if (_mm256_movemask_epi8(_mm256_or_si256(low, high)) != 0) {
+                        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(low));
+                        if (mask != 0) {
+                            return data + i + __builtin_ctz(mask);
+                        }
+                        mask = static_cast<uint32_t>(_mm256_movemask_epi8(high));
+                        return data + i + 32 + __builtin_ctz(mask);
+                    }
+                }
+                for (; i + 32 <= size; i += 32) {
+                    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+                    if (mask != 0) {
+                        return data + i + __builtin_ctz(mask);
+                    }
+                }
+                return find_byte_sse2(data + i, size - i, value);
+            }
+
+            __attribute__((target("avx2"))) uint8_t xor_bytes_avx2(const uint8_t *data, size_t size) {
+                __m256i acc = _mm256_setzero_si256();
+                size_t i = 0;
+                for (; i + 32 <= size; i += 32) {
+                    acc = _mm256_xor_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+                }
+                __m128i folded = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+                return fold_xor_128(folded) ^ xor_bytes_sse2(data + i, size - i);
+            }
+#endif
+
+#if defined(TRACTOR_SCAN_NEON)
+            const uint8_t *find_byte_neon(const uint8_t *data, size_t size, uint8_t value) {
+                const uint8x16_t needle = vdupq_n_u8(value);
+                size_t i = 0;
+                for (; i + 16 <= size; i += 16) {
+                    uint8x16_t matches = vceqq_u8(vld1q_u8(data + i), needle);
+                    // Narrow every byte lane to a nibble so the match mask fits one 64-bit register
+                    uint64_t mask =
+                        vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+                    if (mask != 0) {
+                        return data + i + (__builtin_ctzll(mask) >> 2);
+                    }
+                }
+                return find_byte_scalar(data + i, size - i, value);
+            }
+
+            uint8_t xor_bytes_neon(const uint8_t *data, size_t size) {
+                uint8x16_t acc = vdupq_n_u8(0);
+                size_t i = 0;
+                for (; i + 16 <= size; i += 16) {
+                    acc = veorq_u8(acc, vld1q_u8(data + i));
+                }
+                uint64x2_t wide = vreinterpretq_u64_u8(acc);
+                uint64_t folded = vgetq_lane_u64(wide, 0) ^ vgetq_lane_u64(wide, 1);
+                folded ^= folded >> 32;
+                folded ^= folded >> 16;
+                folded ^= folded >> 8;
+                return static_cast<uint8_t>(folded) ^ xor_bytes_scalar(data + i, size - i);
+            }
+#endif
+
+            struct Kernels {
+                SimdLevel level;
+                const uint8_t *(*find_byte)(const uint8_t *, size_t, uint8_t);
+                uint8_t (*xor_bytes)(const uint8_t *, size_t);
+            };
+
+            constexpr Kernels SCALAR_KERNELS{SimdLevel::Scalar, find_byte_scalar, xor_bytes_scalar};
+#if defined(TRACTOR_SCAN_X86)
+            constexpr Kernels SSE2_KERNELS{SimdLevel::SSE2, find_byte_sse2, xor_bytes_sse2};
+            constexpr Kernels AVX2_KERNELS{SimdLevel::AVX2, find_byte_avx2, xor_bytes_avx2};
+#endif
+#if defined(TRACTOR_SCAN_NEON)
+            constexpr Kernels NEON_KERNELS{SimdLevel::NEON, find_byte_neon, xor_bytes_neon};
+#endif
+
+            SimdLevel detect_simd_level() {
+#if defined(TRACTOR_SCAN_X86)
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#elif defined(TRACTOR_SCAN_NEON)
+                return SimdLevel::NEON;
+#else
+                return SimdLevel::Scalar;
+#endif
+            }
+
+            const Kernels *kernels_for(SimdLevel level) {
+                switch (level) {
+#if defined(TRACTOR_SCAN_X86)
+                case SimdLevel::AVX2:
+                    return detected_simd_level() == SimdLevel::AVX2 ? &AVX2_KERNELS : nullptr;
+                case SimdLevel::SSE2:
+                    return &SSE2_KERNELS;
+#endif
+#if defined(TRACTOR_SCAN_NEON)
+                case SimdLevel::NEON:
+                    return &NEON_KERNELS;
+#endif
+                case SimdLevel::Scalar:
+                    return &SCALAR_KERNELS;
+                default:
+                    return nullptr;
+                }
+            }
+
+            std::atomic<const Kernels *> &active_kernels() {
+                static std::atomic<const Kernels *> active{kernels_for(detected_simd_level())};
+                return active;
+            }
+
+        } // namespace
+
+        SimdLevel detected_simd_level() {
+            static const SimdLevel level = detect_simd_level();
+            return level;
+        }
+
+        SimdLevel simd_level() { return active_kernels().load(std::memory_order_relaxed)->level; }
+
+        SimdLevel set_simd_level(SimdLevel level) {
+            const Kernels *kernels = kernels_for(level);
+            if (kernels == nullptr) {
+                kernels = kernels_for(detected_simd_level());
+            }
+            active_kernels().store(kernels, std::memory_order_relaxed);
+            return kernels->level;
+        }
+
+        const char *simd_level_name(SimdLevel level) {
+            switch (level) {
+            case SimdLevel::Scalar:
+                return "scalar";
+            case SimdLevel::SSE2:
+                return "sse2";
+            case SimdLevel::AVX2:
+                return "avx2";
+            case SimdLevel::NEON:
+                return "neon";
+            }
+            return "unknown";
+        }
+
+        const uint8_t *find_byte(const uint8_t *data, size_t size, uint8_t value) {
+            if (data == nullptr || size == 0) {
+                return nullptr;
+            }
+            return active_kernels().load(std::memory_order_relaxed)->find_byte(data, size, value);
+        }
+
+        uint8_t xor_bytes(const uint8_t *data, size_t size) {
+            if (data == nullptr || size == 0) {
+                return 0;
+            }
+            return active_kernels().load(std::memory_order_relaxed)->xor_bytes(data, size);
+        }
+
+        uint8_t nmea_checksum(std::string_view sentence) {
+            auto data = reinterpret_cast<const uint8_t *>(sentence.data());
+            size_t size = sentence.size();
+            if (size > 0 && (data[0] == '$' || data[0] == '!')) {
+                data++;
+                size--;
+            }
+
+            const uint8_t *star = find_byte(data, size, '*');
+            if (star != nullptr) {
+                size = static_cast<size_t>(star - data);
+            }
+            return xor_bytes(data, size);
+        }
+
+        bool nmea_checksum_valid(std::string_view sentence) {
+            auto data = reinterpret_cast<const uint8_t *>(sentence.data());
+            const uint8_t *star = find_byte(data, sentence.size(), '*');
+            if (star == nullptr) {
+                return false;
+            }
+
+            size_t star_pos = static_cast<size_t>(star - data);
+            if (star_pos + 2 >= sentence.size()) {
+                return false;
+            }
+
+            auto hex_value = [](char c) -> int {
+                if (c >= '0' && c <= '9') {
+                    return c - '0';
+                }
+                if (c >= 'A' && c <= 'F') {
+                    return c - 'A' + 10;
+                }
+                if (c >= 'a' && c <= 'f') {
+                    return c - 'a' + 10;
+                }
+                return -1;
+            };
+
+            int high = hex_value(sentence[star_pos + 1]);
+            int low = hex_value(sentence[star_pos + 2]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+
+            return nmea_checksum(sentence.substr(0, star_pos)) == ((high << 4) | low);
+        }
+
+    } // namespace comms
+} // namespace tractor
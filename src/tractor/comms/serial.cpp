@@ -1,39 +1,340 @@
 #include "tractor/comms/serial.hpp"
+#include "tractor/comms/reactor.hpp"
+#include "tractor/comms/scan.hpp"
+#include "tractor/trace.hpp"
 #include <algorithm>
 #include <atomic>
+#include <bit>
+#include <cerrno>
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <mutex>
+#include <random>
+#include <sys/uio.h>
 #include <thread>
 
 namespace tractor {
     namespace comms {
 
+        namespace {
+            using Clock = std::chrono::steady_clock;
+
+            // Only used for values with a single writer, a concurrent reset may be overwritten
+            void raise_to(std::atomic<uint64_t> &target, uint64_t value) {
+                if (value > target.load(std::memory_order_relaxed)) {
+                    target.store(value, std::memory_order_relaxed);
+                }
+            }
+
+            uint64_t elapsed_ns(Clock::time_point from, Clock::time_point to) {
+                return to > from ? static_cast<uint64_t>(
+                                       std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count())
+                                 : 0;
+            }
+
+            /**
+             * Bounded frame queue between the reader (single producer) and the dispatcher thread.
+             *
+             * Every slot carries a sequence number telling whether it is free for position pos
+             * (sequence == pos) or holds the frame of position pos (sequence == pos + 1), so producer and
+             * consumer never share a lock. With OverflowPolicy::DropOldest the producer also claims frames
+             * from the consumer side, which is why the tail is advanced with compare-and-swap. Slots hold
+             * handles to buffers of the port's FramePool; the dispatcher moves the handle out of its slot
+             * before running callbacks, so a slow callback never pins a slot and nothing is allocated per
+             * frame.
+             */
+            class FrameQueue {
+              public:
+                FrameQueue(size_t depth, OverflowPolicy policy, FramePool &pool)
+                    : capacity_(std::max<size_t>(depth, 1)), policy_(policy), pool_(pool), slots_(new Slot[capacity_]) {
+                    for (size_t i = 0; i < capacity_; i++) {
+                        slots_[i].sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                // Producer side, returns false if the new frame was dropped; dropped counts every discarded frame
+                bool push(const uint8_t *data, size_t size, const FrameInfo &info, uint64_t &dropped) {
+                    Slot &slot = slots_[head_ % capacity_];
+                    for (int attempt = 0; slot.sequence.load() != head_; attempt++) {
+                        if (policy_ == OverflowPolicy::DropNewest || stopping_.load(std::memory_order_relaxed)) {
+                            dropped++;
+                            return false;
+                        }
+
+                        if (policy_ == OverflowPolicy::Block) {
+                            uint32_t signal = space_signal_.load();
+                            if (slot.sequence.load() != head_ && !stopping_.load()) {
+                                space_signal_.wait(signal);
+                            }
+                            continue;
+                        }
+
+                        // DropOldest: discard the head of the queue, which frees our slot unless the
+                        // dispatcher is swapping it out right now
+                        if (drop_oldest()) {
+                            dropped++;
+                        } else if (attempt > 64) {
+                            dropped++;
+                            return false;
+                        } else {
+                            std::this_thread::yield();
+                        }
+                    }
+
+                    slot.frame = pool_.acquire(std::span<const uint8_t>(data, size));
+                    if (!slot.frame) {
+                        dropped++;
+                        return false;
+                    }
+                    slot.info = info;
+                    slot.sequence.store(head_ + 1);
+                    head_++;
+
+                    data_signal_.fetch_add(1);
+                    data_signal_.notify_one();
+                    return true;
+                }
+
+                // Consumer side, moves the oldest frame into the caller's handle
+                bool pop(Frame &frame, FrameInfo &info) {
+                    size_t pos = tail_.load(std::memory_order_relaxed);
+                    for (;;) {
+                        Slot &slot = slots_[pos % capacity_];
+                        auto diff = static_cast<std::ptrdiff_t>(slot.sequence.load() - (pos + 1));
+                        if (diff < 0) {
+                            return false;
+                        }
+                        if (diff > 0) {
+                            pos = tail_.load(std::memory_order_relaxed);
+                            continue;
+                        }
+                        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            frame = std::move(slot.frame);
+                            info = slot.info;
+                            slot.sequence.store(pos + capacity_);
+                            if (policy_ == OverflowPolicy::Block) {
+                                space_signal_.fetch_add(1);
+                                space_signal_.notify_one();
+                            }
+                            return true;
+                        }
+                    }
+                }
+
+                // Consumer side, sleeps until a frame was pushed after `signal` was read or stop() was called
+                uint32_t signal() const { return data_signal_.load(); }
+                void wait(uint32_t signal) const { data_signal_.wait(signal); }
+
+                bool is_stopping() const { return stopping_.load(); }
+
+                void stop() {
+                    stopping_.store(true);
+                    for (auto *signal : {&data_signal_, &space_signal_}) {
+                        signal->fetch_add(1);
+                        signal->notify_all();
+                    }
+                }
+
+              private:
+                struct Slot {
+                    std::atomic<size_t> sequence{0};
+                    FrameInfo info;
+                    Frame frame;
+                };
+
+                bool drop_oldest() {
+                    size_t pos = tail_.load(std::memory_order_relaxed);
+                    Slot &slot = slots_[pos % capacity_];
+                    if (slot.sequence.load() != pos + 1 ||
+                        !tail_.compare_exchange_strong(pos, pos + 1, std::memory_order_relaxed)) {
+                        return false;
+                    }
+                    slot.frame.reset();
+                    slot.sequence.store(pos + capacity_);
+                    return true;
+                }
+
+                const size_t capacity_;
+                const OverflowPolicy policy_;
+                FramePool &pool_;
+                std::unique_ptr<Slot[]> slots_;
+
+                alignas(64) size_t head_ = 0; // Only touched by the producer
+                alignas(64) std::atomic<size_t> tail_{0};
+                alignas(64) mutable std::atomic<uint32_t> data_signal_{0};
+                mutable std::atomic<uint32_t> space_signal_{0};
+                std::atomic<bool> stopping_{false};
+            };
+        } // namespace
+
         struct Serial::Impl {
+            /**
+             * Bytes queued by write_async(), written out by writer_thread. head and tail count bytes
+             * ever queued and ever completed, the ring offset is the count modulo the ring size.
+             */
+            struct WriteQueue {
+                struct Pending {
+                    uint64_t end = 0; // Value of head right after this write was queued
+                    WriteCallback callback;
+                };
+
+                std::mutex mutex;
+                std::condition_variable wake;
+                std::condition_variable drained;
+                std::thread thread;
+                bool stopping = false;
+
+                std::vector<uint8_t> ring;
+                uint64_t head = 0;
+                uint64_t tail = 0;
+
+                std::vector<Pending> pending;
+                size_t pending_head = 0;
+                size_t pending_tail = 0;
+                std::vector<std::pair<WriteCallback, bool>> completed; // Run outside the lock
+            };
+
+            /**
+             * Statistics counters, updated with relaxed atomics so neither the reader nor a monitoring
+             * thread ever blocks. Receive side counters have a single writer (the reader thread or the
+             * reactor worker servicing the port) and live on their own cache line.
+             */
+            struct Counters {
+                alignas(64) std::atomic<uint64_t> lines_received{0};
+                std::atomic<uint64_t> bytes_received{0};
+                std::atomic<uint64_t> frames_received{0};
+                std::atomic<uint64_t> callback_time_ns{0};
+                std::atomic<uint64_t> max_callback_time_ns{0};
+                std::atomic<uint64_t> buffer_high_water_mark{0};
+                std::atomic<uint64_t> chunk_high_water_mark{0};
+                std::atomic<uint64_t> frames_dropped{0};
+                std::array<std::atomic<uint64_t>, Statistics::LATENCY_BUCKETS> latency_histogram{};
+
+                alignas(64) std::atomic<uint64_t> bytes_sent{0};
+                std::atomic<uint64_t> errors{0};
+                std::atomic<uint64_t> reconnects{0};
+                std::atomic<Clock::rep> since{Clock::now().time_since_epoch().count()};
+
+                void reset() {
+                    for (auto *counter : {&lines_received, &bytes_received, &frames_received, &callback_time_ns,
+                                          &max_callback_time_ns, &buffer_high_water_mark, &chunk_high_water_mark,
+                                          &frames_dropped, &bytes_sent, &errors, &reconnects}) {
+                        counter->store(0, std::memory_order_relaxed);
+                    }
+                    for (auto &bucket : latency_histogram) {
+                        bucket.store(0, std::memory_order_relaxed);
+                    }
+                    since.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+                }
+            };
+
+
             SerialOptions options;
             std::unique_ptr<Tty> tty;
 
             std::atomic<bool> running{false};
             std::atomic<bool> connected{false};
             std::thread reader_thread;
+            std::thread dispatcher_thread;
+            std::unique_ptr<FrameQueue> queue; // Set while DispatchMode::Queued is active
+            SerialReactor *reactor = nullptr; // Set while a reactor services this port instead of reader_thread
 
             mutable std::mutex write_mutex;
             mutable std::mutex callback_mutex;
-            mutable std::mutex stats_mutex;
 
             LineCallback line_callback;
             DataCallback data_callback;
+            LineViewCallback line_view_callback;
+            DataViewCallback data_view_callback;
+            LineInfoCallback line_info_callback;
+            DataInfoCallback data_info_callback;
+            FrameCallback frame_callback;
             ConnectionCallback connection_callback;
             ErrorCallback error_callback;
 
-            Statistics stats;
+            Counters stats;
+
+            std::vector<uint8_t> rx_chunk;  // Scratch buffer filled by one read() call
+            std::string read_buffer;        // Bytes of the frame currently being assembled
+            size_t pending_length = 0;      // LengthPrefixed: payload size announced by the prefix, 0 if none
+            Clock::time_point chunk_time;   // When the chunk being framed was read
+            Clock::time_point frame_start;  // When the first byte of the frame in read_buffer was read
+            Clock::time_point chunk_floor;  // No byte of the current chunk arrived before this
+            uint64_t frame_sequence = 0;    // Frames framed so far
+            size_t last_chunk_size = 0;     // Size of the chunk read before the current one
+            double byte_time_ns = 0.0;      // Wire time of one character at the configured format
+
+            // Reused storage handed to the copying callbacks, so they do not allocate once warmed up
+            std::string line_scratch;
+            std::vector<uint8_t> data_scratch;
+            std::string tx_scratch; // Guarded by write_mutex
+
+            // Buffers of on_frame() and the dispatch queue, created under callback_mutex and kept from then on
+            std::unique_ptr<FramePool> frame_pool;
+            std::atomic<const FramePool *> frame_pool_view{nullptr}; // For get_statistics()
+
+            WriteQueue writes;
+
+            std::shared_ptr<CaptureWriter> capture; // Receives every chunk read while set
+            uint16_t capture_channel = 0;
 
-            std::string read_buffer;
+            // Wakes a reconnect wait early when the device reappears
+            std::mutex reconnect_mutex;
+            std::condition_variable reconnect_wake;
+            std::atomic<bool> hotplug_pending{false};
+            size_t hotplug_subscription = 0; // HotplugMonitor::shared() subscription, 0 if none
+            uint32_t reconnect_attempts = 0; // Failed attempts since the port was last connected
+            std::minstd_rand jitter{std::random_device{}()};
 
             ~Impl() {
                 if (reader_thread.joinable()) {
                     reader_thread.join();
                 }
+                if (dispatcher_thread.joinable()) {
+                    dispatcher_thread.join();
+                }
+                if (writes.thread.joinable()) {
+                    writes.thread.join();
+                }
+            }
+
+            // Called with callback_mutex held, sized for the longest frame any framing mode delivers
+            FramePool &ensure_frame_pool() {
+                if (!frame_pool) {
+                    size_t frame_size = std::max({options.max_line_length, options.fixed_length, size_t{255}});
+                    frame_pool = std::make_unique<FramePool>(frame_size, std::max<size_t>(options.frame_pool_size, 1));
+                    frame_pool_view.store(frame_pool.get(), std::memory_order_release);
+                }
+                return *frame_pool;
+            }
+
+            void count(std::atomic<uint64_t> &counter, uint64_t amount = 1) {
+                counter.fetch_add(amount, std::memory_order_relaxed);
+            }
+
+            void record_delivery(Clock::time_point first_byte, Clock::time_point start, Clock::time_point end) {
+                uint64_t latency_us = elapsed_ns(first_byte, start) / 1000;
+                size_t bucket = latency_us == 0 ? 0 : static_cast<size_t>(std::bit_width(latency_us)) - 1;
+                count(stats.latency_histogram[std::min(bucket, Statistics::LATENCY_BUCKETS - 1)]);
+
+                uint64_t callback_ns = elapsed_ns(start, end);
+                count(stats.frames_received);
+                count(stats.callback_time_ns, callback_ns);
+                raise_to(stats.max_callback_time_ns, callback_ns);
+            }
+
+            // Fixed reconnect_delay_ms, or doubling up to reconnect_max_delay_ms and spread over its upper half
+            std::chrono::milliseconds next_reconnect_delay() {
+                uint64_t delay = options.reconnect_delay_ms;
+                if (options.reconnect_max_delay_ms <= delay) {
+                    return std::chrono::milliseconds(delay);
+                }
+
+                delay = std::min<uint64_t>(delay << std::min<uint32_t>(reconnect_attempts, 32),
+                                           options.reconnect_max_delay_ms);
+                reconnect_attempts++;
+                return std::chrono::milliseconds(std::uniform_int_distribution<uint64_t>(delay / 2, delay)(jitter));
             }
         };
 
@@ -55,11 +356,13 @@ namespace tractor {
                 return true;
             }
 
-            if (!connect()) {
+            if (!connect() && !pimpl_->options.auto_reconnect) {
                 return false;
             }
 
             pimpl_->running = true;
+            subscribe_hotplug();
+            start_dispatcher();
             pimpl_->reader_thread = std::thread(&Serial::reader_thread, this);
 
             return true;
@@ -70,12 +373,25 @@ namespace tractor {
                 return;
             }
 
-            pimpl_->running = false;
+            if (pimpl_->reactor != nullptr) {
+                // Ends in reactor_detach() once no worker is inside our callbacks
+                pimpl_->reactor->remove(*this);
+                return;
+            }
+
+            unsubscribe_hotplug();
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->reconnect_mutex);
+                pimpl_->running = false;
+            }
+            pimpl_->reconnect_wake.notify_all();
 
             if (pimpl_->reader_thread.joinable()) {
                 pimpl_->reader_thread.join();
             }
 
+            stop_dispatcher();
+            stop_writer();
             disconnect();
         }
 
@@ -84,40 +400,178 @@ namespace tractor {
         bool Serial::is_connected() const { return pimpl_->connected; }
 
         bool Serial::write_line(const std::string &line) {
-            std::string data = line;
-            if (pimpl_->options.framing == FramingMode::LineDelimited) {
-                data += pimpl_->options.line_delimiter;
+            if (pimpl_->options.framing != FramingMode::LineDelimited) {
+                return write(line);
             }
-            return write(data);
+
+            std::lock_guard<std::mutex> lock(pimpl_->write_mutex);
+            auto &data = pimpl_->tx_scratch;
+            data.assign(line);
+            data += pimpl_->options.line_delimiter;
+
+            struct iovec iov = {data.data(), data.size()};
+            return write_locked(&iov, 1, data.size()) == static_cast<ssize_t>(data.size());
         }
 
-        bool Serial::write(const std::vector<uint8_t> &data) {
+        bool Serial::write(const std::vector<uint8_t> &data) { return write(std::span<const uint8_t>(data)); }
+
+        bool Serial::write(std::span<const uint8_t> data) {
             std::lock_guard<std::mutex> lock(pimpl_->write_mutex);
+            struct iovec iov = {const_cast<uint8_t *>(data.data()), data.size()};
+            return write_locked(&iov, 1, data.size()) == static_cast<ssize_t>(data.size());
+        }
 
-            if (!pimpl_->connected || !pimpl_->tty) {
+        bool Serial::write(const std::string &data) {
+            return write(std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+        }
+
+        bool Serial::write_async(std::span<const uint8_t> data, WriteCallback on_complete) {
+            auto &queue = pimpl_->writes;
+            if (!pimpl_->connected || data.size() > pimpl_->options.write_queue_size) {
                 return false;
             }
 
-            ssize_t written = pimpl_->tty->write(data);
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.stopping) {
+                    return false;
+                }
+
+                if (!queue.thread.joinable()) {
+                    // First use, everything is allocated once here
+                    queue.ring.resize(std::max<size_t>(pimpl_->options.write_queue_size, 1));
+                    queue.pending.resize(std::max<size_t>(pimpl_->options.write_queue_depth, 1));
+                    queue.completed.reserve(queue.pending.size());
+                    queue.thread = std::thread(&Serial::writer_thread, this);
+                }
+
+                const size_t ring_size = queue.ring.size();
+                if (queue.head - queue.tail + data.size() > ring_size ||
+                    queue.pending_head - queue.pending_tail == queue.pending.size()) {
+                    return false;
+                }
+
+                size_t offset = queue.head % ring_size;
+                size_t first = std::min(data.size(), ring_size - offset);
+                std::memcpy(queue.ring.data() + offset, data.data(), first);
+                std::memcpy(queue.ring.data(), data.data() + first, data.size() - first);
+                queue.head += data.size();
+
+                auto &pending = queue.pending[queue.pending_head % queue.pending.size()];
+                pending.end = queue.head;
+                pending.callback = std::move(on_complete);
+                TRACTOR_TRACE_FLOW_BEGIN("serial", "write", trace::flow_id(&queue, queue.pending_head));
+                queue.pending_head++;
+            }
+
+            queue.wake.notify_one();
+            return true;
+        }
+
+        bool Serial::write_async(const std::string &data, WriteCallback on_complete) {
+            return write_async(std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(data.data()), data.size()),
+                               std::move(on_complete));
+        }
+
+        bool Serial::flush(uint32_t timeout_ms) {
+            auto &queue = pimpl_->writes;
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            return queue.drained.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                          [&] { return queue.pending_head == queue.pending_tail; });
+        }
+
+        ssize_t Serial::write_locked(const struct iovec *iov, int count, size_t size) {
+            if (!pimpl_->connected || !pimpl_->tty) {
+                return -1;
+            }
+
+            ssize_t written = count == 1 ? pimpl_->tty->write(static_cast<const uint8_t *>(iov->iov_base), size)
+                                         : pimpl_->tty->write_vectored(iov, count);
             if (written < 0) {
                 std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
                 if (pimpl_->error_callback) {
                     pimpl_->error_callback("Write error: " + pimpl_->tty->get_last_error());
                 }
-                return false;
+                return -1;
+            }
+
+            pimpl_->count(pimpl_->stats.bytes_sent, written);
+            return written;
+        }
+
+        void Serial::writer_thread() {
+            auto &queue = pimpl_->writes;
+            const size_t ring_size = queue.ring.size();
+
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            for (;;) {
+                queue.wake.wait(lock, [&] { return queue.stopping || queue.head != queue.tail; });
+                if (queue.head == queue.tail) {
+                    break;
+                }
+
+                // Everything queued so far goes out in one call, split in two where the ring wraps
+                const uint64_t start = queue.tail;
+                const uint64_t end = queue.head;
+                size_t offset = start % ring_size;
+                size_t size = end - start;
+                size_t first = std::min(size, ring_size - offset);
+                TRACTOR_TRACE_SCOPE("serial", "write_batch");
+                TRACTOR_TRACE_VALUE(size);
+
+                struct iovec iov[2] = {{queue.ring.data() + offset, first}, {queue.ring.data(), size - first}};
+                lock.unlock();
+
+                ssize_t written;
+                {
+                    std::lock_guard<std::mutex> write_lock(pimpl_->write_mutex);
+                    written = write_locked(iov, size > first ? 2 : 1, size);
+                }
+                const uint64_t written_until = start + static_cast<uint64_t>(std::max<ssize_t>(written, 0));
+
+                // Bytes that did not make it are dropped and their writes report failure
+                lock.lock();
+                queue.tail = end;
+                while (queue.pending_tail != queue.pending_head) {
+                    auto &pending = queue.pending[queue.pending_tail % queue.pending.size()];
+                    if (pending.end > end) {
+                        break;
+                    }
+                    TRACTOR_TRACE_FLOW_END("serial", "write", trace::flow_id(&queue, queue.pending_tail));
+                    if (pending.callback) {
+                        queue.completed.emplace_back(std::move(pending.callback), pending.end <= written_until);
+                        pending.callback = nullptr;
+                    }
+                    queue.pending_tail++;
+                }
+
+                if (!queue.completed.empty()) {
+                    lock.unlock();
+                    for (auto &[callback, success] : queue.completed) {
+                        callback(success);
+                    }
+                    lock.lock();
+                    queue.completed.clear();
+                }
+                queue.drained.notify_all();
             }
+        }
 
+        void Serial::stop_writer() {
+            auto &queue = pimpl_->writes;
             {
-                std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                pimpl_->stats.bytes_sent += written;
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.stopping = true;
             }
+            queue.wake.notify_all();
 
-            return written == static_cast<ssize_t>(data.size());
-        }
+            // The writer finishes what is queued before it exits
+            if (queue.thread.joinable()) {
+                queue.thread.join();
+            }
 
-        bool Serial::write(const std::string &data) {
-            std::vector<uint8_t> bytes(data.begin(), data.end());
-            return write(bytes);
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.stopping = false;
         }
 
         void Serial::on_line(LineCallback callback) {
@@ -130,6 +584,34 @@ namespace tractor {
             pimpl_->data_callback = callback;
         }
 
+        void Serial::on_line_view(LineViewCallback callback) {
+            std::lock_guard<std::mutex> lock(pimpl_->callback_mutex);
+            pimpl_->line_view_callback = callback;
+        }
+
+        void Serial::on_data_view(DataViewCallback callback) {
+            std::lock_guard<std::mutex> lock(pimpl_->callback_mutex);
+            pimpl_->data_view_callback = callback;
+        }
+
+        void Serial::on_line_view(LineInfoCallback callback) {
+            std::lock_guard<std::mutex> lock(pimpl_->callback_mutex);
+            pimpl_->line_info_callback = callback;
+        }
+
+        void Serial::on_data_view(DataInfoCallback callback) {
+            std::lock_guard<std::mutex> lock(pimpl_->callback_mutex);
+            pimpl_->data_info_callback = callback;
+        }
+
+        void Serial::on_frame(FrameCallback callback) {
+            std::lock_guard<std::mutex> lock(pimpl_->callback_mutex);
+            if (callback) {
+                pimpl_->ensure_frame_pool();
+            }
+            pimpl_->frame_callback = callback;
+        }
+
         void Serial::on_connection(ConnectionCallback callback) {
             std::lock_guard<std::mutex> lock(pimpl_->callback_mutex);
             pimpl_->connection_callback = callback;
@@ -140,22 +622,91 @@ namespace tractor {
             pimpl_->error_callback = callback;
         }
 
-        Serial::Statistics Serial::get_statistics() const {
-            std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
-            return pimpl_->stats;
+        uint64_t Serial::Statistics::latency_percentile_us(double percentile) const {
+            uint64_t total = 0;
+            for (auto bucket : latency_histogram) {
+                total += bucket;
+            }
+            if (total == 0) {
+                return 0;
+            }
+
+            double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(total);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+                seen += latency_histogram[i];
+                if (seen > 0 && static_cast<double>(seen) >= rank) {
+                    return uint64_t{1} << (i + 1);
+                }
+            }
+            return uint64_t{1} << LATENCY_BUCKETS;
         }
 
-        void Serial::reset_statistics() {
-            std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
-            pimpl_->stats = Statistics{};
+        Serial::Statistics Serial::get_statistics() const {
+            const auto &counters = pimpl_->stats;
+            auto load = [](const std::atomic<uint64_t> &counter) { return counter.load(std::memory_order_relaxed); };
+
+            Statistics stats;
+            stats.lines_received = load(counters.lines_received);
+            stats.bytes_received = load(counters.bytes_received);
+            stats.bytes_sent = load(counters.bytes_sent);
+            stats.errors = load(counters.errors);
+            stats.reconnects = load(counters.reconnects);
+            stats.frames_received = load(counters.frames_received);
+            stats.callback_time_ns = load(counters.callback_time_ns);
+            stats.max_callback_time_ns = load(counters.max_callback_time_ns);
+            stats.buffer_high_water_mark = load(counters.buffer_high_water_mark);
+            stats.chunk_high_water_mark = load(counters.chunk_high_water_mark);
+            stats.frames_dropped = load(counters.frames_dropped);
+            if (const FramePool *pool = pimpl_->frame_pool_view.load(std::memory_order_acquire)) {
+                stats.pool_high_water_mark = pool->get_statistics().high_water_mark;
+            }
+            for (size_t i = 0; i < Statistics::LATENCY_BUCKETS; i++) {
+                stats.latency_histogram[i] = load(counters.latency_histogram[i]);
+            }
+
+            Clock::time_point since{Clock::duration(counters.since.load(std::memory_order_relaxed))};
+            double seconds = std::chrono::duration<double>(Clock::now() - since).count();
+            if (seconds > 0.0) {
+                stats.frames_per_second = static_cast<double>(stats.frames_received) / seconds;
+            }
+
+            return stats;
         }
 
+        void Serial::reset_statistics() { pimpl_->stats.reset(); }
+
         SerialOptions Serial::get_options() const { return pimpl_->options; }
 
         Tty *Serial::get_tty() { return pimpl_->tty.get(); }
 
         bool Serial::connect() {
-            pimpl_->tty = std::make_unique<Tty>(pimpl_->options.port, pimpl_->options.tty_config);
+            std::string path = pimpl_->options.port;
+            if (pimpl_->options.device.by_attributes()) {
+                // The shared monitor keeps a snapshot, otherwise walk /dev
+                PortDescription port;
+                auto &monitor = HotplugMonitor::shared();
+                bool found = monitor.is_running() && monitor.find(pimpl_->options.device, port);
+                if (!monitor.is_running()) {
+                    for (const auto &candidate : list_port_descriptions()) {
+                        if (pimpl_->options.device.matches(candidate)) {
+                            port = candidate;
+                            found = true;
+                            break;
+                        }
+                    }
+                }
+                if (!found) {
+                    std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
+                    if (pimpl_->error_callback) {
+                        pimpl_->error_callback("No port matches the configured device");
+                    }
+                    return false;
+                }
+                path = port.device;
+            }
+
+            pimpl_->tty = std::make_unique<Tty>(path, pimpl_->options.tty_config);
 
             if (!pimpl_->tty->open()) {
                 std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
@@ -167,7 +718,15 @@ namespace tractor {
             }
 
             pimpl_->connected = true;
-            pimpl_->read_buffer.clear();
+            pimpl_->reconnect_attempts = 0;
+            pimpl_->rx_chunk.resize(std::max<size_t>(pimpl_->options.read_chunk_size, 1));
+            reset_framing();
+
+            // Start bit, data bits, parity and stop bits of every character
+            const auto &config = pimpl_->options.tty_config;
+            double bits = 1.0 + static_cast<double>(config.data_bits) + (config.parity != Parity::None ? 1.0 : 0.0) +
+                          (config.stop_bits == StopBits::One ? 1.0 : config.stop_bits == StopBits::Two ? 2.0 : 1.5);
+            pimpl_->byte_time_ns = config.baud_rate > 0 ? bits * 1e9 / config.baud_rate : 0.0;
 
             {
                 std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
@@ -179,6 +738,44 @@ namespace tractor {
             return true;
         }
 
+        void Serial::reset_framing() {
+            pimpl_->read_buffer.clear();
+            pimpl_->read_buffer.reserve(pimpl_->options.max_line_length + 1);
+            pimpl_->pending_length = 0;
+        }
+
+        bool Serial::set_capture(std::shared_ptr<CaptureWriter> capture, uint16_t channel) {
+            if (pimpl_->running) {
+                return false;
+            }
+            pimpl_->capture = std::move(capture);
+            pimpl_->capture_channel = channel;
+            return true;
+        }
+
+        size_t Serial::replay(CaptureReader &reader, const ReplayOptions &options) {
+            if (pimpl_->running) {
+                return 0;
+            }
+
+            // Replayed chunks must not end up in the log again
+            auto capture = std::move(pimpl_->capture);
+            reset_framing();
+            start_dispatcher();
+
+            ReplayOptions chunks = options;
+            chunks.kind = CaptureKind::SerialChunk;
+            size_t replayed = reader.replay(chunks, [this](const CaptureRecord &record) {
+                process_chunk(record.data.data(), record.data.size());
+                return true;
+            });
+
+            stop_dispatcher();
+            reset_framing();
+            pimpl_->capture = std::move(capture);
+            return replayed;
+        }
+
         void Serial::disconnect() {
             if (!pimpl_->connected) {
                 return;
@@ -187,6 +784,8 @@ namespace tractor {
             pimpl_->connected = false;
 
             if (pimpl_->tty) {
+                // A write running on another thread (e.g. the async writer) still uses the port
+                std::lock_guard<std::mutex> lock(pimpl_->write_mutex);
                 pimpl_->tty->close();
                 pimpl_->tty.reset();
             }
@@ -199,15 +798,145 @@ namespace tractor {
             }
         }
 
+        void Serial::subscribe_hotplug() {
+            if (!pimpl_->options.auto_reconnect || !pimpl_->options.hotplug) {
+                return;
+            }
+
+            PortMatch match = pimpl_->options.device;
+            if (!match.by_attributes()) {
+                match.path = pimpl_->options.port;
+            }
+            pimpl_->hotplug_pending = false;
+            pimpl_->hotplug_subscription = HotplugMonitor::shared().subscribe(
+                match, [impl = pimpl_.get()](HotplugEvent event, const PortDescription &) {
+                    if (event != HotplugEvent::Added) {
+                        return;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(impl->reconnect_mutex);
+                        impl->hotplug_pending = true;
+                    }
+                    impl->reconnect_wake.notify_all();
+                });
+        }
+
+        void Serial::unsubscribe_hotplug() {
+            if (pimpl_->hotplug_subscription != 0) {
+                // Waits for a callback still touching this instance
+                HotplugMonitor::shared().unsubscribe(pimpl_->hotplug_subscription);
+                pimpl_->hotplug_subscription = 0;
+            }
+        }
+
+        bool Serial::reactor_attach(SerialReactor *reactor) {
+            if (pimpl_->running) {
+                return false;
+            }
+
+            if (!connect() && !pimpl_->options.auto_reconnect) {
+                return false;
+            }
+
+            if (pimpl_->tty) {
+                pimpl_->tty->set_non_blocking(true);
+            }
+
+            pimpl_->reactor = reactor;
+            pimpl_->running = true;
+            subscribe_hotplug();
+            start_dispatcher();
+            return true;
+        }
+
+        void Serial::reactor_detach() {
+            unsubscribe_hotplug();
+            pimpl_->reactor = nullptr;
+            pimpl_->running = false;
+            stop_dispatcher();
+            stop_writer();
+            disconnect();
+        }
+
+        int Serial::reactor_fd() const { return pimpl_->connected && pimpl_->tty ? pimpl_->tty->get_fd() : -1; }
+
+        bool Serial::reactor_read() {
+            if (!pimpl_->connected || !pimpl_->tty) {
+                return false;
+            }
+
+            ssize_t bytes_read = pimpl_->tty->read_available(pimpl_->rx_chunk.data(), pimpl_->rx_chunk.size());
+            if (bytes_read < 0) {
+                reactor_error();
+                return false;
+            }
+
+            if (bytes_read > 0) {
+                process_chunk(pimpl_->rx_chunk.data(), static_cast<size_t>(bytes_read));
+            }
+
+            return pimpl_->connected;
+        }
+
+        size_t Serial::reactor_chunk_size() const { return pimpl_->rx_chunk.size(); }
+
+        bool Serial::reactor_chunk(const uint8_t *data, ssize_t result) {
+            if (!pimpl_->connected || !pimpl_->tty) {
+                return false;
+            }
+
+            // Completions carry -errno where read() would have set errno
+            if (result < 0 && result != -EAGAIN && result != -EINTR) {
+                reactor_error();
+                return false;
+            }
+
+            if (result > 0) {
+                process_chunk(data, static_cast<size_t>(result));
+            }
+
+            return pimpl_->connected;
+        }
+
+        void Serial::reactor_idle() { drop_partial_frame(); }
+
+        void Serial::reactor_error() {
+            pimpl_->count(pimpl_->stats.errors);
+            disconnect();
+        }
+
+        bool Serial::reactor_reconnect() {
+            if (!connect()) {
+                return false;
+            }
+
+            pimpl_->tty->set_non_blocking(true);
+
+            pimpl_->count(pimpl_->stats.reconnects);
+            return true;
+        }
+
+        std::chrono::milliseconds Serial::reactor_reconnect_delay() { return pimpl_->next_reconnect_delay(); }
+
+        bool Serial::reactor_hotplug() { return pimpl_->hotplug_pending.exchange(false); }
+
         void Serial::reader_thread() {
             while (pimpl_->running) {
                 if (!pimpl_->connected) {
                     if (pimpl_->options.auto_reconnect) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(pimpl_->options.reconnect_delay_ms));
+                        {
+                            std::unique_lock<std::mutex> lock(pimpl_->reconnect_mutex);
+                            pimpl_->reconnect_wake.wait_for(lock, pimpl_->next_reconnect_delay(), [this] {
+                                return !pimpl_->running || pimpl_->hotplug_pending;
+                            });
+                            pimpl_->hotplug_pending = false;
+                        }
+                        if (!pimpl_->running) {
+                            break;
+                        }
 
                         if (connect()) {
-                            std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                            pimpl_->stats.reconnects++;
+                            pimpl_->count(pimpl_->stats.reconnects);
                         }
                     } else {
                         break;
@@ -215,208 +944,416 @@ namespace tractor {
                     continue;
                 }
 
-                // Process data based on framing mode
-                switch (pimpl_->options.framing) {
-                case FramingMode::LineDelimited:
-                    process_line_delimited();
-                    break;
-                case FramingMode::FixedLength:
-                    process_fixed_length();
-                    break;
-                case FramingMode::LengthPrefixed:
-                    process_length_prefixed();
-                    break;
-                case FramingMode::Custom:
-                    process_custom();
-                    break;
-                }
+                process_incoming();
             }
         }
 
-        void Serial::process_line_delimited() {
-            uint8_t ch;
-            ssize_t bytes_read = pimpl_->tty->read(&ch, 1);
+        void Serial::process_incoming() {
+            ssize_t bytes_read = pimpl_->tty->read(pimpl_->rx_chunk.data(), pimpl_->rx_chunk.size());
 
             if (bytes_read < 0) {
                 // Error
-                std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                pimpl_->stats.errors++;
+                pimpl_->count(pimpl_->stats.errors);
                 disconnect();
                 return;
             }
 
             if (bytes_read == 0) {
-                // Timeout, continue
+                // Timeout, a frame that stalled mid-way will not be completed
+                drop_partial_frame();
                 return;
             }
 
-            {
-                std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                pimpl_->stats.bytes_received++;
+            process_chunk(pimpl_->rx_chunk.data(), static_cast<size_t>(bytes_read));
+        }
+
+        void Serial::process_chunk(const uint8_t *data, size_t size) {
+            // A read that did not fill the chunk emptied the driver buffer, later bytes arrived after it
+            pimpl_->chunk_floor = pimpl_->last_chunk_size < pimpl_->rx_chunk.size() ? pimpl_->chunk_time
+                                                                                     : Clock::time_point{};
+            pimpl_->last_chunk_size = size;
+
+            // One clock read per chunk, frames completed by it are timed from here
+            pimpl_->chunk_time = Clock::now();
+            raise_to(pimpl_->stats.chunk_high_water_mark, size);
+            if (pimpl_->capture) {
+                pimpl_->capture->append(CaptureKind::SerialChunk, pimpl_->capture_channel,
+                                        std::span<const uint8_t>(data, size), pimpl_->chunk_time);
             }
 
-            // Check for line delimiter
-            if (ch == pimpl_->options.line_delimiter) {
-                if (!pimpl_->read_buffer.empty()) {
-                    std::string line = pimpl_->read_buffer;
+            // Process data based on framing mode
+            switch (pimpl_->options.framing) {
+            case FramingMode::LineDelimited:
+                process_line_delimited(data, size);
+                break;
+            case FramingMode::FixedLength:
+                process_fixed_length(data, size);
+                break;
+            case FramingMode::LengthPrefixed:
+                process_length_prefixed(data, size);
+                break;
+            case FramingMode::Custom:
+                process_custom(data, size);
+                break;
+            }
+        }
 
-                    // Strip trailing \r if present
-                    if (pimpl_->options.strip_line_endings && !line.empty() && line.back() == '\r') {
-                        line.pop_back();
-                    }
+        void Serial::append_to_frame(const uint8_t *data, size_t size, bool exempt_cr, const char *overflow_message) {
+            auto &buffer = pimpl_->read_buffer;
+            const size_t max_length = pimpl_->options.max_line_length;
 
-                    {
-                        std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                        pimpl_->stats.lines_received++;
-                    }
+            if (size > 0 && buffer.empty()) {
+                pimpl_->frame_start = pimpl_->chunk_time;
+            }
 
-                    // Call callback
-                    {
-                        std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
-                        if (pimpl_->line_callback) {
-                            pimpl_->line_callback(line);
-                        }
-                    }
+            while (size > 0) {
+                if (buffer.size() + size <= max_length) {
+                    buffer.append(reinterpret_cast<const char *>(data), size);
+                    raise_to(pimpl_->stats.buffer_high_water_mark, buffer.size());
+                    return;
+                }
 
-                    pimpl_->read_buffer.clear();
+                // Find the first byte that takes the frame past the limit. A '\r' kept for line ending
+                // stripping is not length checked, so the overflow fires on the next byte instead.
+                size_t index = max_length > buffer.size() ? max_length - buffer.size() : 0;
+                while (exempt_cr && index < size && data[index] == '\r') {
+                    index++;
                 }
-            } else if (ch == '\r' && pimpl_->options.strip_line_endings) {
-                // Skip \r if we're stripping line endings (will be handled above)
-                pimpl_->read_buffer += static_cast<char>(ch);
-            } else {
-                // Append to buffer
-                pimpl_->read_buffer += static_cast<char>(ch);
 
-                // Check for overflow
-                if (pimpl_->read_buffer.size() > pimpl_->options.max_line_length) {
+                if (index == size) {
+                    buffer.append(reinterpret_cast<const char *>(data), size);
+                    raise_to(pimpl_->stats.buffer_high_water_mark, buffer.size());
+                    return;
+                }
+
+                {
                     std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
                     if (pimpl_->error_callback) {
-                        pimpl_->error_callback("Line exceeds maximum length");
+                        pimpl_->error_callback(overflow_message);
                     }
+                }
+                buffer.clear();
+
+                pimpl_->count(pimpl_->stats.errors);
+
+                data += index + 1;
+                size -= index + 1;
+                pimpl_->frame_start = pimpl_->chunk_time;
+            }
+        }
+
+        void Serial::drop_partial_frame() {
+            switch (pimpl_->options.framing) {
+            case FramingMode::FixedLength:
+                pimpl_->read_buffer.clear();
+                break;
+            case FramingMode::LengthPrefixed:
+                if (pimpl_->pending_length > 0) {
                     pimpl_->read_buffer.clear();
+                    pimpl_->pending_length = 0;
 
-                    std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                    pimpl_->stats.errors++;
+                    pimpl_->count(pimpl_->stats.errors);
                 }
+                break;
+            case FramingMode::LineDelimited:
+            case FramingMode::Custom:
+                // Delimited frames may legitimately span quiet periods
+                break;
             }
         }
 
-        void Serial::process_fixed_length() {
-            if (pimpl_->options.fixed_length == 0) {
+        void Serial::deliver_frame(const uint8_t *data, size_t size, Clock::time_point first_byte, size_t trailing) {
+            FrameInfo info;
+            info.first_byte = first_byte;
+            info.last_byte = pimpl_->chunk_time;
+
+            // The frame ended before the bytes that followed it in the same read arrived on the wire
+            std::chrono::duration<double, std::nano> backlog(static_cast<double>(trailing) * pimpl_->byte_time_ns);
+            info.arrival = std::max(info.last_byte - std::chrono::duration_cast<Clock::duration>(backlog),
+                                    pimpl_->chunk_floor);
+            info.sequence = pimpl_->frame_sequence++;
+
+            if (pimpl_->queue) {
+                TRACTOR_TRACE_FLOW_BEGIN("serial", "frame", trace::flow_id(pimpl_.get(), info.sequence));
+                uint64_t dropped = 0;
+                pimpl_->queue->push(data, size, info, dropped);
+                if (dropped > 0) {
+                    pimpl_->count(pimpl_->stats.frames_dropped, dropped);
+                }
                 return;
             }
 
-            std::vector<uint8_t> buffer(pimpl_->options.fixed_length);
-            ssize_t bytes_read = pimpl_->tty->read_exact(buffer.data(), buffer.size());
+            invoke_callbacks(data, size, info);
+        }
 
-            if (bytes_read < 0) {
-                std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                pimpl_->stats.errors++;
-                disconnect();
-                return;
+        void Serial::invoke_callbacks(const uint8_t *data, size_t size, const FrameInfo &info, const Frame *frame) {
+            TRACTOR_TRACE_SCOPE("serial", "callbacks");
+            TRACTOR_TRACE_VALUE(size);
+            if (frame != nullptr) {
+                TRACTOR_TRACE_FLOW_END("serial", "frame", trace::flow_id(pimpl_.get(), info.sequence));
             }
+            auto start = Clock::now();
+            {
+                std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
+                // The queued buffer itself, or a copy into a free one when delivering straight from the read
+                auto deliver_frame = [&] {
+                    if (!pimpl_->frame_callback) {
+                        return;
+                    }
+                    if (frame != nullptr) {
+                        pimpl_->frame_callback(*frame, info);
+                        return;
+                    }
+                    Frame pooled = pimpl_->frame_pool->acquire(std::span<const uint8_t>(data, size));
+                    if (pooled) {
+                        pimpl_->frame_callback(pooled, info);
+                    } else {
+                        pimpl_->count(pimpl_->stats.frames_dropped);
+                    }
+                };
 
-            if (bytes_read == static_cast<ssize_t>(buffer.size())) {
-                {
-                    std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                    pimpl_->stats.bytes_received += bytes_read;
-                }
-
-                {
-                    std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
+                if (pimpl_->options.framing == FramingMode::LineDelimited) {
+                    auto line = reinterpret_cast<const char *>(data);
+                    if (pimpl_->line_view_callback) {
+                        pimpl_->line_view_callback(std::string_view(line, size));
+                    }
+                    if (pimpl_->line_info_callback) {
+                        pimpl_->line_info_callback(std::string_view(line, size), info);
+                    }
+                    deliver_frame();
+                    if (pimpl_->line_callback) {
+                        pimpl_->line_scratch.assign(line, size);
+                        pimpl_->line_callback(pimpl_->line_scratch);
+                    }
+                } else {
+                    if (pimpl_->data_view_callback) {
+                        pimpl_->data_view_callback(std::span<const uint8_t>(data, size));
+                    }
+                    if (pimpl_->data_info_callback) {
+                        pimpl_->data_info_callback(std::span<const uint8_t>(data, size), info);
+                    }
+                    deliver_frame();
                     if (pimpl_->data_callback) {
-                        pimpl_->data_callback(buffer);
+                        pimpl_->data_scratch.assign(data, data + size);
+                        pimpl_->data_callback(pimpl_->data_scratch);
                     }
                 }
             }
+            pimpl_->record_delivery(info.first_byte, start, Clock::now());
         }
 
-        void Serial::process_length_prefixed() {
-            // Read length prefix (1 byte)
-            uint8_t length;
-            ssize_t bytes_read = pimpl_->tty->read(&length, 1);
-
-            if (bytes_read <= 0) {
-                if (bytes_read < 0) {
-                    std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                    pimpl_->stats.errors++;
-                    disconnect();
-                }
+        void Serial::start_dispatcher() {
+            if (pimpl_->options.dispatch != DispatchMode::Queued || pimpl_->queue) {
                 return;
             }
 
-            if (length == 0) {
+            FramePool *pool = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->callback_mutex);
+                pool = &pimpl_->ensure_frame_pool();
+            }
+            pimpl_->queue = std::make_unique<FrameQueue>(pimpl_->options.dispatch_queue_depth,
+                                                         pimpl_->options.overflow_policy, *pool);
+            pimpl_->dispatcher_thread = std::thread(&Serial::dispatcher_thread, this);
+        }
+
+        void Serial::stop_dispatcher() {
+            if (!pimpl_->queue) {
                 return;
             }
 
-            // Read data
-            std::vector<uint8_t> buffer(length);
-            bytes_read = pimpl_->tty->read_exact(buffer.data(), length);
+            pimpl_->queue->stop();
+            if (pimpl_->dispatcher_thread.joinable()) {
+                pimpl_->dispatcher_thread.join();
+            }
+            pimpl_->queue.reset();
+        }
 
-            if (bytes_read == length) {
-                {
-                    std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                    pimpl_->stats.bytes_received += bytes_read + 1; // +1 for length byte
+        void Serial::dispatcher_thread() {
+            FrameQueue &queue = *pimpl_->queue;
+            Frame frame;
+            FrameInfo info;
+
+            // Frames still queued when stopping are delivered before the thread exits
+            for (;;) {
+                uint32_t signal = queue.signal();
+                if (queue.pop(frame, info)) {
+                    invoke_callbacks(frame.data(), frame.size(), info, &frame);
+                    frame.reset();
+                    continue;
                 }
+                if (queue.is_stopping()) {
+                    break;
+                }
+                queue.wait(signal);
+            }
+        }
 
-                {
-                    std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
-                    if (pimpl_->data_callback) {
-                        pimpl_->data_callback(buffer);
+        void Serial::process_line_delimited(const uint8_t *data, size_t size) {
+            TRACTOR_TRACE_SCOPE("serial", "line_delimited");
+            TRACTOR_TRACE_VALUE(size);
+            pimpl_->count(pimpl_->stats.bytes_received, size);
+
+            const auto delimiter = static_cast<uint8_t>(pimpl_->options.line_delimiter);
+            const bool strip = pimpl_->options.strip_line_endings;
+
+            while (size > 0) {
+                const uint8_t *found = find_byte(data, size, delimiter);
+                size_t segment = found ? static_cast<size_t>(found - data) : size;
+
+                // A complete line inside the chunk is delivered straight from the receive buffer
+                if (found && pimpl_->read_buffer.empty() && segment <= pimpl_->options.max_line_length) {
+                    if (segment > 0) {
+                        size_t length = segment;
+                        if (strip && data[length - 1] == '\r') {
+                            length--;
+                        }
+
+                        pimpl_->count(pimpl_->stats.lines_received);
+                        deliver_frame(data, length, pimpl_->chunk_time, size - segment - 1);
                     }
+                    data += segment + 1;
+                    size -= segment + 1;
+                    continue;
+                }
+
+                append_to_frame(data, segment, strip, "Line exceeds maximum length");
+
+                if (!found) {
+                    break;
+                }
+                data += segment + 1;
+                size -= segment + 1;
+
+                // Check for line delimiter
+                if (!pimpl_->read_buffer.empty()) {
+                    auto &line = pimpl_->read_buffer;
+
+                    // Strip trailing \r if present
+                    size_t length = line.size();
+                    if (strip && line.back() == '\r') {
+                        length--;
+                    }
+
+                    pimpl_->count(pimpl_->stats.lines_received);
+
+                    deliver_frame(reinterpret_cast<const uint8_t *>(line.data()), length, pimpl_->frame_start, size);
+                    line.clear();
                 }
-            } else {
-                std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                pimpl_->stats.errors++;
             }
         }
 
-        void Serial::process_custom() {
-            uint8_t ch;
-            ssize_t bytes_read = pimpl_->tty->read(&ch, 1);
-
-            if (bytes_read < 0) {
-                std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                pimpl_->stats.errors++;
-                disconnect();
+        void Serial::process_fixed_length(const uint8_t *data, size_t size) {
+            TRACTOR_TRACE_SCOPE("serial", "fixed_length");
+            TRACTOR_TRACE_VALUE(size);
+            const size_t frame_length = pimpl_->options.fixed_length;
+            if (frame_length == 0) {
                 return;
             }
 
-            if (bytes_read == 0) {
-                return;
+            auto &buffer = pimpl_->read_buffer;
+            while (size > 0) {
+                if (buffer.empty() && size >= frame_length) {
+                    // Whole frame inside the chunk, no need to assemble it
+                    pimpl_->count(pimpl_->stats.bytes_received, frame_length);
+                    deliver_frame(data, frame_length, pimpl_->chunk_time, size - frame_length);
+                    data += frame_length;
+                    size -= frame_length;
+                    continue;
+                }
+
+                if (buffer.empty()) {
+                    pimpl_->frame_start = pimpl_->chunk_time;
+                }
+                size_t take = std::min(frame_length - buffer.size(), size);
+                buffer.append(reinterpret_cast<const char *>(data), take);
+                raise_to(pimpl_->stats.buffer_high_water_mark, buffer.size());
+                data += take;
+                size -= take;
+
+                if (buffer.size() == frame_length) {
+                    pimpl_->count(pimpl_->stats.bytes_received, frame_length);
+                    deliver_frame(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size(),
+                                  pimpl_->frame_start, size);
+                    buffer.clear();
+                }
             }
+        }
 
-            {
-                std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                pimpl_->stats.bytes_received++;
+        void Serial::process_length_prefixed(const uint8_t *data, size_t size) {
+            TRACTOR_TRACE_SCOPE("serial", "length_prefixed");
+            TRACTOR_TRACE_VALUE(size);
+            auto &buffer = pimpl_->read_buffer;
+            while (size > 0) {
+                if (pimpl_->pending_length == 0) {
+                    // Read length prefix (1 byte), empty messages carry no payload
+                    pimpl_->pending_length = *data;
+                    pimpl_->frame_start = pimpl_->chunk_time;
+                    data++;
+                    size--;
+
+                    if (pimpl_->pending_length > 0 && size >= pimpl_->pending_length) {
+                        // Whole payload inside the chunk, no need to assemble it
+                        size_t length = pimpl_->pending_length;
+                        pimpl_->count(pimpl_->stats.bytes_received, length + 1); // +1 for length byte
+                        deliver_frame(data, length, pimpl_->chunk_time, size - length);
+                        data += length;
+                        size -= length;
+                        pimpl_->pending_length = 0;
+                    }
+                    continue;
+                }
+
+                size_t take = std::min(pimpl_->pending_length - buffer.size(), size);
+                buffer.append(reinterpret_cast<const char *>(data), take);
+                raise_to(pimpl_->stats.buffer_high_water_mark, buffer.size());
+                data += take;
+                size -= take;
+
+                if (buffer.size() == pimpl_->pending_length) {
+                    pimpl_->count(pimpl_->stats.bytes_received, buffer.size() + 1); // +1 for length byte
+                    deliver_frame(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size(),
+                                  pimpl_->frame_start, size);
+                    buffer.clear();
+                    pimpl_->pending_length = 0;
+                }
             }
+        }
 
-            // Check for custom delimiter
-            if (ch == pimpl_->options.custom_delimiter) {
-                if (!pimpl_->read_buffer.empty()) {
-                    std::vector<uint8_t> data(pimpl_->read_buffer.begin(), pimpl_->read_buffer.end());
+        void Serial::process_custom(const uint8_t *data, size_t size) {
+            TRACTOR_TRACE_SCOPE("serial", "custom");
+            TRACTOR_TRACE_VALUE(size);
+            pimpl_->count(pimpl_->stats.bytes_received, size);
 
-                    {
-                        std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
-                        if (pimpl_->data_callback) {
-                            pimpl_->data_callback(data);
-                        }
+            const uint8_t delimiter = pimpl_->options.custom_delimiter;
+
+            while (size > 0) {
+                const uint8_t *found = find_byte(data, size, delimiter);
+                size_t segment = found ? static_cast<size_t>(found - data) : size;
+
+                // A complete message inside the chunk is delivered straight from the receive buffer
+                if (found && pimpl_->read_buffer.empty() && segment <= pimpl_->options.max_line_length) {
+                    if (segment > 0) {
+                        deliver_frame(data, segment, pimpl_->chunk_time, size - segment - 1);
                     }
+                    data += segment + 1;
+                    size -= segment + 1;
+                    continue;
+                }
 
-                    pimpl_->read_buffer.clear();
+                append_to_frame(data, segment, false, "Message exceeds maximum length");
+
+                if (!found) {
+                    break;
                 }
-            } else {
-                pimpl_->read_buffer += static_cast<char>(ch);
+                data += segment + 1;
+                size -= segment + 1;
 
-                if (pimpl_->read_buffer.size() > pimpl_->options.max_line_length) {
-                    std::lock_guard<std::mutex> cb_lock(pimpl_->callback_mutex);
-                    if (pimpl_->error_callback) {
-                        pimpl_->error_callback("Message exceeds maximum length");
-                    }
+                // Check for custom delimiter
+                if (!pimpl_->read_buffer.empty()) {
+                    deliver_frame(reinterpret_cast<const uint8_t *>(pimpl_->read_buffer.data()),
+                                  pimpl_->read_buffer.size(), pimpl_->frame_start, size);
                     pimpl_->read_buffer.clear();
-
-                    std::lock_guard<std::mutex> stats_lock(pimpl_->stats_mutex);
-                    pimpl_->stats.errors++;
                 }
             }
         }
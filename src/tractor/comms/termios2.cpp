@@ -0,0 +1,51 @@
+#include "termios2.hpp"
+
+#include <asm/termbits.h>
+#include <cerrno>
+#include <sys/ioctl.h>
+
+namespace tractor {
+    namespace comms {
+        namespace termios2 {
+
+            bool set_speed(int fd, uint32_t baud_rate) {
+#if defined(TCGETS2) && defined(BOTHER)
+                struct ::termios2 tio;
+                if (ioctl(fd, TCGETS2, &tio) != 0) {
+                    return false;
+                }
+
+                tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+                tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+                tio.c_ispeed = baud_rate;
+                tio.c_ospeed = baud_rate;
+
+                return ioctl(fd, TCSETS2, &tio) == 0;
+#else
+                (void)fd;
+                (void)baud_rate;
+                errno = ENOTSUP;
+                return false;
+#endif
+            }
+
+            bool get_speed(int fd, uint32_t &baud_rate) {
+#if defined(TCGETS2)
+                struct ::termios2 tio;
+                if (ioctl(fd, TCGETS2, &tio) != 0) {
+                    return false;
+                }
+
+                baud_rate = tio.c_ospeed;
+                return true;
+#else
+                (void)fd;
+                (void)baud_rate;
+                errno = ENOTSUP;
+                return false;
+#endif
+            }
+
+        } // namespace termios2
+    } // namespace comms
+} // namespace tractor
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tractor {
+    namespace comms {
+        namespace termios2 {
+
+            // Kept out of tty.cpp because <asm/termbits.h> redefines struct termios from <termios.h>
+
+            /**
+             * @brief Set an arbitrary input and output speed with TCSETS2 and BOTHER
+             * @param fd Open terminal file descriptor
+             * @param baud_rate Speed in bits per second
+             * @return true if successful, false otherwise (errno is set)
+             */
+            bool set_speed(int fd, uint32_t baud_rate);
+
+            /**
+             * @brief Read the output speed the driver actually uses with TCGETS2
+             * @param fd Open terminal file descriptor
+             * @param baud_rate Receives the speed in bits per second
+             * @return true if successful, false otherwise (errno is set)
+             */
+            bool get_speed(int fd, uint32_t &baud_rate);
+
+        } // namespace termios2
+    } // namespace comms
+} // namespace tractor
@@ -1,12 +1,17 @@
 #include "tractor/comms/tty.hpp"
+#include "termios2.hpp"
+#include "tractor/trace.hpp"
 
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <fcntl.h>
 #include <filesystem>
+#include <fstream>
+#include <linux/serial.h>
 #include <sys/ioctl.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 #include <system_error>
 #include <termios.h>
 #include <unistd.h>
@@ -23,9 +28,21 @@ namespace tractor {
             std::string last_error;
             struct termios original_termios;
             bool has_original_termios = false;
+            int original_serial_flags = 0;
+            bool has_original_serial_flags = false;
+            int original_latency_timer = -1; // Latency timer found the first time the port was tuned
+            LatencyReport latency_report;
+            uint32_t actual_baud_rate = 0; // Rate reported by the driver, 0 until the port is configured
 
             ~Impl() {
                 if (fd >= 0) {
+                    if (has_original_serial_flags) {
+                        struct serial_struct serial;
+                        if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+                            serial.flags = original_serial_flags;
+                            ioctl(fd, TIOCSSERIAL, &serial);
+                        }
+                    }
                     if (has_original_termios) {
                         tcsetattr(fd, TCSANOW, &original_termios);
                     }
@@ -208,6 +225,10 @@ namespace tractor {
 
             pimpl_->port = port;
             pimpl_->config = config;
+            pimpl_->has_original_serial_flags = false;
+            pimpl_->original_latency_timer = -1;
+            pimpl_->latency_report = LatencyReport{};
+            pimpl_->actual_baud_rate = 0;
 
             // Open the port with non-blocking flag initially
             pimpl_->fd = ::open(port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
@@ -249,6 +270,7 @@ namespace tractor {
 
         void Tty::close() {
             if (pimpl_->fd >= 0) {
+                restore_serial_flags();
                 // Restore original settings if available
                 if (pimpl_->has_original_termios) {
                     tcsetattr(pimpl_->fd, TCSANOW, &pimpl_->original_termios);
@@ -270,14 +292,16 @@ namespace tractor {
                 return false;
             }
 
-            // Set baud rate
-            speed_t speed = baud_rate_to_speed(pimpl_->config.baud_rate);
-            if (speed == B0) {
+            // Set baud rate, rates without a Bxxx constant are applied with termios2 after tcsetattr()
+            if (pimpl_->config.baud_rate == 0) {
                 pimpl_->last_error = "Unsupported baud rate";
                 return false;
             }
-            cfsetispeed(&tty, speed);
-            cfsetospeed(&tty, speed);
+            speed_t speed = baud_rate_to_speed(pimpl_->config.baud_rate);
+            if (speed != B0) {
+                cfsetispeed(&tty, speed);
+                cfsetospeed(&tty, speed);
+            }
 
             // Control modes
             tty.c_cflag |= (CLOCAL | CREAD); // Enable receiver, ignore modem control lines
@@ -365,7 +389,11 @@ namespace tractor {
             tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
 
             // Timeout configuration
-            if (pimpl_->config.vmin_mode) {
+            if (pimpl_->config.low_latency) {
+                // select() provides the timeout, read() returns whatever arrived without waiting
+                tty.c_cc[VMIN] = 0;
+                tty.c_cc[VTIME] = 0;
+            } else if (pimpl_->config.vmin_mode) {
                 // VMIN/VTIME mode
                 tty.c_cc[VMIN] = pimpl_->config.vmin;
                 tty.c_cc[VTIME] = pimpl_->config.vtime;
@@ -381,17 +409,108 @@ namespace tractor {
                 return false;
             }
 
+            if (speed == B0 && !set_custom_baud(pimpl_->config.baud_rate)) {
+                return false;
+            }
+            cache_baud_rate();
+
             // Flush any existing data
             tcflush(pimpl_->fd, TCIOFLUSH);
 
+            if (pimpl_->config.low_latency) {
+                apply_low_latency();
+            } else {
+                restore_serial_flags();
+                pimpl_->latency_report = LatencyReport{};
+            }
+
             return true;
         }
 
+        void Tty::apply_low_latency() {
+            LatencyReport report;
+            report.requested = true;
+
+            struct serial_struct serial;
+            std::memset(&serial, 0, sizeof(serial));
+            if (ioctl(pimpl_->fd, TIOCGSERIAL, &serial) != 0) {
+                report.notes.push_back(std::string("TIOCGSERIAL not supported: ") + std::strerror(errno));
+            } else {
+                if (!pimpl_->has_original_serial_flags) {
+                    pimpl_->original_serial_flags = serial.flags;
+                    pimpl_->has_original_serial_flags = true;
+                }
+                serial.flags |= ASYNC_LOW_LATENCY;
+                if (ioctl(pimpl_->fd, TIOCSSERIAL, &serial) == 0) {
+                    report.async_low_latency = true;
+                } else {
+                    report.notes.push_back(std::string("TIOCSSERIAL failed: ") + std::strerror(errno));
+                }
+            }
+
+            // USB serial drivers with a latency timer expose it next to the tty device
+            std::error_code ec;
+            std::filesystem::path device = std::filesystem::canonical(pimpl_->port, ec);
+            if (ec) {
+                device = pimpl_->port;
+            }
+            auto path = std::filesystem::path("/sys/class/tty") / device.filename() / "device" / "latency_timer";
+            auto read_timer = [&path]() {
+                int value = -1;
+                std::ifstream file(path);
+                if (!(file >> value)) {
+                    value = -1;
+                }
+                return value;
+            };
+
+            int current = read_timer();
+            if (current < 0) {
+                report.notes.push_back("No latency timer exposed by the driver");
+            } else {
+                report.latency_timer_path = path.string();
+                if (pimpl_->original_latency_timer < 0) {
+                    pimpl_->original_latency_timer = current;
+                }
+
+                const int wanted = pimpl_->config.latency_timer_ms;
+                if (wanted > 0 && current != wanted) {
+                    std::ofstream file(path);
+                    if (!(file << wanted) || !file.flush()) {
+                        report.notes.push_back("Latency timer not writable, needs root or a udev rule: " +
+                                               path.string());
+                    }
+                }
+                current = read_timer();
+            }
+            report.latency_timer_ms = pimpl_->original_latency_timer;
+            report.latency_timer_now_ms = current;
+
+            pimpl_->latency_report = std::move(report);
+        }
+
+        void Tty::restore_serial_flags() {
+            if (!pimpl_->has_original_serial_flags) {
+                return;
+            }
+
+            struct serial_struct serial;
+            if (ioctl(pimpl_->fd, TIOCGSERIAL, &serial) == 0) {
+                serial.flags = pimpl_->original_serial_flags;
+                ioctl(pimpl_->fd, TIOCSSERIAL, &serial);
+            }
+            pimpl_->has_original_serial_flags = false;
+        }
+
+        LatencyReport Tty::get_latency_report() const { return pimpl_->latency_report; }
+
         // Write operations
         ssize_t Tty::write(const uint8_t *data, size_t size) {
             if (data == nullptr || size == 0) {
                 return 0;
             }
+            TRACTOR_TRACE_SCOPE("tty", "write");
+            TRACTOR_TRACE_VALUE(size);
 
             if (!is_open()) {
                 pimpl_->last_error = "Port is not open";
@@ -440,6 +559,79 @@ namespace tractor {
 
         ssize_t Tty::write(const std::vector<uint8_t> &data) { return write(data.data(), data.size()); }
 
+        ssize_t Tty::write_vectored(const struct iovec *iov, int count) {
+            if (iov == nullptr || count <= 0) {
+                return 0;
+            }
+            TRACTOR_TRACE_SCOPE("tty", "write_vectored");
+            TRACTOR_TRACE_VALUE(count);
+
+            if (!is_open()) {
+                pimpl_->last_error = "Port is not open";
+                return -1;
+            }
+
+            // Partially written entries are advanced in a local copy, the caller's array stays untouched
+            constexpr int BATCH = 16;
+            struct iovec pending[BATCH];
+            ssize_t total_written = 0;
+
+            // Use select for write timeout
+            struct timeval timeout;
+            timeout.tv_sec = pimpl_->config.write_timeout_ms / 1000;
+            timeout.tv_usec = (pimpl_->config.write_timeout_ms % 1000) * 1000;
+
+            for (int offset = 0; offset < count; offset += BATCH) {
+                int batch = std::min(count - offset, BATCH);
+                std::copy(iov + offset, iov + offset + batch, pending);
+
+                int first = 0;
+                while (first < batch) {
+                    if (pending[first].iov_len == 0) {
+                        first++;
+                        continue;
+                    }
+
+                    fd_set write_fds;
+                    FD_ZERO(&write_fds);
+                    FD_SET(pimpl_->fd, &write_fds);
+
+                    int ret = select(pimpl_->fd + 1, nullptr, &write_fds, nullptr, &timeout);
+                    if (ret < 0) {
+                        pimpl_->last_error = std::string("Select error: ") + std::strerror(errno);
+                        return -1;
+                    } else if (ret == 0) {
+                        pimpl_->last_error = "Write timeout";
+                        return total_written;
+                    }
+
+                    ssize_t written = ::writev(pimpl_->fd, pending + first, batch - first);
+                    if (written < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                            continue;
+                        }
+                        pimpl_->last_error = std::string("Write error: ") + std::strerror(errno);
+                        return -1;
+                    }
+
+                    total_written += written;
+                    auto left = static_cast<size_t>(written);
+                    while (left > 0 && first < batch) {
+                        if (left >= pending[first].iov_len) {
+                            left -= pending[first].iov_len;
+                            first++;
+                        } else {
+                            pending[first].iov_base = static_cast<uint8_t *>(pending[first].iov_base) + left;
+                            pending[first].iov_len -= left;
+                            left = 0;
+                        }
+                    }
+                }
+            }
+
+            return total_written;
+        }
+
         ssize_t Tty::write(const std::string &data) {
             return write(reinterpret_cast<const uint8_t *>(data.data()), data.size());
         }
@@ -449,6 +641,7 @@ namespace tractor {
             if (buffer == nullptr || size == 0) {
                 return 0;
             }
+            TRACTOR_TRACE_SCOPE("tty", "read");
 
             if (!is_open()) {
                 pimpl_->last_error = "Port is not open";
@@ -478,7 +671,13 @@ namespace tractor {
                 pimpl_->last_error = std::string("Read error: ") + std::strerror(errno);
                 return -1;
             }
+            if (bytes_read == 0) {
+                // Readable without data: the device is gone, e.g. an unplugged adapter or a closed pty master
+                pimpl_->last_error = "Port hung up";
+                return -1;
+            }
 
+            TRACTOR_TRACE_VALUE(bytes_read);
             return bytes_read;
         }
 
@@ -493,6 +692,30 @@ namespace tractor {
             return bytes_read;
         }
 
+        ssize_t Tty::read_available(uint8_t *buffer, size_t size) {
+            if (buffer == nullptr || size == 0) {
+                return 0;
+            }
+            TRACTOR_TRACE_SCOPE("tty", "read_available");
+
+            if (!is_open()) {
+                pimpl_->last_error = "Port is not open";
+                return -1;
+            }
+
+            ssize_t bytes_read = ::read(pimpl_->fd, buffer, size);
+            if (bytes_read < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    return 0;
+                }
+                pimpl_->last_error = std::string("Read error: ") + std::strerror(errno);
+                return -1;
+            }
+
+            TRACTOR_TRACE_VALUE(bytes_read);
+            return bytes_read;
+        }
+
         std::vector<uint8_t> Tty::read_until(uint8_t delimiter, size_t max_size) {
             std::vector<uint8_t> result;
             result.reserve(256);
@@ -644,12 +867,20 @@ namespace tractor {
                 return false;
             }
 
-            speed_t speed = baud_rate_to_speed(baud_rate);
-            if (speed == B0) {
+            if (baud_rate == 0) {
                 pimpl_->last_error = "Unsupported baud rate";
                 return false;
             }
 
+            speed_t speed = baud_rate_to_speed(baud_rate);
+            if (speed == B0) {
+                if (!set_custom_baud(baud_rate)) {
+                    return false;
+                }
+                cache_baud_rate();
+                return true;
+            }
+
             cfsetispeed(&tty, speed);
             cfsetospeed(&tty, speed);
 
@@ -658,20 +889,39 @@ namespace tractor {
                 return false;
             }
 
+            cache_baud_rate();
             return true;
         }
 
-        uint32_t Tty::get_baud_rate() const {
-            if (!is_open()) {
-                return pimpl_->config.baud_rate;
+        bool Tty::set_custom_baud(uint32_t baud_rate) {
+            if (!termios2::set_speed(pimpl_->fd, baud_rate)) {
+                pimpl_->last_error = std::string("Unsupported baud rate: ") + std::strerror(errno);
+                return false;
+            }
+            return true;
+        }
+
+        void Tty::cache_baud_rate() {
+            // The driver may round a BOTHER rate to what its divider can produce, so ask it once here
+            // instead of on every get_baud_rate() call
+            uint32_t baud_rate = 0;
+            if (termios2::get_speed(pimpl_->fd, baud_rate) && baud_rate != 0) {
+                pimpl_->actual_baud_rate = baud_rate;
+                return;
             }
 
             struct termios tty;
-            if (tcgetattr(pimpl_->fd, &tty) != 0) {
-                return pimpl_->config.baud_rate;
+            if (tcgetattr(pimpl_->fd, &tty) == 0) {
+                baud_rate = speed_to_baud_rate(cfgetospeed(&tty));
             }
+            pimpl_->actual_baud_rate = baud_rate != 0 ? baud_rate : pimpl_->config.baud_rate;
+        }
 
-            return speed_to_baud_rate(cfgetospeed(&tty));
+        uint32_t Tty::get_baud_rate() const {
+            if (!is_open() || pimpl_->actual_baud_rate == 0) {
+                return pimpl_->config.baud_rate;
+            }
+            return pimpl_->actual_baud_rate;
         }
 
         void Tty::set_read_timeout(uint32_t timeout_ms) { pimpl_->config.read_timeout_ms = timeout_ms; }
@@ -866,6 +1116,27 @@ namespace tractor {
             tcsendbreak(pimpl_->fd, duration);
         }
 
+        bool Tty::set_non_blocking(bool enable) {
+            if (!is_open()) {
+                pimpl_->last_error = "Port is not open";
+                return false;
+            }
+
+            int flags = fcntl(pimpl_->fd, F_GETFL, 0);
+            if (flags == -1) {
+                pimpl_->last_error = std::string("Failed to get file flags: ") + std::strerror(errno);
+                return false;
+            }
+
+            flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+            if (fcntl(pimpl_->fd, F_SETFL, flags) == -1) {
+                pimpl_->last_error = std::string("Failed to set file flags: ") + std::strerror(errno);
+                return false;
+            }
+
+            return true;
+        }
+
         int Tty::get_fd() const { return pimpl_->fd; }
 
     } // namespace comms
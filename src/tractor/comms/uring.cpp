@@ -0,0 +1,255 @@
+#include "uring.hpp"
+
+#include <atomic>
+#include <cerrno>
+
+#ifdef TRACTOR_IO_URING
+#include <cstring>
+#include <ctime>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tractor {
+    namespace comms {
+        namespace uring {
+
+            Ring::~Ring() { close(); }
+
+#ifdef TRACTOR_IO_URING
+
+            namespace {
+                int enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg,
+                          size_t size) {
+                    long result = ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, size);
+                    return result < 0 ? -errno : static_cast<int>(result);
+                }
+
+                uint32_t load_acquire(uint32_t *value) {
+                    return std::atomic_ref<uint32_t>(*value).load(std::memory_order_acquire);
+                }
+
+                void store_release(uint32_t *value, uint32_t update) {
+                    std::atomic_ref<uint32_t>(*value).store(update, std::memory_order_release);
+                }
+            } // namespace
+
+            bool Ring::open(unsigned entries) {
+                close();
+
+                struct io_uring_params params {};
+                int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                if (fd < 0) {
+                    return false;
+                }
+
+                // Waiting with a timeout needs IORING_ENTER_EXT_ARG (5.11), older kernels use epoll
+                const uint32_t required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+                if ((params.features & required) != required) {
+                    ::close(fd);
+                    errno = ENOSYS;
+                    return false;
+                }
+
+                size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+                size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+                size_t ring_size = sq_size > cq_size ? sq_size : cq_size;
+                void *ring = ::mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                    IORING_OFF_SQ_RING);
+                if (ring == MAP_FAILED) {
+                    int error = errno;
+                    ::close(fd);
+                    errno = error;
+                    return false;
+                }
+
+                size_t sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+                void *sqes = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                    IORING_OFF_SQES);
+                if (sqes == MAP_FAILED) {
+                    int error = errno;
+                    ::munmap(ring, ring_size);
+                    ::close(fd);
+                    errno = error;
+                    return false;
+                }
+
+                auto *base = static_cast<uint8_t *>(ring);
+                fd_ = fd;
+                ring_ = ring;
+                ring_size_ = ring_size;
+                sqes_ = sqes;
+                sqes_size_ = sqes_size;
+                sq_head_ = reinterpret_cast<uint32_t *>(base + params.sq_off.head);
+                sq_tail_ = reinterpret_cast<uint32_t *>(base + params.sq_off.tail);
+                sq_array_ = reinterpret_cast<uint32_t *>(base + params.sq_off.array);
+                sq_mask_ = *reinterpret_cast<uint32_t *>(base + params.sq_off.ring_mask);
+                sq_entries_ = params.sq_entries;
+                cq_head_ = reinterpret_cast<uint32_t *>(base + params.cq_off.head);
+                cq_tail_ = reinterpret_cast<uint32_t *>(base + params.cq_off.tail);
+                cqes_ = base + params.cq_off.cqes;
+                cq_mask_ = *reinterpret_cast<uint32_t *>(base + params.cq_off.ring_mask);
+                return true;
+            }
+
+            void Ring::close() {
+                if (fd_ < 0) {
+                    return;
+                }
+                ::munmap(sqes_, sqes_size_);
+                ::munmap(ring_, ring_size_);
+                ::close(fd_);
+                fd_ = -1;
+                ring_ = nullptr;
+                sqes_ = nullptr;
+            }
+
+            bool Ring::register_buffers(const struct iovec *buffers, unsigned count) {
+                if (fd_ < 0) {
+                    errno = EBADF;
+                    return false;
+                }
+                return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+            }
+
+            bool Ring::prepare(uint8_t opcode, int fd, uint64_t address, uint32_t size, uint64_t user_data,
+                               uint16_t buffer_index, uint8_t flags, uint32_t op_flags) {
+                if (fd_ < 0) {
+                    return false;
+                }
+
+                uint32_t tail = load_acquire(sq_tail_);
+                if (tail - load_acquire(sq_head_) >= sq_entries_) {
+                    return false;
+                }
+
+                auto *sqe = static_cast<struct io_uring_sqe *>(sqes_) + (tail & sq_mask_);
+                std::memset(sqe, 0, sizeof(*sqe));
+                sqe->opcode = opcode;
+                sqe->flags = flags;
+                sqe->fd = fd;
+                sqe->addr = address;
+                sqe->len = size;
+                sqe->user_data = user_data;
+                sqe->buf_index = buffer_index;
+                sqe->rw_flags = static_cast<__kernel_rwf_t>(op_flags);
+
+                sq_array_[tail & sq_mask_] = tail & sq_mask_;
+                store_release(sq_tail_, tail + 1);
+                return true;
+            }
+
+            bool Ring::poll_in(int fd, uint64_t user_data) {
+                // The linked request needs its slot too, a lone poll would link to whatever comes next
+                if (fd_ < 0 || sq_entries_ - (load_acquire(sq_tail_) - load_acquire(sq_head_)) < 2) {
+                    return false;
+                }
+                return prepare(IORING_OP_POLL_ADD, fd, 0, 0, user_data, 0, IOSQE_IO_LINK, POLLIN);
+            }
+
+            bool Ring::read_fixed(int fd, void *buffer, uint32_t size, uint16_t buffer_index, uint64_t user_data) {
+                return prepare(IORING_OP_READ_FIXED, fd, reinterpret_cast<uint64_t>(buffer), size, user_data,
+                               buffer_index);
+            }
+
+            bool Ring::read(int fd, void *buffer, uint32_t size, uint64_t user_data) {
+                return prepare(IORING_OP_READ, fd, reinterpret_cast<uint64_t>(buffer), size, user_data);
+            }
+
+            bool Ring::recvmsg(int fd, struct msghdr *message, uint64_t user_data) {
+                return prepare(IORING_OP_RECVMSG, fd, reinterpret_cast<uint64_t>(message), 1, user_data);
+            }
+
+            bool Ring::cancel(uint64_t target, uint64_t user_data) {
+                return prepare(IORING_OP_ASYNC_CANCEL, -1, target, 0, user_data);
+            }
+
+            int Ring::submit() {
+                if (fd_ < 0) {
+                    return -EBADF;
+                }
+                uint32_t pending = load_acquire(sq_tail_) - load_acquire(sq_head_);
+                return pending == 0 ? 0 : enter(fd_, pending, 0, 0, nullptr, 0);
+            }
+
+            int Ring::wait(int timeout_ms) {
+                if (fd_ < 0) {
+                    return -EBADF;
+                }
+
+                // The tail may move under a concurrent submit(), the kernel consumes every entry only once
+                uint32_t pending = load_acquire(sq_tail_) - load_acquire(sq_head_);
+                if (load_acquire(cq_tail_) != *cq_head_) {
+                    int result = pending == 0 ? 0 : enter(fd_, pending, 0, 0, nullptr, 0);
+                    return result < 0 ? result : 0;
+                }
+
+                struct __kernel_timespec timeout {};
+                timeout.tv_sec = timeout_ms / 1000;
+                timeout.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+                struct io_uring_getevents_arg arg {};
+                arg.ts = timeout_ms >= 0 ? reinterpret_cast<uint64_t>(&timeout) : 0;
+
+                int result = enter(fd_, pending, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+                return result == -ETIME || result >= 0 ? 0 : result;
+            }
+
+            bool Ring::next(Completion &completion) {
+                if (fd_ < 0) {
+                    return false;
+                }
+
+                uint32_t head = *cq_head_;
+                if (head == load_acquire(cq_tail_)) {
+                    return false;
+                }
+
+                const auto *cqe = static_cast<const struct io_uring_cqe *>(cqes_) + (head & cq_mask_);
+                completion.user_data = cqe->user_data;
+                completion.result = cqe->res;
+                store_release(cq_head_, head + 1);
+                return true;
+            }
+
+#else
+
+            bool Ring::open(unsigned) {
+                errno = ENOSYS;
+                return false;
+            }
+
+            void Ring::close() {}
+
+            bool Ring::register_buffers(const struct iovec *, unsigned) {
+                errno = ENOSYS;
+                return false;
+            }
+
+            bool Ring::prepare(uint8_t, int, uint64_t, uint32_t, uint64_t, uint16_t, uint8_t, uint32_t) {
+                return false;
+            }
+
+            bool Ring::poll_in(int, uint64_t) { return false; }
+
+            bool Ring::read_fixed(int, void *, uint32_t, uint16_t, uint64_t) { return false; }
+
+            bool Ring::read(int, void *, uint32_t, uint64_t) { return false; }
+
+            bool Ring::recvmsg(int, struct msghdr *, uint64_t) { return false; }
+
+            bool Ring::cancel(uint64_t, uint64_t) { return false; }
+
+            int Ring::submit() { return -ENOSYS; }
+
+            int Ring::wait(int) { return -ENOSYS; }
+
+            bool Ring::next(Completion &) { return false; }
+
+#endif
+
+        } // namespace uring
+    } // namespace comms
+} // namespace tractor
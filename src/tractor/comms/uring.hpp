@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/uio.h>
+
+struct msghdr;
+
+namespace tractor {
+    namespace comms {
+        namespace uring {
+
+            // Thin io_uring wrapper on the raw system calls, so the backend needs no liburing. Built
+            // without TRACTOR_IO_URING, open() fails with ENOSYS and callers use their epoll path.
+
+            /**
+             * @brief One reaped completion
+             */
+            struct Completion {
+                uint64_t user_data = 0;
+                int32_t result = 0; // Bytes transferred, or -errno
+            };
+
+            /**
+             * @brief Submission and completion ring
+             *
+             * Preparing and submitting may happen on any thread but must be serialized by the caller.
+             * wait() and next() belong to a single reaping thread, which may wait while others submit.
+             */
+            class Ring {
+              public:
+                Ring() = default;
+                ~Ring();
+
+                // Delete copy
+                Ring(const Ring &) = delete;
+                Ring &operator=(const Ring &) = delete;
+
+                /**
+                 * @brief Create the ring
+                 * @param entries Submission queue size, rounded up to a power of two by the kernel
+                 * @return true if successful, false otherwise (errno is set)
+                 */
+                bool open(unsigned entries);
+
+                /**
+                 * @brief Destroy the ring, cancelling every request still in flight
+                 */
+                void close();
+
+                /**
+                 * @brief Check if the ring was created
+                 */
+                bool is_open() const { return fd_ >= 0; }
+
+                /**
+                 * @brief Register buffers for read_fixed(), pinning them for the lifetime of the ring
+                 * @param buffers Buffer table, the index of a buffer is its position here
+                 * @param count Number of buffers
+                 * @return true if successful, false otherwise (errno is set)
+                 */
+                bool register_buffers(const struct iovec *buffers, unsigned count);
+
+                /**
+                 * @brief Queue a wait until fd is readable, the request queued next starts only after it
+                 *
+                 * Keeps a read on a terminal with VMIN and VTIME at 0 from completing empty right away.
+                 * The wait completes on its own with the poll events; when it fails, the linked request
+                 * completes with -ECANCELED.
+                 *
+                 * @return true if queued, false if the submission queue has no room for the pair
+                 */
+                bool poll_in(int fd, uint64_t user_data);
+
+                /**
+                 * @brief Queue a read into a registered buffer
+                 * @return true if queued, false if the submission queue is full
+                 */
+                bool read_fixed(int fd, void *buffer, uint32_t size, uint16_t buffer_index, uint64_t user_data);
+
+                /**
+                 * @brief Queue a read into an unregistered buffer
+                 * @return true if queued, false if the submission queue is full
+                 */
+                bool read(int fd, void *buffer, uint32_t size, uint64_t user_data);
+
+                /**
+                 * @brief Queue a recvmsg()
+                 * @return true if queued, false if the submission queue is full
+                 */
+                bool recvmsg(int fd, struct msghdr *message, uint64_t user_data);
+
+                /**
+                 * @brief Queue the cancellation of every request queued with target as user data
+                 * @return true if queued, false if the submission queue is full
+                 */
+                bool cancel(uint64_t target, uint64_t user_data);
+
+                /**
+                 * @brief Hand the queued requests to the kernel
+                 * @return Number of requests submitted, or -errno
+                 */
+                int submit();
+
+                /**
+                 * @brief Submit the queued requests and wait for a completion
+                 * @param timeout_ms Longest wait, negative waits until a completion arrives
+                 * @return 0 when a completion is ready or the wait timed out, -errno otherwise
+                 */
+                int wait(int timeout_ms);
+
+                /**
+                 * @brief Reap the next completion
+                 * @param completion Receives the completion
+                 * @return true if one was reaped, false if the completion queue is empty
+                 */
+                bool next(Completion &completion);
+
+              private:
+                bool prepare(uint8_t opcode, int fd, uint64_t address, uint32_t size, uint64_t user_data,
+                             uint16_t buffer_index = 0, uint8_t flags = 0, uint32_t op_flags = 0);
+
+                int fd_ = -1;
+                void *ring_ = nullptr;
+                size_t ring_size_ = 0;
+                void *sqes_ = nullptr;
+                size_t sqes_size_ = 0;
+
+                uint32_t *sq_head_ = nullptr;
+                uint32_t *sq_tail_ = nullptr;
+                uint32_t *sq_array_ = nullptr;
+                uint32_t sq_mask_ = 0;
+                uint32_t sq_entries_ = 0;
+
+                uint32_t *cq_head_ = nullptr;
+                uint32_t *cq_tail_ = nullptr;
+                void *cqes_ = nullptr;
+                uint32_t cq_mask_ = 0;
+            };
+
+        } // namespace uring
+    } // namespace comms
+} // namespace tractor
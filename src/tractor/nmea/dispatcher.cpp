@@ -0,0 +1,83 @@
+#include "tractor/nmea/dispatcher.hpp"
+#include "tractor/trace.hpp"
+
+namespace tractor {
+    namespace nmea {
+
+        bool Dispatcher::on(std::string_view name, Handler handler) {
+            if (!handler) {
+                return false;
+            }
+            return add(sentence_key(name), [handler = std::move(handler)](const Sentence &sentence) {
+                handler(sentence);
+                return Error::None;
+            });
+        }
+
+        bool Dispatcher::add(uint64_t key, Route route) {
+            if (key == 0) {
+                return false;
+            }
+            for (auto &entry : entries_) {
+                if (entry.key == key) {
+                    entry.route = std::move(route);
+                    return true;
+                }
+            }
+            entries_.push_back(Entry{key, std::move(route)});
+            return true;
+        }
+
+        void Dispatcher::remove(std::string_view name) {
+            uint64_t key = sentence_key(name);
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                if (it->key == key) {
+                    entries_.erase(it);
+                    return;
+                }
+            }
+        }
+
+        void Dispatcher::on_error(ErrorHandler handler) { error_handler_ = std::move(handler); }
+
+        void Dispatcher::on_unhandled(Handler handler) { unhandled_handler_ = std::move(handler); }
+
+        bool Dispatcher::handles(std::string_view name) const {
+            uint64_t key = sentence_key(name);
+            for (const auto &entry : entries_) {
+                if (entry.key == key) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        Error Dispatcher::dispatch(std::string_view line) {
+            TRACTOR_TRACE_SCOPE("nmea", "dispatch");
+            Sentence sentence;
+            Error error = split(line, sentence);
+            if (error == Error::None) {
+                uint64_t key = sentence_key(sentence);
+                error = Error::Unhandled;
+                for (auto &entry : entries_) {
+                    if (entry.key == key) {
+                        error = entry.route(sentence);
+                        break;
+                    }
+                }
+                if (error == Error::Unhandled) {
+                    if (unhandled_handler_) {
+                        unhandled_handler_(sentence);
+                    }
+                    return error;
+                }
+            }
+
+            if (error != Error::None && error_handler_) {
+                error_handler_(line, error);
+            }
+            return error;
+        }
+
+    } // namespace nmea
+} // namespace tractor
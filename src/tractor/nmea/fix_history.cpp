@@ -0,0 +1,187 @@
+#include "tractor/nmea/fix_history.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tractor {
+    namespace nmea {
+
+        namespace {
+
+            using Clock = std::chrono::steady_clock;
+
+            constexpr double KNOTS_TO_MPS = 1852.0 / 3600.0;
+            constexpr double EARTH_RADIUS_M = 6371008.8; // Mean radius, good enough over a few meters
+            constexpr double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+            double seconds(Clock::duration duration) { return std::chrono::duration<double>(duration).count(); }
+
+            // Difference b - a of two angles in degrees, in [-180, 180)
+            double angle_delta(double a, double b) {
+                double delta = std::fmod(b - a + 180.0, 360.0);
+                return (delta < 0.0 ? delta + 360.0 : delta) - 180.0;
+            }
+
+            double wrap_longitude(double longitude) { return angle_delta(0.0, longitude); }
+
+            double wrap_course(double course) {
+                double wrapped = std::fmod(course, 360.0);
+                return wrapped < 0.0 ? wrapped + 360.0 : wrapped;
+            }
+
+            Fix interpolate(const Fix &a, const Fix &b, Clock::time_point time) {
+                if (b.time <= a.time) {
+                    return b;
+                }
+                double f = seconds(time - a.time) / seconds(b.time - a.time);
+                if (f <= 0.0) {
+                    return a;
+                }
+
+                Fix fix = f < 0.5 ? a : b;
+                fix.time = time;
+                fix.latitude = a.latitude + f * (b.latitude - a.latitude);
+                fix.longitude = wrap_longitude(a.longitude + f * angle_delta(a.longitude, b.longitude));
+                fix.altitude = a.altitude + f * (b.altitude - a.altitude);
+                fix.course_deg = wrap_course(a.course_deg + f * angle_delta(a.course_deg, b.course_deg));
+                fix.speed_mps = a.speed_mps + f * (b.speed_mps - a.speed_mps);
+                fix.hdop = std::max(a.hdop, b.hdop);
+                fix.has_course = a.has_course && b.has_course;
+                fix.interpolated = true;
+                return fix;
+            }
+        } // namespace
+
+        FixHistory::FixHistory(size_t capacity) : ring_(std::max<size_t>(capacity, 2)) {}
+
+        FixHistory::~FixHistory() = default;
+
+        bool FixHistory::update(const GGA &gga, Clock::time_point time) {
+            if (gga.fix_quality == 0 || !gga.has_position) {
+                return false;
+            }
+
+            Fix fix;
+            fix.time = time;
+            fix.latitude = gga.latitude;
+            fix.longitude = gga.longitude;
+            fix.altitude = gga.altitude;
+            fix.course_deg = course_deg_;
+            fix.speed_mps = speed_mps_;
+            fix.hdop = gga.hdop;
+            fix.fix_quality = gga.fix_quality;
+            fix.satellites = gga.satellites;
+            fix.has_course = has_course_;
+            push(fix);
+            return true;
+        }
+
+        void FixHistory::update(const RMC &rmc) {
+            if (!rmc.active || !rmc.has_course) {
+                return;
+            }
+            course_deg_ = rmc.course_deg;
+            speed_mps_ = rmc.speed_knots * KNOTS_TO_MPS;
+            has_course_ = true;
+        }
+
+        void FixHistory::update(const VTG &vtg) {
+            if (!vtg.has_course) {
+                return;
+            }
+            course_deg_ = vtg.course_true_deg;
+            speed_mps_ = vtg.speed_kmh > 0.0 ? vtg.speed_kmh / 3.6 : vtg.speed_knots * KNOTS_TO_MPS;
+            has_course_ = true;
+        }
+
+        bool FixHistory::at(Clock::time_point time, Fix &fix, Clock::duration max_extrapolation) const {
+            // Starts over in the rare case the writer overwrote a fix while it was searched
+            for (;;) {
+                uint64_t head = ring_.head();
+                if (head == 0) {
+                    return false;
+                }
+
+                Fix newest;
+                if (!ring_.read(head - 1, newest)) {
+                    continue;
+                }
+
+                if (time >= newest.time) {
+                    Clock::duration ahead = time - newest.time;
+                    if (ahead > max_extrapolation) {
+                        return false;
+                    }
+                    fix = newest;
+                    if (ahead == Clock::duration::zero()) {
+                        return true;
+                    }
+
+                    double dt = seconds(ahead);
+                    double north_mps = 0.0;
+                    double east_mps = 0.0;
+                    Fix previous;
+                    if (newest.has_course) {
+                        north_mps = newest.speed_mps * std::cos(newest.course_deg * DEG_TO_RAD);
+                        east_mps = newest.speed_mps * std::sin(newest.course_deg * DEG_TO_RAD);
+                    } else if (head >= 2 && ring_.read(head - 2, previous) && previous.time < newest.time) {
+                        // Degrees per second along the line through the two newest fixes
+                        double span = seconds(newest.time - previous.time);
+                        fix.latitude += (newest.latitude - previous.latitude) / span * dt;
+                        fix.longitude += angle_delta(previous.longitude, newest.longitude) / span * dt;
+                        fix.altitude += (newest.altitude - previous.altitude) / span * dt;
+                    }
+
+                    double meters_per_degree = EARTH_RADIUS_M * DEG_TO_RAD;
+                    double cos_latitude = std::max(std::cos(newest.latitude * DEG_TO_RAD), 1e-9);
+                    fix.latitude += north_mps * dt / meters_per_degree;
+                    fix.longitude = wrap_longitude(fix.longitude + east_mps * dt / (meters_per_degree * cos_latitude));
+                    fix.time = time;
+                    fix.extrapolated = true;
+                    return true;
+                }
+
+                // Binary search for the newest fix not after time, older fixes sit at lower indexes
+                uint64_t low = head > capacity() ? head - capacity() : 0;
+                uint64_t high = head - 1;
+                Fix before;
+                if (!ring_.read(low, before)) {
+                    continue;
+                }
+                if (time < before.time) {
+                    return false;
+                }
+
+                Fix after = newest;
+                bool overwritten = false;
+                while (high - low > 1) {
+                    uint64_t middle = low + (high - low) / 2;
+                    Fix probe;
+                    if (!ring_.read(middle, probe)) {
+                        overwritten = true;
+                        break;
+                    }
+                    if (probe.time <= time) {
+                        low = middle;
+                        before = probe;
+                    } else {
+                        high = middle;
+                        after = probe;
+                    }
+                }
+                if (overwritten) {
+                    continue;
+                }
+
+                fix = interpolate(before, after, time);
+                return true;
+            }
+        }
+
+        void FixHistory::clear() {
+            ring_.clear();
+            has_course_ = false;
+        }
+
+    } // namespace nmea
+} // namespace tractor
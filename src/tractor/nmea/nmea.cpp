@@ -0,0 +1,400 @@
+#include "tractor/nmea/nmea.hpp"
+#include "tractor/comms/scan.hpp"
+
+#include <charconv>
+#include <cmath>
+
+namespace tractor {
+    namespace nmea {
+
+        namespace {
+
+            // More than any sentence parsed here carries, extra fields are ignored
+            constexpr size_t MAX_FIELDS = 24;
+
+            struct Fields {
+                std::array<std::string_view, MAX_FIELDS> at;
+                size_t count = 0;
+            };
+
+            void collect(std::string_view list, Fields &out) {
+                FieldReader reader(list);
+                std::string_view field;
+                out.count = 0;
+                while (out.count < MAX_FIELDS && reader.next(field)) {
+                    out.at[out.count++] = field;
+                }
+            }
+
+            int hex_value(char c) {
+                if (c >= '0' && c <= '9') {
+                    return c - '0';
+                }
+                if (c >= 'A' && c <= 'F') {
+                    return c - 'A' + 10;
+                }
+                if (c >= 'a' && c <= 'f') {
+                    return c - 'a' + 10;
+                }
+                return -1;
+            }
+
+            // Numeric fields: empty means 0, anything but a complete number is an error
+            template <typename T> bool to_integer(std::string_view field, T &out) {
+                if (field.empty()) {
+                    out = 0;
+                    return true;
+                }
+                T value{};
+                auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+                if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+                    return false;
+                }
+                out = value;
+                return true;
+            }
+
+            // Fixed notation only, NMEA has no exponents, and never inf or nan
+            bool to_double(std::string_view field, double &out) {
+                if (field.empty()) {
+                    out = 0.0;
+                    return true;
+                }
+                double value = 0.0;
+                const char *end = field.data() + field.size();
+                auto result = std::from_chars(field.data(), end, value, std::chars_format::fixed);
+                if (result.ec != std::errc() || result.ptr != end || !std::isfinite(value)) {
+                    return false;
+                }
+                out = value;
+                return true;
+            }
+
+            bool to_two_digits(std::string_view field, size_t offset, uint8_t &out) {
+                char high = field[offset];
+                char low = field[offset + 1];
+                if (high < '0' || high > '9' || low < '0' || low > '9') {
+                    return false;
+                }
+                out = static_cast<uint8_t>((high - '0') * 10 + (low - '0'));
+                return true;
+            }
+
+            bool to_time(std::string_view field, Time &out) {
+                out = Time{};
+                if (field.empty()) {
+                    return true;
+                }
+                if (field.size() < 6 || !to_two_digits(field, 0, out.hour) || !to_two_digits(field, 2, out.minute) ||
+                    !to_double(field.substr(4), out.second) || out.hour > 23 || out.minute > 59 ||
+                    out.second >= 61.0) {
+                    return false;
+                }
+                out.valid = true;
+                return true;
+            }
+
+            bool to_date(std::string_view field, Date &out) {
+                out = Date{};
+                if (field.empty()) {
+                    return true;
+                }
+                uint8_t year = 0;
+                if (field.size() != 6 || !to_two_digits(field, 0, out.day) || !to_two_digits(field, 2, out.month) ||
+                    !to_two_digits(field, 4, year) || out.day < 1 || out.day > 31 || out.month < 1 || out.month > 12) {
+                    return false;
+                }
+                out.year = static_cast<uint16_t>(year < 80 ? 2000 + year : 1900 + year);
+                out.valid = true;
+                return true;
+            }
+
+            // (d)ddmm.mmmm plus hemisphere to signed decimal degrees
+            bool to_coordinate(std::string_view value, std::string_view hemisphere, char positive, char negative,
+                               double limit, double &out, bool &present) {
+                present = false;
+                out = 0.0;
+                if (value.empty() && hemisphere.empty()) {
+                    return true;
+                }
+                double raw = 0.0;
+                if (value.empty() || hemisphere.size() != 1 || !to_double(value, raw) || raw < 0.0) {
+                    return false;
+                }
+                if (hemisphere[0] != positive && hemisphere[0] != negative) {
+                    return false;
+                }
+                double degrees = std::floor(raw / 100.0);
+                double minutes = raw - degrees * 100.0;
+                if (minutes >= 60.0 || degrees + minutes / 60.0 > limit) {
+                    return false;
+                }
+                out = degrees + minutes / 60.0;
+                if (hemisphere[0] == negative) {
+                    out = -out;
+                }
+                present = true;
+                return true;
+            }
+
+            bool to_char(std::string_view field, char fallback, char &out) {
+                if (field.size() > 1) {
+                    return false;
+                }
+                out = field.empty() ? fallback : field[0];
+                return true;
+            }
+
+            template <typename T> Error split_and_parse(std::string_view text, T &out) {
+                Sentence sentence;
+                Error error = split(text, sentence);
+                if (error != Error::None) {
+                    return error;
+                }
+                return parse(sentence, out);
+            }
+
+        } // namespace
+
+        const char *error_name(Error error) {
+            switch (error) {
+            case Error::None:
+                return "none";
+            case Error::Empty:
+                return "empty";
+            case Error::MissingStart:
+                return "missing start";
+            case Error::MissingChecksum:
+                return "missing checksum";
+            case Error::BadChecksum:
+                return "bad checksum";
+            case Error::BadAddress:
+                return "bad address";
+            case Error::WrongType:
+                return "wrong type";
+            case Error::TooFewFields:
+                return "too few fields";
+            case Error::BadField:
+                return "bad field";
+            case Error::FieldTooLong:
+                return "field too long";
+            case Error::Unhandled:
+                return "unhandled";
+            }
+            return "unknown";
+        }
+
+        Error split(std::string_view sentence, Sentence &out) {
+            while (!sentence.empty() && (sentence.back() == '\n' || sentence.back() == '\r')) {
+                sentence.remove_suffix(1);
+            }
+            if (sentence.empty()) {
+                return Error::Empty;
+            }
+            if (sentence[0] != '$' && sentence[0] != '!') {
+                return Error::MissingStart;
+            }
+
+            // The checksum field is always the last three characters
+            if (sentence.size() < 4 || sentence[sentence.size() - 3] != '*') {
+                return Error::MissingChecksum;
+            }
+            int high = hex_value(sentence[sentence.size() - 2]);
+            int low = hex_value(sentence[sentence.size() - 1]);
+            if (high < 0 || low < 0) {
+                return Error::MissingChecksum;
+            }
+            std::string_view body = sentence.substr(1, sentence.size() - 4);
+            if (comms::xor_bytes(reinterpret_cast<const uint8_t *>(body.data()), body.size()) != high * 16 + low) {
+                return Error::BadChecksum;
+            }
+
+            size_t comma = body.find(',');
+            std::string_view address = body.substr(0, comma);
+            if (address.empty()) {
+                return Error::BadAddress;
+            }
+
+            out.address = address;
+            if (address[0] == 'P') {
+                out.talker = address.substr(0, 1);
+                out.type = address.substr(1);
+            } else {
+                if (address.size() < 3) {
+                    return Error::BadAddress;
+                }
+                out.talker = address.substr(0, 2);
+                out.type = address.substr(2);
+            }
+            if (out.type.empty()) {
+                return Error::BadAddress;
+            }
+            out.fields = comma == std::string_view::npos ? std::string_view() : body.substr(comma + 1);
+            return Error::None;
+        }
+
+        Error parse(const Sentence &sentence, GGA &out) {
+            if (sentence.proprietary() || sentence.type != "GGA") {
+                return Error::WrongType;
+            }
+            Fields f;
+            collect(sentence.fields, f);
+            if (f.count < 9) {
+                return Error::TooFewFields;
+            }
+
+            if (!to_time(f.at[0], out.time)) {
+                return Error::BadField;
+            }
+            bool has_latitude = false;
+            bool has_longitude = false;
+            if (!to_coordinate(f.at[1], f.at[2], 'N', 'S', 90.0, out.latitude, has_latitude) ||
+                !to_coordinate(f.at[3], f.at[4], 'E', 'W', 180.0, out.longitude, has_longitude)) {
+                return Error::BadField;
+            }
+            out.has_position = has_latitude && has_longitude;
+            if (!to_integer(f.at[5], out.fix_quality) || !to_integer(f.at[6], out.satellites) ||
+                !to_double(f.at[7], out.hdop) || !to_double(f.at[8], out.altitude)) {
+                return Error::BadField;
+            }
+
+            // Geoid separation and differential fields are optional (indices 10, 12 and 13)
+            out.geoid_separation = 0.0;
+            out.dgps_age = 0.0;
+            out.dgps_station = 0;
+            if ((f.count > 10 && !to_double(f.at[10], out.geoid_separation)) ||
+                (f.count > 12 && !to_double(f.at[12], out.dgps_age)) ||
+                (f.count > 13 && !to_integer(f.at[13], out.dgps_station))) {
+                return Error::BadField;
+            }
+            return Error::None;
+        }
+
+        Error parse(const Sentence &sentence, RMC &out) {
+            if (sentence.proprietary() || sentence.type != "RMC") {
+                return Error::WrongType;
+            }
+            Fields f;
+            collect(sentence.fields, f);
+            if (f.count < 9) {
+                return Error::TooFewFields;
+            }
+
+            if (!to_time(f.at[0], out.time)) {
+                return Error::BadField;
+            }
+            if (f.at[1] != "A" && f.at[1] != "V") {
+                return Error::BadField;
+            }
+            out.active = f.at[1] == "A";
+            bool has_latitude = false;
+            bool has_longitude = false;
+            if (!to_coordinate(f.at[2], f.at[3], 'N', 'S', 90.0, out.latitude, has_latitude) ||
+                !to_coordinate(f.at[4], f.at[5], 'E', 'W', 180.0, out.longitude, has_longitude)) {
+                return Error::BadField;
+            }
+            out.has_position = has_latitude && has_longitude;
+            if (!to_double(f.at[6], out.speed_knots) || !to_double(f.at[7], out.course_deg) ||
+                !to_date(f.at[8], out.date)) {
+                return Error::BadField;
+            }
+            out.has_course = !f.at[7].empty();
+
+            out.magnetic_variation = 0.0;
+            out.mode = 'N';
+            if (f.count > 9 && !to_double(f.at[9], out.magnetic_variation)) {
+                return Error::BadField;
+            }
+            if (f.count > 10 && f.at[10] == "W") {
+                out.magnetic_variation = -out.magnetic_variation;
+            }
+            if (f.count > 11 && !to_char(f.at[11], 'N', out.mode)) {
+                return Error::BadField;
+            }
+            return Error::None;
+        }
+
+        Error parse(const Sentence &sentence, VTG &out) {
+            if (sentence.proprietary() || sentence.type != "VTG") {
+                return Error::WrongType;
+            }
+            Fields f;
+            collect(sentence.fields, f);
+            if (f.count < 8) {
+                return Error::TooFewFields;
+            }
+
+            if (!to_double(f.at[0], out.course_true_deg) || !to_double(f.at[2], out.course_magnetic_deg) ||
+                !to_double(f.at[4], out.speed_knots) || !to_double(f.at[6], out.speed_kmh)) {
+                return Error::BadField;
+            }
+            out.has_course = !f.at[0].empty();
+            out.mode = 'N';
+            if (f.count > 8 && !to_char(f.at[8], 'N', out.mode)) {
+                return Error::BadField;
+            }
+            return Error::None;
+        }
+
+        Error parse(const Sentence &sentence, GSA &out) {
+            if (sentence.proprietary() || sentence.type != "GSA") {
+                return Error::WrongType;
+            }
+            Fields f;
+            collect(sentence.fields, f);
+            if (f.count < 17) {
+                return Error::TooFewFields;
+            }
+
+            if (!to_char(f.at[0], 'A', out.selection) || !to_integer(f.at[1], out.fix_type)) {
+                return Error::BadField;
+            }
+            out.satellite_count = 0;
+            out.satellites.fill(0);
+            for (size_t i = 0; i < GSA::MAX_SATELLITES; i++) {
+                uint8_t prn = 0;
+                if (!to_integer(f.at[2 + i], prn)) {
+                    return Error::BadField;
+                }
+                if (prn != 0) {
+                    out.satellites[out.satellite_count++] = prn;
+                }
+            }
+            if (!to_double(f.at[14], out.pdop) || !to_double(f.at[15], out.hdop) || !to_double(f.at[16], out.vdop)) {
+                return Error::BadField;
+            }
+            out.system_id = 0;
+            if (f.count > 17 && !to_integer(f.at[17], out.system_id)) {
+                return Error::BadField;
+            }
+            return Error::None;
+        }
+
+        Error parse(const Sentence &sentence, PHTG &out) {
+            if (sentence.address != "PHTG") {
+                return Error::WrongType;
+            }
+            Fields f;
+            collect(sentence.fields, f);
+            if (f.count < 6) {
+                return Error::TooFewFields;
+            }
+
+            if (!out.date.assign(f.at[0]) || !out.time.assign(f.at[1]) || !out.system.assign(f.at[2]) ||
+                !out.service.assign(f.at[3])) {
+                return Error::FieldTooLong;
+            }
+            if (!to_integer(f.at[4], out.auth_result) || !to_integer(f.at[5], out.warning)) {
+                return Error::BadField;
+            }
+            return Error::None;
+        }
+
+        Error parse(std::string_view sentence, GGA &out) { return split_and_parse(sentence, out); }
+        Error parse(std::string_view sentence, RMC &out) { return split_and_parse(sentence, out); }
+        Error parse(std::string_view sentence, VTG &out) { return split_and_parse(sentence, out); }
+        Error parse(std::string_view sentence, GSA &out) { return split_and_parse(sentence, out); }
+        Error parse(std::string_view sentence, PHTG &out) { return split_and_parse(sentence, out); }
+
+    } // namespace nmea
+} // namespace tractor
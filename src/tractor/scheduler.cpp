@@ -0,0 +1,315 @@
+#include "tractor/scheduler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+namespace tractor {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+    } // namespace
+
+    struct Scheduler::Impl {
+        struct Task {
+            TaskId id = 0;
+            TaskOptions options;
+            Callback callback;
+            Clock::time_point next;   // Next periodic release
+            Clock::time_point posted; // Release by post(), valid while pending
+            bool pending = false;
+            bool removed = false; // Removed from its own callback, erased once it returns
+            TaskStatistics statistics;
+        };
+
+        struct Lane {
+            int cpu = -1;
+            int number = 0;
+            std::vector<std::unique_ptr<Task>> tasks;
+            std::thread thread;
+            std::condition_variable wake;
+            TaskId running = 0; // Task whose callback is executing
+        };
+
+        SchedulerOptions options;
+        mutable std::mutex mutex;
+        std::condition_variable idle; // Signalled whenever a callback returns
+        std::vector<std::unique_ptr<Lane>> lanes;
+        TaskId next_id = 1;
+        bool running = false;
+        bool stopping = false;
+        std::string last_error;
+
+        Task *find(TaskId id, Lane **lane = nullptr) const {
+            for (const auto &candidate : lanes) {
+                for (const auto &task : candidate->tasks) {
+                    if (task->id == id && !task->removed) {
+                        if (lane != nullptr) {
+                            *lane = candidate.get();
+                        }
+                        return task.get();
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        static void erase(Lane &lane, TaskId id) {
+            auto &tasks = lane.tasks;
+            tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [id](const auto &task) { return task->id == id; }),
+                        tasks.end());
+        }
+
+        // Called with the mutex held
+        void launch(Lane &lane) {
+            lane.thread = std::thread(&Impl::run, this, &lane);
+            pthread_t handle = lane.thread.native_handle();
+
+            if (lane.cpu >= 0) {
+                int result = EINVAL;
+                if (lane.cpu < CPU_SETSIZE) {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    CPU_SET(lane.cpu, &set);
+                    result = ::pthread_setaffinity_np(handle, sizeof(set), &set);
+                }
+                if (result != 0) {
+                    last_error = "Failed to pin lane to CPU " + std::to_string(lane.cpu) + ": " + std::strerror(result);
+                }
+            }
+
+            if (options.realtime) {
+                sched_param param{};
+                param.sched_priority = std::clamp(options.realtime_priority, 1, 99);
+                int result = ::pthread_setschedparam(handle, SCHED_FIFO, &param);
+                if (result != 0) {
+                    last_error = "Failed to set real-time priority: " + std::string(std::strerror(result));
+                }
+            }
+        }
+
+        void run(Lane *lane) {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping) {
+                auto now = Clock::now();
+                Task *best = nullptr;
+                Clock::time_point best_release;
+                Clock::time_point wake_at = Clock::time_point::max();
+
+                // Tasks are in the order they were added, so a strict comparison keeps the older one on ties
+                for (const auto &task : lane->tasks) {
+                    bool periodic = task->options.period.count() > 0;
+                    bool due = periodic && task->next <= now;
+                    if (!due && !task->pending) {
+                        if (periodic) {
+                            wake_at = std::min(wake_at, task->next);
+                        }
+                        continue;
+                    }
+                    Clock::time_point release = due ? task->next : task->posted;
+                    if (due && task->pending) {
+                        release = std::min(task->next, task->posted);
+                    }
+                    if (best == nullptr || task->options.priority > best->options.priority ||
+                        (task->options.priority == best->options.priority && release < best_release)) {
+                        best = task.get();
+                        best_release = release;
+                    }
+                }
+
+                if (best == nullptr) {
+                    if (wake_at == Clock::time_point::max()) {
+                        lane->wake.wait(lock);
+                    } else {
+                        lane->wake.wait_until(lock, wake_at);
+                    }
+                    continue;
+                }
+
+                // Move to the next release still ahead, the ones passed by are overruns
+                auto period = best->options.period;
+                if (period.count() > 0 && best->next <= now) {
+                    auto missed = (now - best->next) / period;
+                    best->next += (missed + 1) * period;
+                    best->statistics.overruns += static_cast<uint64_t>(missed);
+                }
+                best->pending = false;
+
+                TaskId id = best->id;
+                auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - best_release);
+                lane->running = id;
+                lock.unlock();
+                auto begin = Clock::now();
+                best->callback();
+                auto runtime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin);
+                lock.lock();
+                lane->running = 0;
+
+                auto &statistics = best->statistics;
+                statistics.runs++;
+                statistics.last_latency = latency;
+                statistics.max_latency = std::max(statistics.max_latency, latency);
+                statistics.max_runtime = std::max(statistics.max_runtime, runtime);
+                if (best->removed) {
+                    erase(*lane, id);
+                }
+                idle.notify_all();
+            }
+        }
+    };
+
+    Scheduler::Scheduler(const SchedulerOptions &options) : pimpl_(std::make_unique<Impl>()) {
+        pimpl_->options = options;
+    }
+
+    Scheduler::~Scheduler() { stop(); }
+
+    Scheduler::TaskId Scheduler::add(const TaskOptions &options, Callback callback) {
+        if (!callback) {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        auto task = std::make_unique<Impl::Task>();
+        task->id = pimpl_->next_id++;
+        task->options = options;
+        task->callback = std::move(callback);
+        task->next = Clock::now() + options.offset;
+        TaskId id = task->id;
+
+        int cpu = std::max(options.cpu, -1);
+        auto it = std::find_if(pimpl_->lanes.begin(), pimpl_->lanes.end(),
+                               [&](const auto &lane) { return lane->cpu == cpu && lane->number == options.lane; });
+        if (it != pimpl_->lanes.end()) {
+            (*it)->tasks.push_back(std::move(task));
+            (*it)->wake.notify_one();
+            return id;
+        }
+
+        auto lane = std::make_unique<Impl::Lane>();
+        lane->cpu = cpu;
+        lane->number = options.lane;
+        lane->tasks.push_back(std::move(task));
+        pimpl_->lanes.push_back(std::move(lane));
+        if (pimpl_->running && !pimpl_->stopping) {
+            pimpl_->launch(*pimpl_->lanes.back());
+        }
+        return id;
+    }
+
+    bool Scheduler::remove(TaskId id) {
+        std::unique_lock<std::mutex> lock(pimpl_->mutex);
+        Impl::Lane *lane = nullptr;
+        if (pimpl_->find(id, &lane) == nullptr) {
+            return false;
+        }
+
+        if (lane->running == id) {
+            if (lane->thread.get_id() == std::this_thread::get_id()) {
+                pimpl_->find(id)->removed = true;
+                return true;
+            }
+            pimpl_->idle.wait(lock, [lane, id] { return lane->running != id; });
+            if (pimpl_->find(id) == nullptr) {
+                return false;
+            }
+        }
+        Impl::erase(*lane, id);
+        return true;
+    }
+
+    bool Scheduler::post(TaskId id) {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        Impl::Lane *lane = nullptr;
+        Impl::Task *task = pimpl_->find(id, &lane);
+        if (task == nullptr) {
+            return false;
+        }
+        if (!task->pending) {
+            task->pending = true;
+            task->posted = Clock::now();
+            lane->wake.notify_one();
+        }
+        return true;
+    }
+
+    bool Scheduler::start() {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        if (pimpl_->running) {
+            return true;
+        }
+
+        auto now = Clock::now();
+        pimpl_->stopping = false;
+        for (auto &lane : pimpl_->lanes) {
+            for (auto &task : lane->tasks) {
+                task->next = now + task->options.offset;
+            }
+            pimpl_->launch(*lane);
+        }
+        pimpl_->running = true;
+        return true;
+    }
+
+    void Scheduler::stop() {
+        // Lanes added from here on are launched by the next start()
+        std::vector<Impl::Lane *> lanes;
+        {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            if (!pimpl_->running || pimpl_->stopping) {
+                return;
+            }
+            pimpl_->stopping = true;
+            for (auto &lane : pimpl_->lanes) {
+                lane->wake.notify_all();
+                lanes.push_back(lane.get());
+            }
+        }
+
+        for (auto *lane : lanes) {
+            if (lane->thread.joinable()) {
+                lane->thread.join();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->running = false;
+    }
+
+    bool Scheduler::is_running() const {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        return pimpl_->running;
+    }
+
+    size_t Scheduler::size() const {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        size_t count = 0;
+        for (const auto &lane : pimpl_->lanes) {
+            count += static_cast<size_t>(std::count_if(lane->tasks.begin(), lane->tasks.end(),
+                                                       [](const auto &task) { return !task->removed; }));
+        }
+        return count;
+    }
+
+    bool Scheduler::get_statistics(TaskId id, TaskStatistics &statistics) const {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        const Impl::Task *task = pimpl_->find(id);
+        if (task == nullptr) {
+            return false;
+        }
+        statistics = task->statistics;
+        return true;
+    }
+
+    std::string Scheduler::get_last_error() const {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        return pimpl_->last_error;
+    }
+
+} // namespace tractor
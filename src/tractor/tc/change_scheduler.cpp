@@ -0,0 +1,397 @@
+#include "tractor/tc/change_scheduler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tractor {
+    namespace tc {
+
+        namespace {
+
+            using Clock = std::chrono::steady_clock;
+
+            constexpr uint64_t NEVER = UINT64_MAX;
+            constexpr int32_t NONE = -1;
+
+            constexpr uint64_t to_ticks(uint32_t ms) {
+                return (static_cast<uint64_t>(ms) + ChangeScheduler::TICK_MS - 1) / ChangeScheduler::TICK_MS;
+            }
+
+        } // namespace
+
+        struct ChangeScheduler::Impl {
+            struct Watch {
+                ProcessDataStore::Handle handle = ProcessDataStore::INVALID_HANDLE;
+                ClientId client = ClientId::Default;
+                uint16_t element = 0;
+                uint16_t ddi = 0;
+                TriggerSettings settings;
+                int32_t last_value = 0;
+                uint64_t last_tick = 0;
+                uint32_t last_distance = 0;
+                bool sent_once = false;
+                bool pending = false; // A change waits for the end of its window
+
+                // Timer wheel links
+                uint64_t due_tick = NEVER;
+                int32_t prev = NONE;
+                int32_t next = NONE;
+            };
+
+            ProcessDataStore &store;
+            std::array<ChangeNotify, MAX_CLIENTS> notify; // By client
+
+            // Only touched by the thread that polls, except during watch()
+            std::vector<Watch> watches;
+            std::vector<int32_t> by_handle;
+            std::array<int32_t, WHEEL_SIZE> wheel;
+            uint64_t current_tick = 0;
+            Clock::time_point base;
+            bool has_base = false;
+            bool has_distance_trigger = false;
+
+            std::atomic<uint32_t> distance_mm{0};
+            std::atomic<bool> distance_changed{false};
+
+            std::thread thread;
+            std::atomic<bool> running{false};
+            std::mutex wake_mutex;
+            std::condition_variable wake;
+            bool woken = false;
+
+            std::atomic<size_t> changes_seen{0};
+            std::atomic<size_t> notifications_sent{0};
+            std::atomic<size_t> coalesced{0};
+            std::atomic<size_t> suppressed{0};
+            std::atomic<size_t> send_failures{0};
+
+            explicit Impl(ProcessDataStore &s) : store(s) { wheel.fill(NONE); }
+
+            static void on_store_change(void *parent) { static_cast<Impl *>(parent)->wake_up(); }
+
+            void wake_up() {
+                {
+                    std::lock_guard<std::mutex> lock(wake_mutex);
+                    woken = true;
+                }
+                wake.notify_one();
+            }
+
+            uint64_t to_tick(Clock::time_point now) {
+                if (!has_base) {
+                    base = now;
+                    has_base = true;
+                }
+                if (now <= base) {
+                    return 0;
+                }
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - base).count();
+                return static_cast<uint64_t>(elapsed) / TICK_MS;
+            }
+
+            void unlink(int32_t index) {
+                Watch &watch = watches[index];
+                if (watch.due_tick == NEVER) {
+                    return;
+                }
+                if (watch.prev != NONE) {
+                    watches[watch.prev].next = watch.next;
+                } else {
+                    wheel[watch.due_tick % WHEEL_SIZE] = watch.next;
+                }
+                if (watch.next != NONE) {
+                    watches[watch.next].prev = watch.prev;
+                }
+                watch.due_tick = NEVER;
+                watch.prev = NONE;
+                watch.next = NONE;
+            }
+
+            void schedule(int32_t index, uint64_t due) {
+                unlink(index);
+                Watch &watch = watches[index];
+                int32_t &head = wheel[due % WHEEL_SIZE];
+                watch.due_tick = due;
+                watch.next = head;
+                if (head != NONE) {
+                    watches[head].prev = index;
+                }
+                head = index;
+            }
+
+            // Arm the timer for the pending window or the time trigger, whichever comes first
+            void reschedule(int32_t index, uint64_t tick) {
+                Watch &watch = watches[index];
+                uint64_t due = NEVER;
+                if (watch.pending) {
+                    due = std::max(watch.last_tick + to_ticks(watch.settings.min_interval_ms), tick + 1);
+                }
+                if (watch.settings.max_interval_ms > 0) {
+                    due = std::min(due,
+                                   std::max(watch.last_tick + to_ticks(watch.settings.max_interval_ms), tick + 1));
+                }
+                if (due == NEVER) {
+                    unlink(index);
+                } else if (due != watch.due_tick) {
+                    schedule(index, due);
+                }
+            }
+
+            bool below_threshold(const Watch &watch, int32_t value) const {
+                int64_t change = static_cast<int64_t>(value) - watch.last_value;
+                return watch.sent_once && static_cast<uint64_t>(change < 0 ? -change : change) <
+                                              std::max<uint32_t>(watch.settings.change_threshold, 1);
+            }
+
+            bool send(Watch &watch, int32_t value, uint64_t tick) {
+                const ChangeNotify &fn = notify[static_cast<uint8_t>(watch.client)];
+                if (!fn || !fn(watch.element, watch.ddi)) {
+                    send_failures.fetch_add(1, std::memory_order_relaxed);
+                    // Retry a failed change at the end of the next window
+                    watch.pending = watch.pending || watch.settings.on_change;
+                    watch.last_tick = tick;
+                    return false;
+                }
+                watch.last_value = value;
+                watch.last_tick = tick;
+                watch.last_distance = distance_mm.load(std::memory_order_relaxed);
+                watch.sent_once = true;
+                watch.pending = false;
+                notifications_sent.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            size_t changed(int32_t index, uint64_t tick) {
+                Watch &watch = watches[index];
+                changes_seen.fetch_add(1, std::memory_order_relaxed);
+                if (!watch.settings.on_change) {
+                    return 0;
+                }
+                if (watch.pending) {
+                    coalesced.fetch_add(1, std::memory_order_relaxed);
+                    return 0;
+                }
+                int32_t value = store.get(watch.handle);
+                if (below_threshold(watch, value)) {
+                    return 0;
+                }
+
+                // Outside the window of the last notification the change goes out right away
+                size_t sent = 0;
+                if (!watch.sent_once || tick >= watch.last_tick + to_ticks(watch.settings.min_interval_ms)) {
+                    sent = send(watch, value, tick) ? 1 : 0;
+                } else {
+                    watch.pending = true;
+                }
+                reschedule(index, tick);
+                return sent;
+            }
+
+            size_t fire(int32_t index, uint64_t tick) {
+                Watch &watch = watches[index];
+                int32_t value = store.get(watch.handle);
+                bool due = false;
+                if (watch.pending) {
+                    watch.pending = false;
+                    if (below_threshold(watch, value)) {
+                        suppressed.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        due = true;
+                    }
+                }
+                if (!due && watch.settings.max_interval_ms > 0 &&
+                    tick >= watch.last_tick + to_ticks(watch.settings.max_interval_ms)) {
+                    due = true;
+                }
+                size_t sent = due && send(watch, value, tick) ? 1 : 0;
+                reschedule(index, tick);
+                return sent;
+            }
+
+            size_t advance(uint64_t tick) {
+                size_t sent = 0;
+                uint64_t steps = std::min<uint64_t>(tick - current_tick, WHEEL_SIZE);
+                for (uint64_t step = 1; step <= steps; step++) {
+                    int32_t index = wheel[(current_tick + step) % WHEEL_SIZE];
+                    while (index != NONE) {
+                        int32_t next = watches[index].next;
+                        // Entries of later rounds stay in their bucket
+                        if (watches[index].due_tick <= tick) {
+                            unlink(index);
+                            sent += fire(index, tick);
+                        }
+                        index = next;
+                    }
+                }
+                current_tick = tick;
+                return sent;
+            }
+
+            size_t check_distance(uint64_t tick) {
+                if (!has_distance_trigger || !distance_changed.exchange(false)) {
+                    return 0;
+                }
+                uint32_t odometer = distance_mm.load(std::memory_order_relaxed);
+                size_t sent = 0;
+                for (int32_t index = 0; index < static_cast<int32_t>(watches.size()); index++) {
+                    Watch &watch = watches[index];
+                    uint32_t interval = watch.settings.distance_interval_mm;
+                    if (interval == 0 || odometer - watch.last_distance < interval) {
+                        continue;
+                    }
+                    if (send(watch, store.get(watch.handle), tick)) {
+                        sent++;
+                    }
+                    reschedule(index, tick);
+                }
+                return sent;
+            }
+
+            // Tick of the nearest non empty bucket, NEVER if the wheel is empty
+            uint64_t next_wake() const {
+                for (uint64_t step = 1; step <= WHEEL_SIZE; step++) {
+                    if (wheel[(current_tick + step) % WHEEL_SIZE] != NONE) {
+                        return current_tick + step;
+                    }
+                }
+                return NEVER;
+            }
+        };
+
+        ChangeScheduler::ChangeScheduler(ProcessDataStore &store) : pimpl_(std::make_unique<Impl>(store)) {
+            store.set_change_listener(&Impl::on_store_change, pimpl_.get());
+        }
+
+        ChangeScheduler::~ChangeScheduler() {
+            stop();
+            pimpl_->store.set_change_listener(nullptr, nullptr);
+        }
+
+        bool ChangeScheduler::watch(uint16_t element, uint16_t ddi, const TriggerSettings &settings) {
+            return watch_handle(pimpl_->store.find(element, ddi), ClientId::Default, element, ddi, settings);
+        }
+
+        bool ChangeScheduler::watch(ClientId client, uint16_t element, uint16_t ddi, const TriggerSettings &settings) {
+            if (static_cast<uint8_t>(client) >= MAX_CLIENTS) {
+                return false;
+            }
+            return watch_handle(pimpl_->store.find(client, element, ddi), client, element, ddi, settings);
+        }
+
+        bool ChangeScheduler::watch_handle(ProcessDataStore::Handle handle, ClientId client, uint16_t element,
+                                           uint16_t ddi, const TriggerSettings &settings) {
+            if (handle == ProcessDataStore::INVALID_HANDLE) {
+                return false;
+            }
+            if (handle >= pimpl_->by_handle.size()) {
+                pimpl_->by_handle.resize(handle + 1, NONE);
+            }
+
+            int32_t index = pimpl_->by_handle[handle];
+            if (index == NONE) {
+                index = static_cast<int32_t>(pimpl_->watches.size());
+                pimpl_->watches.emplace_back();
+                pimpl_->by_handle[handle] = index;
+            }
+            auto &watch = pimpl_->watches[index];
+            watch.handle = handle;
+            watch.client = client;
+            watch.element = element;
+            watch.ddi = ddi;
+            watch.settings = settings;
+            watch.last_tick = pimpl_->current_tick;
+            watch.last_distance = pimpl_->distance_mm.load(std::memory_order_relaxed);
+            pimpl_->has_distance_trigger = pimpl_->has_distance_trigger || settings.distance_interval_mm > 0;
+            pimpl_->reschedule(index, pimpl_->current_tick);
+            return true;
+        }
+
+        void ChangeScheduler::set_notify(ChangeNotify notify) { set_notify(ClientId::Default, std::move(notify)); }
+
+        void ChangeScheduler::set_notify(ClientId client, ChangeNotify notify) {
+            if (static_cast<uint8_t>(client) < MAX_CLIENTS) {
+                pimpl_->notify[static_cast<uint8_t>(client)] = std::move(notify);
+            }
+        }
+
+        void ChangeScheduler::set_distance(uint32_t odometer_mm) {
+            if (pimpl_->distance_mm.exchange(odometer_mm, std::memory_order_relaxed) == odometer_mm) {
+                return;
+            }
+            if (!pimpl_->distance_changed.exchange(true)) {
+                pimpl_->wake_up();
+            }
+        }
+
+        bool ChangeScheduler::start() {
+            if (pimpl_->running) {
+                return false;
+            }
+            pimpl_->running = true;
+            pimpl_->thread = std::thread(&ChangeScheduler::scheduler_thread, this);
+            return true;
+        }
+
+        void ChangeScheduler::stop() {
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->wake_mutex);
+                pimpl_->running = false;
+            }
+            pimpl_->wake.notify_all();
+            if (pimpl_->thread.joinable()) {
+                pimpl_->thread.join();
+            }
+        }
+
+        bool ChangeScheduler::is_running() const { return pimpl_->running; }
+
+        ChangeScheduler::Statistics ChangeScheduler::get_statistics() const {
+            Statistics stats;
+            stats.changes_seen = pimpl_->changes_seen.load(std::memory_order_relaxed);
+            stats.notifications_sent = pimpl_->notifications_sent.load(std::memory_order_relaxed);
+            stats.coalesced = pimpl_->coalesced.load(std::memory_order_relaxed);
+            stats.suppressed = pimpl_->suppressed.load(std::memory_order_relaxed);
+            stats.send_failures = pimpl_->send_failures.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        void ChangeScheduler::scheduler_thread() {
+            while (pimpl_->running) {
+                poll(Clock::now());
+
+                uint64_t next = pimpl_->next_wake();
+                std::unique_lock<std::mutex> lock(pimpl_->wake_mutex);
+                auto woken = [this] { return pimpl_->woken || !pimpl_->running; };
+                if (next == NEVER) {
+                    pimpl_->wake.wait(lock, woken);
+                } else {
+                    pimpl_->wake.wait_until(lock, pimpl_->base + std::chrono::milliseconds(next * TICK_MS), woken);
+                }
+                pimpl_->woken = false;
+            }
+        }
+
+        size_t ChangeScheduler::poll(Clock::time_point now) {
+            uint64_t tick = pimpl_->to_tick(now);
+            if (tick < pimpl_->current_tick) {
+                tick = pimpl_->current_tick;
+            }
+
+            // Expired windows first, so a change arriving in the same poll opens a new one
+            size_t sent = pimpl_->advance(tick);
+            pimpl_->store.take_changes([&](ProcessDataStore::Handle handle) {
+                if (handle < pimpl_->by_handle.size() && pimpl_->by_handle[handle] != NONE) {
+                    sent += pimpl_->changed(pimpl_->by_handle[handle], tick);
+                }
+            });
+            sent += pimpl_->check_distance(tick);
+            return sent;
+        }
+
+    } // namespace tc
+} // namespace tractor
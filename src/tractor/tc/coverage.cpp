@@ -0,0 +1,492 @@
+#include "tractor/tc/coverage.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tractor {
+    namespace tc {
+
+        namespace {
+
+            constexpr double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+            constexpr double WGS84_A = 6378137.0;         // Semi-major axis in meters
+            constexpr double WGS84_E2 = 6.69437999014e-3; // First eccentricity squared
+            constexpr double MAX_SWATH_EXTENT = 1000.0;   // Larger swaths are position jumps, not travel
+            constexpr size_t ROW_WORDS = CoverageMap::TILE_CELLS / 64;
+            constexpr size_t TILE_WORDS = CoverageMap::TILE_CELLS * ROW_WORDS;
+
+            double longitude_delta(double from, double to) {
+                double delta = to - from;
+                if (delta > 180.0) {
+                    delta -= 360.0;
+                } else if (delta < -180.0) {
+                    delta += 360.0;
+                }
+                return delta;
+            }
+
+            int64_t floor_div(int64_t value, int64_t divisor) {
+                int64_t quotient = value / divisor;
+                return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+            }
+
+            uint64_t tile_key(int64_t tx, int64_t ty) {
+                return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
+            }
+
+            using Quad = std::array<EnuPoint, 4>;
+
+            // Area a section sweeps between two poses: its left and right ends at both
+            Quad swath(const Pose &from, const Pose &to, const SectionGeometry &section) {
+                auto edge = [&section](const Pose &pose, double side) {
+                    double heading = pose.heading_deg * DEG_TO_RAD;
+                    double forward_east = std::sin(heading);
+                    double forward_north = std::cos(heading);
+                    double across = section.y + side * section.width / 2.0;
+                    // The right of a heading (sin, cos) is (cos, -sin)
+                    return EnuPoint{pose.position.east + section.x * forward_east + across * forward_north,
+                                    pose.position.north + section.x * forward_north - across * forward_east};
+                };
+                return {edge(from, -1.0), edge(from, 1.0), edge(to, 1.0), edge(to, -1.0)};
+            }
+
+            /**
+             * Cell rows a quad covers, a cell belongs to the quad when its center does. Rows are those
+             * whose center line the quad crosses, the range is empty for a degenerate quad.
+             */
+            struct Raster {
+                Quad quad;
+                int64_t first_row = 0;
+                int64_t last_row = -1;
+
+                Raster(const Quad &corners, double cell_size) : quad(corners) {
+                    double min_east = quad[0].east, max_east = quad[0].east;
+                    double min_north = quad[0].north, max_north = quad[0].north;
+                    for (const auto &corner : quad) {
+                        min_east = std::min(min_east, corner.east);
+                        max_east = std::max(max_east, corner.east);
+                        min_north = std::min(min_north, corner.north);
+                        max_north = std::max(max_north, corner.north);
+                    }
+                    if (max_east - min_east > MAX_SWATH_EXTENT || max_north - min_north > MAX_SWATH_EXTENT) {
+                        return;
+                    }
+                    first_row = static_cast<int64_t>(std::ceil(min_north / cell_size - 0.5));
+                    last_row = static_cast<int64_t>(std::floor(max_north / cell_size - 0.5));
+                }
+
+                // Calls fn(first, last) for every run of cells of the row inside the quad
+                template <typename F> void row(int64_t row, double cell_size, F &&fn) const {
+                    double y = (static_cast<double>(row) + 0.5) * cell_size;
+                    std::array<double, 4> crossings;
+                    size_t count = 0;
+                    for (size_t i = 0; i < quad.size(); i++) {
+                        const EnuPoint &a = quad[i];
+                        const EnuPoint &b = quad[(i + 1) % quad.size()];
+                        if ((a.north <= y) != (b.north <= y)) {
+                            crossings[count++] = a.east + (y - a.north) * (b.east - a.east) / (b.north - a.north);
+                        }
+                    }
+                    std::sort(crossings.begin(), crossings.begin() + count);
+                    for (size_t i = 0; i + 1 < count; i += 2) {
+                        auto first = static_cast<int64_t>(std::ceil(crossings[i] / cell_size - 0.5));
+                        auto last = static_cast<int64_t>(std::floor(crossings[i + 1] / cell_size - 0.5));
+                        if (first <= last) {
+                            fn(first, last);
+                        }
+                    }
+                }
+            };
+
+        } // namespace
+
+        LocalFrame::LocalFrame(double latitude, double longitude) : latitude_(latitude), longitude_(longitude) {
+            double sin_latitude = std::sin(latitude * DEG_TO_RAD);
+            double w = 1.0 - WGS84_E2 * sin_latitude * sin_latitude;
+            double meridian = WGS84_A * (1.0 - WGS84_E2) / (w * std::sqrt(w));
+            double prime_vertical = WGS84_A / std::sqrt(w);
+            meters_per_degree_north_ = meridian * DEG_TO_RAD;
+            meters_per_degree_east_ = prime_vertical * std::cos(latitude * DEG_TO_RAD) * DEG_TO_RAD;
+        }
+
+        EnuPoint LocalFrame::to_enu(double latitude, double longitude) const {
+            return {longitude_delta(longitude_, longitude) * meters_per_degree_east_,
+                    (latitude - latitude_) * meters_per_degree_north_};
+        }
+
+        void LocalFrame::to_geodetic(const EnuPoint &point, double &latitude, double &longitude) const {
+            latitude = latitude_ + point.north / meters_per_degree_north_;
+            longitude = longitude_delta(0.0, longitude_ + point.east / meters_per_degree_east_);
+        }
+
+        struct CoverageMap::Impl {
+            struct Tile {
+                std::array<uint64_t, TILE_WORDS> bits{}; // Row r is words [r * ROW_WORDS, (r + 1) * ROW_WORDS)
+                bool dirty = false;                      // Changed since it was last written out
+                std::list<uint64_t>::iterator recent;
+            };
+
+            CoverageOptions options;
+            std::vector<SectionGeometry> sections;
+
+            // Queries page tiles in as well, so the tile state is mutable
+            mutable std::mutex mutex;
+            mutable std::unordered_map<uint64_t, std::unique_ptr<Tile>> tiles;
+            mutable std::list<uint64_t> recent;         // Resident tiles, most recently used first
+            mutable std::unordered_set<uint64_t> paged; // Tiles only on disk
+            mutable uint64_t cached_key = 0;
+            mutable Tile *cached_tile = nullptr; // Last tile looked up, rows of a swath mostly stay in one
+            mutable std::string last_error;
+            size_t covered_cells = 0;
+
+            bool paging() const { return !options.page_directory.empty(); }
+
+            std::string tile_path(uint64_t key) const {
+                auto tx = static_cast<int32_t>(key >> 32);
+                auto ty = static_cast<int32_t>(key & 0xFFFFFFFF);
+                return options.page_directory + "/" + std::to_string(tx) + "_" + std::to_string(ty) + ".tile";
+            }
+
+            bool write_tile(uint64_t key, const Tile &tile) const {
+                std::string path = tile_path(key);
+                int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd < 0) {
+                    last_error = "Failed to create " + path + ": " + std::strerror(errno);
+                    return false;
+                }
+                ssize_t written = ::write(fd, tile.bits.data(), sizeof(tile.bits));
+                int error = errno;
+                ::close(fd);
+                if (written != static_cast<ssize_t>(sizeof(tile.bits))) {
+                    last_error = "Failed to write " + path + ": ";
+                    last_error += written < 0 ? std::strerror(error) : "short write";
+                    return false;
+                }
+                return true;
+            }
+
+            bool read_tile(uint64_t key, Tile &tile) const {
+                std::string path = tile_path(key);
+                int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    last_error = "Failed to open " + path + ": " + std::strerror(errno);
+                    return false;
+                }
+                ssize_t size = ::read(fd, tile.bits.data(), sizeof(tile.bits));
+                ::close(fd);
+                if (size != static_cast<ssize_t>(sizeof(tile.bits))) {
+                    last_error = "Truncated tile " + path;
+                    tile.bits.fill(0);
+                    return false;
+                }
+                return true;
+            }
+
+            // Page out least recently used tiles, keeps a tile resident when writing it fails
+            void evict() const {
+                size_t limit = std::max<size_t>(options.max_resident_tiles, 1);
+                while (paging() && tiles.size() > limit) {
+                    uint64_t key = recent.back();
+                    auto it = tiles.find(key);
+                    if (it->second->dirty && !write_tile(key, *it->second)) {
+                        return;
+                    }
+                    if (cached_tile == it->second.get()) {
+                        cached_tile = nullptr;
+                    }
+                    recent.pop_back();
+                    tiles.erase(it);
+                    paged.insert(key);
+                }
+            }
+
+            Tile *tile(int64_t tx, int64_t ty, bool create) const {
+                uint64_t key = tile_key(tx, ty);
+                if (cached_tile != nullptr && cached_key == key) {
+                    return cached_tile;
+                }
+
+                Tile *result;
+                auto it = tiles.find(key);
+                if (it != tiles.end()) {
+                    result = it->second.get();
+                    recent.splice(recent.begin(), recent, result->recent);
+                } else if (paged.count(key) != 0 || create) {
+                    auto tile = std::make_unique<Tile>();
+                    if (paged.erase(key) != 0) {
+                        read_tile(key, *tile);
+                    }
+                    result = tile.get();
+                    recent.push_front(key);
+                    result->recent = recent.begin();
+                    tiles.emplace(key, std::move(tile));
+                    cached_tile = nullptr;
+                    evict();
+                } else {
+                    return nullptr;
+                }
+
+                cached_key = key;
+                cached_tile = result;
+                return result;
+            }
+
+            /**
+             * Calls fn(tile, word, mask) for the words holding cells first to last of a row, tile is
+             * nullptr for tiles that do not exist unless create is set.
+             */
+            template <typename F> void for_words(int64_t row, int64_t first, int64_t last, bool create, F &&fn) const {
+                const auto cells = static_cast<int64_t>(TILE_CELLS);
+                int64_t ty = floor_div(row, cells);
+                auto row_offset = static_cast<size_t>(row - ty * cells) * ROW_WORDS;
+                for (int64_t cell = first; cell <= last;) {
+                    int64_t tx = floor_div(cell, cells);
+                    int64_t end = std::min(last, (tx + 1) * cells - 1);
+                    auto low = static_cast<size_t>(cell - tx * cells);
+                    auto high = static_cast<size_t>(end - tx * cells);
+                    Tile *target = tile(tx, ty, create);
+                    for (size_t word = low / 64; word <= high / 64; word++) {
+                        uint64_t mask = ~uint64_t{0};
+                        if (word == low / 64) {
+                            mask &= ~uint64_t{0} << (low % 64);
+                        }
+                        if (word == high / 64) {
+                            mask &= ~uint64_t{0} >> (63 - high % 64);
+                        }
+                        fn(target, row_offset + word, mask);
+                    }
+                    cell = end + 1;
+                }
+            }
+
+            // Walks the rows of all rasters at once, so neighboring sections share each tile lookup
+            template <typename F> void for_rows(const std::vector<Raster> &rasters, F &&fn) const {
+                int64_t first = INT64_MAX;
+                int64_t last = INT64_MIN;
+                for (const auto &raster : rasters) {
+                    if (raster.first_row <= raster.last_row) {
+                        first = std::min(first, raster.first_row);
+                        last = std::max(last, raster.last_row);
+                    }
+                }
+                for (int64_t row = first; row <= last; row++) {
+                    for (size_t i = 0; i < rasters.size(); i++) {
+                        if (row >= rasters[i].first_row && row <= rasters[i].last_row) {
+                            rasters[i].row(row, options.cell_size,
+                                           [&](int64_t begin, int64_t end) { fn(i, row, begin, end); });
+                        }
+                    }
+                }
+            }
+
+            std::vector<Raster> rasters(const Pose &from, const Pose &to, size_t count) const {
+                std::vector<Raster> result;
+                result.reserve(count);
+                for (size_t i = 0; i < count; i++) {
+                    result.emplace_back(swath(from, to, sections[i]), options.cell_size);
+                }
+                return result;
+            }
+
+            void forget() {
+                tiles.clear();
+                recent.clear();
+                paged.clear();
+                cached_tile = nullptr;
+                covered_cells = 0;
+            }
+        };
+
+        CoverageMap::CoverageMap(const CoverageOptions &options) : pimpl_(std::make_unique<Impl>()) {
+            pimpl_->options = options;
+            if (!(pimpl_->options.cell_size > 0.0)) {
+                pimpl_->options.cell_size = CoverageOptions{}.cell_size;
+            }
+            if (!pimpl_->paging()) {
+                return;
+            }
+
+            std::error_code error;
+            std::filesystem::create_directories(options.page_directory, error);
+            for (std::filesystem::directory_iterator it(options.page_directory, error), end; !error && it != end;
+                 it.increment(error)) {
+                int tx = 0;
+                int ty = 0;
+                char tail = 0;
+                std::string name = it->path().filename().string();
+                if (std::sscanf(name.c_str(), "%d_%d.til%c", &tx, &ty, &tail) != 3 || tail != 'e') {
+                    continue;
+                }
+                uint64_t key = tile_key(tx, ty);
+                Impl::Tile tile;
+                if (pimpl_->read_tile(key, tile)) {
+                    pimpl_->paged.insert(key);
+                    for (uint64_t word : tile.bits) {
+                        pimpl_->covered_cells += std::popcount(word);
+                    }
+                }
+            }
+            if (error) {
+                pimpl_->last_error = "Failed to read " + options.page_directory + ": " + error.message();
+            }
+        }
+
+        CoverageMap::~CoverageMap() { flush(); }
+
+        void CoverageMap::set_sections(std::vector<SectionGeometry> sections) {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            sections.resize(std::min(sections.size(), SectionBoom::MAX_SECTIONS));
+            pimpl_->sections = std::move(sections);
+        }
+
+        size_t CoverageMap::size() const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            return pimpl_->sections.size();
+        }
+
+        size_t CoverageMap::paint(const Pose &from, const Pose &to, const SectionBoom::SectionMask &on) {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            std::vector<Raster> rasters = pimpl_->rasters(from, to, pimpl_->sections.size());
+            for (size_t i = 0; i < rasters.size(); i++) {
+                if ((on[i / 64] >> (i % 64) & 1) == 0) {
+                    rasters[i].last_row = rasters[i].first_row - 1;
+                }
+            }
+
+            size_t added = 0;
+            pimpl_->for_rows(rasters, [&](size_t, int64_t row, int64_t first, int64_t last) {
+                pimpl_->for_words(row, first, last, true, [&](Impl::Tile *tile, size_t word, uint64_t mask) {
+                    uint64_t fresh = mask & ~tile->bits[word];
+                    if (fresh != 0) {
+                        tile->bits[word] |= fresh;
+                        tile->dirty = true;
+                        added += std::popcount(fresh);
+                    }
+                });
+            });
+            pimpl_->covered_cells += added;
+            return added;
+        }
+
+        size_t CoverageMap::overlap(const Pose &from, const Pose &to, std::span<double> fractions) const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            size_t count = std::min(pimpl_->sections.size(), fractions.size());
+            std::vector<Raster> rasters = pimpl_->rasters(from, to, count);
+
+            std::vector<uint64_t> covered(count, 0);
+            std::vector<uint64_t> total(count, 0);
+            pimpl_->for_rows(rasters, [&](size_t section, int64_t row, int64_t first, int64_t last) {
+                total[section] += static_cast<uint64_t>(last - first + 1);
+                pimpl_->for_words(row, first, last, false, [&](Impl::Tile *tile, size_t word, uint64_t mask) {
+                    if (tile != nullptr) {
+                        covered[section] += std::popcount(tile->bits[word] & mask);
+                    }
+                });
+            });
+
+            for (size_t i = 0; i < count; i++) {
+                fractions[i] = total[i] == 0 ? 0.0 : static_cast<double>(covered[i]) / static_cast<double>(total[i]);
+            }
+            return count;
+        }
+
+        SectionBoom::SectionMask CoverageMap::plan(const Pose &pose, double look_ahead, double max_overlap) const {
+            double heading = pose.heading_deg * DEG_TO_RAD;
+            Pose ahead = pose;
+            ahead.position.east += look_ahead * std::sin(heading);
+            ahead.position.north += look_ahead * std::cos(heading);
+
+            std::array<double, SectionBoom::MAX_SECTIONS> fractions{};
+            size_t count = overlap(pose, ahead, fractions);
+
+            SectionBoom::SectionMask on{};
+            for (size_t i = 0; i < count; i++) {
+                if (fractions[i] <= max_overlap) {
+                    on[i / 64] |= uint64_t{1} << (i % 64);
+                }
+            }
+            return on;
+        }
+
+        bool CoverageMap::covered(const EnuPoint &point) const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            const auto cells = static_cast<int64_t>(TILE_CELLS);
+            auto column = static_cast<int64_t>(std::floor(point.east / pimpl_->options.cell_size));
+            auto row = static_cast<int64_t>(std::floor(point.north / pimpl_->options.cell_size));
+            int64_t tx = floor_div(column, cells);
+            int64_t ty = floor_div(row, cells);
+            const Impl::Tile *tile = pimpl_->tile(tx, ty, false);
+            if (tile == nullptr) {
+                return false;
+            }
+            auto x = static_cast<size_t>(column - tx * cells);
+            auto y = static_cast<size_t>(row - ty * cells);
+            return (tile->bits[y * ROW_WORDS + x / 64] >> (x % 64) & 1) != 0;
+        }
+
+        double CoverageMap::covered_area() const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            double cell = pimpl_->options.cell_size;
+            return static_cast<double>(pimpl_->covered_cells) * cell * cell;
+        }
+
+        size_t CoverageMap::tile_count() const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            return pimpl_->tiles.size() + pimpl_->paged.size();
+        }
+
+        size_t CoverageMap::resident_tiles() const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            return pimpl_->tiles.size();
+        }
+
+        bool CoverageMap::flush() {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            if (!pimpl_->paging()) {
+                return true;
+            }
+            bool success = true;
+            for (auto &[key, tile] : pimpl_->tiles) {
+                if (tile->dirty) {
+                    if (pimpl_->write_tile(key, *tile)) {
+                        tile->dirty = false;
+                    } else {
+                        success = false;
+                    }
+                }
+            }
+            return success;
+        }
+
+        void CoverageMap::clear() {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            if (pimpl_->paging()) {
+                for (const auto &[key, tile] : pimpl_->tiles) {
+                    ::unlink(pimpl_->tile_path(key).c_str());
+                }
+                for (uint64_t key : pimpl_->paged) {
+                    ::unlink(pimpl_->tile_path(key).c_str());
+                }
+            }
+            pimpl_->forget();
+        }
+
+        std::string CoverageMap::get_last_error() const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            return pimpl_->last_error;
+        }
+
+    } // namespace tc
+} // namespace tractor
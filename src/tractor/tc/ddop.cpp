@@ -0,0 +1,90 @@
+#include "tractor/tc/ddop.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tractor {
+    namespace tc {
+
+        void DdopWriter::tag(const char *name, uint16_t id) {
+            out_.insert(out_.end(), name, name + 3);
+            u16(id);
+        }
+
+        void DdopWriter::u16(uint16_t value) {
+            out_.push_back(static_cast<uint8_t>(value));
+            out_.push_back(static_cast<uint8_t>(value >> 8));
+        }
+
+        void DdopWriter::u32(uint32_t value) {
+            for (int i = 0; i < 4; i++) {
+                out_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        void DdopWriter::text(std::string_view value) {
+            u8(static_cast<uint8_t>(value.size()));
+            out_.insert(out_.end(), value.begin(), value.end());
+        }
+
+        void DdopWriter::device(const DeviceInfo &device, uint64_t name, std::string_view structure_label) {
+            tag("DVC", 0);
+            text(device.designator);
+            text(device.software_version);
+            u32(static_cast<uint32_t>(name));
+            u32(static_cast<uint32_t>(name >> 32));
+            text(device.serial_number);
+
+            // Both labels are fixed 7 byte fields, padded with spaces
+            std::array<uint8_t, 7> label;
+            label.fill(' ');
+            std::memcpy(label.data(), structure_label.data(), std::min(label.size(), structure_label.size()));
+            out_.insert(out_.end(), label.begin(), label.end());
+            out_.insert(out_.end(), device.localization.begin(), device.localization.end());
+            if (device.version >= 4) {
+                text(device.extended_structure_label);
+            }
+        }
+
+        void DdopWriter::element(uint16_t id, const ElementInfo &element, uint16_t parent_id, const uint16_t *children,
+                                 size_t child_count) {
+            tag("DET", id);
+            u8(static_cast<uint8_t>(element.type));
+            text(element.designator);
+            u16(element.number);
+            u16(parent_id);
+            u16(static_cast<uint16_t>(child_count));
+            for (size_t i = 0; i < child_count; i++) {
+                u16(children[i]);
+            }
+        }
+
+        void DdopWriter::process_data(uint16_t id, const ProcessDataInfo &process_data, uint16_t presentation_id) {
+            tag("DPD", id);
+            u16(process_data.ddi);
+            u8(process_data.properties);
+            u8(process_data.triggers);
+            text(process_data.designator);
+            u16(presentation_id);
+        }
+
+        void DdopWriter::property(uint16_t id, const PropertyInfo &property, uint16_t presentation_id) {
+            tag("DPT", id);
+            u16(property.ddi);
+            u32(static_cast<uint32_t>(property.value));
+            text(property.designator);
+            u16(presentation_id);
+        }
+
+        void DdopWriter::presentation(uint16_t id, const PresentationInfo &presentation) {
+            tag("DVP", id);
+            u32(static_cast<uint32_t>(presentation.offset));
+            uint32_t scale;
+            std::memcpy(&scale, &presentation.scale, sizeof(scale));
+            u32(scale);
+            u8(presentation.decimals);
+            text(presentation.designator);
+        }
+
+    } // namespace tc
+} // namespace tractor
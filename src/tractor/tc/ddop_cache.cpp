@@ -0,0 +1,203 @@
+#include "tractor/tc/ddop_cache.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace tractor {
+    namespace tc {
+
+        namespace {
+
+            constexpr char MAGIC[4] = {'T', 'D', 'O', 'P'};
+            constexpr uint32_t FORMAT_VERSION = 1;
+
+            // Host byte order, the cache never leaves the machine that wrote it
+            struct FileHeader {
+                char magic[4];
+                uint32_t version;
+                uint64_t structure_hash;
+                uint64_t name;
+                uint32_t size;
+                uint32_t reserved;
+                uint64_t checksum;
+            };
+
+            uint64_t checksum(const uint8_t *data, size_t size) {
+                uint64_t hash = 0xCBF29CE484222325ull;
+                for (size_t i = 0; i < size; i++) {
+                    hash ^= data[i];
+                    hash *= 0x100000001B3ull;
+                }
+                return hash;
+            }
+
+            // Every binary pool starts with the device object
+            bool looks_like_pool(const uint8_t *data, size_t size) {
+                return size >= 3 && data[0] == 'D' && data[1] == 'V' && data[2] == 'C';
+            }
+
+            bool write_all(int fd, const uint8_t *data, size_t size) {
+                while (size > 0) {
+                    ssize_t written = ::write(fd, data, size);
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        return false;
+                    }
+                    data += written;
+                    size -= static_cast<size_t>(written);
+                }
+                return true;
+            }
+
+        } // namespace
+
+        std::string structure_label(uint64_t structure_hash) {
+            static constexpr char DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+            std::string label(7, '0');
+            for (size_t i = 0; i < label.size(); i++) {
+                label[i] = DIGITS[(structure_hash >> (64 - 5 * (i + 1))) & 0x1F];
+            }
+            return label;
+        }
+
+        struct DdopCache::Impl {
+            std::string directory;
+            void *map = nullptr;
+            size_t map_size = 0;
+            std::string last_error;
+
+            explicit Impl(std::string dir) : directory(std::move(dir)) {}
+
+            const FileHeader *header() const { return static_cast<const FileHeader *>(map); }
+        };
+
+        DdopCache::DdopCache(std::string directory) : pimpl_(std::make_unique<Impl>(std::move(directory))) {}
+
+        DdopCache::~DdopCache() { unload(); }
+
+        std::string DdopCache::path(uint64_t structure_hash, uint64_t name) const {
+            char file[64];
+            std::snprintf(file, sizeof(file), "ddop-%016llx-%016llx.bin", static_cast<unsigned long long>(name),
+                          static_cast<unsigned long long>(structure_hash));
+            if (pimpl_->directory.empty()) {
+                return file;
+            }
+            return pimpl_->directory + "/" + file;
+        }
+
+        bool DdopCache::load(uint64_t structure_hash, uint64_t name) {
+            unload();
+            std::string file = path(structure_hash, name);
+            int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                // A missing file is the normal first start, not worth an error message
+                if (errno == ENOENT) {
+                    pimpl_->last_error.clear();
+                } else {
+                    pimpl_->last_error = "Failed to open " + file + ": " + std::strerror(errno);
+                }
+                return false;
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) <= sizeof(FileHeader)) {
+                ::close(fd);
+                pimpl_->last_error = "Cache file too short: " + file;
+                return false;
+            }
+
+            size_t size = static_cast<size_t>(st.st_size);
+            void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (map == MAP_FAILED) {
+                pimpl_->last_error = std::string("Failed to map cache file: ") + std::strerror(errno);
+                return false;
+            }
+
+            const auto *header = static_cast<const FileHeader *>(map);
+            const auto *payload = static_cast<const uint8_t *>(map) + sizeof(FileHeader);
+            size_t payload_size = size - sizeof(FileHeader);
+            if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != FORMAT_VERSION ||
+                header->structure_hash != structure_hash || header->name != name || header->size != payload_size ||
+                !looks_like_pool(payload, payload_size) || header->checksum != checksum(payload, payload_size)) {
+                ::munmap(map, size);
+                pimpl_->last_error = "Invalid cache file: " + file;
+                return false;
+            }
+
+            pimpl_->map = map;
+            pimpl_->map_size = size;
+            pimpl_->last_error.clear();
+            return true;
+        }
+
+        bool DdopCache::store(uint64_t structure_hash, uint64_t name, const std::vector<uint8_t> &pool) {
+            if (!looks_like_pool(pool.data(), pool.size()) || pool.size() > UINT32_MAX - sizeof(FileHeader)) {
+                pimpl_->last_error = "Not a binary object pool";
+                return false;
+            }
+
+            FileHeader header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = FORMAT_VERSION;
+            header.structure_hash = structure_hash;
+            header.name = name;
+            header.size = static_cast<uint32_t>(pool.size());
+            header.checksum = checksum(pool.data(), pool.size());
+
+            std::string file = path(structure_hash, name);
+            std::string temporary = file + ".tmp";
+            int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                pimpl_->last_error = "Failed to create " + temporary + ": " + std::strerror(errno);
+                return false;
+            }
+            bool ok = write_all(fd, reinterpret_cast<const uint8_t *>(&header), sizeof(header)) &&
+                      write_all(fd, pool.data(), pool.size()) && ::fsync(fd) == 0;
+            int saved_errno = errno;
+            ::close(fd);
+            if (!ok) {
+                ::unlink(temporary.c_str());
+                pimpl_->last_error = std::string("Failed to write cache file: ") + std::strerror(saved_errno);
+                return false;
+            }
+
+            if (::rename(temporary.c_str(), file.c_str()) < 0) {
+                pimpl_->last_error = std::string("Failed to replace cache file: ") + std::strerror(errno);
+                ::unlink(temporary.c_str());
+                return false;
+            }
+            return load(structure_hash, name);
+        }
+
+        bool DdopCache::is_loaded() const { return pimpl_->map != nullptr; }
+
+        const uint8_t *DdopCache::data() const {
+            if (pimpl_->map == nullptr) {
+                return nullptr;
+            }
+            return static_cast<const uint8_t *>(pimpl_->map) + sizeof(FileHeader);
+        }
+
+        uint32_t DdopCache::size() const { return pimpl_->map == nullptr ? 0 : pimpl_->header()->size; }
+
+        void DdopCache::unload() {
+            if (pimpl_->map != nullptr) {
+                ::munmap(pimpl_->map, pimpl_->map_size);
+                pimpl_->map = nullptr;
+                pimpl_->map_size = 0;
+            }
+        }
+
+        std::string DdopCache::get_last_error() const { return pimpl_->last_error; }
+
+    } // namespace tc
+} // namespace tractor
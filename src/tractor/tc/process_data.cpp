@@ -0,0 +1,180 @@
+#include "tractor/tc/process_data.hpp"
+#include "tractor/trace.hpp"
+
+namespace tractor {
+    namespace tc {
+
+        ProcessDataStore::ProcessDataStore(size_t capacity) : capacity_(capacity) {
+            uint32_t bits = 1;
+            while ((size_t{1} << bits) < capacity * 2 && bits < 31) {
+                bits++;
+            }
+            size_t table_size = size_t{1} << bits;
+            slots_ = std::make_unique<Slot[]>(table_size);
+            settable_ = std::make_unique<bool[]>(table_size);
+            dirty_words_ = (table_size + 63) / 64;
+            dirty_ = std::make_unique<std::atomic<uint64_t>[]>(dirty_words_);
+            mask_ = static_cast<uint32_t>(table_size - 1);
+            shift_ = 32 - bits;
+            for (size_t i = 0; i < MAX_CLIENTS; i++) {
+                clients_[i] = {this, static_cast<ClientId>(i)};
+            }
+        }
+
+        ProcessDataStore::~ProcessDataStore() = default;
+
+        ProcessDataStore::Handle ProcessDataStore::add(uint16_t element, uint16_t ddi, int32_t initial, bool settable) {
+            return add_key(process_data_key(element, ddi), initial, settable);
+        }
+
+        ProcessDataStore::Handle ProcessDataStore::add(ClientId client, uint16_t element, uint16_t ddi, int32_t initial,
+                                                       bool settable) {
+            return add_key(process_data_key(client, element, ddi), initial, settable);
+        }
+
+        ProcessDataStore::Handle ProcessDataStore::add_key(uint32_t key, int32_t initial, bool settable) {
+            if (key == EMPTY_KEY) {
+                return INVALID_HANDLE;
+            }
+            for (uint32_t index = home(key);; index = (index + 1) & mask_) {
+                Slot &slot = slots_[index];
+                if (slot.key == key) {
+                    return index;
+                }
+                if (slot.key == EMPTY_KEY) {
+                    if (size_ >= capacity_) {
+                        return INVALID_HANDLE;
+                    }
+                    slot.key = key;
+                    slot.value.store(initial, std::memory_order_relaxed);
+                    settable_[index] = settable;
+                    size_++;
+                    return index;
+                }
+            }
+        }
+
+        ProcessDataStore::Handle ProcessDataStore::find(uint16_t element, uint16_t ddi) const {
+            return find_key(process_data_key(element, ddi));
+        }
+
+        ProcessDataStore::Handle ProcessDataStore::find(ClientId client, uint16_t element, uint16_t ddi) const {
+            return find_key(process_data_key(client, element, ddi));
+        }
+
+        ProcessDataStore::Handle ProcessDataStore::find_key(uint32_t key) const {
+            if (key == EMPTY_KEY) {
+                return INVALID_HANDLE;
+            }
+            // The table is never more than half full, so probing always reaches an empty slot
+            for (uint32_t index = home(key);; index = (index + 1) & mask_) {
+                uint32_t slot_key = slots_[index].key;
+                if (slot_key == key) {
+                    return index;
+                }
+                if (slot_key == EMPTY_KEY) {
+                    return INVALID_HANDLE;
+                }
+            }
+        }
+
+        bool ProcessDataStore::set(uint16_t element, uint16_t ddi, int32_t value) {
+            Handle handle = find(element, ddi);
+            if (handle == INVALID_HANDLE) {
+                return false;
+            }
+            set(handle, value);
+            return true;
+        }
+
+        bool ProcessDataStore::get(uint16_t element, uint16_t ddi, int32_t &value) const {
+            Handle handle = find(element, ddi);
+            if (handle == INVALID_HANDLE) {
+                return false;
+            }
+            value = get(handle);
+            return true;
+        }
+
+        bool ProcessDataStore::set(ClientId client, uint16_t element, uint16_t ddi, int32_t value) {
+            Handle handle = find(client, element, ddi);
+            if (handle == INVALID_HANDLE) {
+                return false;
+            }
+            set(handle, value);
+            return true;
+        }
+
+        bool ProcessDataStore::get(ClientId client, uint16_t element, uint16_t ddi, int32_t &value) const {
+            Handle handle = find(client, element, ddi);
+            if (handle == INVALID_HANDLE) {
+                return false;
+            }
+            value = get(handle);
+            return true;
+        }
+
+        void ProcessDataStore::set_change_listener(ChangeListener listener, void *parent) {
+            listener_ = listener;
+            listener_parent_ = parent;
+        }
+
+        void ProcessDataStore::mark_changed(Handle handle) {
+            dirty_[handle / 64].fetch_or(uint64_t{1} << (handle % 64), std::memory_order_release);
+            // Only the first change of a batch wakes the consumer
+            if (!pending_.exchange(true) && listener_ != nullptr) {
+                listener_(listener_parent_);
+            }
+        }
+
+        bool ProcessDataStore::request_value_callback(uint16_t element, uint16_t ddi, int32_t &value, void *parent) {
+            TRACTOR_TRACE_SCOPE("tc", "request_value");
+            TRACTOR_TRACE_VALUE(ddi);
+            if (parent == nullptr) {
+                return false;
+            }
+            return static_cast<const ProcessDataStore *>(parent)->get(element, ddi, value);
+        }
+
+        bool ProcessDataStore::value_command_callback(uint16_t element, uint16_t ddi, int32_t value, void *parent) {
+            TRACTOR_TRACE_SCOPE("tc", "value_command");
+            TRACTOR_TRACE_VALUE(ddi);
+            if (parent == nullptr) {
+                return false;
+            }
+            auto store = static_cast<ProcessDataStore *>(parent);
+            return store->command(store->find(element, ddi), value);
+        }
+
+        bool ProcessDataStore::client_request_value_callback(uint16_t element, uint16_t ddi, int32_t &value,
+                                                             void *parent) {
+            TRACTOR_TRACE_SCOPE("tc", "request_value");
+            TRACTOR_TRACE_VALUE(ddi);
+            if (parent == nullptr) {
+                return false;
+            }
+            auto client = static_cast<const Client *>(parent);
+            return client->store->get(client->id, element, ddi, value);
+        }
+
+        bool ProcessDataStore::client_value_command_callback(uint16_t element, uint16_t ddi, int32_t value,
+                                                             void *parent) {
+            TRACTOR_TRACE_SCOPE("tc", "value_command");
+            TRACTOR_TRACE_VALUE(ddi);
+            if (parent == nullptr) {
+                return false;
+            }
+            auto client = static_cast<const Client *>(parent);
+            return client->store->command(client->store->find(client->id, element, ddi), value);
+        }
+
+        bool ProcessDataStore::command(Handle handle, int32_t value) {
+            if (handle == INVALID_HANDLE || !settable_[handle]) {
+                return false;
+            }
+            set(handle, value);
+            return true;
+        }
+
+    } // namespace tc
+} // namespace tractor
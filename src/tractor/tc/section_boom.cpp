@@ -0,0 +1,125 @@
+#include "tractor/tc/section_boom.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace tractor {
+    namespace tc {
+
+        namespace {
+
+            constexpr uint32_t LOW_BITS = 0x55555555; // Low bit of every 2 bit state
+
+            // Spread 16 bits to the low bit of 16 two bit fields
+            constexpr uint32_t spread(uint32_t bits) {
+                bits &= 0xFFFF;
+                bits = (bits | (bits << 8)) & 0x00FF00FF;
+                bits = (bits | (bits << 4)) & 0x0F0F0F0F;
+                bits = (bits | (bits << 2)) & 0x33333333;
+                bits = (bits | (bits << 1)) & LOW_BITS;
+                return bits;
+            }
+
+            // Inverse of spread()
+            constexpr uint32_t compact(uint32_t bits) {
+                bits &= LOW_BITS;
+                bits = (bits | (bits >> 1)) & 0x33333333;
+                bits = (bits | (bits >> 2)) & 0x0F0F0F0F;
+                bits = (bits | (bits >> 4)) & 0x00FF00FF;
+                bits = (bits | (bits >> 8)) & 0x0000FFFF;
+                return bits;
+            }
+
+            static_assert(spread(0xFFFF) == LOW_BITS);
+            static_assert(compact(spread(0xA5C3)) == 0xA5C3);
+
+            // Low bit set for every section that is exactly On (01)
+            constexpr uint32_t on_bits(uint32_t word) { return word & ~(word >> 1) & LOW_BITS; }
+
+        } // namespace
+
+        SectionBoom::SectionBoom(size_t sections) : sections_(std::min(sections, MAX_SECTIONS)) {
+            for (size_t group = 0; group < GROUPS; group++) {
+                size_t first = group * SECTIONS_PER_GROUP;
+                size_t installed = sections_ > first ? std::min(sections_ - first, SECTIONS_PER_GROUP) : 0;
+                not_installed_[group] = installed == SECTIONS_PER_GROUP ? 0 : ~0u << (2 * installed);
+                setpoint_[group].store(not_installed_[group], std::memory_order_relaxed);
+                switch_[group].store(not_installed_[group], std::memory_order_relaxed);
+            }
+        }
+
+        SectionBoom::State SectionBoom::state_of(const Words &words, size_t section) {
+            if (section >= MAX_SECTIONS) {
+                return State::NotInstalled;
+            }
+            uint32_t word = words[section / SECTIONS_PER_GROUP].load(std::memory_order_relaxed);
+            return static_cast<State>((word >> (2 * (section % SECTIONS_PER_GROUP))) & 0x3);
+        }
+
+        SectionBoom::SectionMask SectionBoom::mask_of(const Words &words) {
+            SectionMask mask{};
+            for (size_t group = 0; group < GROUPS; group++) {
+                uint64_t bits = compact(on_bits(words[group].load(std::memory_order_relaxed)));
+                mask[group / 4] |= bits << (16 * (group % 4));
+            }
+            return mask;
+        }
+
+        void SectionBoom::set_section(Words &words, size_t section, State state) {
+            if (section >= sections_) {
+                return;
+            }
+            auto &word = words[section / SECTIONS_PER_GROUP];
+            uint32_t shift = 2 * (section % SECTIONS_PER_GROUP);
+            uint32_t old_word = word.load(std::memory_order_relaxed);
+            uint32_t new_word;
+            do {
+                new_word = (old_word & ~(0x3u << shift)) | (static_cast<uint32_t>(state) << shift);
+            } while (!word.compare_exchange_weak(old_word, new_word, std::memory_order_relaxed));
+        }
+
+        void SectionBoom::set_mask(Words &words, const SectionMask &on) {
+            for (size_t group = 0; group < GROUPS; group++) {
+                uint32_t bits = static_cast<uint32_t>(on[group / 4] >> (16 * (group % 4)));
+                words[group].store((spread(bits) & ~not_installed_[group]) | not_installed_[group],
+                                   std::memory_order_relaxed);
+            }
+        }
+
+        void SectionBoom::set_setpoint(size_t section, State state) { set_section(setpoint_, section, state); }
+
+        void SectionBoom::set_switch(size_t section, bool on) {
+            set_section(switch_, section, on ? State::On : State::Off);
+        }
+
+        void SectionBoom::set_setpoint_mask(const SectionMask &on) { set_mask(setpoint_, on); }
+
+        void SectionBoom::set_switch_mask(const SectionMask &on) { set_mask(switch_, on); }
+
+        size_t SectionBoom::count_on() const {
+            const Words &words = is_auto() ? setpoint_ : switch_;
+            size_t count = 0;
+            for (const auto &word : words) {
+                count += static_cast<size_t>(std::popcount(on_bits(word.load(std::memory_order_relaxed))));
+            }
+            return count;
+        }
+
+        void SectionBoom::decode_setpoint(size_t group, uint32_t value) {
+            if (group >= GROUPS) {
+                return;
+            }
+            // Both bits set for every section commanded "not installed", which keep their state
+            uint32_t skip = value & (value >> 1) & LOW_BITS;
+            uint32_t keep = skip | (skip << 1) | not_installed_[group];
+
+            auto &word = setpoint_[group];
+            uint32_t old_word = word.load(std::memory_order_relaxed);
+            uint32_t new_word;
+            do {
+                new_word = (old_word & keep) | (value & ~keep);
+            } while (!word.compare_exchange_weak(old_word, new_word, std::memory_order_relaxed));
+        }
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,595 @@
+#include "tractor/tc/time_log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <mutex>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+
+namespace tractor {
+    namespace tc {
+
+        namespace {
+            using Clock = std::chrono::steady_clock;
+
+            constexpr size_t TIME_BYTES = 6;      // Milliseconds since midnight and days since 1980-01-01
+            constexpr size_t POSITION_BYTES = 24; // Every PTN attribute, see write_header()
+            constexpr size_t MAX_COLUMNS = 255;
+            constexpr size_t MAX_RECORD = TIME_BYTES + POSITION_BYTES + 1 + MAX_COLUMNS * 5;
+            constexpr size_t MIN_SEGMENT = 64 * 1024;
+            constexpr uint32_t MAX_LOG_NUMBER = 99999; // TLGnnnnn, the files must not be reused
+
+            // ISO 11783-10 time logs are little endian
+            uint8_t *put(uint8_t *out, uint64_t value, size_t bytes) {
+                for (size_t i = 0; i < bytes; i++) {
+                    *out++ = static_cast<uint8_t>(value >> (8 * i));
+                }
+                return out;
+            }
+
+            uint8_t *put_scaled(uint8_t *out, double value, double scale) {
+                double scaled = std::round(value * scale);
+                scaled = std::clamp(scaled, static_cast<double>(INT32_MIN), static_cast<double>(INT32_MAX));
+                return put(out, static_cast<uint32_t>(static_cast<int32_t>(scaled)), 4);
+            }
+
+            uint16_t dop(double value) {
+                return static_cast<uint16_t>(std::clamp(std::round(value * 10.0), 0.0, 65535.0));
+            }
+
+            // Time stamp part shared by TIM A and PTN H/I
+            void split_time(std::chrono::system_clock::time_point time, uint32_t &milliseconds, uint16_t &days) {
+                using namespace std::chrono;
+                auto day = floor<std::chrono::days>(time);
+                milliseconds = static_cast<uint32_t>(duration_cast<std::chrono::milliseconds>(time - day).count());
+                auto since = (day - sys_days{year{1980} / January / 1}).count();
+                days = static_cast<uint16_t>(std::clamp<int64_t>(since, 1, 0xFFFF));
+            }
+
+            uint8_t *encode_head(uint8_t *out, std::chrono::system_clock::time_point time,
+                                 const TimeLogPosition &position) {
+                uint32_t milliseconds = 0;
+                uint16_t days = 0;
+                split_time(time, milliseconds, days);
+                out = put(out, milliseconds, 4);
+                out = put(out, days, 2);
+                out = put_scaled(out, position.latitude, 1e7);
+                out = put_scaled(out, position.longitude, 1e7);
+                out = put_scaled(out, position.altitude, 1e3);
+                out = put(out, position.status, 1);
+                out = put(out, dop(position.pdop), 2);
+                out = put(out, dop(position.hdop), 2);
+                out = put(out, position.satellites, 1);
+                out = put(out, milliseconds, 4);
+                return put(out, days, 2);
+            }
+
+            // Length of the complete records at the start of a time log, trailing zeros are unused space
+            size_t complete_records(const std::vector<uint8_t> &data) {
+                size_t offset = 0;
+                while (offset + TIME_BYTES + POSITION_BYTES + 1 <= data.size()) {
+                    uint16_t days = static_cast<uint16_t>(data[offset + 4] | (data[offset + 5] << 8));
+                    if (days == 0) {
+                        break;
+                    }
+                    size_t size = TIME_BYTES + POSITION_BYTES + 1 + data[offset + TIME_BYTES + POSITION_BYTES] * 5;
+                    if (offset + size > data.size()) {
+                        break;
+                    }
+                    offset += size;
+                }
+                return offset;
+            }
+
+            // Text of a double quoted XML attribute
+            std::string xml_attribute(const std::string &value) {
+                std::string escaped;
+                escaped.reserve(value.size());
+                for (char c : value) {
+                    switch (c) {
+                    case '&':
+                        escaped += "&amp;";
+                        break;
+                    case '<':
+                        escaped += "&lt;";
+                        break;
+                    case '>':
+                        escaped += "&gt;";
+                        break;
+                    case '"':
+                        escaped += "&quot;";
+                        break;
+                    case '\'':
+                        escaped += "&apos;";
+                        break;
+                    default:
+                        escaped += c;
+                    }
+                }
+                return escaped;
+            }
+
+            std::string error_text(const std::string &what, const std::string &path) {
+                return what + " " + path + ": " + std::strerror(errno);
+            }
+        } // namespace
+
+        struct TimeLogger::Impl {
+            struct Column {
+                uint16_t ddi;
+                std::string device_element;
+            };
+
+            struct Segment {
+                std::string name; // TLGnnnnn
+                int fd = -1;
+                uint8_t *map = nullptr;
+                size_t capacity = 0;
+                size_t used = 0;
+                Clock::time_point opened;
+            };
+
+            TimeLogOptions options;
+            std::vector<Column> columns;
+
+            std::atomic<bool> running{false};
+            std::thread thread;
+
+            // Written by the logging thread only, the flusher reads it through used
+            Segment active;
+            std::atomic<size_t> used{0};
+            std::atomic<bool> rotate_requested{false};
+
+            mutable std::mutex mutex;
+            std::condition_variable wake;
+            bool stopping = false;
+            Segment spare;                // Next file, mapped and ready
+            std::vector<Segment> retired; // Full or expired files waiting to be finalized
+            std::vector<std::string> files;
+            uint32_t next_number = 1;
+            bool numbers_exhausted = false; // TLG99999 is taken, rotation stops and the last file fills up
+            std::string last_error;
+
+            std::atomic<uint64_t> records{0};
+            std::atomic<uint64_t> dropped{0};
+            std::atomic<uint64_t> bytes{0};
+
+            std::string path_of(const std::string &file) const { return options.directory + "/" + file; }
+
+            void set_error(std::string message) {
+                std::lock_guard<std::mutex> lock(mutex);
+                last_error = std::move(message);
+            }
+
+            // Replaces the file in one rename, so a reader or a power loss sees the old or the new version
+            bool write_file(const std::string &file, const std::string &content) {
+                std::string path = path_of(file);
+                std::string temporary = path + ".tmp";
+                int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd < 0) {
+                    set_error(error_text("Failed to create", temporary));
+                    return false;
+                }
+                ssize_t written = ::write(fd, content.data(), content.size());
+                bool success = written == static_cast<ssize_t>(content.size()) && ::fdatasync(fd) == 0;
+                ::close(fd);
+                if (!success || ::rename(temporary.c_str(), path.c_str()) < 0) {
+                    set_error(error_text("Failed to write", path));
+                    ::unlink(temporary.c_str());
+                    return false;
+                }
+                return true;
+            }
+
+            std::string header_xml() const {
+                std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<TIM A=\"\" D=\"4\">\n";
+                xml += "<PTN A=\"\" B=\"\" C=\"\" D=\"\" E=\"\" F=\"\" G=\"\" H=\"\" I=\"\"/>\n";
+                for (const auto &column : columns) {
+                    char ddi[5];
+                    std::snprintf(ddi, sizeof(ddi), "%04X", column.ddi);
+                    xml += "<DLV A=\"" + std::string(ddi) + "\" B=\"\" C=\"" + xml_attribute(column.device_element) +
+                           "\"/>\n";
+                }
+                return xml + "</TIM>\n";
+            }
+
+            bool write_task_data(bool completed) {
+                std::vector<std::string> names;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    names = files;
+                }
+                std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                  "<ISO11783_TaskData VersionMajor=\"4\" VersionMinor=\"3\" "
+                                  "TaskControllerManufacturer=\"tractor\" TaskControllerVersion=\"1\" "
+                                  "DataTransferOrigin=\"2\">\n";
+                if (!options.device_xml.empty()) {
+                    xml += options.device_xml + "\n";
+                }
+                xml += "<TSK A=\"" + xml_attribute(options.task_id) + "\" B=\"" + xml_attribute(options.task_name) +
+                       "\" G=\"" + (completed ? "4" : "2") + "\">\n";
+                for (const auto &name : names) {
+                    xml += "<TLG A=\"" + xml_attribute(name) + "\"/>\n";
+                }
+                xml += "</TSK>\n</ISO11783_TaskData>\n";
+                return write_file("TASKDATA.XML", xml);
+            }
+
+            // Creates, preallocates and maps the next time log, its header goes out first
+            bool open_segment(Segment &segment) {
+                char name[16];
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    numbers_exhausted = next_number > MAX_LOG_NUMBER;
+                    if (!numbers_exhausted) {
+                        std::snprintf(name, sizeof(name), "TLG%05u", next_number++);
+                    }
+                }
+                if (numbers_exhausted) {
+                    set_error("No time log numbers left after TLG99999, clear the directory");
+                    return false;
+                }
+                if (!write_file(std::string(name) + ".xml", header_xml())) {
+                    return false;
+                }
+
+                std::string path = path_of(std::string(name) + ".bin");
+                int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd < 0) {
+                    set_error(error_text("Failed to create", path));
+                    return false;
+                }
+                size_t size = std::max(options.segment_size, MIN_SEGMENT);
+                int result = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+                if (result != 0 && (result != EOPNOTSUPP || ::ftruncate(fd, static_cast<off_t>(size)) < 0)) {
+                    set_error("Failed to allocate " + path + ": " + std::strerror(result));
+                    ::close(fd);
+                    return false;
+                }
+
+                int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+                flags |= MAP_POPULATE; // Fault the pages in now rather than on the logging thread
+#endif
+                void *map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+                if (map == MAP_FAILED) {
+                    set_error(error_text("Failed to map", path));
+                    ::close(fd);
+                    return false;
+                }
+
+                segment.name = name;
+                segment.fd = fd;
+                segment.map = static_cast<uint8_t *>(map);
+                segment.capacity = size;
+                segment.used = 0;
+                segment.opened = Clock::now();
+                return true;
+            }
+
+            // Syncs the records and trims the file to them, an unused file is removed with its header
+            void close_segment(Segment &segment, bool keep) {
+                if (segment.map == nullptr) {
+                    return;
+                }
+                ::msync(segment.map, segment.used, MS_SYNC);
+                ::munmap(segment.map, segment.capacity);
+                std::string path = path_of(segment.name + ".bin");
+                if (::ftruncate(segment.fd, static_cast<off_t>(segment.used)) < 0 || ::fdatasync(segment.fd) < 0) {
+                    set_error(error_text("Failed to finalize", path));
+                }
+                ::close(segment.fd);
+                if (!keep) {
+                    ::unlink(path.c_str());
+                    ::unlink(path_of(segment.name + ".xml").c_str());
+                }
+                segment = Segment{};
+            }
+
+            // Trims the time logs of an earlier run to their complete records and adopts them
+            void recover() {
+                std::error_code error;
+                std::vector<std::string> found;
+                for (std::filesystem::directory_iterator it(options.directory, error), end; !error && it != end;
+                     it.increment(error)) {
+                    unsigned number = 0;
+                    char tail = 0;
+                    std::string name = it->path().filename().string();
+                    if (name.size() == 12 && std::sscanf(name.c_str(), "TLG%5u.bi%c", &number, &tail) == 2 &&
+                        tail == 'n') {
+                        found.push_back(name.substr(0, 8));
+                        next_number = std::max(next_number, number + 1);
+                    }
+                }
+                std::sort(found.begin(), found.end());
+
+                for (const auto &name : found) {
+                    std::string path = path_of(name + ".bin");
+                    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+                    if (fd < 0) {
+                        continue;
+                    }
+                    std::vector<uint8_t> data(static_cast<size_t>(std::max<off_t>(::lseek(fd, 0, SEEK_END), 0)));
+                    ssize_t size = ::pread(fd, data.data(), data.size(), 0);
+                    data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+                    size_t complete = complete_records(data);
+                    if (complete != data.size() && ::ftruncate(fd, static_cast<off_t>(complete)) == 0) {
+                        ::fdatasync(fd);
+                    }
+                    ::close(fd);
+
+                    if (complete == 0) {
+                        ::unlink(path.c_str());
+                        ::unlink(path_of(name + ".xml").c_str());
+                    } else {
+                        files.push_back(name);
+                    }
+                }
+            }
+
+            bool append(const uint8_t *record, size_t size) {
+                if (active.used + size > active.capacity || rotate_requested.load(std::memory_order_relaxed)) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (spare.map == nullptr) {
+                        // Nothing to rotate to, the flusher asks again once a spare is ready
+                        rotate_requested.store(false, std::memory_order_relaxed);
+                        lock.unlock();
+                        if (active.used + size > active.capacity) {
+                            dropped.fetch_add(1, std::memory_order_relaxed);
+                            return false;
+                        }
+                    } else {
+                        retired.push_back(active);
+                        active = spare;
+                        spare = Segment{};
+                        used.store(0, std::memory_order_release);
+                        rotate_requested.store(false, std::memory_order_relaxed);
+                        lock.unlock();
+                        wake.notify_one();
+                    }
+                }
+
+                std::memcpy(active.map + active.used, record, size);
+                active.used += size;
+                used.store(active.used, std::memory_order_release);
+                records.fetch_add(1, std::memory_order_relaxed);
+                bytes.fetch_add(size, std::memory_order_relaxed);
+                return true;
+            }
+        };
+
+        TimeLogger::TimeLogger(const TimeLogOptions &options) : pimpl_(std::make_unique<Impl>()) {
+            pimpl_->options = options;
+            pimpl_->options.flush_interval_ms = std::max<uint32_t>(options.flush_interval_ms, 1);
+        }
+
+        TimeLogger::~TimeLogger() { stop(); }
+
+        int TimeLogger::add_value(uint16_t ddi, const std::string &device_element) {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            if (pimpl_->running || pimpl_->columns.size() >= MAX_COLUMNS) {
+                return -1;
+            }
+            pimpl_->columns.push_back({ddi, device_element});
+            return static_cast<int>(pimpl_->columns.size() - 1);
+        }
+
+        bool TimeLogger::start() {
+            if (pimpl_->running) {
+                return true;
+            }
+            if (pimpl_->options.directory.empty()) {
+                pimpl_->set_error("No time log directory configured");
+                return false;
+            }
+
+            std::error_code error;
+            std::filesystem::create_directories(pimpl_->options.directory, error);
+            if (error) {
+                pimpl_->set_error("Failed to create " + pimpl_->options.directory + ": " + error.message());
+                return false;
+            }
+
+            pimpl_->files.clear();
+            pimpl_->recover();
+            const uint32_t first_number = pimpl_->next_number;
+            if (!pimpl_->open_segment(pimpl_->active)) {
+                return false;
+            }
+            pimpl_->used.store(0, std::memory_order_relaxed);
+            pimpl_->rotate_requested.store(false, std::memory_order_relaxed);
+            pimpl_->records.store(0, std::memory_order_relaxed);
+            pimpl_->dropped.store(0, std::memory_order_relaxed);
+            pimpl_->bytes.store(0, std::memory_order_relaxed);
+            // Without numbers left for a spare the active file is the last one. TASKDATA.XML only lists
+            // the active file once both are ready, a failure removes them and hands their numbers out again
+            bool ready = pimpl_->open_segment(pimpl_->spare) || pimpl_->numbers_exhausted;
+            if (ready) {
+                pimpl_->files.push_back(pimpl_->active.name);
+                ready = pimpl_->write_task_data(false);
+                if (!ready) {
+                    pimpl_->files.pop_back();
+                }
+            }
+            if (!ready) {
+                pimpl_->close_segment(pimpl_->spare, false);
+                pimpl_->close_segment(pimpl_->active, false);
+                pimpl_->next_number = first_number;
+                pimpl_->numbers_exhausted = false;
+                return false;
+            }
+
+            pimpl_->stopping = false;
+            pimpl_->running = true;
+            pimpl_->thread = std::thread(&TimeLogger::flusher_thread, this);
+            return true;
+        }
+
+        void TimeLogger::stop() {
+            if (!pimpl_->running.exchange(false)) {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->mutex);
+                pimpl_->stopping = true;
+            }
+            pimpl_->wake.notify_all();
+            if (pimpl_->thread.joinable()) {
+                pimpl_->thread.join();
+            }
+
+            for (auto &segment : pimpl_->retired) {
+                pimpl_->close_segment(segment, true);
+            }
+            pimpl_->retired.clear();
+            pimpl_->close_segment(pimpl_->spare, false);
+
+            // An empty last file is not worth keeping in the task
+            bool keep = pimpl_->active.used > 0;
+            if (!keep) {
+                std::lock_guard<std::mutex> lock(pimpl_->mutex);
+                auto &files = pimpl_->files;
+                files.erase(std::remove(files.begin(), files.end(), pimpl_->active.name), files.end());
+            }
+            pimpl_->close_segment(pimpl_->active, keep);
+            pimpl_->write_task_data(true);
+        }
+
+        bool TimeLogger::is_running() const { return pimpl_->running; }
+
+        bool TimeLogger::log(std::chrono::system_clock::time_point time, const TimeLogPosition &position,
+                             std::span<const TimeLogValue> values) {
+            if (!pimpl_->running) {
+                return false;
+            }
+
+            uint8_t record[MAX_RECORD];
+            uint8_t *out = encode_head(record, time, position);
+            uint8_t *count = out++;
+            size_t columns = pimpl_->columns.size();
+            size_t written = 0;
+            for (const auto &value : values) {
+                if (value.column < columns && written < MAX_COLUMNS) {
+                    out = put(out, value.column, 1);
+                    out = put(out, static_cast<uint32_t>(value.value), 4);
+                    written++;
+                }
+            }
+            *count = static_cast<uint8_t>(written);
+            return pimpl_->append(record, static_cast<size_t>(out - record));
+        }
+
+        bool TimeLogger::log(std::chrono::system_clock::time_point time, const TimeLogPosition &position,
+                             std::span<const int32_t> values) {
+            if (!pimpl_->running) {
+                return false;
+            }
+
+            uint8_t record[MAX_RECORD];
+            uint8_t *out = encode_head(record, time, position);
+            size_t count = std::min(values.size(), pimpl_->columns.size());
+            out = put(out, count, 1);
+            for (size_t column = 0; column < count; column++) {
+                out = put(out, column, 1);
+                out = put(out, static_cast<uint32_t>(values[column]), 4);
+            }
+            return pimpl_->append(record, static_cast<size_t>(out - record));
+        }
+
+        TimeLogger::Statistics TimeLogger::get_statistics() const {
+            Statistics stats;
+            stats.records = pimpl_->records.load(std::memory_order_relaxed);
+            stats.records_dropped = pimpl_->dropped.load(std::memory_order_relaxed);
+            stats.bytes_written = pimpl_->bytes.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            stats.files = pimpl_->files.size();
+            return stats;
+        }
+
+        std::vector<std::string> TimeLogger::get_files() const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            return pimpl_->files;
+        }
+
+        std::string TimeLogger::get_last_error() const {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex);
+            return pimpl_->last_error;
+        }
+
+        void TimeLogger::flusher_thread() {
+            const auto interval = std::chrono::milliseconds(pimpl_->options.flush_interval_ms);
+            const long page = ::sysconf(_SC_PAGESIZE);
+            uint8_t *synced_map = nullptr;
+            size_t synced = 0;
+            bool spare_failed = false; // Retry a failed file on the next pass rather than at once
+
+            std::unique_lock<std::mutex> lock(pimpl_->mutex);
+            while (!pimpl_->stopping) {
+                pimpl_->wake.wait_for(lock, interval, [this, spare_failed] {
+                    return pimpl_->stopping || !pimpl_->retired.empty() ||
+                           (pimpl_->spare.map == nullptr && !spare_failed && !pimpl_->numbers_exhausted);
+                });
+
+                // The logging thread swaps active only under the mutex, so these fields are consistent;
+                // active.used is its own and is read through the atomic instead
+                std::vector<Impl::Segment> finished = std::move(pimpl_->retired);
+                pimpl_->retired.clear();
+                uint8_t *map = pimpl_->active.map;
+                std::string name = pimpl_->active.name;
+                Clock::time_point opened = pimpl_->active.opened;
+                size_t used = pimpl_->used.load(std::memory_order_acquire);
+                bool need_spare = pimpl_->spare.map == nullptr && !pimpl_->stopping && !pimpl_->numbers_exhausted;
+                if (!finished.empty() &&
+                    std::find(pimpl_->files.begin(), pimpl_->files.end(), name) == pimpl_->files.end()) {
+                    pimpl_->files.push_back(name);
+                }
+                lock.unlock();
+
+                // Write back what the logging thread stored since the last pass
+                if (map != synced_map) {
+                    synced_map = map;
+                    synced = 0;
+                }
+                if (used > synced) {
+                    size_t from = synced - synced % static_cast<size_t>(page);
+                    ::msync(map + from, used - from, MS_SYNC);
+                    synced = used;
+                }
+
+                for (auto &segment : finished) {
+                    pimpl_->close_segment(segment, true);
+                }
+                if (!finished.empty()) {
+                    pimpl_->write_task_data(false);
+                }
+
+                Impl::Segment prepared;
+                if (need_spare) {
+                    spare_failed = !pimpl_->open_segment(prepared);
+                }
+
+                auto rotate_interval = pimpl_->options.rotate_interval;
+                bool rotate = rotate_interval.count() > 0 && used > 0 && Clock::now() - opened >= rotate_interval;
+
+                lock.lock();
+                if (prepared.map != nullptr) {
+                    pimpl_->spare = prepared;
+                }
+                // Only with a spare to swap in, otherwise every log() would take the mutex for nothing
+                if (rotate && pimpl_->spare.map != nullptr) {
+                    pimpl_->rotate_requested.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+
+    } // namespace tc
+} // namespace tractor
@@ -0,0 +1,310 @@
+#include "tractor/trace.hpp"
+#include "tractor/detail/seqlock_ring.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace tractor {
+    namespace trace {
+
+        namespace detail {
+            std::atomic<bool> enabled{true};
+        } // namespace detail
+
+        namespace {
+
+            constexpr size_t DEFAULT_BUFFER_SIZE = 8192;
+            constexpr size_t MIN_BUFFER_SIZE = 16;
+            constexpr size_t MAX_EXITED_BUFFERS = 32; // Reconnects start new threads, keep only the newest exited ones
+
+            struct Event {
+                const char *category;
+                const char *name;
+                uint64_t start;
+                uint64_t duration;
+                uint64_t value;
+                uint64_t type;
+            };
+
+            static_assert(std::has_unique_object_representations_v<Event>, "Events are copied as words");
+
+            struct ThreadBuffer {
+                explicit ThreadBuffer(size_t size) : events(size) {}
+
+                // Pushed to by the owning thread only, the exporter reads while it keeps recording
+                tractor::detail::SeqlockRing<Event> events;
+                std::atomic<uint64_t> floor{0}; // Events below it were dropped by clear()
+
+                // Guarded by the registry mutex
+                long tid = 0;
+                std::string thread_name;
+                bool exited = false;
+            };
+
+            std::string current_thread_name() {
+                char name[16] = {};
+                if (::pthread_getname_np(::pthread_self(), name, sizeof(name)) != 0) {
+                    return {};
+                }
+                return name;
+            }
+
+            // Threads still running may have been renamed since they recorded their first event
+            std::string live_thread_name(long tid) {
+                std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+                std::string name;
+                std::getline(comm, name);
+                return name;
+            }
+
+            struct Registry {
+                std::mutex mutex;
+                std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+                size_t buffer_size = DEFAULT_BUFFER_SIZE;
+
+                void drop_exited(size_t keep) {
+                    auto is_exited = [](const auto &buffer) { return buffer->exited; };
+                    auto exited = static_cast<size_t>(std::count_if(buffers.begin(), buffers.end(), is_exited));
+                    for (auto it = buffers.begin(); it != buffers.end() && exited > keep;) {
+                        if ((*it)->exited) {
+                            it = buffers.erase(it);
+                            exited--;
+                        } else {
+                            ++it;
+                        }
+                    }
+                }
+            };
+
+            // Never destroyed, threads may still record while static objects are torn down
+            Registry &registry() {
+                static Registry *instance = new Registry();
+                return *instance;
+            }
+
+            thread_local ThreadBuffer *thread_buffer = nullptr; // Plain pointer, no guard on the hot path
+            thread_local bool thread_detached = false;          // Handle destroyed, the thread records no more
+
+            // Keeps the buffer of the thread in the registry and marks it when the thread exits
+            struct ThreadHandle {
+                std::shared_ptr<ThreadBuffer> buffer;
+
+                // clear() may free the buffer from now on, later tracepoints of the thread are dropped
+                ~ThreadHandle() {
+                    thread_buffer = nullptr;
+                    thread_detached = true;
+                    if (!buffer) {
+                        return;
+                    }
+                    Registry &reg = registry();
+                    std::lock_guard<std::mutex> lock(reg.mutex);
+                    buffer->thread_name = current_thread_name();
+                    buffer->exited = true;
+                }
+            };
+
+            thread_local ThreadHandle thread_handle;
+
+            ThreadBuffer *attach() {
+                Registry &reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                auto buffer = std::make_shared<ThreadBuffer>(reg.buffer_size);
+                buffer->tid = static_cast<long>(::syscall(SYS_gettid));
+                buffer->thread_name = current_thread_name();
+                reg.drop_exited(MAX_EXITED_BUFFERS - 1);
+                reg.buffers.push_back(buffer);
+                thread_handle.buffer = buffer;
+                thread_buffer = buffer.get();
+                return thread_buffer;
+            }
+
+            void write_escaped(std::ostream &out, const char *text) {
+                out << '"';
+                for (const char *c = text != nullptr ? text : ""; *c != '\0'; c++) {
+                    auto byte = static_cast<unsigned char>(*c);
+                    if (byte == '"' || byte == '\\') {
+                        out << '\\' << *c;
+                    } else if (byte < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+                        out << escaped;
+                    } else {
+                        out << *c;
+                    }
+                }
+                out << '"';
+            }
+
+            // Microseconds with the nanoseconds as decimals, without going through a double
+            void write_us(std::ostream &out, uint64_t ns) {
+                char text[32];
+                std::snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(ns / 1000),
+                              static_cast<unsigned>(ns % 1000));
+                out << text;
+            }
+
+            void write_event(std::ostream &out, const Event &event, long pid, long tid) {
+                static constexpr const char *PHASES[] = {"X", "i", "C", "s", "f"};
+                auto type = static_cast<EventType>(event.type);
+
+                out << "{\"ph\":\"" << PHASES[event.type] << "\",\"cat\":";
+                write_escaped(out, event.category);
+                out << ",\"name\":";
+                write_escaped(out, event.name);
+                out << ",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":";
+                write_us(out, event.start);
+
+                switch (type) {
+                case EventType::Complete:
+                    out << ",\"dur\":";
+                    write_us(out, event.duration);
+                    break;
+                case EventType::Instant:
+                    out << ",\"s\":\"t\"";
+                    break;
+                case EventType::Counter:
+                    out << ",\"args\":{";
+                    write_escaped(out, event.name);
+                    out << ':' << event.value << '}';
+                    break;
+                case EventType::FlowBegin:
+                    out << ",\"id\":" << event.value;
+                    break;
+                case EventType::FlowEnd:
+                    out << ",\"id\":" << event.value << ",\"bp\":\"e\"";
+                    break;
+                }
+                if ((type == EventType::Complete || type == EventType::Instant) && event.value != 0) {
+                    out << ",\"args\":{\"value\":" << event.value << '}';
+                }
+                out << '}';
+            }
+
+        } // namespace
+
+        void set_enabled(bool enabled) { detail::enabled.store(enabled, std::memory_order_relaxed); }
+
+        void record(EventType type, const char *category, const char *name, uint64_t start, uint64_t duration,
+                    uint64_t value) {
+            ThreadBuffer *buffer = thread_buffer;
+            if (buffer == nullptr) {
+                if (thread_detached) {
+                    return; // The thread is exiting, its handle cannot be brought back
+                }
+                buffer = attach();
+            }
+            buffer->events.push(Event{category, name, start, duration, value, static_cast<uint64_t>(type)});
+        }
+
+        void set_buffer_size(size_t events) {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.buffer_size = std::bit_ceil(std::max(events, MIN_BUFFER_SIZE));
+        }
+
+        Statistics get_statistics() {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+
+            Statistics stats;
+            stats.threads = reg.buffers.size();
+            for (const auto &buffer : reg.buffers) {
+                uint64_t recorded = buffer->events.head() - buffer->floor.load(std::memory_order_relaxed);
+                size_t capacity = buffer->events.capacity();
+                stats.recorded += recorded;
+                stats.overwritten += recorded > capacity ? recorded - capacity : 0;
+            }
+            return stats;
+        }
+
+        void clear() {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.drop_exited(0);
+            for (const auto &buffer : reg.buffers) {
+                buffer->floor.store(buffer->events.head(), std::memory_order_relaxed);
+            }
+        }
+
+        bool write_chrome_trace(std::ostream &out) {
+            struct Snapshot {
+                std::shared_ptr<ThreadBuffer> buffer;
+                long tid;
+                std::string name;
+                bool exited;
+            };
+
+            // The buffers stay alive through the shared pointers, the lock is not held while copying
+            std::vector<Snapshot> snapshots;
+            {
+                Registry &reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                for (const auto &buffer : reg.buffers) {
+                    snapshots.push_back({buffer, buffer->tid, buffer->thread_name, buffer->exited});
+                }
+            }
+
+            const long pid = static_cast<long>(::getpid());
+            bool first = true;
+            auto separator = [&] {
+                out << (first ? "\n" : ",\n");
+                first = false;
+            };
+
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            std::vector<Event> events;
+            for (auto &snapshot : snapshots) {
+                const ThreadBuffer &buffer = *snapshot.buffer;
+                uint64_t head = buffer.events.head();
+                size_t capacity = buffer.events.capacity();
+                uint64_t begin = std::max(buffer.floor.load(std::memory_order_relaxed),
+                                          head > capacity ? head - capacity : 0);
+
+                events.clear();
+                Event event;
+                for (uint64_t index = begin; index < head; index++) {
+                    if (buffer.events.read(index, event)) {
+                        events.push_back(event);
+                    }
+                }
+
+                std::string name = snapshot.exited ? snapshot.name : live_thread_name(snapshot.tid);
+                if (name.empty()) {
+                    name = snapshot.name;
+                }
+                separator();
+                out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << snapshot.tid
+                    << ",\"args\":{\"name\":";
+                write_escaped(out, name.c_str());
+                out << "}}";
+
+                for (const Event &recorded : events) {
+                    separator();
+                    write_event(out, recorded, pid, snapshot.tid);
+                }
+            }
+            out << "\n]}\n";
+            out.flush();
+            return out.good();
+        }
+
+        bool write_chrome_trace(const std::string &path) {
+            std::ofstream file(path, std::ios::trunc);
+            if (!file) {
+                return false;
+            }
+            return write_chrome_trace(file);
+        }
+
+    } // namespace trace
+} // namespace tractor
@@ -1,7 +1,386 @@
+#include <tractor/trace.hpp>
 #include <tractor/tractor.hpp>
 
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/isobus/isobus_task_controller_client.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
 namespace tractor {
 
+    namespace {
+        // Event counter of the runtime inside run(), the signal handler can only write to it
+        std::atomic<int> signal_fd{-1};
+
+        void on_signal(int) {
+            int fd = signal_fd.load();
+            if (fd >= 0) {
+                uint64_t one = 1;
+                ssize_t written = ::write(fd, &one, sizeof(one));
+                (void)written;
+            }
+        }
+
+        // Task controllers of the industry group, function instance picks one of them
+        std::vector<isobus::NAMEFilter> task_controller_filters(uint8_t instance) {
+            return {isobus::NAMEFilter(isobus::NAME::NAMEParameters::FunctionCode,
+                                       static_cast<std::uint8_t>(isobus::NAME::Function::TaskController)),
+                    isobus::NAMEFilter(isobus::NAME::NAMEParameters::FunctionInstance, instance),
+                    isobus::NAMEFilter(isobus::NAME::NAMEParameters::IndustryGroup,
+                                       static_cast<std::uint8_t>(
+                                           isobus::NAME::IndustryGroup::AgriculturalAndForestryEquipment)),
+                    isobus::NAMEFilter(isobus::NAME::NAMEParameters::DeviceClass,
+                                       static_cast<std::uint8_t>(isobus::NAME::DeviceClass::NonSpecific))};
+        }
+    } // namespace
+
+    struct Tractor::Impl {
+        struct HostedClient {
+            TcClientOptions options;
+            tc::ClientId id = tc::ClientId::Default;
+            std::shared_ptr<isobus::InternalControlFunction> control_function;
+            std::shared_ptr<isobus::PartneredControlFunction> task_controller;
+            std::shared_ptr<isobus::TaskControllerClient> client;
+            Scheduler::TaskId task = 0;
+        };
+
+        TractorOptions options;
+        Scheduler scheduler;
+        comms::SerialReactor reactor;
+
+        std::shared_ptr<can::BatchedSocketCan> can;
+        std::shared_ptr<isobus::InternalControlFunction> control_function;
+        std::shared_ptr<isobus::PartneredControlFunction> task_controller;
+        std::shared_ptr<isobus::TaskControllerClient> tc_client;
+        Scheduler::TaskId tc_task = 0;
+
+        tc::ProcessDataStore process_data; // Before the change scheduler watching it
+        tc::ChangeScheduler changes;
+        std::vector<HostedClient> hosted;
+
+        int stop_fd = -1;
+        bool running = false;
+        mutable std::mutex mutex;
+        std::string last_error;
+
+        explicit Impl(const TractorOptions &options)
+            : options(options), scheduler(options.scheduler), reactor(options.reactor),
+              process_data(options.process_data_capacity), changes(process_data) {
+            // Until the application routes them elsewhere, changes of the default client go to the legacy one
+            changes.set_notify(tc::ClientId::Default, [this](uint16_t element, uint16_t ddi) {
+                return tc_client && tc_client->on_value_changed_trigger(element, ddi);
+            });
+        }
+
+        void set_error(std::string message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            last_error = std::move(message);
+        }
+
+        // Without an interface the runtime runs the reactor and the scheduler only
+        bool start_can() {
+            if (options.can.interface.empty()) {
+                if (options.name != 0 || !hosted.empty()) {
+                    set_error("Claiming a NAME needs a CAN interface");
+                    return false;
+                }
+                return true;
+            }
+
+            can = std::make_shared<can::BatchedSocketCan>(options.can);
+            isobus::CANHardwareInterface::set_number_of_can_channels(1);
+            isobus::CANHardwareInterface::assign_can_channel_frame_handler(0, can);
+            if (!isobus::CANHardwareInterface::start() || !can->get_is_valid()) {
+                std::string reason = can->get_last_error();
+                set_error("Failed to start CAN on " + options.can.interface +
+                          (reason.empty() ? std::string() : ": " + reason));
+                isobus::CANHardwareInterface::stop();
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.can_settle_ms));
+            return true;
+        }
+
+        void stop_can() {
+            if (!options.can.interface.empty()) {
+                isobus::CANHardwareInterface::stop();
+            }
+        }
+
+        // Created once, the network manager keeps them across restarts
+        void create_control_functions() {
+            if (options.name == 0 || control_function) {
+                return;
+            }
+            auto &network = isobus::CANNetworkManager::CANNetwork;
+            control_function = network.create_internal_control_function(isobus::NAME(options.name), 0);
+            if (!options.task_controller) {
+                return;
+            }
+
+            task_controller =
+                network.create_partnered_control_function(0, task_controller_filters(options.tc_instance));
+            tc_client = std::make_shared<isobus::TaskControllerClient>(task_controller, control_function, nullptr);
+        }
+
+        // The callbacks answer from the client's binding of the store, which lives as long as the runtime
+        void create_hosted_client(HostedClient &hosted_client) {
+            if (hosted_client.client) {
+                return;
+            }
+            auto &network = isobus::CANNetworkManager::CANNetwork;
+            const TcClientOptions &client_options = hosted_client.options;
+            hosted_client.control_function =
+                network.create_internal_control_function(isobus::NAME(client_options.name), 0);
+            hosted_client.task_controller =
+                network.create_partnered_control_function(0, task_controller_filters(client_options.tc_instance));
+            hosted_client.client = std::make_shared<isobus::TaskControllerClient>(
+                hosted_client.task_controller, hosted_client.control_function, nullptr);
+
+            tc::ProcessDataStore::Client *binding = process_data.client(hosted_client.id);
+            hosted_client.client->add_request_value_callback(tc::ProcessDataStore::client_request_value_callback,
+                                                             binding);
+            hosted_client.client->add_value_command_callback(tc::ProcessDataStore::client_value_command_callback,
+                                                             binding);
+            auto client = hosted_client.client;
+            changes.set_notify(hosted_client.id, [client](uint16_t element, uint16_t ddi) {
+                return client->on_value_changed_trigger(element, ddi);
+            });
+        }
+
+        // Configured on every start, terminate() forgets the pool
+        void initialize_hosted_client(HostedClient &hosted_client) {
+            const TcClientOptions &client_options = hosted_client.options;
+            hosted_client.client->configure(client_options.ddop, client_options.ddop_size, client_options.booms,
+                                            client_options.sections, client_options.position_channels,
+                                            client_options.documentation, client_options.tcgeo_without_position,
+                                            client_options.tcgeo_with_position, client_options.peer_control,
+                                            client_options.section_control);
+            hosted_client.client->initialize(false);
+
+            // A lane per client, a burst of requests on one does not hold up the update of another
+            TaskOptions task;
+            task.name = "tc_client_" + std::to_string(static_cast<int>(hosted_client.id));
+            task.period = client_options.update;
+            task.priority = 10;
+            task.cpu = client_options.cpu;
+            task.lane = RESERVED_LANE - static_cast<int>(hosted_client.id);
+            auto client = hosted_client.client;
+            hosted_client.task = scheduler.add(task, [client] {
+                TRACTOR_TRACE_SCOPE("tc", "update");
+                if (client->get_is_initialized()) {
+                    client->update();
+                }
+            });
+        }
+    };
+
+    Tractor::Tractor() : Tractor(TractorOptions{}) {}
+
+    Tractor::Tractor(const TractorOptions &options) : pimpl_(std::make_unique<Impl>(options)) {
+        pimpl_->stop_fd = ::eventfd(0, EFD_CLOEXEC);
+    }
+
+    Tractor::~Tractor() {
+        stop();
+        if (pimpl_->stop_fd >= 0) {
+            ::close(pimpl_->stop_fd);
+        }
+    }
+
     std::string Tractor::version() const { return "0.0.1"; }
 
+    bool Tractor::start() {
+        if (pimpl_->running) {
+            return true;
+        }
+
+        if (!pimpl_->start_can()) {
+            return false;
+        }
+        pimpl_->create_control_functions();
+
+        if (!pimpl_->reactor.start()) {
+            pimpl_->set_error("Failed to start serial reactor: " + pimpl_->reactor.get_last_error());
+            pimpl_->stop_can();
+            return false;
+        }
+
+        if (pimpl_->tc_client) {
+            TaskOptions task;
+            task.name = "tc_client";
+            task.period = pimpl_->options.tc_update;
+            task.priority = 10;
+            task.cpu = pimpl_->options.tc_cpu;
+            task.lane = RESERVED_LANE - static_cast<int>(tc::ClientId::Default);
+            auto client = pimpl_->tc_client;
+            pimpl_->tc_task = pimpl_->scheduler.add(task, [client] {
+                TRACTOR_TRACE_SCOPE("tc", "update");
+                if (client->get_is_initialized()) {
+                    client->update();
+                }
+            });
+        }
+        for (auto &hosted_client : pimpl_->hosted) {
+            pimpl_->create_hosted_client(hosted_client);
+            pimpl_->initialize_hosted_client(hosted_client);
+        }
+        if (pimpl_->tc_client || !pimpl_->hosted.empty()) {
+            pimpl_->changes.start();
+        }
+        pimpl_->scheduler.start();
+
+        pimpl_->running = true;
+        return true;
+    }
+
+    void Tractor::stop() {
+        if (!pimpl_->running) {
+            return;
+        }
+        pimpl_->running = false;
+
+        pimpl_->scheduler.stop();
+        if (pimpl_->tc_task != 0) {
+            pimpl_->scheduler.remove(pimpl_->tc_task);
+            pimpl_->tc_task = 0;
+        }
+        for (auto &hosted_client : pimpl_->hosted) {
+            if (hosted_client.task != 0) {
+                pimpl_->scheduler.remove(hosted_client.task);
+                hosted_client.task = 0;
+            }
+        }
+        pimpl_->changes.stop();
+        pimpl_->reactor.stop();
+        for (auto &hosted_client : pimpl_->hosted) {
+            if (hosted_client.client->get_is_initialized()) {
+                hosted_client.client->terminate();
+            }
+        }
+        if (pimpl_->tc_client && pimpl_->tc_client->get_is_initialized()) {
+            pimpl_->tc_client->terminate();
+        }
+        pimpl_->stop_can();
+    }
+
+    bool Tractor::is_running() const { return pimpl_->running; }
+
+    int Tractor::run() {
+        if (!start()) {
+            return -1;
+        }
+
+        struct sigaction previous_int {};
+        struct sigaction previous_term {};
+        if (pimpl_->options.handle_signals) {
+            struct sigaction action {};
+            action.sa_handler = on_signal;
+            sigemptyset(&action.sa_mask);
+            signal_fd = pimpl_->stop_fd;
+            ::sigaction(SIGINT, &action, &previous_int);
+            ::sigaction(SIGTERM, &action, &previous_term);
+        }
+
+        uint64_t value = 0;
+        while (::read(pimpl_->stop_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+
+        if (pimpl_->options.handle_signals) {
+            ::sigaction(SIGINT, &previous_int, nullptr);
+            ::sigaction(SIGTERM, &previous_term, nullptr);
+            signal_fd = -1;
+        }
+        stop();
+        return 0;
+    }
+
+    void Tractor::request_stop() {
+        uint64_t one = 1;
+        ssize_t written = ::write(pimpl_->stop_fd, &one, sizeof(one));
+        (void)written;
+    }
+
+    tc::ClientId Tractor::add_tc_client(const TcClientOptions &options) {
+        if (pimpl_->running) {
+            pimpl_->set_error("TC clients are added before start()");
+            return tc::ClientId::Default;
+        }
+        if (options.ddop == nullptr || options.ddop_size == 0) {
+            pimpl_->set_error("TC client without a DDOP");
+            return tc::ClientId::Default;
+        }
+        if (pimpl_->hosted.size() + 1 >= tc::MAX_CLIENTS) {
+            pimpl_->set_error("Too many TC clients");
+            return tc::ClientId::Default;
+        }
+
+        Impl::HostedClient hosted_client;
+        hosted_client.options = options;
+        hosted_client.id = static_cast<tc::ClientId>(pimpl_->hosted.size() + 1);
+        pimpl_->hosted.push_back(std::move(hosted_client));
+        return pimpl_->hosted.back().id;
+    }
+
+    tc::ProcessDataStore &Tractor::process_data() { return pimpl_->process_data; }
+
+    tc::ChangeScheduler &Tractor::change_scheduler() { return pimpl_->changes; }
+
+    Scheduler &Tractor::scheduler() { return pimpl_->scheduler; }
+
+    comms::SerialReactor &Tractor::reactor() { return pimpl_->reactor; }
+
+    std::shared_ptr<can::BatchedSocketCan> Tractor::get_can_interface() const { return pimpl_->can; }
+
+    std::shared_ptr<isobus::InternalControlFunction> Tractor::get_control_function() const {
+        return pimpl_->control_function;
+    }
+
+    std::shared_ptr<isobus::PartneredControlFunction> Tractor::get_task_controller() const {
+        return pimpl_->task_controller;
+    }
+
+    std::shared_ptr<isobus::TaskControllerClient> Tractor::get_tc_client() const { return pimpl_->tc_client; }
+
+    std::shared_ptr<isobus::TaskControllerClient> Tractor::get_tc_client(tc::ClientId client) const {
+        if (client == tc::ClientId::Default) {
+            return pimpl_->tc_client;
+        }
+        for (const auto &hosted_client : pimpl_->hosted) {
+            if (hosted_client.id == client) {
+                return hosted_client.client;
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<isobus::InternalControlFunction> Tractor::get_control_function(tc::ClientId client) const {
+        if (client == tc::ClientId::Default) {
+            return pimpl_->control_function;
+        }
+        for (const auto &hosted_client : pimpl_->hosted) {
+            if (hosted_client.id == client) {
+                return hosted_client.control_function;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string Tractor::get_last_error() const {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        return pimpl_->last_error;
+    }
+
 } // namespace tractor
@@ -0,0 +1,174 @@
+#include "tractor/can/frame_capture.hpp"
+#include "tractor/comms/capture.hpp"
+#include "tractor/comms/serial.hpp"
+#include <chrono>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace tractor::comms;
+using Clock = std::chrono::steady_clock;
+
+static std::string capture_path(const char *name) {
+    return (std::filesystem::temp_directory_path() / (std::string("tractor-") + name + ".cap")).string();
+}
+
+static std::span<const uint8_t> bytes(const std::string &text) {
+    return std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+}
+
+TEST_CASE("Capture records round trip") {
+    auto path = capture_path("roundtrip");
+    CaptureWriter writer(path, 4096);
+    REQUIRE(writer.open());
+
+    auto start = Clock::now();
+    CHECK(writer.append(CaptureKind::SerialChunk, 1, bytes("$GPGGA"), start + std::chrono::milliseconds(5)));
+    CHECK(writer.append(CaptureKind::SerialChunk, 2, bytes(""), start + std::chrono::milliseconds(7)));
+
+    // Readable while still being written, ending at the last complete record
+    CaptureReader reader;
+    REQUIRE(reader.open(path));
+    CaptureRecord record;
+    size_t records = 0;
+    while (reader.next(record)) {
+        records++;
+    }
+    CHECK(records == 2);
+    reader.close();
+
+    // Fill the rest, the record that does not fit is dropped
+    std::string chunk(1000, 'x');
+    size_t appended = 0;
+    while (writer.append(CaptureKind::SerialChunk, 1, bytes(chunk))) {
+        appended++;
+    }
+    CHECK(appended == 3);
+    CHECK(writer.records_dropped() == 1);
+    writer.close();
+    CHECK(std::filesystem::file_size(path) == 64 + writer.bytes_used());
+
+    REQUIRE(reader.open(path));
+    REQUIRE(reader.next(record));
+    CHECK(record.kind == CaptureKind::SerialChunk);
+    CHECK(record.channel == 1);
+    CHECK(std::string(record.data.begin(), record.data.end()) == "$GPGGA");
+    CHECK(record.timestamp_ns >= 5000000);
+    uint64_t first = record.timestamp_ns;
+    REQUIRE(reader.next(record));
+    CHECK(record.channel == 2);
+    CHECK(record.data.empty());
+    CHECK(record.timestamp_ns - first == 2000000);
+
+    // Channel selection and early stop
+    reader.rewind();
+    ReplayOptions options;
+    options.channel = 1;
+    CHECK(reader.replay(options, [](const CaptureRecord &) { return true; }) == 4);
+    reader.rewind();
+    CHECK(reader.replay(ReplayOptions{}, [](const CaptureRecord &) { return false; }) == 1);
+
+    CaptureReader invalid;
+    CHECK_FALSE(invalid.open(path + ".missing"));
+    CHECK_FALSE(invalid.get_last_error().empty());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Serial replays a capture through its framing") {
+    auto path = capture_path("serial");
+    auto writer = std::make_shared<CaptureWriter>(path, 4096);
+    REQUIRE(writer->open());
+    auto start = Clock::now();
+    const std::vector<std::string> chunks = {"$GPGGA,1*00\r\n$GPR", "MC,2*00\r\n", "$PHTG,3", "*00\r\n$PART"};
+    for (size_t i = 0; i < chunks.size(); i++) {
+        writer->append(CaptureKind::SerialChunk, 0, bytes(chunks[i]), start + std::chrono::milliseconds(20 * i));
+    }
+    writer->append(CaptureKind::SerialChunk, 1, bytes("$OTHER*00\r\n"), start);
+    writer->close();
+
+    SUBCASE("As fast as possible") {
+        SerialOptions serial_options;
+        serial_options.port = "/dev/null";
+        Serial serial(serial_options);
+        std::vector<std::string> lines;
+        serial.on_line([&](const std::string &line) { lines.push_back(line); });
+
+        CaptureReader reader;
+        REQUIRE(reader.open(path));
+        ReplayOptions options;
+        options.channel = 0;
+        CHECK(serial.replay(reader, options) == 4);
+        REQUIRE(lines.size() == 3);
+        CHECK(lines[0] == "$GPGGA,1*00");
+        CHECK(lines[1] == "$GPRMC,2*00");
+        CHECK(lines[2] == "$PHTG,3*00");
+        CHECK(serial.get_statistics().lines_received == 3);
+
+        // The unfinished line of a replay does not leak into the next one
+        reader.rewind();
+        lines.clear();
+        CHECK(serial.replay(reader) == 5);
+        CHECK(lines.size() == 4);
+        CHECK(lines[0] == "$GPGGA,1*00");
+    }
+
+    SUBCASE("Realtime through the dispatcher") {
+        SerialOptions serial_options;
+        serial_options.port = "/dev/null";
+        serial_options.dispatch = DispatchMode::Queued;
+        Serial serial(serial_options);
+        std::vector<std::string> lines;
+        serial.on_line([&](const std::string &line) { lines.push_back(line); });
+
+        CaptureReader reader;
+        REQUIRE(reader.open(path));
+        ReplayOptions options;
+        options.realtime = true;
+        options.speed = 2.0;
+        options.channel = 0;
+        auto replay_start = Clock::now();
+        CHECK(serial.replay(reader, options) == 4);
+        CHECK(Clock::now() - replay_start >= std::chrono::milliseconds(30));
+        CHECK(lines.size() == 3);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("CAN frames round trip through a capture") {
+    auto path = capture_path("can");
+    CaptureWriter writer(path, 4096);
+    REQUIRE(writer.open());
+
+    isobus::CANMessageFrame frame;
+    frame.identifier = 0x09F80180;
+    frame.isExtendedFrame = true;
+    frame.channel = 1;
+    frame.dataLength = 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        frame.data[i] = i;
+    }
+    CHECK(tractor::can::capture_frame(writer, frame));
+    frame.identifier = 0x123;
+    frame.isExtendedFrame = false;
+    frame.channel = 0;
+    frame.dataLength = 2;
+    CHECK(tractor::can::capture_frame(writer, frame));
+    writer.append(CaptureKind::SerialChunk, 1, bytes("$GPGGA\n"));
+    writer.close();
+
+    CaptureReader reader;
+    REQUIRE(reader.open(path));
+    std::vector<isobus::CANMessageFrame> frames;
+    CHECK(tractor::can::replay_frames(reader, [&](const isobus::CANMessageFrame &f) { frames.push_back(f); }) == 2);
+    REQUIRE(frames.size() == 2);
+    CHECK(frames[0].identifier == 0x09F80180);
+    CHECK(frames[0].isExtendedFrame);
+    CHECK(frames[0].channel == 1);
+    CHECK(frames[0].dataLength == 8);
+    CHECK(frames[0].data[7] == 7);
+    CHECK(frames[1].identifier == 0x123);
+    CHECK_FALSE(frames[1].isExtendedFrame);
+    CHECK(frames[1].dataLength == 2);
+    std::filesystem::remove(path);
+}
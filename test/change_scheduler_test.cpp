@@ -0,0 +1,183 @@
+#include "tractor/tc/change_scheduler.hpp"
+#include <atomic>
+#include <doctest/doctest.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "pty_helpers.hpp"
+
+using namespace tractor::tc;
+using namespace std::chrono_literals;
+
+TEST_CASE("ChangeScheduler coalesces changes inside the window") {
+    ProcessDataStore store;
+    auto auth = store.add(0, 65432);
+    store.add(1, 141);
+    ChangeScheduler scheduler(store);
+    std::vector<std::pair<uint16_t, uint16_t>> sent;
+    scheduler.set_notify([&](uint16_t element, uint16_t ddi) {
+        sent.emplace_back(element, ddi);
+        return true;
+    });
+    TriggerSettings settings;
+    settings.min_interval_ms = 100;
+    REQUIRE(scheduler.watch(0, 65432, settings));
+    CHECK_FALSE(scheduler.watch(2, 141));
+
+    auto t0 = std::chrono::steady_clock::now();
+    CHECK(scheduler.poll(t0) == 0);
+
+    // First change after a quiet period goes out right away
+    store.set(auth, 1);
+    CHECK(scheduler.poll(t0 + 5ms) == 1);
+    REQUIRE(sent.size() == 1);
+    CHECK(sent[0] == std::make_pair<uint16_t, uint16_t>(0, 65432));
+
+    // Further changes wait for the end of the window and are merged
+    store.set(auth, 2);
+    CHECK(scheduler.poll(t0 + 20ms) == 0);
+    store.set(auth, 3);
+    CHECK(scheduler.poll(t0 + 40ms) == 0);
+    CHECK(scheduler.poll(t0 + 90ms) == 0);
+    CHECK(scheduler.poll(t0 + 110ms) == 1);
+    CHECK(sent.size() == 2);
+
+    // A value that flaps back before the window ends is not sent
+    store.set(auth, 4);
+    CHECK(scheduler.poll(t0 + 120ms) == 0);
+    store.set(auth, 3);
+    CHECK(scheduler.poll(t0 + 130ms) == 0);
+    CHECK(scheduler.poll(t0 + 300ms) == 0);
+    CHECK(sent.size() == 2);
+
+    // Writing the same value is not a change
+    store.set(auth, 3);
+    CHECK(scheduler.poll(t0 + 400ms) == 0);
+
+    auto stats = scheduler.get_statistics();
+    CHECK(stats.changes_seen == 5);
+    CHECK(stats.notifications_sent == 2);
+    CHECK(stats.coalesced == 2);
+    CHECK(stats.suppressed == 1);
+}
+
+TEST_CASE("ChangeScheduler threshold, time and distance triggers") {
+    ProcessDataStore store;
+    auto rate = store.add(2, 2);
+    auto area = store.add(2, 116);
+    ChangeScheduler scheduler(store);
+    std::vector<uint16_t> sent;
+    scheduler.set_notify([&](uint16_t, uint16_t ddi) {
+        sent.push_back(ddi);
+        return true;
+    });
+
+    TriggerSettings threshold;
+    threshold.min_interval_ms = 0;
+    threshold.change_threshold = 10;
+    threshold.max_interval_ms = 1000;
+    REQUIRE(scheduler.watch(2, 2, threshold));
+
+    TriggerSettings distance;
+    distance.on_change = false;
+    distance.distance_interval_mm = 5000;
+    REQUIRE(scheduler.watch(2, 116, distance));
+
+    auto t0 = std::chrono::steady_clock::now();
+    store.set(rate, 100);
+    CHECK(scheduler.poll(t0) == 1);
+    store.set(rate, 105);
+    CHECK(scheduler.poll(t0 + 10ms) == 0);
+    store.set(rate, 111);
+    CHECK(scheduler.poll(t0 + 20ms) == 1);
+
+    // Time trigger repeats the value even without a change
+    CHECK(scheduler.poll(t0 + 500ms) == 0);
+    CHECK(scheduler.poll(t0 + 1020ms) == 1);
+    CHECK(scheduler.poll(t0 + 1500ms) == 0);
+    CHECK(scheduler.poll(t0 + 5000ms) == 1);
+
+    // Distance trigger ignores value changes
+    store.set(area, 7);
+    scheduler.set_distance(3000);
+    CHECK(scheduler.poll(t0 + 5010ms) == 0);
+    scheduler.set_distance(6000);
+    CHECK(scheduler.poll(t0 + 5020ms) == 1);
+    scheduler.set_distance(9000);
+    CHECK(scheduler.poll(t0 + 5030ms) == 0);
+
+    CHECK(sent == std::vector<uint16_t>{2, 2, 2, 2, 116});
+}
+
+TEST_CASE("ChangeScheduler sends to the client of each value") {
+    const ClientId sprayer = static_cast<ClientId>(1);
+    ProcessDataStore store;
+    auto legacy = store.add(1, 141);
+    auto hosted = store.add(sprayer, 1, 141);
+    ChangeScheduler scheduler(store);
+    std::vector<std::pair<uint16_t, uint16_t>> legacy_sent;
+    std::vector<std::pair<uint16_t, uint16_t>> hosted_sent;
+    scheduler.set_notify([&](uint16_t element, uint16_t ddi) {
+        legacy_sent.emplace_back(element, ddi);
+        return true;
+    });
+    scheduler.set_notify(sprayer, [&](uint16_t element, uint16_t ddi) {
+        hosted_sent.emplace_back(element, ddi);
+        return true;
+    });
+    REQUIRE(scheduler.watch(1, 141));
+    REQUIRE(scheduler.watch(sprayer, 1, 141));
+    CHECK_FALSE(scheduler.watch(static_cast<ClientId>(2), 1, 141));
+    CHECK_FALSE(scheduler.watch(static_cast<ClientId>(MAX_CLIENTS), 1, 141));
+
+    auto t0 = std::chrono::steady_clock::now();
+    store.set(hosted, 1);
+    CHECK(scheduler.poll(t0) == 1);
+    CHECK(legacy_sent.empty());
+    REQUIRE(hosted_sent.size() == 1);
+    CHECK(hosted_sent[0] == std::make_pair<uint16_t, uint16_t>(1, 141));
+
+    store.set(legacy, 1);
+    CHECK(scheduler.poll(t0 + 1s) == 1);
+    CHECK(legacy_sent.size() == 1);
+    CHECK(hosted_sent.size() == 1);
+}
+
+TEST_CASE("ChangeScheduler thread reacts to changes") {
+    ProcessDataStore store;
+    auto auth = store.add(0, 65432);
+    ChangeScheduler scheduler(store);
+    std::atomic<int> calls{0};
+    std::atomic<bool> accept{false};
+    scheduler.set_notify([&](uint16_t, uint16_t) {
+        calls++;
+        return accept.load();
+    });
+    TriggerSettings settings;
+    settings.min_interval_ms = 50;
+    REQUIRE(scheduler.watch(0, 65432, settings));
+
+    REQUIRE(scheduler.start());
+    CHECK_FALSE(scheduler.start());
+    CHECK(scheduler.is_running());
+
+    store.set(auth, 1);
+    CHECK(wait_for([&] { return calls.load() == 1; }));
+
+    // A rejected notification is retried after the window
+    accept = true;
+    CHECK(wait_for([&] { return scheduler.get_statistics().notifications_sent == 1; }));
+    CHECK(calls.load() == 2);
+    CHECK(scheduler.get_statistics().send_failures == 1);
+
+    for (int32_t value = 2; value < 100; value++) {
+        store.set(auth, value);
+    }
+    CHECK(wait_for([&] { return scheduler.get_statistics().notifications_sent >= 2; }));
+    std::this_thread::sleep_for(200ms);
+    CHECK(scheduler.get_statistics().notifications_sent <= 3);
+
+    scheduler.stop();
+    CHECK_FALSE(scheduler.is_running());
+}
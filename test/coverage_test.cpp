@@ -0,0 +1,142 @@
+#include "tractor/tc/coverage.hpp"
+#include <array>
+#include <cstdlib>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <memory>
+
+using namespace tractor::tc;
+
+// Two 1 m sections side by side, centered on the antenna
+static std::unique_ptr<CoverageMap> make_map(const CoverageOptions &options = CoverageOptions{}) {
+    auto map = std::make_unique<CoverageMap>(options);
+    map->set_sections({{0.0, -0.5, 1.0}, {0.0, 0.5, 1.0}});
+    return map;
+}
+
+static Pose pose(double east, double north, double heading_deg = 0.0) { return {{east, north}, heading_deg}; }
+
+static SectionBoom::SectionMask all_on() {
+    SectionBoom::SectionMask mask{};
+    mask.fill(~uint64_t{0});
+    return mask;
+}
+
+TEST_CASE("LocalFrame") {
+    LocalFrame frame(52.0, 5.0);
+    EnuPoint origin = frame.to_enu(52.0, 5.0);
+    CHECK(origin.east == doctest::Approx(0.0));
+    CHECK(origin.north == doctest::Approx(0.0));
+
+    EnuPoint point = frame.to_enu(52.001, 5.001);
+    CHECK(point.north == doctest::Approx(111.26).epsilon(1e-3));
+    CHECK(point.east == doctest::Approx(68.68).epsilon(1e-3));
+
+    double latitude = 0.0;
+    double longitude = 0.0;
+    frame.to_geodetic(point, latitude, longitude);
+    CHECK(latitude == doctest::Approx(52.001));
+    CHECK(longitude == doctest::Approx(5.001));
+
+    LocalFrame antimeridian(-40.0, 179.9999);
+    CHECK(antimeridian.to_enu(-40.0, -179.9999).east == doctest::Approx(17.06).epsilon(1e-2));
+}
+
+TEST_CASE("CoverageMap painting and overlap") {
+    auto map = make_map();
+    CHECK(map->size() == 2);
+    CHECK_FALSE(map->covered({0.0, 5.0}));
+
+    // 10 m north with both sections on: 2 x 10 x 100 cells of 10 cm
+    CHECK(map->paint(pose(0.0, 0.0), pose(0.0, 10.0), all_on()) == 2000);
+    CHECK(map->covered_area() == doctest::Approx(20.0));
+    CHECK(map->covered({-0.95, 5.0}));
+    CHECK(map->covered({0.95, 9.9}));
+    CHECK_FALSE(map->covered({1.05, 5.0}));
+    CHECK_FALSE(map->covered({0.0, 10.05}));
+    CHECK(map->paint(pose(0.0, 0.0), pose(0.0, 10.0), all_on()) == 0);
+
+    std::array<double, 2> fractions{};
+    SUBCASE("Overlap with a pass half a section to the right") {
+        REQUIRE(map->overlap(pose(0.5, 2.0), pose(0.5, 8.0), fractions) == 2);
+        CHECK(fractions[0] == doctest::Approx(1.0));
+        CHECK(fractions[1] == doctest::Approx(0.5));
+    }
+
+    SUBCASE("Driving back south over the same ground") {
+        REQUIRE(map->overlap(pose(0.0, 10.0, 180.0), pose(0.0, 0.0, 180.0), fractions) == 2);
+        CHECK(fractions[0] == doctest::Approx(1.0));
+        CHECK(fractions[1] == doctest::Approx(1.0));
+    }
+
+    SUBCASE("Only sections that are on paint") {
+        SectionBoom::SectionMask left{};
+        left[0] = 1;
+        CHECK(map->paint(pose(5.0, 0.0), pose(5.0, 10.0), left) == 1000);
+        CHECK(map->covered({4.5, 5.0}));
+        CHECK_FALSE(map->covered({5.5, 5.0}));
+    }
+
+    SUBCASE("Position jumps paint nothing") { CHECK(map->paint(pose(0.0, 0.0), pose(5000.0, 0.0), all_on()) == 0); }
+
+    SUBCASE("Section setpoints for a SectionBoom") {
+        SectionBoom boom(2);
+        boom.set_setpoint_mask(map->plan(pose(0.5, 2.0), 5.0));
+        CHECK(boom.setpoint(0) == SectionBoom::State::Off);
+        CHECK(boom.setpoint(1) == SectionBoom::State::On);
+
+        boom.set_setpoint_mask(map->plan(pose(0.5, 2.0), 5.0, 0.25));
+        CHECK(boom.count_on() == 0);
+
+        boom.set_setpoint_mask(map->plan(pose(10.0, 2.0), 5.0));
+        CHECK(boom.count_on() == 2);
+    }
+
+    map->clear();
+    CHECK(map->covered_area() == 0.0);
+    CHECK(map->tile_count() == 0);
+}
+
+TEST_CASE("CoverageMap across tiles and quadrants") {
+    auto map = std::make_unique<CoverageMap>();
+    map->set_sections({{0.0, 0.0, 3.0}});
+
+    // Diagonal pass through the origin, crossing tile edges at negative coordinates
+    CHECK(map->paint(pose(-30.0, -30.0, 45.0), pose(30.0, 30.0, 45.0), all_on()) > 0);
+    CHECK(map->covered_area() == doctest::Approx(3.0 * 84.853).epsilon(0.02));
+    CHECK(map->covered({0.0, 0.0}));
+    CHECK(map->covered({-20.0, -20.0}));
+    CHECK_FALSE(map->covered({5.0, -5.0}));
+    CHECK(map->tile_count() >= 5);
+}
+
+TEST_CASE("CoverageMap paging") {
+    char name[] = "/tmp/tractor_coverage_XXXXXX";
+    REQUIRE(mkdtemp(name) != nullptr);
+    std::filesystem::path directory = name;
+
+    CoverageOptions options;
+    options.page_directory = directory.string();
+    options.max_resident_tiles = 2;
+
+    double area = 0.0;
+    {
+        auto map = make_map(options);
+        CHECK(map->paint(pose(0.0, 0.0), pose(0.0, 120.0), all_on()) == 24000);
+        CHECK(map->resident_tiles() <= 2);
+        CHECK(map->tile_count() >= 5);
+        CHECK(map->covered({0.5, 1.0})); // Pages the first tile back in
+        CHECK(map->get_last_error().empty());
+        area = map->covered_area();
+    }
+
+    // Coverage of an earlier run on the same field is picked up from the directory
+    auto map = make_map(options);
+    CHECK(map->covered_area() == doctest::Approx(area));
+    CHECK(map->covered({-0.5, 60.0}));
+    CHECK_FALSE(map->covered({-1.5, 60.0}));
+
+    map->clear();
+    CHECK(std::filesystem::is_empty(directory));
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,82 @@
+#include "tractor/tc/ddop_cache.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace tractor::tc;
+
+static_assert(StructureHash().add("ab").add("c").value() != StructureHash().add("a").add("bc").value());
+static_assert(StructureHash().add(uint64_t{6}).value() != StructureHash().add(uint64_t{8}).value());
+
+static std::string make_temp_dir() {
+    char dir[] = "/tmp/ddop_cache_testXXXXXX";
+    REQUIRE(mkdtemp(dir) != nullptr);
+    return dir;
+}
+
+TEST_CASE("DdopCache stores and maps a pool") {
+    std::string dir = make_temp_dir();
+    const uint64_t hash = StructureHash().add("Sprayer").add(uint64_t{6}).value();
+    const uint64_t name = 0xA00086000C7E0042ull;
+    const std::vector<uint8_t> pool = {'D', 'V', 'C', 0x00, 0x00, 0x07, 'S', 'p', 'r', 'a', 'y', 'e', 'r'};
+
+    DdopCache cache(dir);
+    CHECK_FALSE(cache.load(hash, name));
+    CHECK(cache.get_last_error().empty());
+    CHECK_FALSE(cache.is_loaded());
+    CHECK(cache.data() == nullptr);
+
+    REQUIRE(cache.store(hash, name, pool));
+    REQUIRE(cache.is_loaded());
+    CHECK(std::vector<uint8_t>(cache.data(), cache.data() + cache.size()) == pool);
+
+    // A fresh start maps the same bytes, a different NAME or structure misses
+    DdopCache restart(dir);
+    REQUIRE(restart.load(hash, name));
+    CHECK(std::vector<uint8_t>(restart.data(), restart.data() + restart.size()) == pool);
+    CHECK_FALSE(restart.load(hash, name + 1));
+    CHECK_FALSE(restart.load(hash + 1, name));
+    CHECK_FALSE(restart.is_loaded());
+
+    CHECK_FALSE(cache.store(hash, name, std::vector<uint8_t>{1, 2, 3}));
+    CHECK_FALSE(cache.store(hash, name, std::vector<uint8_t>{}));
+
+    std::remove(cache.path(hash, name).c_str());
+    rmdir(dir.c_str());
+}
+
+TEST_CASE("DdopCache rejects damaged files") {
+    std::string dir = make_temp_dir();
+    const std::vector<uint8_t> pool = {'D', 'V', 'C', 0x00, 0x00, 0x03, 'T', 'a', 'g'};
+    DdopCache cache(dir);
+    REQUIRE(cache.store(1, 2, pool));
+    cache.unload();
+    CHECK_FALSE(cache.is_loaded());
+
+    std::string file = cache.path(1, 2);
+    {
+        std::fstream stream(file, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekp(-1, std::ios::end);
+        stream.put('x');
+    }
+    CHECK_FALSE(cache.load(1, 2));
+    CHECK_FALSE(cache.get_last_error().empty());
+
+    REQUIRE(truncate(file.c_str(), 10) == 0);
+    CHECK_FALSE(cache.load(1, 2));
+
+    std::remove(file.c_str());
+    rmdir(dir.c_str());
+}
+
+TEST_CASE("Structure labels follow the structure hash") {
+    std::string label = structure_label(StructureHash().add("Tag").value());
+    CHECK(label.size() == 7);
+    CHECK(label == structure_label(StructureHash().add("Tag").value()));
+    CHECK(label != structure_label(StructureHash().add("Tag").add(uint64_t{2}).value()));
+    CHECK(structure_label(0) == "0000000");
+    CHECK(structure_label(~uint64_t{0}) == "VVVVVVV");
+}
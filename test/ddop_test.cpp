@@ -0,0 +1,162 @@
+#include "tractor/tc/ddop.hpp"
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+using namespace tractor::tc;
+
+constexpr DdopDescription<2, 3, 1, 2> SPRAYER{
+    .device = {"Sprayer", "1.0.0", "SP1"},
+    .elements = {{
+        {"Sprayer", ElementType::Device, 0},
+        {"Boom", ElementType::Function, 1, 0},
+    }},
+    .process_data = {{
+        {0, "Actual Work State", 141, PD_MEMBER_OF_DEFAULT_SET, TRIGGER_ON_CHANGE},
+        {1, "Setpoint Work State", 289, PD_SETTABLE, TRIGGER_ON_CHANGE},
+        {1, "Total Area", 116, PD_MEMBER_OF_DEFAULT_SET, TRIGGER_TOTAL, 0},
+    }},
+    .properties = {{
+        {1, "Working Width", 67, 9144, 1},
+    }},
+    .presentations = {{
+        {"m2", 0, 1.0f, 0},
+        {"mm", 0, 1.0f, 0},
+    }},
+};
+static_assert(SPRAYER.valid());
+static_assert(SPRAYER.element_id(1) == 2);
+static_assert(SPRAYER.process_data_id(0) == 3);
+static_assert(SPRAYER.property_id(0) == 6);
+static_assert(SPRAYER.presentation_id(1) == 8);
+static_assert(SPRAYER.presentation_id(NO_INDEX) == NULL_OBJECT_ID);
+
+constexpr DdopDescription<2, 0, 0, 0> DUPLICATE_ELEMENT_NUMBER{
+    .device = {"Bad", "1", "1"},
+    .elements = {{{"Device", ElementType::Device, 0}, {"Boom", ElementType::Function, 0, 0}}},
+};
+static_assert(!DUPLICATE_ELEMENT_NUMBER.valid());
+
+constexpr DdopDescription<2, 0, 0, 0> FORWARD_PARENT{
+    .device = {"Bad", "1", "1"},
+    .elements = {{{"Boom", ElementType::Function, 1, 1}, {"Device", ElementType::Device, 0}}},
+};
+static_assert(!FORWARD_PARENT.valid());
+
+constexpr DdopDescription<2, 0, 0, 0> DEVICE_ELEMENT_NUMBER{
+    .device = {"Bad", "1", "1"},
+    .elements = {{{"Device", ElementType::Device, 1}, {"Boom", ElementType::Function, 0, 0}}},
+};
+static_assert(!DEVICE_ELEMENT_NUMBER.valid());
+
+constexpr DdopDescription<2, 0, 0, 0> TWO_DEVICE_ELEMENTS{
+    .device = {"Bad", "1", "1"},
+    .elements = {{{"Device", ElementType::Device, 0}, {"Other", ElementType::Device, 1}}},
+};
+static_assert(!TWO_DEVICE_ELEMENTS.valid());
+
+constexpr DdopDescription<1, 2, 0, 0> DUPLICATE_DDI{
+    .device = {"Bad", "1", "1"},
+    .elements = {{{"Device", ElementType::Device, 0}}},
+    .process_data = {{{0, "A", 141}, {0, "B", 141}}},
+};
+static_assert(!DUPLICATE_DDI.valid());
+
+constexpr DdopDescription<1, 1, 0, 0> MISSING_PRESENTATION{
+    .device = {"Bad", "1", "1"},
+    .elements = {{{"Device", ElementType::Device, 0}}},
+    .process_data = {{{0, "A", 141, 0, 0, 0}}},
+};
+static_assert(!MISSING_PRESENTATION.valid());
+
+static size_t find(const std::vector<uint8_t> &pool, const char *tag, size_t from = 0) {
+    for (size_t i = from; i + 3 <= pool.size(); i++) {
+        if (pool[i] == tag[0] && pool[i + 1] == tag[1] && pool[i + 2] == tag[2]) {
+            return i;
+        }
+    }
+    return pool.size();
+}
+
+static uint16_t u16_at(const std::vector<uint8_t> &pool, size_t offset) {
+    return static_cast<uint16_t>(pool[offset] | (pool[offset + 1] << 8));
+}
+
+TEST_CASE("DdopDescription serializes a binary pool") {
+    std::vector<uint8_t> pool;
+    SPRAYER.serialize(0x0102030405060708ull, pool);
+    REQUIRE(pool.size() == SPRAYER.binary_size());
+
+    // Device object with NAME and the structure label derived from the hash
+    REQUIRE(find(pool, "DVC") == 0);
+    CHECK(u16_at(pool, 3) == 0);
+    CHECK(pool[5] == 7);
+    CHECK(std::string(pool.begin() + 6, pool.begin() + 13) == "Sprayer");
+    size_t name_offset = 13 + 1 + 5;
+    CHECK(pool[name_offset] == 0x08);
+    CHECK(pool[name_offset + 7] == 0x01);
+    size_t label_offset = name_offset + 8 + 1 + 3;
+    CHECK(std::string(pool.begin() + label_offset, pool.begin() + label_offset + 7) ==
+          structure_label(SPRAYER.structure_hash()));
+
+    // Boom lists its process data and property as children
+    size_t device_element = find(pool, "DET");
+    size_t boom = find(pool, "DET", device_element + 1);
+    REQUIRE(boom < pool.size());
+    CHECK(u16_at(pool, boom + 3) == 2);
+    CHECK(pool[boom + 5] == static_cast<uint8_t>(ElementType::Function));
+    size_t after_designator = boom + 7 + 4;
+    CHECK(u16_at(pool, after_designator) == 1);     // Element number
+    CHECK(u16_at(pool, after_designator + 2) == 1); // Parent object ID
+    REQUIRE(u16_at(pool, after_designator + 4) == 3);
+    CHECK(u16_at(pool, after_designator + 6) == SPRAYER.process_data_id(1));
+    CHECK(u16_at(pool, after_designator + 8) == SPRAYER.process_data_id(2));
+    CHECK(u16_at(pool, after_designator + 10) == SPRAYER.property_id(0));
+
+    size_t total_area = find(pool, "DPD", find(pool, "DPD", find(pool, "DPD") + 1) + 1);
+    REQUIRE(total_area < pool.size());
+    CHECK(u16_at(pool, total_area + 5) == 116);
+    size_t presentation = total_area + 7 + 2 + 1 + std::string("Total Area").size();
+    CHECK(u16_at(pool, presentation) == SPRAYER.presentation_id(0));
+
+    // Same structure, same label, a different NAME only changes the NAME field
+    std::vector<uint8_t> other;
+    SPRAYER.serialize(0x1112131415161718ull, other);
+    CHECK(other.size() == pool.size());
+    CHECK(std::equal(other.begin() + label_offset, other.end(), pool.begin() + label_offset));
+
+    // A layout built at compile time gives the same bytes
+    static constexpr auto LAYOUT = SPRAYER.layout();
+    static_assert(LAYOUT.structure_hash == SPRAYER.structure_hash());
+    static_assert(LAYOUT.binary_size == SPRAYER.binary_size());
+    static_assert(LAYOUT.first_child[1] - LAYOUT.first_child[0] == 1);
+    static_assert(LAYOUT.children[LAYOUT.first_child[1]] == SPRAYER.process_data_id(1));
+    SPRAYER.serialize(0x0102030405060708ull, other, LAYOUT);
+    CHECK(other == pool);
+}
+
+TEST_CASE("DdopDescription hash and process data registration") {
+    constexpr auto base = SPRAYER.structure_hash();
+    auto changed = SPRAYER;
+    changed.process_data[2].triggers |= TRIGGER_TIME_INTERVAL;
+    CHECK(changed.structure_hash() != base);
+    changed = SPRAYER;
+    changed.properties[0].value = 12000;
+    CHECK(changed.structure_hash() != base);
+
+    ProcessDataStore store;
+    REQUIRE(SPRAYER.register_process_data(store));
+    CHECK(store.size() == 3);
+    CHECK(store.contains(1, 289));
+    CHECK(ProcessDataStore::value_command_callback(1, 289, 1, &store));
+    CHECK_FALSE(ProcessDataStore::value_command_callback(0, 141, 1, &store));
+
+    // A second implement with the same DDOP keeps its own values in the store
+    const ClientId second = static_cast<ClientId>(1);
+    REQUIRE(SPRAYER.register_process_data(store, second));
+    CHECK(store.size() == 6);
+    CHECK(ProcessDataStore::client_value_command_callback(1, 289, 2, store.client(second)));
+    int32_t value = 0;
+    CHECK(store.get(1, 289, value));
+    CHECK(value == 1);
+}
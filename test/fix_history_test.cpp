@@ -0,0 +1,155 @@
+#include "tractor/nmea/fix_history.hpp"
+#include <atomic>
+#include <chrono>
+#include <doctest/doctest.h>
+#include <thread>
+
+using namespace tractor::nmea;
+using namespace std::chrono_literals;
+
+static Fix make_fix(std::chrono::steady_clock::time_point time, double latitude, double longitude) {
+    Fix fix;
+    fix.time = time;
+    fix.latitude = latitude;
+    fix.longitude = longitude;
+    fix.fix_quality = 4;
+    fix.hdop = 0.8;
+    return fix;
+}
+
+TEST_CASE("FixHistory latest fix") {
+    FixHistory history(5);
+    CHECK(history.capacity() == 8);
+
+    Fix fix;
+    CHECK_FALSE(history.latest(fix));
+    CHECK_FALSE(history.at(std::chrono::steady_clock::now(), fix));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; i++) {
+        history.push(make_fix(start + i * 100ms, 52.0 + i * 1e-5, 5.0));
+    }
+    CHECK(history.count() == 20);
+    REQUIRE(history.latest(fix));
+    CHECK(fix.latitude == doctest::Approx(52.0 + 19 * 1e-5));
+    CHECK(fix.time == start + 1900ms);
+
+    SUBCASE("Fixes that fell out of the ring") { CHECK_FALSE(history.at(start + 500ms, fix)); }
+
+    SUBCASE("Clear") {
+        history.clear();
+        CHECK(history.count() == 0);
+        CHECK_FALSE(history.latest(fix));
+    }
+}
+
+TEST_CASE("FixHistory from NMEA sentences") {
+    FixHistory history;
+    auto now = std::chrono::steady_clock::now();
+
+    GGA gga;
+    gga.latitude = 48.1;
+    gga.longitude = 11.5;
+    gga.has_position = true;
+    gga.fix_quality = 0;
+    CHECK_FALSE(history.update(gga, now));
+
+    VTG vtg;
+    vtg.course_true_deg = 90.0;
+    vtg.speed_kmh = 36.0;
+    vtg.has_course = true;
+    history.update(vtg);
+
+    gga.fix_quality = 4;
+    gga.satellites = 14;
+    gga.hdop = 0.7;
+    REQUIRE(history.update(gga, now));
+
+    Fix fix;
+    REQUIRE(history.latest(fix));
+    CHECK(fix.latitude == doctest::Approx(48.1));
+    CHECK(fix.fix_quality == 4);
+    CHECK(fix.satellites == 14);
+    CHECK(fix.has_course);
+    CHECK(fix.speed_mps == doctest::Approx(10.0));
+    CHECK(fix.course_deg == doctest::Approx(90.0));
+}
+
+TEST_CASE("FixHistory interpolation and extrapolation") {
+    FixHistory history;
+    auto start = std::chrono::steady_clock::now();
+
+    Fix a = make_fix(start, 52.0, 179.9999);
+    a.course_deg = 350.0;
+    a.speed_mps = 6.0;
+    Fix b = make_fix(start + 100ms, 52.0001, -179.9999);
+    b.course_deg = 10.0;
+    b.speed_mps = 8.0;
+    b.hdop = 1.2;
+    b.fix_quality = 5;
+    history.push(a);
+    history.push(b);
+
+    Fix fix;
+    SUBCASE("Between two fixes") {
+        REQUIRE(history.at(start + 25ms, fix));
+        CHECK(fix.interpolated);
+        CHECK(fix.latitude == doctest::Approx(52.000025));
+        CHECK(fix.longitude == doctest::Approx(179.99995)); // Across the antimeridian, not via 0
+        CHECK(fix.course_deg == doctest::Approx(355.0));
+        CHECK(fix.speed_mps == doctest::Approx(6.5));
+        CHECK(fix.hdop == doctest::Approx(1.2));
+        CHECK(fix.fix_quality == 4);
+
+        REQUIRE(history.at(start, fix));
+        CHECK(fix.latitude == doctest::Approx(52.0));
+        CHECK_FALSE(fix.interpolated);
+        CHECK_FALSE(history.at(start - 1ms, fix));
+    }
+
+    SUBCASE("Along the line through the two newest fixes") {
+        REQUIRE(history.at(start + 200ms, fix));
+        CHECK(fix.extrapolated);
+        CHECK(fix.latitude == doctest::Approx(52.0002));
+        CHECK(fix.longitude == doctest::Approx(-179.9997));
+        CHECK_FALSE(history.at(start + 700ms, fix));
+        CHECK(history.at(start + 700ms, fix, 1s));
+    }
+
+    SUBCASE("Along course and speed") {
+        Fix c = make_fix(start + 200ms, 0.0, 10.0);
+        c.course_deg = 0.0;
+        c.speed_mps = 10.0;
+        c.has_course = true;
+        history.push(c);
+
+        // 10 m north in one second is about 9e-5 degrees of latitude
+        REQUIRE(history.at(start + 1200ms, fix, 2s));
+        CHECK(fix.latitude == doctest::Approx(8.9932e-5).epsilon(1e-3));
+        CHECK(fix.longitude == doctest::Approx(10.0));
+    }
+}
+
+TEST_CASE("FixHistory readers never see a torn fix") {
+    FixHistory history(4);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> torn{0};
+
+    // Every fix has latitude == longitude, a reader mixing two fixes sees them differ
+    std::thread reader([&] {
+        Fix fix;
+        while (!done) {
+            if (history.latest(fix) && fix.latitude != fix.longitude) {
+                torn++;
+            }
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 200000; i++) {
+        history.push(make_fix(start + i * 1ms, i, i));
+    }
+    done = true;
+    reader.join();
+    CHECK(torn == 0);
+}
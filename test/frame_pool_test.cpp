@@ -0,0 +1,174 @@
+#include "pty_helpers.hpp"
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <doctest/doctest.h>
+#include <memory_resource>
+#include <new>
+#include <thread>
+#include <tractor/comms/frame_pool.hpp>
+#include <tractor/comms/serial.hpp>
+#include <vector>
+
+using namespace tractor::comms;
+
+// Every heap allocation of the test binary, to show the receive path does not allocate once running
+static std::atomic<size_t> allocations{0};
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+static std::span<const uint8_t> bytes(const char *text) {
+    return {reinterpret_cast<const uint8_t *>(text), std::char_traits<char>::length(text)};
+}
+
+TEST_CASE("FramePool handles") {
+    auto pool = std::make_unique<FramePool>(16, 2);
+    CHECK(pool->frame_size() == 16);
+    CHECK(pool->capacity() == 2);
+    CHECK(pool->available() == 2);
+
+    Frame first = pool->acquire(bytes("$GPGGA"));
+    REQUIRE(first);
+    CHECK(first.view() == "$GPGGA");
+    CHECK(first.capacity() == 16);
+    CHECK(first.use_count() == 1);
+
+    // Copies share the buffer
+    Frame copy = first;
+    CHECK(copy.data() == first.data());
+    CHECK(first.use_count() == 2);
+    CHECK(pool->available() == 1);
+
+    Frame second = pool->acquire();
+    REQUIRE(second);
+    CHECK(second.empty());
+    CHECK_FALSE(second.resize(17));
+    CHECK(second.assign(bytes("0123456789abcdef")));
+    CHECK_FALSE(pool->acquire());
+    CHECK_FALSE(pool->acquire(bytes("this is longer than sixteen bytes")));
+
+    auto stats = pool->get_statistics();
+    CHECK(stats.acquired == 2);
+    CHECK(stats.exhausted == 2);
+    CHECK(stats.in_use == 2);
+    CHECK(stats.high_water_mark == 2);
+
+    // The buffer returns with its last handle
+    first.reset();
+    CHECK(pool->available() == 0);
+    copy = std::move(second);
+    CHECK(pool->available() == 1);
+    CHECK(copy.view() == "0123456789abcdef");
+
+    // A frame outlives its pool
+    Frame kept = pool->acquire(bytes("kept"));
+    pool.reset();
+    CHECK(kept.view() == "kept");
+    CHECK(copy.view() == "0123456789abcdef");
+}
+
+TEST_CASE("FramePool as a memory resource") {
+    FramePool pool(64, 4);
+    {
+        std::pmr::vector<uint32_t> values(&pool);
+        values.reserve(16);
+        for (uint32_t i = 0; i < 16; i++) {
+            values.push_back(i);
+        }
+        CHECK(pool.available() == 3);
+        CHECK_THROWS_AS(values.reserve(17), std::bad_alloc);
+        CHECK(values[15] == 15);
+    }
+    CHECK(pool.available() == 4);
+}
+
+TEST_CASE("FramePool shared between threads") {
+    FramePool pool(8, 8);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> taken{0};
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            std::array<Frame, 3> held;
+            for (int i = 0; i < 20000; i++) {
+                Frame frame = pool.acquire();
+                if (frame) {
+                    frame.data()[0] = static_cast<uint8_t>(i);
+                    held[i % held.size()] = std::move(frame);
+                    taken++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK(pool.available() == 8);
+    auto stats = pool.get_statistics();
+    CHECK(stats.acquired == taken);
+    CHECK(stats.in_use == 0);
+    CHECK(stats.high_water_mark <= 8);
+}
+
+TEST_CASE("Serial receives queued frames without allocating") {
+    PtyPair pty;
+    REQUIRE(pty.master >= 0);
+
+    SerialOptions options;
+    options.port = pty.slave;
+    options.dispatch = DispatchMode::Queued;
+    options.dispatch_queue_depth = 32;
+    options.frame_pool_size = 48;
+    options.hotplug = false;
+    Serial serial(options);
+
+    // The application keeps the newest frames past the callback
+    std::array<Frame, 8> recent;
+    std::atomic<size_t> received{0};
+    serial.on_frame([&](const Frame &frame, const FrameInfo &) {
+        recent[received % recent.size()] = frame;
+        received++;
+    });
+    REQUIRE(serial.start());
+
+    auto send = [&](int from, int to) {
+        char line[64];
+        for (int i = from; i < to; i++) {
+            int length = std::snprintf(line, sizeof(line), "$GPGGA,%06d,5200.000,N,00500.000,E*00\r\n", i);
+            ssize_t written = ::write(pty.master, line, static_cast<size_t>(length));
+            (void)written;
+            if (i % 16 == 15) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    };
+
+    send(0, 64);
+    REQUIRE(wait_for([&] { return received >= 64; }));
+
+    size_t before = allocations.load();
+    send(64, 1064);
+    bool complete = wait_for([&] { return received >= 1064; }, 5000);
+    size_t during = allocations.load() - before;
+
+    REQUIRE(complete);
+    CHECK(during == 0);
+    CHECK(recent[1063 % recent.size()].view() == "$GPGGA,001063,5200.000,N,00500.000,E*00");
+    auto stats = serial.get_statistics();
+    CHECK(stats.frames_dropped == 0);
+    CHECK(stats.pool_high_water_mark >= recent.size());
+    CHECK(stats.pool_high_water_mark <= options.frame_pool_size);
+    serial.stop();
+}
@@ -0,0 +1,175 @@
+#include "tractor/can/gnss_bridge.hpp"
+#include <atomic>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <thread>
+#include <vector>
+
+using namespace tractor;
+using namespace tractor::can;
+
+static int64_t read_le(const uint8_t *data, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    if (size < 8 && (value >> (8 * size - 1)) & 1) {
+        value |= ~uint64_t{0} << (8 * size);
+    }
+    return static_cast<int64_t>(value);
+}
+
+TEST_CASE("NMEA 2000 encoding") {
+    SUBCASE("CAN identifiers") {
+        CHECK(n2k_can_id(PGN_POSITION_RAPID, 0x80, 2) == 0x09F80180);
+        CHECK(n2k_can_id(PGN_GNSS_POSITION, 0x80, 3) == 0x0DF80580);
+        // PDU1 groups carry the destination instead of the group extension
+        CHECK(n2k_can_id(0xEA00, 0x80, 6, 0x26) == 0x18EA2680);
+    }
+
+    SUBCASE("Position and COG/SOG rapid updates") {
+        auto position = encode_position_rapid(48.1173, -11.5166667);
+        CHECK(read_le(position.data(), 4) == 481173000);
+        CHECK(read_le(position.data() + 4, 4) == -115166667);
+
+        auto motion = encode_cog_sog_rapid(7, 90.0, 5.0);
+        CHECK(motion[0] == 7);
+        CHECK(motion[1] == 0xFC);
+        CHECK(read_le(motion.data() + 2, 2) == 15708); // pi/2 in 1e-4 rad
+        CHECK((read_le(motion.data() + 4, 2) & 0xFFFF) == 500);
+        CHECK(motion[6] == 0xFF);
+
+        auto unknown = encode_cog_sog_rapid(0, -1.0, -1.0);
+        CHECK(unknown[2] == 0xFF);
+        CHECK(unknown[4] == 0xFF);
+    }
+
+    SUBCASE("GNSS position data") {
+        GnssPosition position;
+        position.latitude = 48.1173;
+        position.longitude = 11.5;
+        position.altitude = 545.4;
+        position.method = 4;
+        position.satellites = 12;
+        position.hdop = 0.8;
+        uint8_t buffer[GNSS_POSITION_MAX_SIZE];
+        REQUIRE(encode_gnss_position(position, buffer) == 43);
+        CHECK(read_le(buffer + 7, 8) == 481173000000000000);
+        CHECK(read_le(buffer + 23, 8) == 545400000);
+        CHECK(buffer[31] == 0x40);
+        CHECK(buffer[33] == 12);
+        CHECK(read_le(buffer + 34, 2) == 80);
+        CHECK(read_le(buffer + 36, 2) == 0x7FFF); // PDOP unavailable
+        CHECK(buffer[42] == 0);
+
+        position.has_reference_station = true;
+        position.reference_station_id = 31;
+        position.reference_station_age = 1.2;
+        REQUIRE(encode_gnss_position(position, buffer) == GNSS_POSITION_MAX_SIZE);
+        CHECK(buffer[42] == 1);
+        CHECK(read_le(buffer + 45, 2) == 120);
+    }
+
+    SUBCASE("Fast packet framing") {
+        uint8_t payload[43];
+        for (size_t i = 0; i < sizeof(payload); i++) {
+            payload[i] = static_cast<uint8_t>(i);
+        }
+        std::array<FramePayload, FAST_PACKET_MAX_FRAMES> frames;
+        REQUIRE(fast_packet_frames(payload, sizeof(payload), 5, frames) == 7);
+        CHECK(frames[0][0] == 0xA0);
+        CHECK(frames[0][1] == 43);
+        CHECK(frames[0][2] == 0);
+        CHECK(frames[0][7] == 5);
+        CHECK(frames[1][0] == 0xA1);
+        CHECK(frames[1][1] == 6);
+        CHECK(frames[6][0] == 0xA6);
+        CHECK(frames[6][1] == 41);
+        CHECK(frames[6][2] == 42);
+        CHECK(frames[6][3] == 0xFF);
+
+        std::vector<uint8_t> too_large(224);
+        CHECK(fast_packet_frames(too_large.data(), too_large.size(), 0, frames) == 0);
+    }
+}
+
+TEST_CASE("GNSS bridge sends at fixed rates") {
+    GnssBridgeConfig config;
+    config.rapid_interval_ms = 100;
+    config.position_interval_ms = 1000;
+    GnssBridge bridge(config);
+
+    std::vector<isobus::CANMessageFrame> sent;
+    bridge.set_sink([&](const isobus::CANMessageFrame &frame) {
+        sent.push_back(frame);
+        return true;
+    });
+
+    auto now = std::chrono::steady_clock::now();
+    CHECK(bridge.poll(now) == 0); // nothing to send without a fix
+    CHECK_FALSE(bridge.has_fix());
+
+    nmea::GGA gga;
+    REQUIRE(nmea::parse("$GPGGA,123519.00,4807.038,N,01131.000,E,4,12,0.8,545.4,M,46.9,M,1.2,0031*49", gga) ==
+            nmea::Error::None);
+    nmea::RMC rmc;
+    REQUIRE(nmea::parse("$GPRMC,123519.00,A,4807.038,N,01131.000,E,010.0,090.0,141026,,,A*59", rmc) ==
+            nmea::Error::None);
+    bridge.update(gga);
+    bridge.update(rmc);
+    CHECK(bridge.has_fix());
+
+    // The first round sends both rapid updates and the 7 frame GNSS position (with reference station)
+    sent.clear();
+    CHECK(bridge.poll(now + std::chrono::milliseconds(1000)) == 2 + 7);
+    REQUIRE(sent.size() == 9);
+    CHECK(sent[0].identifier == n2k_can_id(PGN_POSITION_RAPID, 0x80, 2));
+    CHECK(sent[0].isExtendedFrame);
+    CHECK(sent[0].dataLength == 8);
+    CHECK(sent[1].identifier == n2k_can_id(PGN_COG_SOG_RAPID, 0x80, 2));
+    CHECK(read_le(sent[1].data + 4, 2) == 514); // 10 knots in 0.01 m/s
+    CHECK(sent[2].identifier == n2k_can_id(PGN_GNSS_POSITION, 0x80, 3));
+    CHECK(sent[2].data[1] == GNSS_POSITION_MAX_SIZE);
+    CHECK(read_le(sent[2].data + 3, 2) == 20740); // 2026-10-14 in days since 1970
+    CHECK(sent[1].data[0] == sent[2].data[2]);    // COG/SOG and position share the SID
+
+    // Nothing is due again until the rapid interval has passed
+    CHECK(bridge.poll(now + std::chrono::milliseconds(1050)) == 0);
+    CHECK(bridge.poll(now + std::chrono::milliseconds(1100)) == 2);
+    CHECK(bridge.poll(now + std::chrono::milliseconds(2000)) == 2 + 7);
+
+    // A stale fix stops the output
+    CHECK(bridge.poll(now + std::chrono::milliseconds(5000)) == 0);
+
+    auto stats = bridge.get_statistics();
+    CHECK(stats.position_rapid_sent == 3);
+    CHECK(stats.gnss_position_sent == 2);
+    CHECK(stats.send_failures == 0);
+}
+
+TEST_CASE("GNSS bridge sending thread") {
+    GnssBridge bridge;
+    std::atomic<size_t> frames{0};
+    bridge.set_sink([&](const isobus::CANMessageFrame &) {
+        frames++;
+        return true;
+    });
+
+    nmea::GGA gga;
+    REQUIRE(nmea::parse("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47", gga) == nmea::Error::None);
+    bridge.update(gga);
+
+    REQUIRE(bridge.start());
+    CHECK(bridge.is_running());
+    CHECK_FALSE(bridge.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    bridge.stop();
+    CHECK_FALSE(bridge.is_running());
+
+    // Position rapid every 100 ms plus one GNSS position, no COG/SOG without course
+    auto stats = bridge.get_statistics();
+    CHECK(stats.position_rapid_sent >= 2);
+    CHECK(stats.cog_sog_sent == 0);
+    CHECK(stats.gnss_position_sent == 1);
+    CHECK(frames == stats.frames_sent);
+}
@@ -0,0 +1,199 @@
+#include "pty_helpers.hpp"
+#include "tractor/comms/hotplug.hpp"
+#include "tractor/comms/serial.hpp"
+#include <atomic>
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace tractor::comms;
+
+namespace fs = std::filesystem;
+
+// Scratch directory standing in for /dev, removed with everything in it
+struct TempDirectory {
+    fs::path path;
+
+    TempDirectory() {
+        char name[] = "/tmp/tractor_hotplug_XXXXXX";
+        if (mkdtemp(name) != nullptr) {
+            path = name;
+        }
+    }
+
+    ~TempDirectory() {
+        std::error_code error;
+        fs::remove_all(path, error);
+    }
+};
+
+struct Recorder {
+    std::mutex mutex;
+    std::vector<std::pair<HotplugEvent, std::string>> events;
+
+    HotplugMonitor::Callback callback() {
+        return [this](HotplugEvent event, const PortDescription &port) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.emplace_back(event, port.path);
+        };
+    }
+
+    bool saw(HotplugEvent event, const std::string &path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &[seen, seen_path] : events) {
+            if (seen == event && seen_path == path) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+static void touch(const fs::path &path) {
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+TEST_CASE("PortMatch") {
+    PortDescription port;
+    port.path = "/dev/serial/by-id/usb-u-blox_GNSS_receiver-if00";
+    port.device = "/dev/ttyACM0";
+    port.by_id = port.path;
+    port.vendor_id = 0x1546;
+    port.product_id = 0x01a9;
+    port.serial_number = "A1B2";
+
+    CHECK(PortMatch{}.matches(port));
+    CHECK_FALSE(PortMatch{}.by_attributes());
+
+    PortMatch by_path;
+    by_path.path = "/dev/ttyACM0";
+    CHECK(by_path.matches(port));
+    CHECK_FALSE(by_path.by_attributes());
+    by_path.path = "/dev/ttyACM1";
+    CHECK_FALSE(by_path.matches(port));
+
+    PortMatch by_usb;
+    by_usb.vendor_id = 0x1546;
+    by_usb.product_id = 0x01a9;
+    CHECK(by_usb.by_attributes());
+    CHECK(by_usb.matches(port));
+    by_usb.serial_number = "other";
+    CHECK_FALSE(by_usb.matches(port));
+}
+
+TEST_CASE("HotplugMonitor") {
+    TempDirectory dir;
+    REQUIRE_FALSE(dir.path.empty());
+    touch(dir.path / "present");
+
+    HotplugMonitor monitor({dir.path.string(), (dir.path / "serial/by-id").string()});
+    REQUIRE(monitor.start());
+    CHECK(monitor.is_running());
+
+    SUBCASE("Snapshot of the ports present at start") {
+        auto ports = monitor.ports();
+        REQUIRE(ports.size() == 1);
+        CHECK(ports[0].path == (dir.path / "present").string());
+
+        PortMatch match;
+        match.path = (dir.path / "present").string();
+        PortDescription port;
+        CHECK(monitor.find(match, port));
+        match.path = (dir.path / "absent").string();
+        CHECK_FALSE(monitor.find(match, port));
+    }
+
+    SUBCASE("Added and removed devices") {
+        Recorder recorder;
+        PortMatch match;
+        match.path = (dir.path / "ttyUSB0").string();
+        REQUIRE(monitor.subscribe(match, recorder.callback()) != 0);
+
+        touch(dir.path / "ttyUSB1");
+        touch(dir.path / "ttyUSB0");
+        CHECK(wait_for([&] { return recorder.saw(HotplugEvent::Added, match.path); }));
+
+        fs::remove(dir.path / "ttyUSB0");
+        CHECK(wait_for([&] { return recorder.saw(HotplugEvent::Removed, match.path); }));
+        CHECK_FALSE(recorder.saw(HotplugEvent::Added, (dir.path / "ttyUSB1").string()));
+    }
+
+    SUBCASE("Link directory created later") {
+        Recorder recorder;
+        REQUIRE(monitor.subscribe(PortMatch{}, recorder.callback()) != 0);
+
+        // udev creates the directory and its first link in quick succession
+        fs::create_directories(dir.path / "serial/by-id");
+        fs::create_symlink(dir.path / "present", dir.path / "serial/by-id/usb-adapter");
+        std::string link = (dir.path / "serial/by-id/usb-adapter").string();
+        CHECK(wait_for([&] { return recorder.saw(HotplugEvent::Added, link); }));
+
+        PortDescription port;
+        REQUIRE(describe_port(link, port));
+        CHECK(port.by_id == link);
+        CHECK(port.device == fs::canonical(dir.path / "present").string());
+    }
+
+    monitor.stop();
+    CHECK_FALSE(monitor.is_running());
+}
+
+TEST_CASE("Serial reconnects when its device reappears") {
+    TempDirectory dir;
+    REQUIRE_FALSE(dir.path.empty());
+    auto first = std::make_unique<PtyPair>();
+    REQUIRE_FALSE(first->slave.empty());
+
+    fs::path link = dir.path / "gnss";
+    fs::create_symlink(first->slave, link);
+
+    SerialOptions options;
+    options.port = link.string();
+    options.tty_config.read_timeout_ms = 50;
+    options.auto_reconnect = true;
+    options.reconnect_delay_ms = 5000;
+
+    std::atomic<int> connects{0};
+    Serial serial(options);
+    serial.on_connection([&](bool connected) { connects += connected ? 1 : 0; });
+    REQUIRE(serial.start());
+    REQUIRE(connects == 1);
+
+    // Unplug, the reader then waits the full delay unless the device shows up again
+    first.reset();
+    REQUIRE(wait_for([&] { return !serial.is_connected(); }));
+
+    PtyPair second;
+    REQUIRE_FALSE(second.slave.empty());
+    fs::create_symlink(second.slave, dir.path / "gnss.new");
+    fs::rename(dir.path / "gnss.new", link);
+
+    CHECK(wait_for([&] { return serial.is_connected(); }, 1000));
+    CHECK(connects == 2);
+    serial.stop();
+}
+
+TEST_CASE("Serial starts while its device is missing") {
+    SerialOptions options;
+    options.port = "/dev/tractor_missing_port";
+    Serial serial(options);
+    CHECK_FALSE(serial.start());
+
+    options.auto_reconnect = true;
+    options.hotplug = false;
+    options.reconnect_delay_ms = 10;
+    options.reconnect_max_delay_ms = 40;
+    Serial retrying(options);
+    CHECK(retrying.start());
+    CHECK(retrying.is_running());
+    CHECK_FALSE(retrying.is_connected());
+    retrying.stop();
+    CHECK_FALSE(retrying.is_running());
+}
@@ -0,0 +1,63 @@
+#include "tractor/nmea/dispatcher.hpp"
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+using namespace tractor::nmea;
+
+static_assert(sentence_key("GGA") == 0x474741);
+static_assert(sentence_key("") == 0);
+static_assert(sentence_key("TOOLONGNAME") == 0);
+
+TEST_CASE("Dispatcher routes every talker to one handler") {
+    Dispatcher dispatcher;
+    std::vector<std::string> talkers;
+    REQUIRE(dispatcher.on<GGA>([&](const GGA &gga) {
+        CHECK(gga.fix_quality == 1);
+        talkers.emplace_back("GGA");
+    }));
+    REQUIRE(dispatcher.on("VTG", [&](const Sentence &sentence) { talkers.emplace_back(sentence.talker); }));
+    CHECK(dispatcher.handles("GGA"));
+    CHECK_FALSE(dispatcher.handles("RMC"));
+
+    CHECK(dispatcher.dispatch("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n") ==
+          Error::None);
+    CHECK(dispatcher.dispatch("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*25") == Error::None);
+    CHECK(dispatcher.dispatch("$GNVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*3B") == Error::None);
+
+    REQUIRE(talkers.size() == 3);
+    CHECK(talkers[0] == "GGA");
+    CHECK(talkers[1] == "GP");
+    CHECK(talkers[2] == "GN");
+}
+
+TEST_CASE("Dispatcher proprietary sentences and errors") {
+    Dispatcher dispatcher;
+    int auth_result = -1;
+    REQUIRE(dispatcher.on<PHTG>([&](const PHTG &phtg) { auth_result = phtg.auth_result; }));
+
+    std::vector<Error> errors;
+    dispatcher.on_error([&](std::string_view, Error error) { errors.push_back(error); });
+    std::string unhandled;
+    dispatcher.on_unhandled([&](const Sentence &sentence) { unhandled = std::string(sentence.address); });
+
+    CHECK(dispatcher.dispatch("$PHTG,14:10:2026,12:30:45.50,GAL,OSNMA,1,0*36") == Error::None);
+    CHECK(auth_result == 1);
+
+    CHECK(dispatcher.dispatch("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*25") == Error::Unhandled);
+    CHECK(unhandled == "GPVTG");
+
+    CHECK(dispatcher.dispatch("$PHTG,14:10:2026,12:30:45.50,GAL,OSNMA,1,0*37") == Error::BadChecksum);
+    CHECK(dispatcher.dispatch("garbage") == Error::MissingStart);
+    REQUIRE(errors.size() == 2);
+    CHECK(errors[0] == Error::BadChecksum);
+
+    // Registering again replaces the handler, removing it makes the type unhandled
+    int calls = 0;
+    REQUIRE(dispatcher.on("PHTG", [&](const Sentence &) { calls++; }));
+    CHECK(dispatcher.dispatch("$PHTG,14:10:2026,12:30:45.50,GAL,OSNMA,1,0*36") == Error::None);
+    CHECK(calls == 1);
+    dispatcher.remove("PHTG");
+    CHECK(dispatcher.dispatch("$PHTG,14:10:2026,12:30:45.50,GAL,OSNMA,1,0*36") == Error::Unhandled);
+    CHECK_FALSE(dispatcher.on("", [](const Sentence &) {}));
+}
@@ -0,0 +1,150 @@
+#include "tractor/nmea/nmea.hpp"
+#include <doctest/doctest.h>
+#include <string>
+
+using namespace tractor::nmea;
+
+TEST_CASE("NMEA sentence splitting") {
+    Sentence sentence;
+
+    SUBCASE("Standard sentence") {
+        REQUIRE(split("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*25\r\n", sentence) == Error::None);
+        CHECK(sentence.address == "GPVTG");
+        CHECK(sentence.talker == "GP");
+        CHECK(sentence.type == "VTG");
+        CHECK(sentence.fields == "054.7,T,034.4,M,005.5,N,010.2,K,A");
+        CHECK_FALSE(sentence.proprietary());
+    }
+
+    SUBCASE("Proprietary sentence") {
+        REQUIRE(split("$PHTG,14:10:2026,12:30:45.50,GAL,OSNMA,1,0*36", sentence) == Error::None);
+        CHECK(sentence.talker == "P");
+        CHECK(sentence.type == "HTG");
+        CHECK(sentence.proprietary());
+    }
+
+    SUBCASE("Malformed input") {
+        CHECK(split("", sentence) == Error::Empty);
+        CHECK(split("\r\n", sentence) == Error::Empty);
+        CHECK(split("GPVTG,054.7,T*25", sentence) == Error::MissingStart);
+        CHECK(split("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A", sentence) == Error::MissingChecksum);
+        CHECK(split("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*2", sentence) == Error::MissingChecksum);
+        CHECK(split("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*26", sentence) == Error::BadChecksum);
+        CHECK(split("$*00", sentence) == Error::BadAddress);
+    }
+
+    SUBCASE("Field reader keeps empty fields") {
+        FieldReader reader("a,,b,");
+        std::string_view field;
+        std::string joined;
+        int count = 0;
+        while (reader.next(field)) {
+            joined += "[" + std::string(field) + "]";
+            count++;
+        }
+        CHECK(count == 4);
+        CHECK(joined == "[a][][b][]");
+    }
+}
+
+TEST_CASE("NMEA GGA and RMC") {
+    SUBCASE("GGA with every field") {
+        GGA gga;
+        REQUIRE(parse("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47", gga) == Error::None);
+        CHECK(gga.time.valid);
+        CHECK(gga.time.hour == 12);
+        CHECK(gga.time.minute == 35);
+        CHECK(gga.time.second == doctest::Approx(19.0));
+        CHECK(gga.latitude == doctest::Approx(48.1173));
+        CHECK(gga.longitude == doctest::Approx(11.516666).epsilon(1e-6));
+        CHECK(gga.fix_quality == 1);
+        CHECK(gga.satellites == 8);
+        CHECK(gga.hdop == doctest::Approx(0.9));
+        CHECK(gga.altitude == doctest::Approx(545.4));
+        CHECK(gga.geoid_separation == doctest::Approx(46.9));
+        CHECK(gga.has_position);
+    }
+
+    SUBCASE("GGA hemispheres and missing fix") {
+        GGA gga;
+        REQUIRE(parse("$GPGGA,123519,4807.038,N,01131.000,W,1,08,0.9,545.4,M,46.9,M,,*55", gga) == Error::None);
+        CHECK(gga.longitude < 0.0);
+
+        REQUIRE(parse("$GPGGA,,,,,,0,00,,,M,,M,,*66", gga) == Error::None);
+        CHECK_FALSE(gga.time.valid);
+        CHECK_FALSE(gga.has_position);
+        CHECK(gga.fix_quality == 0);
+    }
+
+    SUBCASE("GGA errors") {
+        GGA gga;
+        CHECK(parse("$GPGGA,123519,48x7.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*0F", gga) == Error::BadField);
+        CHECK(parse("$GPGGA,123519,4807.038,N*27", gga) == Error::TooFewFields);
+        CHECK(parse("$GPGGA,123519,nan,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*38", gga) == Error::BadField);
+        CHECK(parse("$GPGGA,123519,inf,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*38", gga) == Error::BadField);
+        CHECK(parse("$GPGGA,123519,1e3,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*3E", gga) == Error::BadField);
+        CHECK(parse("$GPGGA,123519,9500.0,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*4B", gga) == Error::BadField);
+        CHECK(parse("$GPGGA,123519,4807.038,N,18100.000,E,1,08,0.9,545.4,M,46.9,M,,*4D", gga) == Error::BadField);
+        CHECK(parse("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*25", gga) == Error::WrongType);
+    }
+
+    SUBCASE("RMC") {
+        RMC rmc;
+        REQUIRE(parse("$GNRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A*37", rmc) ==
+                Error::None);
+        CHECK(rmc.active);
+        CHECK(rmc.latitude == doctest::Approx(48.1173));
+        CHECK(rmc.speed_knots == doctest::Approx(22.4));
+        CHECK(rmc.course_deg == doctest::Approx(84.4));
+        CHECK(rmc.has_course);
+        CHECK(rmc.date.valid);
+        CHECK(rmc.date.day == 23);
+        CHECK(rmc.date.month == 3);
+        CHECK(rmc.date.year == 1994);
+        CHECK(rmc.magnetic_variation == doctest::Approx(-3.1));
+        CHECK(rmc.mode == 'A');
+
+        REQUIRE(parse("$GPRMC,123519,A,4807.038,S,01131.000,E,,,230394,,*00", rmc) == Error::None);
+        CHECK(rmc.latitude < 0.0);
+        CHECK_FALSE(rmc.has_course);
+        CHECK(rmc.mode == 'N');
+    }
+}
+
+TEST_CASE("NMEA VTG and GSA") {
+    VTG vtg;
+    REQUIRE(parse("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A*25", vtg) == Error::None);
+    CHECK(vtg.course_true_deg == doctest::Approx(54.7));
+    CHECK(vtg.course_magnetic_deg == doctest::Approx(34.4));
+    CHECK(vtg.speed_knots == doctest::Approx(5.5));
+    CHECK(vtg.speed_kmh == doctest::Approx(10.2));
+    CHECK(vtg.mode == 'A');
+    CHECK(vtg.has_course);
+
+    GSA gsa;
+    REQUIRE(parse("$GNGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1,1*3A", gsa) == Error::None);
+    CHECK(gsa.selection == 'A');
+    CHECK(gsa.fix_type == 3);
+    REQUIRE(gsa.satellite_count == 5);
+    CHECK(gsa.satellites[0] == 4);
+    CHECK(gsa.satellites[4] == 24);
+    CHECK(gsa.pdop == doctest::Approx(2.5));
+    CHECK(gsa.hdop == doctest::Approx(1.3));
+    CHECK(gsa.vdop == doctest::Approx(2.1));
+    CHECK(gsa.system_id == 1);
+}
+
+TEST_CASE("NMEA PHTG") {
+    PHTG phtg;
+    REQUIRE(parse("$PHTG,14:10:2026,12:30:45.50,GAL,OSNMA,1,0*36", phtg) == Error::None);
+    CHECK(phtg.date == "14:10:2026");
+    CHECK(phtg.time == "12:30:45.50");
+    CHECK(phtg.system == "GAL");
+    CHECK(phtg.service == "OSNMA");
+    CHECK(phtg.auth_result == 1);
+    CHECK(phtg.warning == 0);
+
+    CHECK(parse("$PHTG,14:10:2026,12:30:45.50,GALILEO-AND-MORE-SYSTEMS,OSNMA,1,0*1C", phtg) == Error::FieldTooLong);
+    CHECK(parse("$GPGGA,123519,4807.038,N*27", phtg) == Error::WrongType);
+    CHECK(std::string(error_name(Error::BadChecksum)) == "bad checksum");
+}
@@ -0,0 +1,115 @@
+#include "tractor/tc/process_data.hpp"
+#include <doctest/doctest.h>
+#include <thread>
+
+using namespace tractor::tc;
+
+TEST_CASE("ProcessDataStore keys by element and DDI") {
+    ProcessDataStore store(4);
+    auto work_state = store.add(1, 141, 0);
+    auto boom_state = store.add(2, 141, 1);
+    auto rate = store.add(2, 1, 100, true);
+    REQUIRE(work_state != ProcessDataStore::INVALID_HANDLE);
+    REQUIRE(boom_state != ProcessDataStore::INVALID_HANDLE);
+    REQUIRE(rate != ProcessDataStore::INVALID_HANDLE);
+    CHECK(store.size() == 3);
+    CHECK(store.add(2, 141, 5) == boom_state);
+    CHECK(store.get(boom_state) == 1);
+
+    store.set(work_state, 1);
+    store.set(boom_state, 0);
+    int32_t value = -1;
+    CHECK(store.get(1, 141, value));
+    CHECK(value == 1);
+    CHECK(store.get(2, 141, value));
+    CHECK(value == 0);
+    CHECK_FALSE(store.get(3, 141, value));
+    CHECK_FALSE(store.set(0, 141, 1));
+    CHECK(store.contains(2, 1));
+    CHECK_FALSE(store.contains(1, 1));
+
+    CHECK(store.add(4, 1) != ProcessDataStore::INVALID_HANDLE);
+    CHECK(store.add(5, 1) == ProcessDataStore::INVALID_HANDLE);
+    CHECK(store.add(0xFFFF, 0xFFFF) == ProcessDataStore::INVALID_HANDLE);
+    CHECK(store.size() == store.capacity());
+}
+
+TEST_CASE("ProcessDataStore TC callbacks") {
+    ProcessDataStore store;
+    auto actual = store.add(0, 141, 1);
+    auto setpoint = store.add(0, 289, 0, true);
+
+    int32_t value = -1;
+    CHECK(ProcessDataStore::request_value_callback(0, 141, value, &store));
+    CHECK(value == 1);
+    CHECK_FALSE(ProcessDataStore::request_value_callback(1, 141, value, &store));
+    CHECK_FALSE(ProcessDataStore::request_value_callback(0, 141, value, nullptr));
+
+    CHECK(ProcessDataStore::value_command_callback(0, 289, 0x55, &store));
+    CHECK(store.get(setpoint) == 0x55);
+    CHECK_FALSE(ProcessDataStore::value_command_callback(0, 141, 0, &store));
+    CHECK(store.get(actual) == 1);
+    CHECK_FALSE(ProcessDataStore::value_command_callback(0, 1, 0, &store));
+}
+
+TEST_CASE("ProcessDataStore shared by several clients") {
+    const ClientId sprayer = static_cast<ClientId>(1);
+    const ClientId spreader = static_cast<ClientId>(2);
+    ProcessDataStore store;
+    auto legacy = store.add(1, 141, 1);
+    auto sprayer_state = store.add(sprayer, 1, 141, 0);
+    auto spreader_rate = store.add(spreader, 1, 1, 100, true);
+    REQUIRE(sprayer_state != ProcessDataStore::INVALID_HANDLE);
+    REQUIRE(spreader_rate != ProcessDataStore::INVALID_HANDLE);
+    CHECK(sprayer_state != legacy);
+    CHECK(store.find(ClientId::Default, 1, 141) == legacy);
+    CHECK(store.find(sprayer, 1, 1) == ProcessDataStore::INVALID_HANDLE);
+    CHECK(process_data_key(ClientId::Default, 1, 141) == process_data_key(1, 141));
+
+    // The bindings route the callbacks of each client to its own entries
+    int32_t value = -1;
+    CHECK(ProcessDataStore::client_request_value_callback(1, 141, value, store.client(sprayer)));
+    CHECK(value == 0);
+    CHECK(ProcessDataStore::client_request_value_callback(1, 141, value, store.client(ClientId::Default)));
+    CHECK(value == 1);
+    CHECK_FALSE(ProcessDataStore::client_request_value_callback(1, 141, value, store.client(spreader)));
+    CHECK_FALSE(ProcessDataStore::client_request_value_callback(1, 141, value, nullptr));
+
+    CHECK(ProcessDataStore::client_value_command_callback(1, 1, 250, store.client(spreader)));
+    CHECK(store.get(spreader_rate) == 250);
+    CHECK_FALSE(ProcessDataStore::client_value_command_callback(1, 141, 1, store.client(sprayer)));
+    CHECK(store.get(sprayer_state) == 0);
+    CHECK(store.set(sprayer, 1, 141, 1));
+    CHECK(store.get(ClientId::Default, 1, 141, value));
+    CHECK(value == 1);
+}
+
+TEST_CASE("ProcessDataStore concurrent producers and readers") {
+    ProcessDataStore store(256);
+    for (uint16_t element = 0; element < 128; element++) {
+        REQUIRE(store.add(element, 141, 0) != ProcessDataStore::INVALID_HANDLE);
+        REQUIRE(store.add(element, 142, 0) != ProcessDataStore::INVALID_HANDLE);
+    }
+
+    std::thread producer([&] {
+        for (int32_t round = 1; round <= 1000; round++) {
+            for (uint16_t element = 0; element < 128; element++) {
+                store.set(element, 141, round);
+            }
+        }
+    });
+    int32_t last = 0;
+    for (int i = 0; i < 1000; i++) {
+        int32_t value = -1;
+        REQUIRE(ProcessDataStore::request_value_callback(64, 141, value, &store));
+        CHECK(value >= last);
+        last = value;
+    }
+    producer.join();
+
+    int32_t value = -1;
+    CHECK(store.get(127, 141, value));
+    CHECK(value == 1000);
+    CHECK(store.get(127, 142, value));
+    CHECK(value == 0);
+}
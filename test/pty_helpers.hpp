@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+// Pseudo terminal pair: the test writes to the master side, Serial opens the slave device
+struct PtyPair {
+    int master = -1;
+    std::string slave;
+
+    PtyPair() {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0) {
+            slave = ptsname(master);
+        }
+    }
+
+    ~PtyPair() {
+        if (master >= 0) {
+            ::close(master);
+        }
+    }
+
+    void send(const std::string &data) const {
+        size_t offset = 0;
+        while (offset < data.size()) {
+            ssize_t written = ::write(master, data.data() + offset, data.size() - offset);
+            if (written <= 0) {
+                break;
+            }
+            offset += written;
+        }
+    }
+};
+
+template <typename Predicate> static bool wait_for(Predicate predicate, int timeout_ms = 2000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (predicate()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return predicate();
+}
@@ -0,0 +1,238 @@
+#include "pty_helpers.hpp"
+#include "tractor/comms/reactor.hpp"
+#include <atomic>
+#include <doctest/doctest.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tractor::comms;
+
+static SerialOptions make_options(const PtyPair &pty) {
+    SerialOptions options;
+    options.port = pty.slave;
+    options.tty_config.baud_rate = 115200;
+    options.tty_config.read_timeout_ms = 100;
+    return options;
+}
+
+TEST_CASE("Reactor construction") {
+    SerialReactor reactor;
+    CHECK_FALSE(reactor.is_running());
+    CHECK(reactor.size() == 0);
+    CHECK(reactor.start());
+    CHECK(reactor.is_running());
+    reactor.stop();
+    CHECK_FALSE(reactor.is_running());
+}
+
+TEST_CASE("Reactor services several ports from one thread") {
+    PtyPair gnss;
+    PtyPair rate_controller;
+    REQUIRE_FALSE(gnss.slave.empty());
+    REQUIRE_FALSE(rate_controller.slave.empty());
+
+    auto reactor = std::make_unique<SerialReactor>();
+    REQUIRE(reactor->start());
+
+    Serial gnss_serial(make_options(gnss));
+    Serial rate_serial(make_options(rate_controller));
+
+    std::mutex mutex;
+    std::vector<std::string> gnss_lines;
+    std::vector<std::string> rate_lines;
+    gnss_serial.on_line([&](const std::string &line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        gnss_lines.push_back(line);
+    });
+    rate_serial.on_line([&](const std::string &line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        rate_lines.push_back(line);
+    });
+
+    REQUIRE(reactor->add(gnss_serial));
+    REQUIRE(reactor->add(rate_serial));
+    CHECK(reactor->size() == 2);
+    CHECK(gnss_serial.is_running());
+    CHECK(gnss_serial.is_connected());
+
+    SUBCASE("Lines from both ports are delivered") {
+        gnss.send("$GPGGA,1*00\r\n$GPRMC,2*00\r\n");
+        rate_controller.send("RATE 120\n");
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return gnss_lines.size() == 2 && rate_lines.size() == 1;
+        }));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(gnss_lines.size() == 2);
+        CHECK(gnss_lines[0] == "$GPGGA,1*00");
+        CHECK(gnss_lines[1] == "$GPRMC,2*00");
+        REQUIRE(rate_lines.size() == 1);
+        CHECK(rate_lines[0] == "RATE 120");
+    }
+
+    SUBCASE("Writes still work on a reactor port") {
+        CHECK(rate_serial.write_line("SET 1"));
+        char buffer[16] = {};
+        CHECK(wait_for([&] { return ::read(rate_controller.master, buffer, sizeof(buffer)) > 0; }));
+        CHECK(std::string(buffer).rfind("SET 1", 0) == 0);
+    }
+
+    SUBCASE("Stopping a serial port detaches it") {
+        gnss_serial.stop();
+        CHECK(reactor->size() == 1);
+        CHECK_FALSE(gnss_serial.is_running());
+        CHECK_FALSE(gnss_serial.is_connected());
+
+        rate_controller.send("RATE 90\n");
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return rate_lines.size() == 1;
+        }));
+    }
+
+    SUBCASE("Destroying the reactor detaches its ports") {
+        reactor.reset();
+        CHECK_FALSE(gnss_serial.is_running());
+        CHECK_FALSE(rate_serial.is_running());
+        CHECK_FALSE(gnss_serial.is_connected());
+    }
+}
+
+TEST_CASE("Reactor ports stopped from their own callback") {
+    PtyPair gnss;
+    PtyPair rate_controller;
+    REQUIRE_FALSE(gnss.slave.empty());
+    REQUIRE_FALSE(rate_controller.slave.empty());
+
+    ReactorOptions reactor_options;
+    SUBCASE("epoll") { reactor_options.backend = ReactorBackend::Epoll; }
+    SUBCASE("io_uring") { reactor_options.backend = ReactorBackend::IoUring; }
+    SerialReactor reactor(reactor_options);
+    REQUIRE(reactor.start());
+
+    Serial gnss_serial(make_options(gnss));
+    Serial rate_serial(make_options(rate_controller));
+    std::atomic<int> gnss_lines{0};
+    std::atomic<int> rate_lines{0};
+    gnss_serial.on_line([&](const std::string &) {
+        gnss_lines++;
+        gnss_serial.stop();
+    });
+    rate_serial.on_line([&](const std::string &) { rate_lines++; });
+    REQUIRE(reactor.add(gnss_serial));
+    REQUIRE(reactor.add(rate_serial));
+
+    // The port is detached once the callback returned, rather than deadlocking its worker
+    gnss.send("$GPGGA,1*00\r\n");
+    CHECK(wait_for([&] { return !gnss_serial.is_running(); }));
+    CHECK(reactor.size() == 1);
+    CHECK_FALSE(gnss_serial.is_connected());
+
+    rate_controller.send("RATE 90\n");
+    CHECK(wait_for([&] { return rate_lines == 1; }));
+    gnss.send("$GPGGA,2*00\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(gnss_lines == 1);
+    reactor.stop();
+}
+
+TEST_CASE("Reactor rejects a port that cannot open") {
+    SerialReactor reactor;
+    SerialOptions options;
+    options.port = "/dev/ttyNONEXISTENT999";
+    Serial serial(options);
+    CHECK_FALSE(reactor.add(serial));
+    CHECK_FALSE(reactor.get_last_error().empty());
+    CHECK(reactor.size() == 0);
+
+    SUBCASE("Unless it should reconnect later") {
+        options.auto_reconnect = true;
+        Serial retrying(options);
+        CHECK(reactor.add(retrying));
+        CHECK(reactor.size() == 1);
+        CHECK(retrying.is_running());
+        CHECK_FALSE(retrying.is_connected());
+    }
+}
+
+TEST_CASE("Reactor with the io_uring backend") {
+    PtyPair gnss;
+    PtyPair rate_controller;
+    REQUIRE_FALSE(gnss.slave.empty());
+    REQUIRE_FALSE(rate_controller.slave.empty());
+
+    // One registered buffer, the second port reads into its own
+    ReactorOptions reactor_options;
+    reactor_options.backend = ReactorBackend::IoUring;
+    reactor_options.ring_buffers = 1;
+    auto reactor = std::make_unique<SerialReactor>(reactor_options);
+    CHECK((reactor->get_backend() == ReactorBackend::IoUring || !reactor->get_last_error().empty()));
+    REQUIRE(reactor->start());
+
+    auto gnss_options = make_options(gnss);
+    gnss_options.tty_config.low_latency = true; // VMIN and VTIME 0, must not spin on empty reads
+    Serial gnss_serial(gnss_options);
+    Serial rate_serial(make_options(rate_controller));
+
+    std::mutex mutex;
+    std::vector<std::string> gnss_lines;
+    std::vector<std::string> rate_lines;
+    gnss_serial.on_line([&](const std::string &line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        gnss_lines.push_back(line);
+    });
+    rate_serial.on_line([&](const std::string &line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        rate_lines.push_back(line);
+    });
+
+    REQUIRE(reactor->add(gnss_serial));
+    REQUIRE(reactor->add(rate_serial));
+
+    gnss.send("$GPGGA,1*00\r\n");
+    rate_controller.send("RATE 120\n");
+    CHECK(wait_for([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return gnss_lines.size() == 1 && rate_lines.size() == 1;
+    }));
+
+    SUBCASE("Reads are posted again after every completion") {
+        for (int i = 0; i < 20; i++) {
+            gnss.send("$GPRMC," + std::to_string(i) + "*00\r\n");
+        }
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return gnss_lines.size() == 21;
+        }));
+        CHECK(gnss_serial.get_statistics().errors == 0);
+    }
+
+    SUBCASE("Removed ports free their buffer for the next one") {
+        reactor->remove(gnss_serial);
+        CHECK(reactor->size() == 1);
+        CHECK_FALSE(gnss_serial.is_running());
+
+        PtyPair spare;
+        Serial spare_serial(make_options(spare));
+        std::atomic<int> spare_lines{0};
+        spare_serial.on_line([&](const std::string &) { spare_lines++; });
+        REQUIRE(reactor->add(spare_serial));
+        spare.send("SPARE\n");
+        rate_controller.send("RATE 90\n");
+        CHECK(wait_for([&] { return spare_lines.load() == 1; }));
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return rate_lines.size() == 2;
+        }));
+    }
+
+    SUBCASE("Destroying the reactor cancels the posted reads") {
+        reactor.reset();
+        CHECK_FALSE(gnss_serial.is_running());
+        CHECK_FALSE(rate_serial.is_connected());
+    }
+}
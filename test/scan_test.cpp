@@ -0,0 +1,103 @@
+#include "tractor/comms/scan.hpp"
+#include <cstring>
+#include <doctest/doctest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace tractor::comms;
+
+static std::vector<SimdLevel> supported_levels() {
+    std::vector<SimdLevel> levels;
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON}) {
+        if (set_simd_level(level) == level) {
+            levels.push_back(level);
+        }
+    }
+    set_simd_level(detected_simd_level());
+    return levels;
+}
+
+TEST_CASE("SIMD level detection") {
+    CHECK(simd_level() == detected_simd_level());
+    CHECK(set_simd_level(SimdLevel::Scalar) == SimdLevel::Scalar);
+    CHECK(simd_level() == SimdLevel::Scalar);
+    CHECK(set_simd_level(detected_simd_level()) == detected_simd_level());
+    CHECK(std::string(simd_level_name(SimdLevel::AVX2)) == "avx2");
+}
+
+TEST_CASE("find_byte matches memchr on every kernel") {
+    std::mt19937 rng(42);
+    std::vector<uint8_t> buffer(300);
+
+    for (auto level : supported_levels()) {
+        set_simd_level(level);
+        MESSAGE("kernel: " << simd_level_name(level));
+
+        for (size_t offset = 0; offset < 4; offset++) {
+            for (size_t size = 0; size + offset <= buffer.size(); size += 7) {
+                for (auto &byte : buffer) {
+                    byte = static_cast<uint8_t>(rng() % 16);
+                }
+                const uint8_t *data = buffer.data() + offset;
+                for (uint8_t value : {uint8_t{0}, uint8_t{5}, uint8_t{15}, uint8_t{200}}) {
+                    auto expected = static_cast<const uint8_t *>(std::memchr(data, value, size));
+                    CHECK(find_byte(data, size, value) == expected);
+                }
+            }
+        }
+
+        // A single match at every position of a 64 byte block, covering every lane of every kernel
+        std::vector<uint8_t> zeros(64, 0);
+        for (size_t pos = 0; pos < zeros.size(); pos++) {
+            zeros[pos] = '\n';
+            CHECK(find_byte(zeros.data(), zeros.size(), '\n') == zeros.data() + pos);
+            zeros[pos] = 0;
+        }
+    }
+
+    set_simd_level(detected_simd_level());
+    CHECK(find_byte(nullptr, 0, 'x') == nullptr);
+}
+
+TEST_CASE("xor_bytes matches a scalar reduction on every kernel") {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> buffer(257);
+    for (auto &byte : buffer) {
+        byte = static_cast<uint8_t>(rng());
+    }
+
+    for (auto level : supported_levels()) {
+        set_simd_level(level);
+        MESSAGE("kernel: " << simd_level_name(level));
+
+        for (size_t offset = 0; offset < 3; offset++) {
+            for (size_t size = 0; size + offset <= buffer.size(); size++) {
+                uint8_t expected = 0;
+                for (size_t i = 0; i < size; i++) {
+                    expected ^= buffer[offset + i];
+                }
+                CHECK(xor_bytes(buffer.data() + offset, size) == expected);
+            }
+        }
+    }
+
+    set_simd_level(detected_simd_level());
+}
+
+TEST_CASE("NMEA checksum") {
+    const std::string gga = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+
+    CHECK(nmea_checksum(gga) == 0x47);
+    CHECK(nmea_checksum("GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,") == 0x47);
+    CHECK(nmea_checksum_valid(gga));
+    CHECK(nmea_checksum_valid(gga + "\r\n"));
+    CHECK(nmea_checksum_valid("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6a"));
+    CHECK(nmea_checksum_valid("!AIVDM,1,1,,B,15M67FC000G?ufbE`FepT@3n00Sa,0*5C"));
+
+    CHECK_FALSE(nmea_checksum_valid("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*48"));
+    CHECK_FALSE(nmea_checksum_valid("$GPGGA,123519,4807.038,N"));
+    CHECK_FALSE(nmea_checksum_valid("$GPGGA,123519*4"));
+    CHECK_FALSE(nmea_checksum_valid("$GPGGA,123519*ZZ"));
+    CHECK_FALSE(nmea_checksum_valid(""));
+}
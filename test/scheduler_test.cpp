@@ -0,0 +1,175 @@
+#include <atomic>
+#include <chrono>
+#include <doctest/doctest.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tractor/scheduler.hpp>
+#include <vector>
+
+using namespace std::chrono_literals;
+using tractor::Scheduler;
+using tractor::TaskOptions;
+
+static bool wait_for(const std::function<bool()> &condition, std::chrono::milliseconds timeout = 2000ms) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+static TaskOptions task(const char *name, std::chrono::microseconds period, int priority = 0) {
+    TaskOptions options;
+    options.name = name;
+    options.period = period;
+    options.priority = priority;
+    return options;
+}
+
+TEST_CASE("Scheduler periodic tasks") {
+    Scheduler scheduler;
+    std::atomic<int> runs{0};
+    auto id = scheduler.add(task("tick", 10ms), [&] { runs++; });
+    REQUIRE(id != 0);
+    CHECK(scheduler.add(task("empty", 10ms), nullptr) == 0);
+    CHECK(scheduler.size() == 1);
+
+    REQUIRE(scheduler.start());
+    CHECK(scheduler.is_running());
+    std::this_thread::sleep_for(205ms);
+    scheduler.stop();
+    CHECK_FALSE(scheduler.is_running());
+
+    // Releases at start plus whole periods, the first one at start
+    CHECK(runs >= 15);
+    CHECK(runs <= 22);
+    Scheduler::TaskStatistics stats;
+    REQUIRE(scheduler.get_statistics(id, stats));
+    CHECK(stats.runs == static_cast<uint64_t>(runs.load()));
+    CHECK(stats.max_latency < 10ms);
+    CHECK_FALSE(scheduler.get_statistics(id + 100, stats));
+}
+
+TEST_CASE("Scheduler order of due tasks") {
+    Scheduler scheduler;
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int value) {
+        return [&, value] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(value);
+        };
+    };
+
+    auto low = scheduler.add(task("low", 0us, 0), record(1));
+    auto first = scheduler.add(task("first", 0us, 5), record(2));
+    auto second = scheduler.add(task("second", 0us, 5), record(3));
+    CHECK(scheduler.post(low));
+    CHECK(scheduler.post(second));
+    CHECK(scheduler.post(first));
+    CHECK(scheduler.post(first)); // Still pending, one run
+    CHECK_FALSE(scheduler.post(999));
+
+    // Highest priority first, then the earlier release
+    REQUIRE(scheduler.start());
+    REQUIRE(wait_for([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return order.size() == 3;
+    }));
+    std::this_thread::sleep_for(20ms);
+    scheduler.stop();
+    CHECK(order == std::vector<int>{3, 2, 1});
+}
+
+TEST_CASE("Scheduler overruns and removal") {
+    Scheduler scheduler;
+    REQUIRE(scheduler.start());
+
+    SUBCASE("A long run skips the releases it covers") {
+        std::atomic<int> runs{0};
+        auto id = scheduler.add(task("slow", 5ms), [&] {
+            if (runs++ == 0) {
+                std::this_thread::sleep_for(23ms);
+            }
+        });
+        REQUIRE(wait_for([&] { return runs >= 3; }));
+        Scheduler::TaskStatistics stats;
+        REQUIRE(scheduler.get_statistics(id, stats));
+        CHECK(stats.overruns >= 3);
+        CHECK(stats.max_runtime >= 23ms);
+    }
+
+    SUBCASE("A task removing itself") {
+        std::atomic<int> runs{0};
+        Scheduler::TaskId id = 0;
+        std::atomic<bool> added{false};
+        id = scheduler.add(task("once", 1ms), [&] {
+            if (added) {
+                runs++;
+                scheduler.remove(id);
+            }
+        });
+        added = true;
+        REQUIRE(wait_for([&] { return scheduler.size() == 0; }));
+        std::this_thread::sleep_for(10ms);
+        CHECK(runs == 1);
+        CHECK_FALSE(scheduler.remove(id));
+    }
+
+    SUBCASE("remove() waits for the run in progress") {
+        std::atomic<bool> inside{false};
+        std::atomic<bool> finished{false};
+        auto id = scheduler.add(task("busy", 0us), [&] {
+            inside = true;
+            std::this_thread::sleep_for(30ms);
+            finished = true;
+        });
+        std::thread poster([&] { scheduler.post(id); });
+        poster.join();
+        REQUIRE(wait_for([&] { return inside.load(); }));
+        CHECK(scheduler.remove(id));
+        CHECK(finished);
+    }
+
+    SUBCASE("Lanes on other CPUs run in parallel") {
+        std::atomic<bool> release{false};
+        std::atomic<int> other{0};
+        TaskOptions blocking = task("blocking", 0us);
+        auto blocker = scheduler.add(blocking, [&] {
+            while (!release) {
+                std::this_thread::sleep_for(1ms);
+            }
+        });
+        TaskOptions pinned = task("pinned", 2ms);
+        pinned.cpu = 0;
+        scheduler.add(pinned, [&] { other++; });
+        scheduler.post(blocker);
+        CHECK(wait_for([&] { return other >= 5; }));
+        release = true;
+        CHECK(scheduler.get_last_error().empty());
+    }
+
+    SUBCASE("Lanes of the same CPU run in parallel") {
+        std::atomic<bool> release{false};
+        std::atomic<int> other{0};
+        TaskOptions blocking = task("blocking", 0us);
+        blocking.lane = 1;
+        auto blocker = scheduler.add(blocking, [&] {
+            while (!release) {
+                std::this_thread::sleep_for(1ms);
+            }
+        });
+        TaskOptions unblocked = task("unblocked", 2ms);
+        unblocked.lane = 2;
+        scheduler.add(unblocked, [&] { other++; });
+        scheduler.post(blocker);
+        CHECK(wait_for([&] { return other >= 5; }));
+        release = true;
+    }
+
+    scheduler.stop();
+}
@@ -0,0 +1,111 @@
+#include "tractor/tc/section_boom.hpp"
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <random>
+
+using namespace tractor::tc;
+using State = SectionBoom::State;
+
+// The per section loop the condensed states used to be built with
+static uint32_t reference_encoding(const SectionBoom &boom, size_t group, bool setpoint) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < SectionBoom::SECTIONS_PER_GROUP; i++) {
+        size_t section = group * SectionBoom::SECTIONS_PER_GROUP + i;
+        if (section < boom.size()) {
+            State state = setpoint ? boom.setpoint(section) : boom.actual(section);
+            value |= static_cast<uint32_t>(state) << (2 * i);
+        } else {
+            value |= 0x3u << (2 * i);
+        }
+    }
+    return value;
+}
+
+TEST_CASE("SectionBoom condensed work state encoding") {
+    SectionBoom boom(36);
+    CHECK(boom.size() == 36);
+    CHECK(boom.encode_setpoint(0) == 0);
+    CHECK(boom.encode_setpoint(2) == 0xFFFFFF00); // Sections 33-36 installed
+    CHECK(boom.encode_setpoint(3) == 0xFFFFFFFF);
+    CHECK(boom.setpoint(40) == State::NotInstalled);
+
+    boom.set_setpoint(0, State::On);
+    boom.set_setpoint(17, State::On);
+    boom.set_setpoint(35, State::Error);
+    boom.set_setpoint(36, State::On); // Not installed, ignored
+    CHECK(boom.encode_setpoint(0) == 0x00000001);
+    CHECK(boom.encode_setpoint(1) == 0x00000004);
+    CHECK(boom.encode_setpoint(2) == 0xFFFFFF80);
+
+    std::mt19937 random(42);
+    for (int round = 0; round < 50; round++) {
+        SectionBoom::SectionMask mask{};
+        for (auto &word : mask) {
+            word = (static_cast<uint64_t>(random()) << 32) | random();
+        }
+        boom.set_setpoint_mask(mask);
+        boom.set_switch(random() % 36, true);
+        boom.set_auto(round % 2 == 0);
+        for (size_t group = 0; group < SectionBoom::GROUPS; group++) {
+            CHECK(boom.encode_setpoint(group) == reference_encoding(boom, group, true));
+            CHECK(boom.encode_actual(group) == reference_encoding(boom, group, false));
+        }
+    }
+}
+
+TEST_CASE("SectionBoom masks and modes") {
+    SectionBoom boom(96);
+    SectionBoom::SectionMask on{};
+    on[0] = 0x8000000000000001ull; // Sections 1 and 64
+    on[1] = 0xFFFFFFFFFFFFFFFFull; // 65-128, only up to 96 installed
+    boom.set_setpoint_mask(on);
+
+    auto mask = boom.setpoint_mask();
+    CHECK(mask[0] == on[0]);
+    CHECK(mask[1] == 0x00000000FFFFFFFFull);
+    CHECK(mask[2] == 0);
+    CHECK(boom.count_on() == 34);
+    CHECK(boom.actual(63) == State::On);
+    CHECK(boom.encode_actual(6) == 0xFFFFFFFF);
+
+    // Manual mode follows the switches
+    boom.set_auto(false);
+    CHECK(boom.count_on() == 0);
+    boom.set_switch(5, true);
+    CHECK(boom.actual(5) == State::On);
+    CHECK(boom.actual(0) == State::Off);
+    CHECK(boom.actual_mask()[0] == 0x20);
+    boom.set_switch_mask(SectionBoom::SectionMask{0x3});
+    CHECK(boom.count_on() == 2);
+    CHECK(boom.switch_state(5) == State::Off);
+}
+
+TEST_CASE("SectionBoom decodes TC setpoints") {
+    SectionBoom boom(6);
+    boom.set_setpoint(2, State::On);
+
+    // Sections 1 and 2 on, section 3 "not installed" keeps its state, 4 to 6 off, 7 to 16 outside the boom
+    boom.decode_setpoint(0, 0x00000035);
+    CHECK(boom.setpoint(0) == State::On);
+    CHECK(boom.setpoint(1) == State::On);
+    CHECK(boom.setpoint(2) == State::On);
+    CHECK(boom.setpoint(3) == State::Off);
+    CHECK(boom.encode_setpoint(0) == 0xFFFFF015);
+
+    boom.decode_setpoint(0, 0xFFFFF000);
+    CHECK(boom.count_on() == 0);
+    boom.decode_setpoint(16, 0x1); // Out of range, ignored
+    CHECK(boom.encode_setpoint(16) == 0xFFFFFFFF);
+    CHECK(boom.encode_actual(SIZE_MAX) == 0xFFFFFFFF);
+
+    bool setpoint = false;
+    size_t group = 0;
+    CHECK(condensed_work_state_group(290, setpoint, group));
+    CHECK(setpoint);
+    CHECK(group == 0);
+    CHECK(condensed_work_state_group(176, setpoint, group));
+    CHECK_FALSE(setpoint);
+    CHECK(group == 15);
+    CHECK_FALSE(condensed_work_state_group(177, setpoint, group));
+    CHECK_FALSE(condensed_work_state_group(306, setpoint, group));
+}
@@ -0,0 +1,154 @@
+#include "pty_helpers.hpp"
+#include "tractor/comms/serial.hpp"
+#include <atomic>
+#include <doctest/doctest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tractor::comms;
+
+static SerialOptions make_options(const PtyPair &pty, OverflowPolicy policy, size_t depth) {
+    SerialOptions options;
+    options.port = pty.slave;
+    options.tty_config.baud_rate = 115200;
+    options.tty_config.read_timeout_ms = 100;
+    options.dispatch = DispatchMode::Queued;
+    options.dispatch_queue_depth = depth;
+    options.overflow_policy = policy;
+    return options;
+}
+
+static std::string numbered_lines(int count) {
+    std::string data;
+    for (int i = 0; i < count; i++) {
+        data += "LINE " + std::to_string(i) + "\n";
+    }
+    return data;
+}
+
+TEST_CASE("Queued dispatch runs callbacks on a dispatcher thread") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    Serial serial(make_options(pty, OverflowPolicy::DropOldest, 16));
+    std::mutex mutex;
+    std::vector<std::string> lines;
+    std::thread::id callback_thread;
+    serial.on_line([&](const std::string &line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        callback_thread = std::this_thread::get_id();
+        lines.push_back(line);
+    });
+    REQUIRE(serial.start());
+
+    pty.send("$GPGGA,1*00\r\n$GPRMC,2*00\r\n");
+    CHECK(wait_for([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lines.size() == 2;
+    }));
+    serial.stop();
+
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0] == "$GPGGA,1*00");
+    CHECK(lines[1] == "$GPRMC,2*00");
+    CHECK(callback_thread != std::this_thread::get_id());
+    CHECK(serial.get_statistics().frames_dropped == 0);
+}
+
+TEST_CASE("Queued dispatch overflow policies") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    const int total = 20;
+    std::mutex mutex;
+    std::vector<std::string> lines;
+    std::atomic<bool> release{false};
+    auto slow_callback = [&](const std::string &line) {
+        // Hold the dispatcher on the first frame until the reader has seen every byte
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        lines.push_back(line);
+    };
+    auto delivered = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lines.size();
+    };
+
+    SUBCASE("Drop newest keeps the frames that were queued first") {
+        Serial serial(make_options(pty, OverflowPolicy::DropNewest, 4));
+        serial.on_line(slow_callback);
+        REQUIRE(serial.start());
+
+        pty.send(numbered_lines(total));
+        CHECK(wait_for([&] { return serial.get_statistics().lines_received == total; }));
+        release = true;
+        CHECK(wait_for([&] { return delivered() + serial.get_statistics().frames_dropped == total; }));
+        serial.stop();
+
+        auto stats = serial.get_statistics();
+        CHECK(stats.frames_dropped > 0);
+        CHECK(lines.size() + stats.frames_dropped == total);
+        REQUIRE_FALSE(lines.empty());
+        CHECK(lines[0] == "LINE 0");
+        CHECK(lines.back() != "LINE 19");
+    }
+
+    SUBCASE("Drop oldest keeps the most recent frames") {
+        Serial serial(make_options(pty, OverflowPolicy::DropOldest, 4));
+        serial.on_line(slow_callback);
+        REQUIRE(serial.start());
+
+        pty.send(numbered_lines(total));
+        CHECK(wait_for([&] { return serial.get_statistics().lines_received == total; }));
+        release = true;
+        CHECK(wait_for([&] { return delivered() + serial.get_statistics().frames_dropped == total; }));
+        serial.stop();
+
+        auto stats = serial.get_statistics();
+        CHECK(stats.frames_dropped > 0);
+        CHECK(lines.size() + stats.frames_dropped == total);
+        REQUIRE_FALSE(lines.empty());
+        CHECK(lines.back() == "LINE 19");
+    }
+
+    SUBCASE("Block delivers every frame") {
+        Serial serial(make_options(pty, OverflowPolicy::Block, 4));
+        serial.on_line(slow_callback);
+        REQUIRE(serial.start());
+
+        pty.send(numbered_lines(total));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK(serial.get_statistics().lines_received < total); // reader is held back by the full queue
+        release = true;
+        CHECK(wait_for([&] { return delivered() == total; }));
+        serial.stop();
+
+        CHECK(serial.get_statistics().frames_dropped == 0);
+        REQUIRE(lines.size() == total);
+        for (int i = 0; i < total; i++) {
+            CHECK(lines[i] == "LINE " + std::to_string(i));
+        }
+    }
+}
+
+TEST_CASE("Stopping drains the dispatch queue") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    Serial serial(make_options(pty, OverflowPolicy::Block, 8));
+    std::atomic<int> count{0};
+    serial.on_line([&](const std::string &) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        count++;
+    });
+    REQUIRE(serial.start());
+
+    pty.send(numbered_lines(5));
+    CHECK(wait_for([&] { return serial.get_statistics().lines_received == 5; }));
+    serial.stop();
+    CHECK(count == 5);
+}
@@ -0,0 +1,394 @@
+#include "pty_helpers.hpp"
+#include "tractor/comms/serial.hpp"
+#include <atomic>
+#include <doctest/doctest.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace tractor::comms;
+
+static SerialOptions make_options(const PtyPair &pty, FramingMode framing) {
+    SerialOptions options;
+    options.port = pty.slave;
+    options.tty_config.baud_rate = 115200;
+    options.tty_config.read_timeout_ms = 100;
+    options.framing = framing;
+    return options;
+}
+
+TEST_CASE("Serial line framing") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    SUBCASE("Several lines in one chunk") {
+        Serial serial(make_options(pty, FramingMode::LineDelimited));
+        std::mutex mutex;
+        std::vector<std::string> lines;
+        serial.on_line([&](const std::string &line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+        });
+        REQUIRE(serial.start());
+
+        pty.send("$GPGGA,1*00\r\n$GPRMC,2*00\r\n\n$PHTG,3*00\r\n");
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return lines.size() == 3;
+        }));
+        serial.stop();
+
+        REQUIRE(lines.size() == 3);
+        CHECK(lines[0] == "$GPGGA,1*00");
+        CHECK(lines[1] == "$GPRMC,2*00");
+        CHECK(lines[2] == "$PHTG,3*00");
+
+        auto stats = serial.get_statistics();
+        CHECK(stats.lines_received == 3);
+        CHECK(stats.bytes_received == 39);
+        CHECK(stats.errors == 0);
+    }
+
+    SUBCASE("Line split across writes") {
+        Serial serial(make_options(pty, FramingMode::LineDelimited));
+        std::mutex mutex;
+        std::vector<std::string> lines;
+        serial.on_line([&](const std::string &line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+        });
+        REQUIRE(serial.start());
+
+        pty.send("$GNGGA,12");
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        pty.send("34*00\r");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pty.send("\n");
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return lines.size() == 1;
+        }));
+        serial.stop();
+
+        REQUIRE(lines.size() == 1);
+        CHECK(lines[0] == "$GNGGA,1234*00");
+    }
+
+    SUBCASE("Overlong line is reported and discarded") {
+        auto options = make_options(pty, FramingMode::LineDelimited);
+        options.max_line_length = 8;
+        Serial serial(options);
+        std::mutex mutex;
+        std::vector<std::string> lines;
+        std::atomic<int> errors{0};
+        serial.on_line([&](const std::string &line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+        });
+        serial.on_error([&](const std::string &) { errors++; });
+        REQUIRE(serial.start());
+
+        pty.send("0123456789\nok\n");
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return lines.size() == 2;
+        }));
+        serial.stop();
+
+        REQUIRE(lines.size() == 2);
+        CHECK(lines[0] == "9");
+        CHECK(lines[1] == "ok");
+        CHECK(errors == 1);
+        CHECK(serial.get_statistics().errors == 1);
+    }
+}
+
+TEST_CASE("Serial binary framing") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    std::mutex mutex;
+    std::vector<std::vector<uint8_t>> messages;
+    auto collect = [&](const std::vector<uint8_t> &data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back(data);
+    };
+    auto count = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return messages.size();
+    };
+
+    SUBCASE("Fixed length") {
+        auto options = make_options(pty, FramingMode::FixedLength);
+        options.fixed_length = 4;
+        Serial serial(options);
+        serial.on_data(collect);
+        REQUIRE(serial.start());
+
+        pty.send(std::string("\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a", 10));
+        CHECK(wait_for([&] { return count() == 2; }));
+        serial.stop();
+
+        REQUIRE(messages.size() == 2);
+        CHECK(messages[0] == std::vector<uint8_t>{1, 2, 3, 4});
+        CHECK(messages[1] == std::vector<uint8_t>{5, 6, 7, 8});
+        CHECK(serial.get_statistics().bytes_received == 8);
+    }
+
+    SUBCASE("Length prefixed") {
+        Serial serial(make_options(pty, FramingMode::LengthPrefixed));
+        serial.on_data(collect);
+        REQUIRE(serial.start());
+
+        pty.send(std::string("\x02\xaa\xbb\x00\x03\x01\x02\x03", 8));
+        CHECK(wait_for([&] { return count() == 2; }));
+        serial.stop();
+
+        REQUIRE(messages.size() == 2);
+        CHECK(messages[0] == std::vector<uint8_t>{0xaa, 0xbb});
+        CHECK(messages[1] == std::vector<uint8_t>{1, 2, 3});
+        CHECK(serial.get_statistics().bytes_received == 7);
+    }
+
+    SUBCASE("Length prefixed frame that stalls counts as an error") {
+        Serial serial(make_options(pty, FramingMode::LengthPrefixed));
+        serial.on_data(collect);
+        REQUIRE(serial.start());
+
+        pty.send(std::string("\x05\x01\x02", 3));
+        CHECK(wait_for([&] { return serial.get_statistics().errors == 1; }));
+        pty.send(std::string("\x01\x09", 2));
+        CHECK(wait_for([&] { return count() == 1; }));
+        serial.stop();
+
+        REQUIRE(messages.size() == 1);
+        CHECK(messages[0] == std::vector<uint8_t>{9});
+    }
+
+    SUBCASE("Custom delimiter") {
+        auto options = make_options(pty, FramingMode::Custom);
+        options.custom_delimiter = 0x7e;
+        Serial serial(options);
+        serial.on_data(collect);
+        REQUIRE(serial.start());
+
+        pty.send(std::string("\x10\x11\x7e\x7e\x12\x7e", 6));
+        CHECK(wait_for([&] { return count() == 2; }));
+        serial.stop();
+
+        REQUIRE(messages.size() == 2);
+        CHECK(messages[0] == std::vector<uint8_t>{0x10, 0x11});
+        CHECK(messages[1] == std::vector<uint8_t>{0x12});
+        CHECK(serial.get_statistics().bytes_received == 6);
+    }
+}
+
+TEST_CASE("Serial view callbacks") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    SUBCASE("Lines as views, alongside the copying callback") {
+        Serial serial(make_options(pty, FramingMode::LineDelimited));
+        std::mutex mutex;
+        std::vector<std::string> views;
+        std::vector<std::string> copies;
+        serial.on_line_view([&](std::string_view line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            views.emplace_back(line);
+        });
+        serial.on_line([&](const std::string &line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            copies.push_back(line);
+        });
+        REQUIRE(serial.start());
+
+        pty.send("$GPGGA,1*00\r\n$GPRMC,");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pty.send("2*00\r\n");
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return views.size() == 2 && copies.size() == 2;
+        }));
+        serial.stop();
+
+        REQUIRE(views.size() == 2);
+        CHECK(views[0] == "$GPGGA,1*00");
+        CHECK(views[1] == "$GPRMC,2*00");
+        CHECK(copies == views);
+        CHECK(serial.get_statistics().lines_received == 2);
+    }
+
+    SUBCASE("Binary frames as spans") {
+        auto options = make_options(pty, FramingMode::FixedLength);
+        options.fixed_length = 3;
+        Serial serial(options);
+        std::mutex mutex;
+        std::vector<std::vector<uint8_t>> messages;
+        serial.on_data_view([&](std::span<const uint8_t> data) {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.emplace_back(data.begin(), data.end());
+        });
+        REQUIRE(serial.start());
+
+        pty.send(std::string("\x01\x02\x03\x04", 4));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pty.send(std::string("\x05\x06", 2));
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return messages.size() == 2;
+        }));
+        serial.stop();
+
+        REQUIRE(messages.size() == 2);
+        CHECK(messages[0] == std::vector<uint8_t>{1, 2, 3});
+        CHECK(messages[1] == std::vector<uint8_t>{4, 5, 6});
+    }
+
+    SUBCASE("Writing a span") {
+        Serial serial(make_options(pty, FramingMode::FixedLength));
+        REQUIRE(serial.start());
+
+        const uint8_t frame[] = {0xde, 0xad, 0xbe, 0xef};
+        CHECK(serial.write(std::span<const uint8_t>(frame)));
+
+        uint8_t buffer[8] = {};
+        ssize_t received = 0;
+        CHECK(wait_for([&] {
+            ssize_t n = ::read(pty.master, buffer + received, sizeof(buffer) - received);
+            if (n > 0) {
+                received += n;
+            }
+            return received >= 4;
+        }));
+        serial.stop();
+
+        CHECK(received == 4);
+        CHECK(std::vector<uint8_t>(buffer, buffer + 4) == std::vector<uint8_t>(frame, frame + 4));
+        CHECK(serial.get_statistics().bytes_sent == 4);
+    }
+}
+
+TEST_CASE("Serial frame statistics") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    Serial serial(make_options(pty, FramingMode::LineDelimited));
+    std::atomic<int> lines{0};
+    serial.on_line_view([&](std::string_view) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        lines++;
+    });
+    REQUIRE(serial.start());
+
+    pty.send("$GPGGA,1*00\r\n$GPVTG,");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pty.send("2*00\r\n");
+    CHECK(wait_for([&] { return lines == 2; }));
+    serial.stop();
+
+    auto stats = serial.get_statistics();
+    CHECK(stats.frames_received == 2);
+    CHECK(stats.frames_per_second > 0.0);
+    CHECK(stats.callback_time_ns >= 4000000);
+    CHECK(stats.max_callback_time_ns >= 2000000);
+    CHECK(stats.max_callback_time_ns <= stats.callback_time_ns);
+    CHECK(stats.buffer_high_water_mark == 12); // "$GPVTG,2*00\r" was assembled across two reads
+    CHECK(stats.chunk_high_water_mark >= 6);
+
+    uint64_t histogram_total = 0;
+    for (auto bucket : stats.latency_histogram) {
+        histogram_total += bucket;
+    }
+    CHECK(histogram_total == 2);
+    CHECK(stats.latency_percentile_us(100) >= stats.latency_percentile_us(50));
+
+    serial.reset_statistics();
+    stats = serial.get_statistics();
+    CHECK(stats.frames_received == 0);
+    CHECK(stats.bytes_received == 0);
+    CHECK(stats.max_callback_time_ns == 0);
+    CHECK(stats.latency_percentile_us(99) == 0);
+}
+
+TEST_CASE("Serial frame timestamps") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    SUBCASE("Lines carry the reads they arrived with") {
+        Serial serial(make_options(pty, FramingMode::LineDelimited));
+        std::mutex mutex;
+        std::vector<std::string> lines;
+        std::vector<FrameInfo> infos;
+        serial.on_line_view([&](std::string_view line, const FrameInfo &info) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.emplace_back(line);
+            infos.push_back(info);
+        });
+        REQUIRE(serial.start());
+
+        auto sent = std::chrono::steady_clock::now();
+        pty.send("$GPGGA,1*00\r\n$GPRMC,");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pty.send("2*00\r\n");
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return lines.size() == 2;
+        }));
+        serial.stop();
+
+        REQUIRE(infos.size() == 2);
+        CHECK(infos[0].sequence == 0);
+        CHECK(infos[1].sequence == 1);
+        CHECK(infos[0].first_byte >= sent);
+        CHECK(infos[0].first_byte == infos[0].last_byte);
+        CHECK(infos[1].first_byte == infos[0].last_byte);
+        CHECK(infos[1].last_byte - infos[1].first_byte >= std::chrono::milliseconds(15));
+
+        // "$GPRMC," followed the first line in its read, 7 characters at 115200 baud
+        auto backlog = infos[0].last_byte - infos[0].arrival;
+        CHECK(backlog > std::chrono::microseconds(550));
+        CHECK(backlog < std::chrono::microseconds(700));
+        CHECK(infos[1].arrival == infos[1].last_byte);
+    }
+
+    SUBCASE("Queued frames keep their timestamps") {
+        auto options = make_options(pty, FramingMode::FixedLength);
+        options.fixed_length = 2;
+        options.dispatch = DispatchMode::Queued;
+        Serial serial(options);
+        std::mutex mutex;
+        std::vector<FrameInfo> infos;
+        serial.on_data_view([&](std::span<const uint8_t> data, const FrameInfo &info) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (data.size() == 2) {
+                infos.push_back(info);
+            }
+        });
+        REQUIRE(serial.start());
+
+        pty.send(std::string("\x01\x02\x03", 3));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pty.send(std::string("\x04", 1));
+        CHECK(wait_for([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return infos.size() == 2;
+        }));
+        serial.stop();
+
+        REQUIRE(infos.size() == 2);
+        CHECK(infos[1].sequence == 1);
+        CHECK(infos[1].first_byte == infos[0].last_byte);
+        CHECK(infos[1].last_byte - infos[1].first_byte >= std::chrono::milliseconds(15));
+        CHECK(infos[0].arrival < infos[0].last_byte);
+    }
+}
+
+TEST_CASE("Latency percentile from the histogram") {
+    Serial::Statistics stats;
+    stats.latency_histogram[3] = 90; // 8..16 us
+    stats.latency_histogram[10] = 10; // 1..2 ms
+    CHECK(stats.latency_percentile_us(50) == 16);
+    CHECK(stats.latency_percentile_us(90) == 16);
+    CHECK(stats.latency_percentile_us(95) == 2048);
+    CHECK(stats.latency_percentile_us(100) == 2048);
+}
@@ -1,6 +1,9 @@
+#include "pty_helpers.hpp"
 #include "tractor/comms/tty.hpp"
 #include <chrono>
 #include <doctest/doctest.h>
+#include <sys/uio.h>
+#include <termios.h>
 #include <thread>
 
 using namespace tractor::comms;
@@ -13,6 +16,7 @@ TEST_CASE("Serial Configuration Tests") {
         CHECK(config.parity == Parity::None);
         CHECK(config.stop_bits == StopBits::One);
         CHECK(config.flow_control == FlowControl::None);
+        CHECK_FALSE(config.low_latency);
     }
 
     SUBCASE("Custom configuration") {
@@ -157,6 +161,13 @@ TEST_CASE("Serial Error Handling") {
         CHECK_FALSE(serial.get_last_error().empty());
     }
 
+    SUBCASE("Vectored write to closed port") {
+        char data[] = "test";
+        struct iovec iov = {data, 4};
+        CHECK(serial.write_vectored(&iov, 1) == -1);
+        CHECK(serial.write_vectored(nullptr, 0) == 0);
+    }
+
     SUBCASE("Read from closed port") {
         uint8_t buffer[10];
         ssize_t result = serial.read(buffer, 10);
@@ -271,3 +282,70 @@ TEST_CASE("Serial Open Tests") {
         CHECK_FALSE(serial.get_last_error().empty());
     }
 }
+
+TEST_CASE("Serial Low Latency Profile") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    SUBCASE("Disabled by default") {
+        Tty serial(pty.slave, 115200);
+        REQUIRE(serial.open());
+        CHECK_FALSE(serial.get_latency_report().requested);
+    }
+
+    SUBCASE("Reads return immediately and missing driver support is reported") {
+        SerialConfig config;
+        config.baud_rate = 115200;
+        config.low_latency = true;
+        Tty serial(pty.slave, config);
+        REQUIRE(serial.open());
+
+        struct termios tty;
+        REQUIRE(tcgetattr(serial.get_fd(), &tty) == 0);
+        CHECK(tty.c_cc[VMIN] == 0);
+        CHECK(tty.c_cc[VTIME] == 0);
+
+        // A pseudo terminal has neither serial flags nor a USB latency timer
+        auto report = serial.get_latency_report();
+        CHECK(report.requested);
+        CHECK_FALSE(report.async_low_latency);
+        CHECK(report.latency_timer_ms == -1);
+        CHECK(report.latency_timer_path.empty());
+        CHECK(report.notes.size() == 2);
+
+        pty.send("$GPGGA\n");
+        uint8_t buffer[16];
+        CHECK(serial.read(buffer, sizeof(buffer)) == 7);
+    }
+}
+
+TEST_CASE("Serial Non Standard Baud Rates") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+
+    SUBCASE("Opening at a rate without a Bxxx constant") {
+        Tty serial(pty.slave, 250000);
+        REQUIRE(serial.open());
+        CHECK(serial.get_baud_rate() == 250000);
+    }
+
+    SUBCASE("Switching between standard and non standard rates") {
+        Tty serial(pty.slave, 115200);
+        REQUIRE(serial.open());
+        CHECK(serial.get_baud_rate() == 115200);
+
+        CHECK(serial.set_baud_rate(1843200));
+        CHECK(serial.get_baud_rate() == 1843200);
+
+        CHECK(serial.set_baud_rate(9600));
+        CHECK(serial.get_baud_rate() == 9600);
+    }
+
+    SUBCASE("Zero is rejected") {
+        Tty serial(pty.slave, 115200);
+        REQUIRE(serial.open());
+        CHECK_FALSE(serial.set_baud_rate(0));
+        CHECK(serial.get_last_error() == "Unsupported baud rate");
+        CHECK(serial.get_baud_rate() == 115200);
+    }
+}
@@ -0,0 +1,119 @@
+#include "pty_helpers.hpp"
+#include "tractor/comms/serial.hpp"
+#include <atomic>
+#include <doctest/doctest.h>
+#include <mutex>
+#include <string>
+#include <sys/uio.h>
+#include <vector>
+
+using namespace tractor::comms;
+
+static SerialOptions make_options(const PtyPair &pty) {
+    SerialOptions options;
+    options.port = pty.slave;
+    options.tty_config.baud_rate = 115200;
+    options.tty_config.read_timeout_ms = 100;
+    options.write_queue_size = 64;
+    options.write_queue_depth = 8;
+    return options;
+}
+
+static std::string drain(const PtyPair &pty, size_t expected) {
+    std::string received;
+    char buffer[256];
+    wait_for([&] {
+        ssize_t n = ::read(pty.master, buffer, sizeof(buffer));
+        if (n > 0) {
+            received.append(buffer, n);
+        }
+        return received.size() >= expected;
+    });
+    return received;
+}
+
+TEST_CASE("Asynchronous writes") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+    fcntl(pty.master, F_SETFL, O_NONBLOCK);
+
+    SUBCASE("Fails while not connected") {
+        Serial serial(make_options(pty));
+        CHECK_FALSE(serial.write_async(std::string("$PCMD,1\r\n")));
+        CHECK(serial.flush(10));
+    }
+
+    SUBCASE("Queued writes arrive in order and report completion") {
+        Serial serial(make_options(pty));
+        REQUIRE(serial.start());
+
+        std::mutex mutex;
+        std::vector<int> completed;
+        for (int i = 0; i < 5; i++) {
+            CHECK(serial.write_async("CMD" + std::to_string(i) + "\n", [&, i](bool success) {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.push_back(success ? i : -1);
+            }));
+        }
+        CHECK(serial.flush());
+
+        CHECK(drain(pty, 25) == "CMD0\nCMD1\nCMD2\nCMD3\nCMD4\n");
+        std::lock_guard<std::mutex> lock(mutex);
+        CHECK(completed == std::vector<int>{0, 1, 2, 3, 4});
+        CHECK(serial.get_statistics().bytes_sent == 25);
+    }
+
+    SUBCASE("Wrapping around the ring keeps the byte order") {
+        Serial serial(make_options(pty));
+        REQUIRE(serial.start());
+
+        std::string expected;
+        for (int i = 0; i < 20; i++) {
+            std::string command = "RATE " + std::to_string(100 + i) + "\n"; // 9 bytes, does not divide 64
+            while (!serial.write_async(command)) {
+                serial.flush(100);
+            }
+            expected += command;
+        }
+        CHECK(serial.flush());
+        CHECK(drain(pty, expected.size()) == expected);
+    }
+
+    SUBCASE("Rejects writes larger than the ring") {
+        Serial serial(make_options(pty));
+        REQUIRE(serial.start());
+        CHECK_FALSE(serial.write_async(std::string(65, 'x')));
+        CHECK(serial.write_async(std::string(64, 'x')));
+        CHECK(serial.flush());
+        CHECK(drain(pty, 64).size() == 64);
+    }
+
+    SUBCASE("Stop flushes pending writes") {
+        Serial serial(make_options(pty));
+        REQUIRE(serial.start());
+        std::atomic<int> done{0};
+        CHECK(serial.write_async(std::string("A\n"), [&](bool success) { done += success ? 1 : 0; }));
+        CHECK(serial.write_async(std::string("B\n"), [&](bool success) { done += success ? 1 : 0; }));
+        serial.stop();
+        CHECK(done == 2);
+        CHECK(drain(pty, 4) == "A\nB\n");
+    }
+}
+
+TEST_CASE("Vectored tty write") {
+    PtyPair pty;
+    REQUIRE_FALSE(pty.slave.empty());
+    fcntl(pty.master, F_SETFL, O_NONBLOCK);
+
+    SerialConfig config;
+    config.baud_rate = 115200;
+    Tty tty(pty.slave, config);
+    REQUIRE(tty.open());
+
+    char first[] = "$PCMD,";
+    char empty[] = "";
+    char second[] = "1*00\r\n";
+    struct iovec iov[3] = {{first, 6}, {empty, 0}, {second, 6}};
+    CHECK(tty.write_vectored(iov, 3) == 12);
+    CHECK(drain(pty, 12) == "$PCMD,1*00\r\n");
+}
@@ -0,0 +1,31 @@
+#include "tractor/can/socketcan.hpp"
+#include <doctest/doctest.h>
+
+using namespace tractor::can;
+
+TEST_CASE("BatchedSocketCan without an interface") {
+    SocketCanOptions options;
+    options.interface = "tractor-missing0";
+    options.receive_timeout_ms = 10;
+    BatchedSocketCan handler(options);
+
+    handler.open();
+    CHECK_FALSE(handler.get_is_valid());
+    CHECK_FALSE(handler.get_last_error().empty());
+
+    isobus::CANMessageFrame frame{};
+    frame.identifier = 0x18EF00FE;
+    frame.isExtendedFrame = true;
+    frame.dataLength = 8;
+    CHECK_FALSE(handler.write_frame(frame));
+    CHECK_FALSE(handler.read_frame(frame));
+
+    auto stats = handler.get_statistics();
+    CHECK(stats.frames_received == 0);
+    CHECK(stats.frames_sent == 0);
+    CHECK(stats.send_calls == 0);
+
+    // Closing a handler that never opened is harmless
+    handler.close();
+    CHECK_FALSE(handler.get_is_valid());
+}
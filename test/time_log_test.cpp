@@ -0,0 +1,283 @@
+#include "tractor/tc/time_log.hpp"
+#include <array>
+#include <cstdlib>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tractor::tc;
+
+static std::string temporary_directory() {
+    char name[] = "/tmp/tractor_time_log_XXXXXX";
+    REQUIRE(mkdtemp(name) != nullptr);
+    return name;
+}
+
+static std::string read_text(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static std::vector<uint8_t> read_binary(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static uint32_t get(const std::vector<uint8_t> &data, size_t offset, size_t bytes) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+    }
+    return value;
+}
+
+// 2024-03-01 12:00:00.250 UTC
+static std::chrono::system_clock::time_point noon() {
+    using namespace std::chrono;
+    return sys_days{year{2024} / March / 1} + hours(12) + milliseconds(250);
+}
+
+TEST_CASE("TimeLogger record layout") {
+    std::filesystem::path directory = temporary_directory();
+    TimeLogOptions options;
+    options.directory = directory.string();
+    options.device_xml = "<DVC A=\"DVC-1\"/>";
+
+    TimeLogger logger(options);
+    CHECK(logger.add_value(0x0084, "DET-1") == 0);
+    CHECK(logger.add_value(0x0074, "DET-2") == 1);
+    REQUIRE(logger.start());
+    CHECK(logger.is_running());
+    CHECK(logger.add_value(0x0001, "DET-1") == -1);
+
+    TimeLogPosition position;
+    position.latitude = 52.1234567;
+    position.longitude = -5.5;
+    position.altitude = 12.345;
+    position.status = 4;
+    position.pdop = 1.5;
+    position.hdop = 0.9;
+    position.satellites = 14;
+
+    std::array<int32_t, 2> values{1000, -20};
+    CHECK(logger.log(noon(), position, values));
+    std::array<TimeLogValue, 1> sparse{{{1, 7}}};
+    CHECK(logger.log(noon() + std::chrono::seconds(1), position, sparse));
+    std::array<TimeLogValue, 1> unknown{{{9, 7}}};
+    CHECK(logger.log(noon() + std::chrono::seconds(2), position, unknown));
+    logger.stop();
+    CHECK_FALSE(logger.log(noon(), position, values));
+
+    auto stats = logger.get_statistics();
+    CHECK(stats.records == 3);
+    CHECK(stats.records_dropped == 0);
+    CHECK(stats.files == 1);
+    REQUIRE(logger.get_files() == std::vector<std::string>{"TLG00001"});
+
+    // Trimmed to the records: 31 bytes each plus 5 per value
+    auto data = read_binary(directory / "TLG00001.bin");
+    REQUIRE(data.size() == 41 + 36 + 31);
+    CHECK(get(data, 0, 4) == 12 * 3600 * 1000 + 250);
+    CHECK(get(data, 4, 2) == 16131);
+    CHECK(static_cast<int32_t>(get(data, 6, 4)) == 521234567);
+    CHECK(static_cast<int32_t>(get(data, 10, 4)) == -55000000);
+    CHECK(static_cast<int32_t>(get(data, 14, 4)) == 12345);
+    CHECK(data[18] == 4);
+    CHECK(get(data, 19, 2) == 15);
+    CHECK(get(data, 21, 2) == 9);
+    CHECK(data[23] == 14);
+    CHECK(get(data, 24, 4) == get(data, 0, 4));
+    CHECK(get(data, 28, 2) == 16131);
+    CHECK(data[30] == 2);
+    CHECK(data[31] == 0);
+    CHECK(static_cast<int32_t>(get(data, 32, 4)) == 1000);
+    CHECK(data[36] == 1);
+    CHECK(static_cast<int32_t>(get(data, 37, 4)) == -20);
+    CHECK(data[41 + 30] == 1);
+    CHECK(data[41 + 31] == 1);
+    CHECK(get(data, 41 + 32, 4) == 7);
+    CHECK(data[77 + 30] == 0);
+
+    auto header = read_text(directory / "TLG00001.xml");
+    CHECK(header.find("<DLV A=\"0084\" B=\"\" C=\"DET-1\"/>") != std::string::npos);
+    CHECK(header.find("<DLV A=\"0074\" B=\"\" C=\"DET-2\"/>") != std::string::npos);
+
+    auto task_data = read_text(directory / "TASKDATA.XML");
+    CHECK(task_data.find("<DVC A=\"DVC-1\"/>") != std::string::npos);
+    CHECK(task_data.find("G=\"4\"") != std::string::npos);
+    CHECK(task_data.find("<TLG A=\"TLG00001\"/>") != std::string::npos);
+
+    // The spare file prepared for rotation is gone
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00002.bin"));
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00002.xml"));
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("TimeLogger escapes XML attributes") {
+    std::filesystem::path directory = temporary_directory();
+    TimeLogOptions options;
+    options.directory = directory.string();
+    options.task_id = "TSK<1>";
+    options.task_name = "Smith & Sons \"North\" field";
+
+    TimeLogger logger(options);
+    CHECK(logger.add_value(0x0084, "DET-'1'") == 0);
+    REQUIRE(logger.start());
+    std::array<int32_t, 1> values{1};
+    CHECK(logger.log(noon(), TimeLogPosition{}, values));
+    logger.stop();
+
+    auto task_data = read_text(directory / "TASKDATA.XML");
+    CHECK(task_data.find("<TSK A=\"TSK&lt;1&gt;\" B=\"Smith &amp; Sons &quot;North&quot; field\" G=\"4\">") !=
+          std::string::npos);
+    auto header = read_text(directory / "TLG00001.xml");
+    CHECK(header.find("C=\"DET-&apos;1&apos;\"") != std::string::npos);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("TimeLogger rotation by size") {
+    std::filesystem::path directory = temporary_directory();
+    TimeLogOptions options;
+    options.directory = directory.string();
+    options.segment_size = 64 * 1024;
+    options.flush_interval_ms = 5;
+
+    TimeLogger logger(options);
+    for (int i = 0; i < 40; i++) {
+        REQUIRE(logger.add_value(static_cast<uint16_t>(0x0100 + i), "DET-1") == i);
+    }
+    REQUIRE(logger.start());
+
+    // 231 bytes per record, so 1000 records need four files of 64 KiB
+    std::array<int32_t, 40> values{};
+    size_t stored = 0;
+    for (int i = 0; i < 1000; i++) {
+        values[0] = i;
+        stored += logger.log(noon() + std::chrono::seconds(i), TimeLogPosition{}, values) ? 1 : 0;
+        if (i % 100 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    logger.stop();
+
+    auto stats = logger.get_statistics();
+    CHECK(stats.records == stored);
+    CHECK(stats.records + stats.records_dropped == 1000);
+    CHECK(stats.files >= 4);
+
+    size_t total = 0;
+    auto task_data = read_text(directory / "TASKDATA.XML");
+    for (const auto &file : logger.get_files()) {
+        CHECK(task_data.find("<TLG A=\"" + file + "\"/>") != std::string::npos);
+        CHECK(std::filesystem::exists(directory / (file + ".xml")));
+        auto size = std::filesystem::file_size(directory / (file + ".bin"));
+        CHECK(size % 231 == 0);
+        total += size;
+    }
+    CHECK(total == stats.bytes_written);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("TimeLogger stops rotating after TLG99999") {
+    std::filesystem::path directory = temporary_directory();
+    {
+        // One complete record without values, left by an earlier run
+        std::vector<uint8_t> record(31, 0);
+        record[4] = 1;
+        std::ofstream file(directory / "TLG99998.bin", std::ios::binary);
+        file.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+    }
+    TimeLogOptions options;
+    options.directory = directory.string();
+    options.segment_size = 64 * 1024;
+    options.flush_interval_ms = 5;
+
+    TimeLogger logger(options);
+    REQUIRE(logger.start());
+    CHECK(logger.get_last_error().find("TLG99999") != std::string::npos);
+
+    // 31 bytes per record, the last file holds 2114 of them
+    std::array<int32_t, 0> values{};
+    for (int i = 0; i < 2500; i++) {
+        logger.log(noon() + std::chrono::seconds(i), TimeLogPosition{}, values);
+    }
+    logger.stop();
+
+    auto stats = logger.get_statistics();
+    CHECK(stats.records == 2114);
+    CHECK(stats.records_dropped == 2500 - 2114);
+    CHECK(logger.get_files() == std::vector<std::string>{"TLG99998", "TLG99999"});
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00000.bin"));
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00001.bin"));
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("TimeLogger start without TASKDATA.XML") {
+    std::filesystem::path directory = temporary_directory();
+    // A directory in the way of TASKDATA.XML makes writing it fail
+    std::filesystem::create_directory(directory / "TASKDATA.XML");
+    TimeLogOptions options;
+    options.directory = directory.string();
+
+    TimeLogger logger(options);
+    CHECK_FALSE(logger.start());
+    CHECK(logger.get_files().empty());
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00001.bin"));
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00002.bin"));
+
+    // The numbers of the removed files are handed out again
+    std::filesystem::remove(directory / "TASKDATA.XML");
+    REQUIRE(logger.start());
+    CHECK(logger.get_files() == std::vector<std::string>{"TLG00001"});
+    logger.stop();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("TimeLogger recovery after power loss") {
+    std::filesystem::path directory = temporary_directory();
+
+    // A time log left at its preallocated size after one record, and one cut off inside a record
+    std::vector<uint8_t> record(31, 0);
+    record[4] = 1;
+    std::vector<uint8_t> leftover(record);
+    leftover.resize(4096, 0);
+    std::vector<uint8_t> cut(record);
+    cut.insert(cut.end(), record.begin(), record.end());
+    cut.back() = 2;
+    cut.resize(cut.size() + 7, 0);
+    std::ofstream(directory / "TLG00006.bin", std::ios::binary)
+        .write(reinterpret_cast<const char *>(cut.data()), static_cast<std::streamsize>(cut.size()));
+    std::ofstream(directory / "TLG00006.xml") << "<TIM/>";
+    std::ofstream(directory / "TLG00007.bin", std::ios::binary)
+        .write(reinterpret_cast<const char *>(leftover.data()), static_cast<std::streamsize>(leftover.size()));
+    std::ofstream(directory / "TLG00007.xml") << "<TIM/>";
+    // The empty spare of the same run
+    std::ofstream(directory / "TLG00008.bin", std::ios::binary) << std::string(4096, '\0');
+    std::ofstream(directory / "TLG00008.xml") << "<TIM/>";
+
+    TimeLogOptions options;
+    options.directory = directory.string();
+    TimeLogger logger(options);
+    logger.add_value(0x0084, "DET-1");
+    REQUIRE(logger.start());
+    CHECK(std::filesystem::file_size(directory / "TLG00006.bin") == 31);
+    CHECK(std::filesystem::file_size(directory / "TLG00007.bin") == 31);
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00008.bin"));
+    CHECK_FALSE(std::filesystem::exists(directory / "TLG00008.xml"));
+
+    std::array<int32_t, 1> values{5};
+    CHECK(logger.log(noon(), TimeLogPosition{}, values));
+    logger.stop();
+
+    REQUIRE(logger.get_files() == std::vector<std::string>{"TLG00006", "TLG00007", "TLG00009"});
+    auto task_data = read_text(directory / "TASKDATA.XML");
+    CHECK(task_data.find("<TLG A=\"TLG00006\"/>") != std::string::npos);
+    CHECK(task_data.find("<TLG A=\"TLG00007\"/>") != std::string::npos);
+    CHECK(task_data.find("<TLG A=\"TLG00009\"/>") != std::string::npos);
+    CHECK(std::filesystem::file_size(directory / "TLG00009.bin") == 36);
+    std::filesystem::remove_all(directory);
+}
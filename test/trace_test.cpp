@@ -0,0 +1,174 @@
+// The tracepoints of this file are compiled in whatever the library was built with
+#define TRACTOR_TRACE
+
+#include <atomic>
+#include <doctest/doctest.h>
+#include <pthread.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tractor/trace.hpp>
+#include <vector>
+
+namespace trace = tractor::trace;
+
+static std::string export_trace() {
+    std::ostringstream out;
+    REQUIRE(trace::write_chrome_trace(out));
+    return out.str();
+}
+
+static size_t occurrences(const std::string &text, const std::string &pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+static void traced_read(uint64_t bytes) {
+    TRACTOR_TRACE_SCOPE("tty", "read");
+    TRACTOR_TRACE_VALUE(bytes);
+}
+
+TEST_CASE("Trace events in the Chrome format") {
+    trace::clear();
+
+    traced_read(82);
+    TRACTOR_TRACE_INSTANT("can", "rx", 0x18EF8000);
+    TRACTOR_TRACE_COUNTER("serial", "queue_depth", 3);
+    TRACTOR_TRACE_INSTANT("test", "quote \" and \\", 0);
+
+    auto stats = trace::get_statistics();
+    CHECK(stats.recorded == 4);
+    CHECK(stats.overwritten == 0);
+
+    std::string json = export_trace();
+    CHECK(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    CHECK(json.find("\n]}\n") == json.size() - 4);
+    CHECK(json.find("\"ph\":\"X\",\"cat\":\"tty\",\"name\":\"read\"") != std::string::npos);
+    CHECK(json.find("\"args\":{\"value\":82}") != std::string::npos);
+    CHECK(json.find("\"ph\":\"i\",\"cat\":\"can\",\"name\":\"rx\"") != std::string::npos);
+    CHECK(json.find("\"args\":{\"value\":418349056}") != std::string::npos);
+    CHECK(json.find("\"ph\":\"C\",\"cat\":\"serial\",\"name\":\"queue_depth\"") != std::string::npos);
+    CHECK(json.find("\"args\":{\"queue_depth\":3}") != std::string::npos);
+    CHECK(json.find("\"name\":\"quote \\\" and \\\\\"") != std::string::npos);
+    CHECK(occurrences(json, "\"name\":\"thread_name\"") >= 1);
+
+    // Timestamps are microseconds with three decimals
+    size_t ts = json.find("\"ts\":");
+    REQUIRE(ts != std::string::npos);
+    size_t dot = json.find('.', ts);
+    CHECK(json.find_first_not_of("0123456789", dot + 1) == dot + 4);
+
+    trace::clear();
+    CHECK(trace::get_statistics().recorded == 0);
+    CHECK(occurrences(export_trace(), "\"ph\":\"X\"") == 0);
+}
+
+TEST_CASE("Trace recording paused") {
+    trace::clear();
+    trace::set_enabled(false);
+    CHECK_FALSE(trace::is_enabled());
+    traced_read(1);
+    TRACTOR_TRACE_INSTANT("test", "paused", 0);
+    trace::set_enabled(true);
+    CHECK(trace::get_statistics().recorded == 0);
+
+    traced_read(2);
+    CHECK(trace::get_statistics().recorded == 1);
+}
+
+TEST_CASE("Trace buffers per thread") {
+    trace::clear();
+    trace::set_buffer_size(16);
+
+    // A new thread gets the smaller buffer and keeps its newest events
+    std::thread worker([] {
+        ::pthread_setname_np(::pthread_self(), "trace-worker");
+        for (uint64_t i = 1; i <= 100; i++) {
+            TRACTOR_TRACE_INSTANT("test", "tick", i);
+        }
+    });
+    worker.join();
+    trace::set_buffer_size(8192);
+
+    auto stats = trace::get_statistics();
+    CHECK(stats.recorded == 100);
+    CHECK(stats.overwritten == 84);
+
+    std::string json = export_trace();
+    CHECK(occurrences(json, "\"name\":\"tick\"") == 16);
+    CHECK(json.find("\"args\":{\"value\":84}") == std::string::npos);
+    CHECK(json.find("\"args\":{\"value\":85}") != std::string::npos);
+    CHECK(json.find("\"args\":{\"value\":100}") != std::string::npos);
+    CHECK(json.find("\"args\":{\"name\":\"trace-worker\"}") != std::string::npos);
+
+    // Buffers of exited threads go with clear()
+    size_t threads = stats.threads;
+    trace::clear();
+    CHECK(trace::get_statistics().threads == threads - 1);
+}
+
+TEST_CASE("Trace tracepoints after a thread's buffer is released") {
+    trace::clear();
+
+    // Constructed before the first tracepoint, so destroyed after the thread's trace handle
+    struct LateTracepoint {
+        ~LateTracepoint() {
+            trace::clear();
+            TRACTOR_TRACE_INSTANT("test", "late", 1);
+        }
+    };
+    std::thread worker([] {
+        static thread_local LateTracepoint late;
+        (void)late;
+        TRACTOR_TRACE_INSTANT("test", "early", 1);
+    });
+    worker.join();
+
+    std::string json = export_trace();
+    CHECK(json.find("\"name\":\"early\"") == std::string::npos);
+    CHECK(json.find("\"name\":\"late\"") == std::string::npos);
+}
+
+TEST_CASE("Trace flows between threads while exporting") {
+    trace::clear();
+    constexpr int ITEMS = 2000;
+
+    std::atomic<int> produced{0};
+    std::atomic<int> consumed{0};
+    int queue_owner = 0;
+    std::thread producer([&] {
+        for (int i = 0; i < ITEMS; i++) {
+            TRACTOR_TRACE_SCOPE("test", "push");
+            TRACTOR_TRACE_FLOW_BEGIN("test", "item", trace::flow_id(&queue_owner, i));
+            produced++;
+        }
+    });
+    std::thread consumer([&] {
+        while (consumed < ITEMS) {
+            if (consumed < produced) {
+                TRACTOR_TRACE_SCOPE("test", "pop");
+                TRACTOR_TRACE_FLOW_END("test", "item", trace::flow_id(&queue_owner, consumed.load()));
+                consumed++;
+            }
+        }
+    });
+
+    // Exports taken while both threads record are consistent
+    for (int i = 0; i < 5; i++) {
+        std::string json = export_trace();
+        CHECK(json.find("\n]}\n") == json.size() - 4);
+    }
+    producer.join();
+    consumer.join();
+
+    std::string json = export_trace();
+    CHECK(occurrences(json, "\"ph\":\"s\"") == ITEMS);
+    CHECK(occurrences(json, "\"ph\":\"f\"") == ITEMS);
+    CHECK(occurrences(json, "\"bp\":\"e\"") == ITEMS);
+    std::string last_id = ",\"id\":" + std::to_string(trace::flow_id(&queue_owner, ITEMS - 1));
+    CHECK(occurrences(json, last_id) == 2);
+    CHECK(trace::get_statistics().recorded == 4 * ITEMS);
+}
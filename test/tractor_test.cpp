@@ -1,7 +1,128 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <doctest/doctest.h>
+#include <string>
 #include <tractor/tractor.hpp>
 
+using namespace std::chrono_literals;
+
+// Serial and scheduler only, nothing needs CAN hardware
+static tractor::TractorOptions without_can() {
+    tractor::TractorOptions options;
+    options.can.interface.clear();
+    options.handle_signals = false;
+    return options;
+}
+
 TEST_CASE("Tractor version") {
     tractor::Tractor trac;
     CHECK(trac.version() == "0.0.1");
 }
+
+TEST_CASE("Tractor start on a missing CAN interface") {
+    tractor::TractorOptions options;
+    options.can.interface = "tractor-missing0";
+    options.can_settle_ms = 0;
+    options.handle_signals = false;
+
+    tractor::Tractor runtime(options);
+    CHECK_FALSE(runtime.start());
+    CHECK_FALSE(runtime.is_running());
+    CHECK(runtime.get_last_error().find("tractor-missing0") != std::string::npos);
+    CHECK(runtime.get_tc_client() == nullptr);
+    CHECK(runtime.run() == -1);
+
+    // Nothing to take down, neither here nor in the destructor
+    runtime.stop();
+    CHECK_FALSE(runtime.is_running());
+}
+
+TEST_CASE("Tractor without CAN") {
+    SUBCASE("A NAME needs an interface") {
+        auto options = without_can();
+        options.name = 0xA00086000CE00001;
+        tractor::Tractor runtime(options);
+        CHECK_FALSE(runtime.start());
+        CHECK_FALSE(runtime.get_last_error().empty());
+    }
+
+    SUBCASE("start() and stop() run the reactor and the scheduler") {
+        tractor::Tractor runtime(without_can());
+        REQUIRE(runtime.start());
+        CHECK(runtime.is_running());
+        CHECK(runtime.start());
+        CHECK(runtime.reactor().is_running());
+        CHECK(runtime.get_can_interface() == nullptr);
+        runtime.stop();
+        CHECK_FALSE(runtime.is_running());
+        CHECK_FALSE(runtime.reactor().is_running());
+        runtime.stop();
+    }
+}
+
+TEST_CASE("Tractor run() returns on request_stop()") {
+    tractor::Tractor runtime(without_can());
+
+    SUBCASE("Requested before run()") {
+        runtime.request_stop();
+        CHECK(runtime.run() == 0);
+        CHECK_FALSE(runtime.is_running());
+    }
+
+    SUBCASE("Requested by a task") {
+        std::atomic<int> runs{0};
+        tractor::TaskOptions task;
+        task.name = "stopper";
+        task.period = 1ms;
+        runtime.scheduler().add(task, [&] {
+            if (++runs == 3) {
+                runtime.request_stop();
+            }
+        });
+        CHECK(runtime.run() == 0);
+        CHECK(runs >= 3);
+        CHECK_FALSE(runtime.is_running());
+    }
+}
+
+TEST_CASE("Tractor add_tc_client") {
+    static const uint8_t ddop[] = {0x44, 0x56, 0x43};
+    tractor::TcClientOptions client;
+    client.name = 0xA00086000CE00002;
+    client.ddop = ddop;
+    client.ddop_size = sizeof(ddop);
+
+    SUBCASE("Ids in order until the pool of ids is taken") {
+        tractor::Tractor runtime(without_can());
+        for (size_t i = 1; i < tractor::tc::MAX_CLIENTS; i++) {
+            CHECK(runtime.add_tc_client(client) == static_cast<tractor::tc::ClientId>(i));
+        }
+        CHECK(runtime.add_tc_client(client) == tractor::tc::ClientId::Default);
+        CHECK_FALSE(runtime.get_last_error().empty());
+    }
+
+    SUBCASE("Without a DDOP") {
+        tractor::Tractor runtime(without_can());
+        client.ddop = nullptr;
+        CHECK(runtime.add_tc_client(client) == tractor::tc::ClientId::Default);
+        CHECK_FALSE(runtime.get_last_error().empty());
+    }
+
+    SUBCASE("Clients exist only once started") {
+        tractor::Tractor runtime(without_can());
+        auto id = runtime.add_tc_client(client);
+        REQUIRE(id != tractor::tc::ClientId::Default);
+        CHECK(runtime.get_tc_client(id) == nullptr);
+        CHECK(runtime.get_control_function(id) == nullptr);
+        CHECK(runtime.get_tc_client(static_cast<tractor::tc::ClientId>(2)) == nullptr);
+    }
+
+    SUBCASE("Not after start()") {
+        tractor::Tractor runtime(without_can());
+        REQUIRE(runtime.start());
+        CHECK(runtime.add_tc_client(client) == tractor::tc::ClientId::Default);
+        CHECK_FALSE(runtime.get_last_error().empty());
+        runtime.stop();
+    }
+}
@@ -57,6 +57,24 @@ option("tests")
     set_description("Enable tests")
 option_end()
 
+option("bench")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build benchmarks")
+option_end()
+
+option("io_uring")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build the io_uring backend of the serial reactor and CAN handler")
+option_end()
+
+option("trace")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Compile in the tracepoints of the serial, CAN and TC paths")
+option_end()
+
 -- Define concord package (from git)
 package("concord")
     add_deps("cmake")
@@ -144,6 +162,12 @@ target("tractor")
     add_includedirs("include", {public = true})
     add_packages("concord", "agisostack")
     add_syslinks("pthread")
+    if has_config("io_uring") then
+        add_defines("TRACTOR_IO_URING")
+    end
+    if has_config("trace") then
+        add_defines("TRACTOR_TRACE", {public = true})
+    end
 
     add_installfiles("include/(tractor/**.hpp)")
     on_install(function (target)
@@ -168,6 +192,18 @@ if has_config("examples") and os.projectdir() == os.curdir() then
     end
 end
 
+-- Benchmarks (only build when tractor is the main project)
+if has_config("bench") and os.projectdir() == os.curdir() then
+    target("tractor_bench")
+        set_kind("binary")
+        add_files("bench/tractor_bench.cpp")
+        add_deps("tractor")
+        add_packages("concord", "agisostack")
+        add_syslinks("pthread")
+        add_includedirs("include")
+    target_end()
+end
+
 -- Tests (only build when tractor is the main project)
 if has_config("tests") and os.projectdir() == os.curdir() then
     for _, filepath in ipairs(os.files("test/*.cpp")) do